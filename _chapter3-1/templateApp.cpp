@@ -47,6 +47,9 @@ OBJMESH *objmesh = NULL;
 
 PROGRAM *program = NULL;
 
+// uniform名称的ID，初始化时解析一次，绘制时无需再比较字符串
+unsigned int modelviewprojectionmatrix_id = 0;
+
 // 是否开启自动旋转
 unsigned char auto_rotate = 1;
 
@@ -64,27 +67,13 @@ TEMPLATEAPP templateApp = { templateAppInit,
                             templateAppToucheCancelled};
 
 //作为供Program结构使用的回调，每次调用Program_draw时都会自动触发该函数；
-//循环检查着色器中所有的uniform变量，并获取对每个变量的控制，可将回调链接到
-//一个或者多个着色器，并在统一位置处理所有的uniform变量更新
+//通过初始化时解析的uniform名称ID直接访问uniform变量，无需比较字符串，
+//只有数值改变时才会上传到着色器
 void program_draw_callback( void *ptr ) {
 
 	PROGRAM *curr_program = ( PROGRAM * )ptr;
 
-	unsigned int i = 0;
-
-	while( i != curr_program->uniform_count ) {
-
-		if( !strcmp( curr_program->uniform_array[ i ].name, "MODELVIEWPROJECTIONMATRIX" ) ) {
-
-			glUniformMatrix4fv( curr_program->uniform_array[ i ].location,
-								1,
-								GL_FALSE,
-								( float * )GFX_get_modelview_projection_matrix() ); 
-		}
-
-
-		++i;
-	}
+	PROGRAM_set_uniform_mat4( curr_program, modelviewprojectionmatrix_id, GFX_get_modelview_projection_matrix() );
 }
 
 //获取obj文件，再获取该文件的网格
@@ -104,6 +93,9 @@ void templateAppInit( int width, int height ) {
 						 0.1f,
 						 100.0f,
 						 0.0f );
+    //解析uniform名称的ID
+	modelviewprojectionmatrix_id = PROGRAM_get_name_id( ( char * )"MODELVIEWPROJECTIONMATRIX" );
+
     //新建一个可自动加载、编译和链接着色器程序的着色器程序
 	program = PROGRAM_create( ( char * )"default",
 							  VERTEX_SHADER,
@@ -47,6 +47,12 @@ OBJMESH *objmesh = NULL;
 
 PROGRAM *program = NULL;
 
+// uniform名称的ID，初始化时解析一次，绘制时无需再比较字符串
+unsigned int modelviewmatrix_id = 0,
+             projectionmatrix_id = 0,
+             normalmatrix_id = 0,
+             lightposition_id = 0;
+
 // 是否开启自动旋转
 unsigned char auto_rotate = 1;
 
@@ -64,34 +70,21 @@ TEMPLATEAPP templateApp = { templateAppInit,
                             templateAppToucheCancelled};
 
 //作为供Program结构使用的回调，每次调用Program_draw时都会自动触发该函数；
-//循环检查着色器中所有的uniform变量，并获取对每个变量的控制，可将回调链接到
-//一个或者多个着色器，并在统一位置处理所有的uniform变量更新
+//通过初始化时解析的uniform名称ID直接访问uniform变量，无需比较字符串，
+//只有数值改变时才会上传到着色器
 void program_draw_callback( void *ptr ) {
 
 	PROGRAM *curr_program = ( PROGRAM * )ptr;
 
-	unsigned int i = 0;
-
-	while( i != curr_program->uniform_count ) {
-        // 处理投影矩阵
-        if(!strcmp(curr_program->uniform_array[i].name, "MODELVIEWMATRIX")) {
-            glUniformMatrix4fv(curr_program->uniform_array[i].location, 1, GL_FALSE, (float *)GFX_get_modelview_matrix());
-        }
-        // 处理投影矩阵
-        else if(!strcmp(curr_program->uniform_array[i].name, "PROJECTIONMATRIX")) {
-            glUniformMatrix4fv(curr_program->uniform_array[i].location, 1, GL_FALSE, (float *) GFX_get_projection_matrix());
-        }
-        // 处理法线矩阵(仅包含旋转，不包括位置，所以3*3)
-        else if(!strcmp(curr_program->uniform_array[i].name, "NORMALMATRIX")) {
-            glUniformMatrix3fv(curr_program->uniform_array[i].location, 1, GL_FALSE, (float *) GFX_get_normal_matrix());
-        }
-        else if(!strcmp(curr_program->uniform_array[i].name, "LIGHTPOSITION")) {
-            vec3 light = {0.0f, 0.0f, 0.0f};  // 暂时设置光源位置为屏幕的中心点
-            glUniformMatrix3fv(curr_program->uniform_array[i].location, 1, GL_FALSE, (float *) &light);
-        }
+    vec3 light = {0.0f, 0.0f, 0.0f};  // 暂时设置光源位置为屏幕的中心点
 
-		++i;
-	}
+    // 处理模型视图矩阵
+    PROGRAM_set_uniform_mat4(curr_program, modelviewmatrix_id, GFX_get_modelview_matrix());
+    // 处理投影矩阵
+    PROGRAM_set_uniform_mat4(curr_program, projectionmatrix_id, GFX_get_projection_matrix());
+    // 处理法线矩阵(仅包含旋转，不包括位置，所以3*3)
+    PROGRAM_set_uniform_mat3(curr_program, normalmatrix_id, GFX_get_normal_matrix());
+    PROGRAM_set_uniform_vec3(curr_program, lightposition_id, &light);
 }
 
 //获取obj文件，再获取该文件的网格
@@ -111,6 +104,12 @@ void templateAppInit( int width, int height ) {
 						 0.1f,
 						 100.0f,
 						 0.0f );
+    //解析uniform名称的ID
+	modelviewmatrix_id = PROGRAM_get_name_id( ( char * )"MODELVIEWMATRIX" );
+	projectionmatrix_id = PROGRAM_get_name_id( ( char * )"PROJECTIONMATRIX" );
+	normalmatrix_id = PROGRAM_get_name_id( ( char * )"NORMALMATRIX" );
+	lightposition_id = PROGRAM_get_name_id( ( char * )"LIGHTPOSITION" );
+
     //新建一个可自动加载、编译和链接着色器程序的着色器程序
 	program = PROGRAM_create( ( char * )"default",
 							  VERTEX_SHADER,
@@ -30,6 +30,12 @@ as being the original software.
 
 OBJ * obj = NULL;
 
+RENDERQUEUE * renderqueue = NULL;
+
+// uniform名称的ID，初始化时解析一次，绘制时无需再比较字符串
+unsigned int diffuse_id = 0,
+             modelviewprojectionmatrix_id = 0;
+
 /* The main structure of the template. This is a pure C struct, you initialize the structure
    as demonstrated below. Depending on the type of your type of app simply comment / uncomment
    which event callback you want to use. */
@@ -68,16 +74,16 @@ void program_bind_attrib_location(void *ptr) {
 void material_draw_callback(void *ptr) {
     OBJMATERIAL * objmaterial = (OBJMATERIAL *)ptr;
     PROGRAM * program = objmaterial->program;
-    unsigned int i = 0;
-    while (i != program->uniform_count) {
-        if (!strcmp(program->uniform_array[i].name, "DIFFUSE")) {
-            glUniform1i(program->uniform_array[i].location, 1);
-        }
-        else if (!strcmp(program->uniform_array[i].name, "MODELVIEWPROJECTIONMATRIX")) {
-            glUniformMatrix4fv(program->uniform_array[i].location, 1, GL_FALSE, (float *)GFX_get_modelview_projection_matrix());
-        }
-        
-        i++;
+    // 只有数值改变时才会上传到着色器
+    PROGRAM_set_uniform_1i(program, diffuse_id, 1);
+    PROGRAM_set_uniform_mat4(program, modelviewprojectionmatrix_id, GFX_get_modelview_projection_matrix());
+}
+
+void renderqueue_pass_callback(unsigned char pass) {
+    // 必须告诉显卡启用混合以及使用纹理的Alpha值，从而对每个可视像素进行混合操作
+    if (pass == RENDERQUEUE_PASS_TRANSPARENT) {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_DST_ALPHA);
     }
 }
 
@@ -100,6 +106,9 @@ void templateAppInit( int width, int height )
     
     obj = OBJ_load(OBJ_FILE, 1);
     
+    diffuse_id = PROGRAM_get_name_id((char *)"DIFFUSE");
+    modelviewprojectionmatrix_id = PROGRAM_get_name_id((char *)"MODELVIEWPROJECTIONMATRIX");
+    
     // 为每个网格对象生成VBO和VAO
     unsigned int i = 0;
     while (i != obj->n_objmesh) {
@@ -155,6 +164,7 @@ void templateAppInit( int width, int height )
     
     mclose(vertex_shader);
     
+    renderqueue = RENDERQUEUE_init(renderqueue_pass_callback);
 }
 
 
@@ -175,47 +185,19 @@ void templateAppDraw( void )
     
     GFX_look_at(&e, &c, &u);
     
-    // 遍历所有对象，并在屏幕上绘制出来
+    // 将所有对象提交到渲染队列，按状态(固体、Alpha测试、透明)排序后再绘制
+    RENDERQUEUE_clear(renderqueue);
     unsigned int i = 0;
     while (i != obj->n_objmesh) {
-        OBJMATERIAL * objmaterial = obj->objmesh[i].objtrianglelist[0].objmaterial;
-        // 判断是否是固体对象
-        if (objmaterial->dissolve == 1.0f) {
-            GFX_push_matrix();
-            GFX_translate(obj->objmesh[i].location.x, obj->objmesh[i].location.y, obj->objmesh[i].location.z);
-            OBJ_draw_mesh(obj, i);
-            GFX_pop_matrix();
-            i++;
-        }
-    }
-    
-    i = 0;
-    while (i != obj->n_objmesh) {
-        OBJMATERIAL * objmaterial = obj->objmesh[i].objtrianglelist[0].objmaterial;
-        // 判断是否是一个Alpha测试对象(dissvole = 0)
-        if (!objmaterial->dissolve) {
-            GFX_push_matrix();
-            GFX_translate(obj->objmesh[i].location.x, obj->objmesh[i].location.y, obj->objmesh[i].location.z);
-            OBJ_draw_mesh(obj, i);
-            GFX_pop_matrix();
-            i++;
-        }
+        GFX_push_matrix();
+        GFX_translate(obj->objmesh[i].location.x, obj->objmesh[i].location.y, obj->objmesh[i].location.z);
+        RENDERQUEUE_add_mesh(renderqueue, obj, i, NULL);
+        GFX_pop_matrix();
+        i++;
     }
     
-    // 必须告诉显卡启用混合以及使用纹理的Alpha值，从而对每个可视像素进行混合操作
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_DST_ALPHA);
-    i = 0;
-    while (i != obj->n_objmesh) {
-        OBJMATERIAL * objmaterial = obj->objmesh[i].objtrianglelist[0].objmaterial;
-        if (objmaterial->dissolve > 0.0f && objmaterial->dissolve < 1.0f) {
-            GFX_push_matrix();
-            GFX_translate(obj->objmesh[i].location.x, obj->objmesh[i].location.y, obj->objmesh[i].location.z);
-            OBJ_draw_mesh(obj, i);
-            GFX_pop_matrix();
-            i++;
-        }
-    }
+    RENDERQUEUE_sort(renderqueue);
+    RENDERQUEUE_draw(renderqueue);
     glDisable(GL_BLEND);
     
 }
@@ -248,6 +230,7 @@ void templateAppAccelerometer( float x, float y, float z )
 void templateAppExit( void )
 {
 	/* Code to run when the application exit, perfect location to free everything. */
+    renderqueue = RENDERQUEUE_free(renderqueue);
     unsigned i = 0;
     while (i != obj->n_objmaterial) {
         SHADER_free(obj->objmaterial[i].program->vertex_shader);
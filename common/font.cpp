@@ -103,7 +103,12 @@ FONT *FONT_free( FONT *font )
 
 	if( font->character_data ) free( font->character_data );
 
-	if( font->tid ) glDeleteTextures( 1, &font->tid );
+	if( font->tid )
+	{
+		glDeleteTextures( 1, &font->tid );
+		
+		GFX_reset_state();
+	}
 
 	free( font );
 	return NULL;
@@ -168,7 +173,7 @@ unsigned char FONT_load( FONT			*font,
 		
 		glGenTextures(1, &font->tid );
 		
-		glBindTexture( GL_TEXTURE_2D, font->tid );
+		GFX_bind_texture( GL_TEXTURE_2D, font->tid );
 		
 		glTexImage2D( GL_TEXTURE_2D,
 					  0,
@@ -199,20 +204,42 @@ unsigned char FONT_load( FONT			*font,
 	\param[in] y The Y position in screen coordinate where to print the first character contain in the text.
 	\param[in] text The string of texture to print on screen.
 	\param[in] color The RGBA color to use to draw the font.	
+	
+	\note The uniform and vertex attribute name ids are interned by the first call.
 */
 void FONT_print( FONT *font, float x, float y, char *text, vec4 *color )
 {
-	char vertex_attribute =  PROGRAM_get_vertex_attrib_location( font->program,
-																 ( char * )"POSITION" ),
-																 
-		 texcoord_attribute = PROGRAM_get_vertex_attrib_location( font->program,
-																 ( char * )"TEXCOORD0" );
+	static unsigned char resolved = 0;
+	
+	static unsigned int position_id,
+						texcoord0_id,
+						modelviewprojectionmatrix_id,
+						diffuse_id,
+						color_id;
+	
+	int vertex_attribute,
+		texcoord_attribute;
+	
+	if( !resolved )
+	{
+		position_id					 = PROGRAM_get_name_id( ( char * )"POSITION" );
+		texcoord0_id				 = PROGRAM_get_name_id( ( char * )"TEXCOORD0" );
+		modelviewprojectionmatrix_id = PROGRAM_get_name_id( ( char * )"MODELVIEWPROJECTIONMATRIX" );
+		diffuse_id					 = PROGRAM_get_name_id( ( char * )"DIFFUSE" );
+		color_id					 = PROGRAM_get_name_id( ( char * )"COLOR" );
+		
+		resolved = 1;
+	}
+	
+	vertex_attribute   = PROGRAM_get_vertex_attrib_location2( font->program, position_id );
+	
+	texcoord_attribute = PROGRAM_get_vertex_attrib_location2( font->program, texcoord0_id );
 
-	glBindVertexArrayOES( 0 );
+	GFX_bind_vertex_array( 0 );
 
-	glBindBuffer( GL_ARRAY_BUFFER, 0 );
+	GFX_bind_buffer( GL_ARRAY_BUFFER, 0 );
 	
-	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+	GFX_bind_buffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
 
 	glDisable( GL_CULL_FACE );
 	
@@ -226,18 +253,17 @@ void FONT_print( FONT *font, float x, float y, char *text, vec4 *color )
 	
 	PROGRAM_draw( font->program );
 
-	glUniformMatrix4fv( PROGRAM_get_uniform_location( font->program, ( char * )"MODELVIEWPROJECTIONMATRIX"),
-						1,
-						GL_FALSE, 
-						( float * )GFX_get_modelview_projection_matrix() );
+	PROGRAM_set_uniform_mat4( font->program,
+							  modelviewprojectionmatrix_id,
+							  GFX_get_modelview_projection_matrix() );
 
-	glUniform1i( PROGRAM_get_uniform_location( font->program, ( char * )"DIFFUSE" ), 0 );
+	PROGRAM_set_uniform_1i( font->program, diffuse_id, 0 );
 	
-	if( color ) glUniform4fv( PROGRAM_get_uniform_location( font->program, ( char * )"COLOR" ), 1, ( float * )color );
+	if( color ) PROGRAM_set_uniform_vec4( font->program, color_id, color );
 
-	glActiveTexture( GL_TEXTURE0 );
+	GFX_active_texture( 0 );
 
-	glBindTexture( GL_TEXTURE_2D, font->tid );
+	GFX_bind_texture( GL_TEXTURE_2D, font->tid );
 	
 	glEnableVertexAttribArray( vertex_attribute );
 	
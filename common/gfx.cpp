@@ -78,6 +78,12 @@ void GFX_start( void )
 		__android_log_print( ANDROID_LOG_INFO, "", "GL_EXTENSIONS:  %s\n"  , ( char * )glGetString( GL_EXTENSIONS ) );
 	#endif
 
+	gfx.index_uint = strstr( ( char * )glGetString( GL_EXTENSIONS ), "GL_OES_element_index_uint" ) != NULL;
+
+	gfx.half_float = strstr( ( char * )glGetString( GL_EXTENSIONS ), "GL_OES_vertex_half_float" ) != NULL;
+
+	GFX_reset_state();
+
 	glHint( GL_GENERATE_MIPMAP_HINT, GL_NICEST );
 	
 	glHint( GL_FRAGMENT_SHADER_DERIVATIVE_HINT_OES, GL_NICEST );
@@ -161,6 +167,213 @@ void GFX_error( void )
 	}
 }
 
+/*!
+	Invalidate the GLES state cache, the next binding of each kind will be sent to the driver.
+	Have to be called after binding programs, VAOs, buffers or textures directly with GLES,
+	and after deleting a GLES object that might be bound (the driver can recycle its id).
+*/
+void GFX_reset_state( void )
+{
+	unsigned int n_issued		  = gfx.state.n_issued,
+				 n_elided		  = gfx.state.n_elided,
+				 n_uniform_issued = gfx.state.n_uniform_issued,
+				 n_uniform_elided = gfx.state.n_uniform_elided;
+
+	memset( &gfx.state, 0xFF, sizeof( GFXSTATE ) );
+	
+	gfx.state.n_issued		   = n_issued;
+	gfx.state.n_elided		   = n_elided;
+	gfx.state.n_uniform_issued = n_uniform_issued;
+	gfx.state.n_uniform_elided = n_uniform_elided;
+}
+
+
+/*!
+	Reset the GLES state cache and uniform upload counters, usually called once per frame.
+*/
+void GFX_reset_state_counter( void )
+{
+	gfx.state.n_issued		   =
+	gfx.state.n_elided		   =
+	gfx.state.n_uniform_issued =
+	gfx.state.n_uniform_elided = 0;
+}
+
+
+/*!
+	Retrieve the GLES state cache counters since the last GFX_reset_state_counter.
+	
+	\param[out] n_issued The number of state changes sent to the driver.
+	\param[out] n_elided The number of state changes skipped because they would not change anything.
+*/
+void GFX_get_state_counter( unsigned int *n_issued, unsigned int *n_elided )
+{
+	*n_issued = gfx.state.n_issued;
+	*n_elided = gfx.state.n_elided;
+}
+
+
+/*!
+	Retrieve the uniform upload counters since the last GFX_reset_state_counter.
+	
+	\param[out] n_issued The number of uniform uploads sent to the driver by PROGRAM_set_uniform.
+	\param[out] n_elided The number of uniform uploads skipped because the value did not change.
+*/
+void GFX_get_uniform_counter( unsigned int *n_issued, unsigned int *n_elided )
+{
+	*n_issued = gfx.state.n_uniform_issued;
+	*n_elided = gfx.state.n_uniform_elided;
+}
+
+
+/*!
+	Cached glUseProgram.
+	
+	\param[in] pid The GLSL program id.
+*/
+void GFX_use_program( unsigned int pid )
+{
+	if( gfx.state.program == pid )
+	{
+		++gfx.state.n_elided;
+		return;
+	}
+	
+	glUseProgram( pid );
+	
+	gfx.state.program = pid;
+	
+	++gfx.state.n_issued;
+}
+
+
+/*!
+	Cached glBindVertexArrayOES. Since the GL_ELEMENT_ARRAY_BUFFER binding is part of the VAO
+	state, binding a different VAO invalidate the cached element array buffer.
+	
+	\param[in] vao The VAO id.
+*/
+void GFX_bind_vertex_array( unsigned int vao )
+{
+	if( gfx.state.vao == vao )
+	{
+		++gfx.state.n_elided;
+		return;
+	}
+	
+	glBindVertexArrayOES( vao );
+	
+	gfx.state.vao				   = vao;
+	gfx.state.element_array_buffer = GFX_STATE_UNKNOWN;
+	
+	++gfx.state.n_issued;
+}
+
+
+/*!
+	Cached glBindBuffer.
+	
+	\param[in] target GL_ARRAY_BUFFER or GL_ELEMENT_ARRAY_BUFFER.
+	\param[in] buffer The VBO id.
+*/
+void GFX_bind_buffer( unsigned int target, unsigned int buffer )
+{
+	unsigned int *binding = target == GL_ELEMENT_ARRAY_BUFFER ?
+							&gfx.state.element_array_buffer :
+							&gfx.state.array_buffer;
+	
+	if( *binding == buffer )
+	{
+		++gfx.state.n_elided;
+		return;
+	}
+	
+	glBindBuffer( target, buffer );
+	
+	*binding = buffer;
+	
+	++gfx.state.n_issued;
+}
+
+
+/*!
+	Cached glActiveTexture.
+	
+	\param[in] unit The texture unit index (0 for GL_TEXTURE0).
+*/
+void GFX_active_texture( unsigned int unit )
+{
+	if( gfx.state.active_texture == unit )
+	{
+		++gfx.state.n_elided;
+		return;
+	}
+	
+	glActiveTexture( GL_TEXTURE0 + unit );
+	
+	gfx.state.active_texture = unit;
+	
+	++gfx.state.n_issued;
+}
+
+
+/*!
+	Cached glBindTexture, for the active texture unit.
+	
+	\param[in] target GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP.
+	\param[in] tid The texture id.
+*/
+void GFX_bind_texture( unsigned int target, unsigned int tid )
+{
+	unsigned int *binding;
+	
+	// Units over MAX_TEXTURE_UNIT are not tracked.
+	if( gfx.state.active_texture >= MAX_TEXTURE_UNIT )
+	{
+		glBindTexture( target, tid );
+		
+		++gfx.state.n_issued;
+		return;
+	}
+	
+	binding = &gfx.state.texture[ gfx.state.active_texture ][ target == GL_TEXTURE_CUBE_MAP ];
+	
+	if( *binding == tid )
+	{
+		++gfx.state.n_elided;
+		return;
+	}
+	
+	glBindTexture( target, tid );
+	
+	*binding = tid;
+	
+	++gfx.state.n_issued;
+}
+
+
+/*!
+	Cached glBindTexture for a specific texture unit. The active texture unit is only switched
+	when the texture is not already bound to the unit.
+	
+	\param[in] unit The texture unit index (0 for GL_TEXTURE0).
+	\param[in] target GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP.
+	\param[in] tid The texture id.
+*/
+void GFX_bind_texture_unit( unsigned int unit, unsigned int target, unsigned int tid )
+{
+	if( unit < MAX_TEXTURE_UNIT && gfx.state.texture[ unit ][ target == GL_TEXTURE_CUBE_MAP ] == tid )
+	{
+		++gfx.state.n_elided;
+		return;
+	}
+	
+	GFX_active_texture( unit );
+	
+	GFX_bind_texture( target, tid );
+}
+
+
 
 /*!
 	Set the current matrix mode that you want to work with. Only the MODELVIEW_MATRIX,
@@ -176,6 +389,38 @@ void GFX_set_matrix_mode( unsigned int mode )
 { gfx.matrix_mode = mode; }
 
 
+/*!
+	Flag the top most matrix of the stack set as target by the GFX_set_matrix_mode function as
+	modified, so the cached modelview projection and normal matrices are computed again the next
+	time they are requested. Only needed after modifying a matrix directly using the pointer
+	returned by GFX_get_modelview_matrix or GFX_get_projection_matrix.
+	
+	\param[in] orthonormal Determine if the modification keeps the rotation part of the modelview matrix
+	orthonormal (1 for translations and rotations), else 0.
+*/
+void GFX_dirty_matrix( unsigned char orthonormal )
+{
+	switch( gfx.matrix_mode )
+	{
+		case MODELVIEW_MATRIX:
+		{
+			gfx.modelview_serial[ gfx.modelview_matrix_index ] = ++gfx.serial;
+			
+			gfx.modelview_orthonormal[ gfx.modelview_matrix_index ] &= orthonormal;
+			
+			break;
+		}
+		
+		case PROJECTION_MATRIX:
+		{
+			gfx.projection_serial[ gfx.projection_matrix_index ] = ++gfx.serial;
+			
+			break;
+		}
+	}
+}
+
+
 /*!
 	Set the current matrix set as target by the GFX_set_matrix_mode to the
 	identity matrix.
@@ -188,6 +433,8 @@ void GFX_load_identity( void )
 		{
 			mat4_identity( GFX_get_modelview_matrix() );
 			
+			gfx.modelview_orthonormal[ gfx.modelview_matrix_index ] = 1;
+			
 			break;
 		}
 		
@@ -205,11 +452,78 @@ void GFX_load_identity( void )
 			break;
 		}		
 	}
+	
+	GFX_dirty_matrix( 1 );
+}
+
+
+/*!
+	Function internally used to save the top most matrix of the current stack at its first
+	overflow, or to restore it once the last ignored push is popped, so the transformations
+	applied in between do not leak into the level below.
+
+	\param[in] restore Determine if the matrix is restored (1) or saved (0).
+*/
+void GFX_overflow_matrix( unsigned char restore )
+{
+	switch( gfx.matrix_mode )
+	{
+		case MODELVIEW_MATRIX:
+		{
+			if( restore )
+			{
+				mat4_copy_mat4( GFX_get_modelview_matrix(), &gfx.overflow_matrix[ MODELVIEW_MATRIX ] );
+
+				gfx.modelview_serial	 [ gfx.modelview_matrix_index ] = gfx.overflow_serial[ MODELVIEW_MATRIX ];
+				gfx.modelview_orthonormal[ gfx.modelview_matrix_index ] = gfx.overflow_orthonormal;
+			}
+			else
+			{
+				mat4_copy_mat4( &gfx.overflow_matrix[ MODELVIEW_MATRIX ], GFX_get_modelview_matrix() );
+
+				gfx.overflow_serial[ MODELVIEW_MATRIX ] = gfx.modelview_serial	   [ gfx.modelview_matrix_index ];
+				gfx.overflow_orthonormal				= gfx.modelview_orthonormal[ gfx.modelview_matrix_index ];
+			}
+
+			break;
+		}
+
+		case PROJECTION_MATRIX:
+		{
+			if( restore )
+			{
+				mat4_copy_mat4( GFX_get_projection_matrix(), &gfx.overflow_matrix[ PROJECTION_MATRIX ] );
+
+				gfx.projection_serial[ gfx.projection_matrix_index ] = gfx.overflow_serial[ PROJECTION_MATRIX ];
+			}
+			else
+			{
+				mat4_copy_mat4( &gfx.overflow_matrix[ PROJECTION_MATRIX ], GFX_get_projection_matrix() );
+
+				gfx.overflow_serial[ PROJECTION_MATRIX ] = gfx.projection_serial[ gfx.projection_matrix_index ];
+			}
+
+			break;
+		}
+
+		case TEXTURE_MATRIX:
+		{
+			if( restore ) mat4_copy_mat4( GFX_get_texture_matrix(), &gfx.overflow_matrix[ TEXTURE_MATRIX ] );
+
+			else mat4_copy_mat4( &gfx.overflow_matrix[ TEXTURE_MATRIX ], GFX_get_texture_matrix() );
+
+			break;
+		}
+	}
 }
 
 
 /*!
 	Push the current matrix stack set as target by the GFX_set_matrix_mode function.
+	A push that does not fit in the stack report an error on the console, is ignored
+	and its matching GFX_pop_matrix is ignored as well. The top most matrix is saved by
+	the first ignored push and restored by the last ignored pop, so the transformations
+	applied in between are discarded as if the push had succeeded. \sa MAX_MODELVIEW_MATRIX
 */
 void GFX_push_matrix( void )
 {
@@ -217,9 +531,15 @@ void GFX_push_matrix( void )
 	{
 		case MODELVIEW_MATRIX:
 		{
+			if( gfx.modelview_matrix_index + 1 == MAX_MODELVIEW_MATRIX ) goto overflow;
+
 			mat4_copy_mat4( &gfx.modelview_matrix[ gfx.modelview_matrix_index + 1 ],
 							&gfx.modelview_matrix[ gfx.modelview_matrix_index	  ] );
 		
+			// Same matrix, same serial number: the cached matrices remain valid.
+			gfx.modelview_serial	 [ gfx.modelview_matrix_index + 1 ] = gfx.modelview_serial	   [ gfx.modelview_matrix_index ];
+			gfx.modelview_orthonormal[ gfx.modelview_matrix_index + 1 ] = gfx.modelview_orthonormal[ gfx.modelview_matrix_index ];
+		
 			++gfx.modelview_matrix_index;
 			
 			break;
@@ -227,9 +547,13 @@ void GFX_push_matrix( void )
 
 		case PROJECTION_MATRIX:
 		{
+			if( gfx.projection_matrix_index + 1 == MAX_PROJECTION_MATRIX ) goto overflow;
+
 			mat4_copy_mat4( &gfx.projection_matrix[ gfx.projection_matrix_index + 1 ],
 							&gfx.projection_matrix[ gfx.projection_matrix_index	    ] );
 			
+			gfx.projection_serial[ gfx.projection_matrix_index + 1 ] = gfx.projection_serial[ gfx.projection_matrix_index ];
+			
 			++gfx.projection_matrix_index;
 			
 			break;
@@ -237,6 +561,8 @@ void GFX_push_matrix( void )
 		
 		case TEXTURE_MATRIX:
 		{
+			if( gfx.texture_matrix_index + 1 == MAX_TEXTURE_MATRIX ) goto overflow;
+
 			mat4_copy_mat4( &gfx.texture_matrix[ gfx.texture_matrix_index + 1 ],
 							&gfx.texture_matrix[ gfx.texture_matrix_index     ] );
 			
@@ -245,19 +571,45 @@ void GFX_push_matrix( void )
 			break;
 		}		
 	}
+	
+	return;
+
+
+overflow:
+
+	if( !gfx.matrix_overflow[ gfx.matrix_mode ] )
+	{
+		console_print( "[ GFX ]\nERROR: Matrix stack %d overflow.\n", gfx.matrix_mode );
+
+		GFX_overflow_matrix( 0 );
+	}
+	
+	++gfx.matrix_overflow[ gfx.matrix_mode ];
 }
 
 
 /*!
 	Pop the current matrix stack set as target by the GFX_set_matrix_mode function.
+	Popping an empty stack report an error on the console and is ignored.
 */
 
 void GFX_pop_matrix( void )
 {
+	if( gfx.matrix_overflow[ gfx.matrix_mode ] )
+	{
+		--gfx.matrix_overflow[ gfx.matrix_mode ];
+
+		if( !gfx.matrix_overflow[ gfx.matrix_mode ] ) GFX_overflow_matrix( 1 );
+
+		return;
+	}
+
 	switch( gfx.matrix_mode )
 	{
 		case MODELVIEW_MATRIX:
 		{
+			if( !gfx.modelview_matrix_index ) goto underflow;
+
 			--gfx.modelview_matrix_index;
 			
 			break;
@@ -265,6 +617,8 @@ void GFX_pop_matrix( void )
 			
 		case PROJECTION_MATRIX:
 		{
+			if( !gfx.projection_matrix_index ) goto underflow;
+
 			--gfx.projection_matrix_index;
 			
 			break;
@@ -272,11 +626,68 @@ void GFX_pop_matrix( void )
 		
 		case TEXTURE_MATRIX:
 		{
+			if( !gfx.texture_matrix_index ) goto underflow;
+
 			--gfx.texture_matrix_index;
 			
 			break;
 		}		
 	}
+	
+	return;
+
+
+underflow:
+
+	console_print( "[ GFX ]\nERROR: Matrix stack %d underflow.\n", gfx.matrix_mode );
+}
+
+
+/*!
+	Push the current matrix stack set as target by the GFX_set_matrix_mode function and multiply
+	the new top most matrix by a translation, rotation and scale matrix built directly from the
+	parameters. Equivalent to GFX_push_matrix, GFX_translate, GFX_rotate on the Z, Y and X axis then
+	GFX_scale, using a single matrix multiply.
+	
+	\param[in] location The translation vector.
+	\param[in] rotation The euler angles in degrees.
+	\param[in] scale The scale factor on each axis.
+*/
+void GFX_push_transform( vec3 *location, vec3 *rotation, vec3 *scale )
+{
+	mat4 mat;
+	
+	unsigned char orthonormal = ( scale->x == 1.0f && scale->y == 1.0f && scale->z == 1.0f );
+	
+	GFX_push_matrix();
+	
+	mat4_transform( &mat, location, rotation, scale );
+	
+	switch( gfx.matrix_mode )
+	{
+		case MODELVIEW_MATRIX:
+		{
+			mat4_multiply_mat4( GFX_get_modelview_matrix(), GFX_get_modelview_matrix(), &mat );
+
+			break;
+		}
+			
+		case PROJECTION_MATRIX:
+		{
+			mat4_multiply_mat4( GFX_get_projection_matrix(), GFX_get_projection_matrix(), &mat );
+			
+			break;
+		}
+		
+		case TEXTURE_MATRIX:
+		{
+			mat4_multiply_mat4( GFX_get_texture_matrix(), GFX_get_texture_matrix(), &mat );
+			
+			break;
+		}		
+	}
+	
+	GFX_dirty_matrix( orthonormal );
 }
 
 
@@ -311,6 +722,8 @@ void GFX_load_matrix( mat4 *m )
 			break;
 		}		
 	}
+	
+	GFX_dirty_matrix( 0 );
 }
 
 
@@ -345,6 +758,8 @@ void GFX_multiply_matrix( mat4 *m )
 			break;
 		}		
 	}
+	
+	GFX_dirty_matrix( 0 );
 }
 
 
@@ -385,6 +800,8 @@ void GFX_translate( float x, float y, float z )
 			break;
 		}		
 	}
+	
+	GFX_dirty_matrix( 1 );
 }
 
 
@@ -428,6 +845,8 @@ void GFX_rotate( float angle, float x, float y, float z )
 			break;
 		}		
 	}
+	
+	GFX_dirty_matrix( 1 );
 }
 
 
@@ -473,6 +892,8 @@ void GFX_scale( float x, float y, float z )
 			break;
 		}		
 	}
+	
+	GFX_dirty_matrix( 0 );
 }
 
 
@@ -505,15 +926,23 @@ mat4 *GFX_get_texture_matrix( void )
 
 /*!
 	Return the result of the of the top most modelview matrix multiplied by the top
-	most projection matrix.
+	most projection matrix. The result is cached and only computed again when one
+	of the two matrices have been modified.
 	
 	\return Return the 4x4 matrix pointer of the projection matrix index.	
 */
 mat4 *GFX_get_modelview_projection_matrix( void )
 {
-	mat4_multiply_mat4( &gfx.modelview_projection_matrix, 
-						GFX_get_projection_matrix(),
-						GFX_get_modelview_matrix() );
+	if( gfx.modelview_projection_serial[ 0 ] != gfx.modelview_serial [ gfx.modelview_matrix_index  ] ||
+		gfx.modelview_projection_serial[ 1 ] != gfx.projection_serial[ gfx.projection_matrix_index ] )
+	{
+		mat4_multiply_mat4( &gfx.modelview_projection_matrix, 
+							GFX_get_projection_matrix(),
+							GFX_get_modelview_matrix() );
+		
+		gfx.modelview_projection_serial[ 0 ] = gfx.modelview_serial [ gfx.modelview_matrix_index  ];
+		gfx.modelview_projection_serial[ 1 ] = gfx.projection_serial[ gfx.projection_matrix_index ];
+	}
 	
 	return &gfx.modelview_projection_matrix; 
 }
@@ -521,22 +950,38 @@ mat4 *GFX_get_modelview_projection_matrix( void )
 
 /*!
 	Return the result of the inverse and transposed operation of the top most modelview matrix applied
-	on the rotation part of the matrix.
+	on the rotation part of the matrix. The result is cached and only computed again when the modelview
+	matrix have been modified. When the modelview matrix is only made of rotations and translations the
+	rotation part is used as is, and when it is affine only the 3x3 rotation part is inverted.
 	
 	\return Return the 3x3 matrix pointer that represent the invert and transpose
 	result of the top most model view matrix.
 */
 mat3 *GFX_get_normal_matrix( void )
 {
-	mat4 mat;
+	mat4 *m = GFX_get_modelview_matrix();
 	
-	mat4_copy_mat4( &mat, GFX_get_modelview_matrix() );
+	if( gfx.normal_serial == gfx.modelview_serial[ gfx.modelview_matrix_index ] ) return &gfx.normal_matrix;
+	
+	gfx.normal_serial = gfx.modelview_serial[ gfx.modelview_matrix_index ];
+	
+	if( gfx.modelview_orthonormal[ gfx.modelview_matrix_index ] ) mat3_copy_mat4( &gfx.normal_matrix, m );
+	
+	else if( !m->m[ 0 ].w && !m->m[ 1 ].w && !m->m[ 2 ].w && m->m[ 3 ].w == 1.0f )
+	{ mat3_invert_transpose_mat4( &gfx.normal_matrix, m ); }
+	
+	else
+	{
+		mat4 mat;
+		
+		mat4_copy_mat4( &mat, m );
 
-	mat4_invert_full( &mat );
+		mat4_invert_full( &mat );
 
-	mat4_transpose( &mat );
-	
-	mat3_copy_mat4( &gfx.normal_matrix, &mat );
+		mat4_transpose( &mat );
+		
+		mat3_copy_mat4( &gfx.normal_matrix, &mat );
+	}
 
 	return &gfx.normal_matrix;
 }
@@ -579,6 +1024,8 @@ void GFX_ortho( float left, float right, float bottom, float top, float clip_sta
 			break;
 		}		
 	}
+	
+	GFX_dirty_matrix( 0 );
 }
 
 
@@ -675,6 +1122,8 @@ void GFX_look_at( vec3 *eye, vec3 *center, vec3 *up )
 		 u;
 
 	mat4 mat;
+	
+	unsigned char orthonormal = gfx.modelview_orthonormal[ gfx.modelview_matrix_index ];
 
 	mat4_identity( &mat );
 
@@ -701,6 +1150,9 @@ void GFX_look_at( vec3 *eye, vec3 *center, vec3 *up )
 	mat.m[ 2 ].z = -f.z;
 
 	GFX_multiply_matrix( &mat );
+	
+	// The look at matrix is a pure rotation.
+	if( gfx.matrix_mode == MODELVIEW_MATRIX ) gfx.modelview_orthonormal[ gfx.modelview_matrix_index ] = orthonormal;
 
 	GFX_translate( -eye->x, -eye->y, -eye->z );
 }
@@ -810,3 +1262,1163 @@ int GFX_unproject( float winx, float winy, float winz, mat4 *modelview_matrix, m
 	
 	return 1;
 }
+
+
+/*!
+	Create a new RENDERQUEUE structure pointer.
+	
+	\param[in] renderqueuepasscallback The function to call when RENDERQUEUE_draw start to draw a new pass, can be NULL.
+	
+	\return Return a new RENDERQUEUE structure pointer.
+*/
+RENDERQUEUE *RENDERQUEUE_init( RENDERQUEUEPASSCALLBACK *renderqueuepasscallback )
+{
+	RENDERQUEUE *renderqueue = ( RENDERQUEUE * ) calloc( 1, sizeof( RENDERQUEUE ) );
+	
+	renderqueue->renderqueuepasscallback = renderqueuepasscallback;
+	
+	return renderqueue;
+}
+
+
+/*!
+	Free a previously initialized RENDERQUEUE structure.
+	
+	\param[in,out] renderqueue A valid RENDERQUEUE structure pointer.
+	
+	\return Return a NULL RENDERQUEUE structure pointer.
+*/
+RENDERQUEUE *RENDERQUEUE_free( RENDERQUEUE *renderqueue )
+{
+	if( renderqueue->renderitem ) free( renderqueue->renderitem );
+	
+	if( renderqueue->index ) free( renderqueue->index );
+	
+	if( renderqueue->index_tmp ) free( renderqueue->index_tmp );
+	
+	free( renderqueue );
+	return NULL;
+}
+
+
+/*!
+	Remove all the RENDERITEM of a RENDERQUEUE. Call this function at the beginning of every frame,
+	the memory is kept to be reused by the next frame.
+	
+	\param[in,out] renderqueue A valid RENDERQUEUE structure pointer.
+*/
+void RENDERQUEUE_clear( RENDERQUEUE *renderqueue )
+{ renderqueue->n_renderitem = 0; }
+
+
+/*!
+	Function internally used to append a new RENDERITEM and build its sort key.
+	
+	Opaque passes are sorted by program, textures and VBO then front to back using the 14 high bits
+	of the depth (to take advantage of early depth rejection), while the transparent pass is sorted
+	back to front using the full depth.
+	
+	\param[in,out] renderqueue A valid RENDERQUEUE structure pointer.
+	\param[in] objmaterial The OBJMATERIAL used to draw the item, can be NULL.
+	\param[in] vbo The VAO or VBO id of the item.
+	\param[in] modelview_matrix The modelview matrix to use, if NULL the current modelview matrix is used.
+	
+	\return Return the new RENDERITEM pointer.
+*/
+RENDERITEM *RENDERQUEUE_add_item( RENDERQUEUE *renderqueue, OBJMATERIAL *objmaterial, unsigned int vbo, mat4 *modelview_matrix )
+{
+	RENDERITEM *renderitem;
+	
+	union
+	{
+		float			f;
+		unsigned int	u;
+		
+	} depth;
+	
+	unsigned long long pid = 0,
+					   tid = 0;
+	
+	if( renderqueue->n_renderitem == renderqueue->max_renderitem )
+	{
+		renderqueue->max_renderitem = renderqueue->max_renderitem ? renderqueue->max_renderitem << 1 : 64;
+		
+		renderqueue->renderitem = ( RENDERITEM * ) realloc( renderqueue->renderitem,
+															 renderqueue->max_renderitem * sizeof( RENDERITEM ) );
+
+		renderqueue->index = ( unsigned int * ) realloc( renderqueue->index,
+														 renderqueue->max_renderitem * sizeof( unsigned int ) );
+
+		renderqueue->index_tmp = ( unsigned int * ) realloc( renderqueue->index_tmp,
+															 renderqueue->max_renderitem * sizeof( unsigned int ) );
+	}
+	
+	renderitem = &renderqueue->renderitem[ renderqueue->n_renderitem ];
+	
+	memset( renderitem, 0, sizeof( RENDERITEM ) );
+
+	mat4_copy_mat4( &renderitem->modelview_matrix,
+					modelview_matrix ? modelview_matrix : GFX_get_modelview_matrix() );
+
+	renderitem->objmaterial = objmaterial;
+	
+	renderitem->pass = RENDERQUEUE_PASS_SOLID;
+	
+	if( objmaterial )
+	{
+		if( !objmaterial->dissolve ) renderitem->pass = RENDERQUEUE_PASS_ALPHA_TESTED;
+		
+		else if( objmaterial->dissolve != 1.0f ) renderitem->pass = RENDERQUEUE_PASS_TRANSPARENT;
+	
+		if( objmaterial->program ) pid = objmaterial->program->pid;
+		
+		// The diffuse and bump map are the textures most likely to change between materials sharing a program.
+		if( objmaterial->texture_diffuse ) tid |= ( objmaterial->texture_diffuse->tid & 0xFF ) << 8;
+		
+		if( objmaterial->texture_bump ) tid |= ( objmaterial->texture_bump->tid & 0xFF );
+	}
+	
+	// Distance along the view direction, positive floats keep their order when compared as integers.
+	depth.f = -renderitem->modelview_matrix.m[ 3 ].z;
+	
+	if( !( depth.f > 0.0f ) ) depth.f = 0.0f;
+
+	renderitem->key = ( unsigned long long )renderitem->pass << 62;
+	
+	if( renderitem->pass == RENDERQUEUE_PASS_TRANSPARENT )
+	{
+		renderitem->key |= ( unsigned long long )( 0x7FFFFFFF - depth.u ) << 31;
+		renderitem->key |= ( pid & 0x7FFF ) << 16;
+		renderitem->key |= tid;
+	}
+	else
+	{
+		renderitem->key |= ( pid & 0xFFFF ) << 46;
+		renderitem->key |= tid << 30;
+		renderitem->key |= ( unsigned long long )( vbo & 0xFFFF ) << 14;
+		renderitem->key |= depth.u >> 17;
+	}
+	
+	// Submission order, until RENDERQUEUE_sort is called.
+	renderqueue->index[ renderqueue->n_renderitem ] = renderqueue->n_renderitem;
+	
+	++renderqueue->n_renderitem;
+	
+	return renderitem;
+}
+
+
+/*!
+	Submit all the OBJTRIANGLELIST of a specific OBJMESH index to a RENDERQUEUE. The OBJMESH is skipped
+	if it is not visible or if its distance is 0.
+	
+	\param[in,out] renderqueue A valid RENDERQUEUE structure pointer.
+	\param[in] obj A valid OBJ structure pointer.
+	\param[in] mesh_index The mesh index in the OBJ OBJMESH database.
+	\param[in] modelview_matrix The modelview matrix to draw the OBJMESH with, if NULL the current modelview matrix is used.
+*/
+void RENDERQUEUE_add_mesh( RENDERQUEUE *renderqueue, OBJ *obj, unsigned int mesh_index, mat4 *modelview_matrix )
+{
+	OBJMESH *objmesh = &obj->objmesh[ mesh_index ];
+	
+	unsigned int i = 0;
+	
+	if( !objmesh->visible || !objmesh->distance ) return;
+
+	while( i != objmesh->n_objtrianglelist )
+	{
+		RENDERITEM *renderitem = RENDERQUEUE_add_item( renderqueue,
+													   objmesh->objtrianglelist[ i ].objmaterial,
+													   objmesh->vao ? objmesh->vao : objmesh->vbo,
+													   modelview_matrix );
+		renderitem->obj					= obj;
+		renderitem->mesh_index			= mesh_index;
+		renderitem->triangle_list_index = i;
+		
+		++i;
+	}
+}
+
+
+/*!
+	Submit all the visible MD5MESH of an MD5 to a RENDERQUEUE. The MD5 is skipped if it is not visible
+	or if its distance is 0.
+	
+	\param[in,out] renderqueue A valid RENDERQUEUE structure pointer.
+	\param[in] md5 A valid MD5 structure pointer.
+	\param[in] modelview_matrix The modelview matrix to draw the MD5 with, if NULL the current modelview matrix is used.
+*/
+void RENDERQUEUE_add_md5( RENDERQUEUE *renderqueue, MD5 *md5, mat4 *modelview_matrix )
+{
+	unsigned int i = 0;
+	
+	if( !md5->visible || !md5->distance ) return;
+	
+	while( i != md5->n_mesh )
+	{
+		MD5MESH *md5mesh = &md5->md5mesh[ i ];
+		
+		if( md5mesh->visible )
+		{
+			RENDERITEM *renderitem = RENDERQUEUE_add_item( renderqueue,
+														   md5mesh->objmaterial,
+														   md5mesh->vao ? md5mesh->vao : md5mesh->vbo,
+														   modelview_matrix );
+			renderitem->md5mesh = md5mesh;
+		}
+		
+		++i;
+	}
+}
+
+
+/*!
+	Sort the RENDERITEM of a RENDERQUEUE by key using an LSD radix sort on 8 bits digits.
+	The digits that are identical for all the items are skipped.
+	
+	\param[in,out] renderqueue A valid RENDERQUEUE structure pointer.
+*/
+void RENDERQUEUE_sort( RENDERQUEUE *renderqueue )
+{
+	unsigned int i = 0,
+				 j,
+				 histogram[ 8 ][ 256 ],
+				 start = get_micro_time();
+	
+	memset( histogram, 0, sizeof( histogram ) );
+	
+	while( i != renderqueue->n_renderitem )
+	{
+		unsigned long long key = renderqueue->renderitem[ i ].key;
+		
+		j = 0;
+		while( j != 8 )
+		{
+			++histogram[ j ][ ( key >> ( j << 3 ) ) & 0xFF ];
+			++j;
+		}
+		
+		renderqueue->index[ i ] = i;
+		
+		++i;
+	}
+
+	j = 0;
+	while( j != 8 )
+	{
+		unsigned int *tmp,
+					 offset = 0,
+					 shift  = j << 3;
+	
+		if( renderqueue->n_renderitem &&
+			histogram[ j ][ ( renderqueue->renderitem[ 0 ].key >> shift ) & 0xFF ] == renderqueue->n_renderitem )
+		{
+			++j;
+			continue;
+		}
+	
+		i = 0;
+		while( i != 256 )
+		{
+			unsigned int n = histogram[ j ][ i ];
+			
+			histogram[ j ][ i ] = offset;
+			
+			offset += n;
+			
+			++i;
+		}
+		
+		i = 0;
+		while( i != renderqueue->n_renderitem )
+		{
+			unsigned int index = renderqueue->index[ i ];
+			
+			renderqueue->index_tmp[ histogram[ j ][ ( renderqueue->renderitem[ index ].key >> shift ) & 0xFF ]++ ] = index;
+			
+			++i;
+		}
+		
+		tmp = renderqueue->index;
+		renderqueue->index = renderqueue->index_tmp;
+		renderqueue->index_tmp = tmp;
+	
+		++j;
+	}
+	
+	renderqueue->sort_time = get_micro_time() - start;
+}
+
+
+/*!
+	Draw all the RENDERITEM of a RENDERQUEUE in the order determined by RENDERQUEUE_sort. The current
+	modelview matrix is restored when the function returns.
+	
+	\param[in,out] renderqueue A valid RENDERQUEUE structure pointer.
+	
+	\return Return the number of indices sent for drawing. (Divided this number by 3 for knowing how many triangles)
+*/
+unsigned int RENDERQUEUE_draw( RENDERQUEUE *renderqueue )
+{
+	unsigned int i = 0,
+				 n = 0,
+				 n_issued,
+				 n_elided,
+				 pass = GFX_STATE_UNKNOWN,
+				 start = get_micro_time();
+
+	GFX_get_state_counter( &n_issued, &n_elided );
+
+	GFX_push_matrix();
+	
+	while( i != renderqueue->n_renderitem )
+	{
+		RENDERITEM *renderitem = &renderqueue->renderitem[ renderqueue->index[ i ] ];
+		
+		if( renderitem->pass != pass )
+		{
+			pass = renderitem->pass;
+			
+			if( renderqueue->renderqueuepasscallback ) renderqueue->renderqueuepasscallback( renderitem->pass );
+		}
+
+		GFX_load_matrix( &renderitem->modelview_matrix );
+		
+		if( renderitem->obj )
+		{
+			n += OBJ_draw_triangle_list( renderitem->obj,
+										 renderitem->mesh_index,
+										 renderitem->triangle_list_index );
+		}
+		else n += MD5_draw_mesh( renderitem->md5mesh );
+		
+		++i;
+	}
+	
+	GFX_pop_matrix();
+
+	renderqueue->n_issued = gfx.state.n_issued - n_issued;
+	renderqueue->n_elided = gfx.state.n_elided - n_elided;
+	
+	renderqueue->draw_time = get_micro_time() - start;
+	
+	return n;
+}
+
+
+/*!
+	Create a new empty BVH structure pointer.
+	
+	\return Return a new BVH structure pointer.
+*/
+BVH *BVH_init( void )
+{
+	return ( BVH * ) calloc( 1, sizeof( BVH ) );
+}
+
+
+/*!
+	Free a previously initialized BVH structure pointer. The OBJMESH and MD5 it was built
+	from are not affected.
+	
+	\param[in,out] bvh A valid BVH structure pointer.
+	
+	\return Return a NULL BVH structure pointer.
+*/
+BVH *BVH_free( BVH *bvh )
+{
+	if( bvh->bvhobject ) free( bvh->bvhobject );
+	
+	if( bvh->index ) free( bvh->index );
+	
+	if( bvh->bvhnode ) free( bvh->bvhnode );
+	
+	if( bvh->stack ) free( bvh->stack );
+	
+	if( bvh->result ) free( bvh->result );
+	
+	free( bvh );
+	return NULL;
+}
+
+
+/*!
+	Function internally used to compute the world bounding box of a BVHOBJECT from the
+	location, rotation and scale of its OBJMESH or MD5.
+	
+	\param[in,out] bvhobject A valid BVHOBJECT structure pointer.
+*/
+void BVH_update_bound( BVHOBJECT *bvhobject )
+{
+	mat4 m;
+	
+	vec3 c,
+		 e;
+	
+	if( bvhobject->objmesh )
+	{
+		// The OBJMESH vertices are centered on its location.
+		OBJMESH *objmesh = bvhobject->objmesh;
+		
+		mat4_transform( &m, &objmesh->location, &objmesh->rotation, &objmesh->scale );
+		
+		c.x =
+		c.y =
+		c.z = 0.0f;
+		
+		e.x = objmesh->dimension.x * 0.5f;
+		e.y = objmesh->dimension.y * 0.5f;
+		e.z = objmesh->dimension.z * 0.5f;
+	}
+	else
+	{
+		MD5 *md5 = bvhobject->md5;
+		
+		mat4_transform( &m, &md5->location, &md5->rotation, &md5->scale );
+		
+		vec3_mid( &c, &md5->min, &md5->max );
+		
+		e.x = md5->dimension.x * 0.5f;
+		e.y = md5->dimension.y * 0.5f;
+		e.z = md5->dimension.z * 0.5f;
+	}
+
+	vec3_multiply_mat4( &c, &c, &m );
+	
+	c.x += m.m[ 3 ].x;
+	c.y += m.m[ 3 ].y;
+	c.z += m.m[ 3 ].z;
+	
+	// Extents of the transformed box.
+	{
+		vec3 t = { fabsf( m.m[ 0 ].x ) * e.x + fabsf( m.m[ 1 ].x ) * e.y + fabsf( m.m[ 2 ].x ) * e.z,
+				   fabsf( m.m[ 0 ].y ) * e.x + fabsf( m.m[ 1 ].y ) * e.y + fabsf( m.m[ 2 ].y ) * e.z,
+				   fabsf( m.m[ 0 ].z ) * e.x + fabsf( m.m[ 1 ].z ) * e.y + fabsf( m.m[ 2 ].z ) * e.z };
+		
+		vec3_diff( &bvhobject->min, &c, &t );
+		
+		vec3_add( &bvhobject->max, &c, &t );
+	}
+}
+
+
+/*!
+	Function internally used to append a new BVHOBJECT.
+	
+	\param[in,out] bvh A valid BVH structure pointer.
+	\param[in] objmesh The OBJMESH of the object, or NULL.
+	\param[in] md5 The MD5 of the object, or NULL.
+	
+	\return Return the index of the new BVHOBJECT.
+*/
+unsigned int BVH_add_object( BVH *bvh, OBJMESH *objmesh, MD5 *md5 )
+{
+	BVHOBJECT *bvhobject;
+	
+	if( bvh->n_bvhobject == bvh->max_bvhobject )
+	{
+		bvh->max_bvhobject = bvh->max_bvhobject ? bvh->max_bvhobject << 1 : 64;
+		
+		bvh->bvhobject = ( BVHOBJECT * ) realloc( bvh->bvhobject, bvh->max_bvhobject * sizeof( BVHOBJECT ) );
+	}
+	
+	bvhobject = &bvh->bvhobject[ bvh->n_bvhobject ];
+	
+	memset( bvhobject, 0, sizeof( BVHOBJECT ) );
+	
+	bvhobject->objmesh = objmesh;
+	bvhobject->md5	   = md5;
+	
+	BVH_update_bound( bvhobject );
+	
+	++bvh->n_bvhobject;
+	
+	return bvh->n_bvhobject - 1;
+}
+
+
+/*!
+	Add an OBJMESH to a BVH. The world bounding box of the OBJMESH is computed from its
+	dimension (see OBJ_update_bound_mesh), location, rotation and scale. Call BVH_build once
+	all the objects are added.
+	
+	\param[in,out] bvh A valid BVH structure pointer.
+	\param[in] objmesh A valid OBJMESH structure pointer, must stay valid as long as the BVH is used.
+	
+	\return Return the object index of the OBJMESH in the BVH.
+*/
+unsigned int BVH_add_mesh( BVH *bvh, OBJMESH *objmesh )
+{ return BVH_add_object( bvh, objmesh, NULL ); }
+
+
+/*!
+	Add an MD5 to a BVH. The world bounding box of the MD5 is computed from its bind pose
+	bounding box, location, rotation and scale. Call BVH_build once all the objects are added.
+	
+	\param[in,out] bvh A valid BVH structure pointer.
+	\param[in] md5 A valid MD5 structure pointer, must stay valid as long as the BVH is used.
+	
+	\return Return the object index of the MD5 in the BVH.
+*/
+unsigned int BVH_add_md5( BVH *bvh, MD5 *md5 )
+{ return BVH_add_object( bvh, NULL, md5 ); }
+
+
+/*!
+	Function internally used to recompute the bounding box of a node from its children,
+	or from its objects for leaf nodes.
+	
+	\param[in,out] bvh A valid BVH structure pointer.
+	\param[in] node_index The node index.
+	
+	\return Return 1 if the bounding box of the node changed, else return 0.
+*/
+unsigned char BVH_refit_node( BVH *bvh, unsigned int node_index )
+{
+	BVHNODE *bvhnode = &bvh->bvhnode[ node_index ];
+	
+	vec3 min = {  99999.999f,  99999.999f,  99999.999f },
+		 max = { -99999.999f, -99999.999f, -99999.999f };
+	
+	if( bvhnode->right )
+	{
+		BVHNODE *left  = bvhnode + 1,
+				*right = &bvh->bvhnode[ bvhnode->right ];
+		
+		min.x = fminf( left->min.x, right->min.x );
+		min.y = fminf( left->min.y, right->min.y );
+		min.z = fminf( left->min.z, right->min.z );
+		
+		max.x = fmaxf( left->max.x, right->max.x );
+		max.y = fmaxf( left->max.y, right->max.y );
+		max.z = fmaxf( left->max.z, right->max.z );
+	}
+	else
+	{
+		unsigned int i = bvhnode->first;
+		
+		while( i != bvhnode->first + bvhnode->count )
+		{
+			BVHOBJECT *bvhobject = &bvh->bvhobject[ bvh->index[ i ] ];
+			
+			min.x = fminf( min.x, bvhobject->min.x );
+			min.y = fminf( min.y, bvhobject->min.y );
+			min.z = fminf( min.z, bvhobject->min.z );
+			
+			max.x = fmaxf( max.x, bvhobject->max.x );
+			max.y = fmaxf( max.y, bvhobject->max.y );
+			max.z = fmaxf( max.z, bvhobject->max.z );
+			
+			++i;
+		}
+	}
+	
+	if( !memcmp( &min, &bvhnode->min, sizeof( vec3 ) ) &&
+		!memcmp( &max, &bvhnode->max, sizeof( vec3 ) ) ) return 0;
+	
+	memcpy( &bvhnode->min, &min, sizeof( vec3 ) );
+	memcpy( &bvhnode->max, &max, sizeof( vec3 ) );
+	
+	return 1;
+}
+
+
+/*!
+	Function internally used to recursively build the nodes covering a range of the
+	BVH index array. The range is split at the middle of the largest axis of the bounding
+	box of the object centers.
+	
+	\param[in,out] bvh A valid BVH structure pointer.
+	\param[in] first The first entry of the index array to cover.
+	\param[in] count The number of entries to cover.
+	\param[in] parent The parent node index.
+	
+	\return Return the index of the new node.
+*/
+unsigned int BVH_build_node( BVH *bvh, unsigned int first, unsigned int count, int parent )
+{
+	unsigned int node_index = bvh->n_bvhnode++;
+	
+	BVHNODE *bvhnode = &bvh->bvhnode[ node_index ];
+	
+	bvhnode->parent = parent;
+	bvhnode->right  = 0;
+	bvhnode->first  = first;
+	bvhnode->count  = count;
+	
+	if( count <= BVH_LEAF_SIZE )
+	{
+		unsigned int i = first;
+		
+		while( i != first + count )
+		{
+			bvh->bvhobject[ bvh->index[ i ] ].node = node_index;
+			++i;
+		}
+	}
+	else
+	{
+		unsigned int i = first,
+					 j = first + count,
+					 axis = 0;
+		
+		float split;
+		
+		vec3 min = {  99999.999f,  99999.999f,  99999.999f },
+			 max = { -99999.999f, -99999.999f, -99999.999f };
+		
+		// Bounding box of the object centers (times 2 to skip the division).
+		while( i != first + count )
+		{
+			BVHOBJECT *bvhobject = &bvh->bvhobject[ bvh->index[ i ] ];
+			
+			vec3 c;
+			
+			vec3_add( &c, &bvhobject->min, &bvhobject->max );
+			
+			min.x = fminf( min.x, c.x ); max.x = fmaxf( max.x, c.x );
+			min.y = fminf( min.y, c.y ); max.y = fmaxf( max.y, c.y );
+			min.z = fminf( min.z, c.z ); max.z = fmaxf( max.z, c.z );
+			
+			++i;
+		}
+		
+		if( ( max.y - min.y ) > ( max.x - min.x ) ) axis = 1;
+		
+		if( ( max.z - min.z ) > ( ( float * )&max )[ axis ] - ( ( float * )&min )[ axis ] ) axis = 2;
+		
+		split = ( ( ( float * )&min )[ axis ] + ( ( float * )&max )[ axis ] ) * 0.5f;
+		
+		// Partition the range around the split plane.
+		i = first;
+		while( i != j )
+		{
+			BVHOBJECT *bvhobject = &bvh->bvhobject[ bvh->index[ i ] ];
+			
+			if( ( ( float * )&bvhobject->min )[ axis ] + ( ( float * )&bvhobject->max )[ axis ] < split ) ++i;
+			else
+			{
+				unsigned int t = bvh->index[ i ];
+				
+				bvh->index[ i ] = bvh->index[ --j ];
+				bvh->index[ j ] = t;
+			}
+		}
+		
+		// All the centers are on the same side (or equal), split the range in half.
+		if( i == first || i == first + count ) i = first + ( count >> 1 );
+		
+		BVH_build_node( bvh, first, i - first, node_index );
+		
+		bvh->bvhnode[ node_index ].right = BVH_build_node( bvh, i, first + count - i, node_index );
+	}
+	
+	BVH_refit_node( bvh, node_index );
+	
+	return node_index;
+}
+
+
+/*!
+	Build (or rebuild) the node hierarchy of a BVH from the current bounding boxes of its
+	objects. Only needed when objects are added, moving objects only require BVH_update
+	or BVH_refit.
+	
+	\param[in,out] bvh A valid BVH structure pointer.
+*/
+void BVH_build( BVH *bvh )
+{
+	unsigned int i = 0;
+	
+	bvh->n_bvhnode = 0;
+	
+	bvh->n_result = 0;
+	
+	if( !bvh->n_bvhobject ) return;
+	
+	// A binary tree with at least one object per leaf has less than 2n nodes.
+	bvh->index	 = ( unsigned int * ) realloc( bvh->index, bvh->n_bvhobject * sizeof( unsigned int ) );
+	bvh->bvhnode = ( BVHNODE * ) realloc( bvh->bvhnode, ( bvh->n_bvhobject << 1 ) * sizeof( BVHNODE ) );
+	bvh->stack	 = ( unsigned int * ) realloc( bvh->stack, ( bvh->n_bvhobject << 1 ) * sizeof( unsigned int ) );
+	bvh->result	 = ( unsigned int * ) realloc( bvh->result, bvh->n_bvhobject * sizeof( unsigned int ) );
+	
+	while( i != bvh->n_bvhobject )
+	{
+		bvh->index[ i ] = i;
+		++i;
+	}
+	
+	BVH_build_node( bvh, 0, bvh->n_bvhobject, -1 );
+}
+
+
+/*!
+	Update the bounding box of a single object that moved, rotated or was scaled, and refit
+	the nodes above it. The refit stops as soon as a node bounding box is unchanged, so the
+	cost is at most the depth of the tree.
+	
+	\param[in,out] bvh A valid BVH structure pointer.
+	\param[in] object_index The object index returned by BVH_add_mesh or BVH_add_md5.
+	
+	\note The tree topology is not changed, when most of the objects moved far from their
+	original location call BVH_build to restore the query performances.
+*/
+void BVH_update( BVH *bvh, unsigned int object_index )
+{
+	int node_index;
+	
+	if( !bvh->n_bvhnode ) return;
+	
+	BVH_update_bound( &bvh->bvhobject[ object_index ] );
+	
+	node_index = bvh->bvhobject[ object_index ].node;
+	
+	while( node_index != -1 && BVH_refit_node( bvh, node_index ) )
+	{ node_index = bvh->bvhnode[ node_index ].parent; }
+}
+
+
+/*!
+	Update the bounding boxes of all the objects of a BVH and refit all the nodes in a single
+	bottom up pass, without rebuilding the tree.
+	
+	\param[in,out] bvh A valid BVH structure pointer.
+*/
+void BVH_refit( BVH *bvh )
+{
+	unsigned int i = 0;
+	
+	while( i != bvh->n_bvhobject )
+	{
+		BVH_update_bound( &bvh->bvhobject[ i ] );
+		++i;
+	}
+	
+	// Children always have a greater index than their parent.
+	i = bvh->n_bvhnode;
+	while( i )
+	{
+		--i;
+		BVH_refit_node( bvh, i );
+	}
+}
+
+
+/*!
+	Function internally used to append all the objects covered by a node to the query result.
+	
+	\param[in,out] bvh A valid BVH structure pointer.
+	\param[in] bvhnode A valid BVHNODE structure pointer.
+*/
+void BVH_add_result( BVH *bvh, BVHNODE *bvhnode )
+{
+	memcpy( &bvh->result[ bvh->n_result ],
+			&bvh->index[ bvhnode->first ],
+			bvhnode->count * sizeof( unsigned int ) );
+	
+	bvh->n_result += bvhnode->count;
+}
+
+
+/*!
+	Function internally used to test a bounding box against the frustum planes that are
+	set in a mask.
+	
+	\param[in] frustum The six clipping planes data.
+	\param[in] min The bottom left corner of the box.
+	\param[in] max The upper right corner of the box.
+	\param[in,out] mask The planes to test, the planes the box is entirely inside of are removed.
+	
+	\return Return 0 if the box is outside the frustum, else return 1.
+*/
+unsigned char BVH_box_in_frustum( vec4 *frustum, vec3 *min, vec3 *max, unsigned int *mask )
+{
+	unsigned int i = 0;
+	
+	vec3 c = { min->x + max->x,
+			   min->y + max->y,
+			   min->z + max->z },
+		 e = { max->x - min->x,
+			   max->y - min->y,
+			   max->z - min->z };
+
+	while( i != 6 )
+	{
+		if( *mask & ( 1 << i ) )
+		{
+			// Twice the distance of the center and the projected radius of the box.
+			float d = frustum[ i ].x * c.x +
+					  frustum[ i ].y * c.y +
+					  frustum[ i ].z * c.z +
+					  frustum[ i ].w * 2.0f,
+				  r = fabsf( frustum[ i ].x ) * e.x +
+					  fabsf( frustum[ i ].y ) * e.y +
+					  fabsf( frustum[ i ].z ) * e.z;
+			
+			if( d + r <= 0.0f ) return 0;
+			
+			if( d - r > 0.0f ) *mask &= ~( 1 << i );
+		}
+		
+		++i;
+	}
+	
+	return 1;
+}
+
+
+/*!
+	Collect all the objects of a BVH whose bounding box is (at least partially) inside the
+	frustum planes. Nodes entirely inside the frustum add all their objects without further
+	tests, and the planes a node is inside of are not tested again for its children.
+	
+	\param[in,out] bvh A valid BVH structure pointer.
+	\param[in] frustum The six clipping planes data (see build_frustum).
+	
+	\return Return the number of visible objects. The object indices are stored in the BVH
+	result array.
+*/
+unsigned int BVH_query_frustum( BVH *bvh, vec4 *frustum )
+{
+	unsigned int n_stack = 0;
+	
+	bvh->n_result = 0;
+	
+	if( !bvh->n_bvhnode ) return 0;
+	
+	// Each stack entry is a node index followed by the 6 bits mask of the planes left to test.
+	bvh->stack[ n_stack++ ] = 0x3F;
+	
+	while( n_stack )
+	{
+		unsigned int node_index = bvh->stack[ --n_stack ] >> 6,
+					 mask		= bvh->stack[ n_stack ] & 0x3F;
+		
+		BVHNODE *bvhnode = &bvh->bvhnode[ node_index ];
+		
+		if( !BVH_box_in_frustum( frustum, &bvhnode->min, &bvhnode->max, &mask ) ) continue;
+		
+		if( !mask ) BVH_add_result( bvh, bvhnode );
+		
+		else if( bvhnode->right )
+		{
+			bvh->stack[ n_stack++ ] = ( bvhnode->right << 6 ) | mask;
+			bvh->stack[ n_stack++ ] = ( ( node_index + 1 ) << 6 ) | mask;
+		}
+		else
+		{
+			unsigned int i = bvhnode->first;
+			
+			while( i != bvhnode->first + bvhnode->count )
+			{
+				BVHOBJECT *bvhobject = &bvh->bvhobject[ bvh->index[ i ] ];
+				
+				unsigned int m = mask;
+				
+				if( BVH_box_in_frustum( frustum, &bvhobject->min, &bvhobject->max, &m ) )
+				{ bvh->result[ bvh->n_result++ ] = bvh->index[ i ]; }
+				
+				++i;
+			}
+		}
+	}
+	
+	return bvh->n_result;
+}
+
+
+/*!
+	Collect all the objects of a BVH whose bounding box overlaps a sphere.
+	
+	\param[in,out] bvh A valid BVH structure pointer.
+	\param[in] location The center of the sphere in world coordinates.
+	\param[in] radius The radius of the sphere.
+	
+	\return Return the number of overlapping objects. The object indices are stored in the
+	BVH result array.
+*/
+unsigned int BVH_query_sphere( BVH *bvh, vec3 *location, float radius )
+{
+	unsigned int n_stack = 0;
+	
+	bvh->n_result = 0;
+	
+	if( !bvh->n_bvhnode ) return 0;
+	
+	bvh->stack[ n_stack++ ] = 0;
+	
+	while( n_stack )
+	{
+		BVHNODE *bvhnode = &bvh->bvhnode[ bvh->stack[ --n_stack ] ];
+		
+		// Squared distance from the sphere center to the closest point of the box.
+		float d = 0.0f,
+			  t;
+		
+		if( location->x < bvhnode->min.x ) { t = bvhnode->min.x - location->x; d += t * t; }
+		else if( location->x > bvhnode->max.x ) { t = location->x - bvhnode->max.x; d += t * t; }
+
+		if( location->y < bvhnode->min.y ) { t = bvhnode->min.y - location->y; d += t * t; }
+		else if( location->y > bvhnode->max.y ) { t = location->y - bvhnode->max.y; d += t * t; }
+
+		if( location->z < bvhnode->min.z ) { t = bvhnode->min.z - location->z; d += t * t; }
+		else if( location->z > bvhnode->max.z ) { t = location->z - bvhnode->max.z; d += t * t; }
+		
+		if( d > radius * radius ) continue;
+		
+		if( bvhnode->right )
+		{
+			bvh->stack[ n_stack++ ] = bvhnode->right;
+			bvh->stack[ n_stack++ ] = ( unsigned int )( bvhnode - bvh->bvhnode ) + 1;
+		}
+		else if( bvhnode->count == 1 ) BVH_add_result( bvh, bvhnode );
+		else
+		{
+			unsigned int i = bvhnode->first;
+			
+			while( i != bvhnode->first + bvhnode->count )
+			{
+				BVHOBJECT *bvhobject = &bvh->bvhobject[ bvh->index[ i ] ];
+				
+				d = 0.0f;
+				
+				if( location->x < bvhobject->min.x ) { t = bvhobject->min.x - location->x; d += t * t; }
+				else if( location->x > bvhobject->max.x ) { t = location->x - bvhobject->max.x; d += t * t; }
+
+				if( location->y < bvhobject->min.y ) { t = bvhobject->min.y - location->y; d += t * t; }
+				else if( location->y > bvhobject->max.y ) { t = location->y - bvhobject->max.y; d += t * t; }
+
+				if( location->z < bvhobject->min.z ) { t = bvhobject->min.z - location->z; d += t * t; }
+				else if( location->z > bvhobject->max.z ) { t = location->z - bvhobject->max.z; d += t * t; }
+				
+				if( d <= radius * radius ) bvh->result[ bvh->n_result++ ] = bvh->index[ i ];
+				
+				++i;
+			}
+		}
+	}
+	
+	return bvh->n_result;
+}
+
+
+/*!
+	Collect all the objects of a BVH whose bounding box overlaps an axis aligned box.
+	
+	\param[in,out] bvh A valid BVH structure pointer.
+	\param[in] min The bottom left corner of the box in world coordinates.
+	\param[in] max The upper right corner of the box in world coordinates.
+	
+	\return Return the number of overlapping objects. The object indices are stored in the
+	BVH result array.
+*/
+unsigned int BVH_query_box( BVH *bvh, vec3 *min, vec3 *max )
+{
+	unsigned int n_stack = 0;
+	
+	bvh->n_result = 0;
+	
+	if( !bvh->n_bvhnode ) return 0;
+	
+	bvh->stack[ n_stack++ ] = 0;
+	
+	while( n_stack )
+	{
+		BVHNODE *bvhnode = &bvh->bvhnode[ bvh->stack[ --n_stack ] ];
+		
+		if( bvhnode->min.x > max->x || bvhnode->max.x < min->x ||
+			bvhnode->min.y > max->y || bvhnode->max.y < min->y ||
+			bvhnode->min.z > max->z || bvhnode->max.z < min->z ) continue;
+		
+		// The node is entirely inside the box.
+		if( bvhnode->min.x >= min->x && bvhnode->max.x <= max->x &&
+			bvhnode->min.y >= min->y && bvhnode->max.y <= max->y &&
+			bvhnode->min.z >= min->z && bvhnode->max.z <= max->z ) BVH_add_result( bvh, bvhnode );
+		
+		else if( bvhnode->right )
+		{
+			bvh->stack[ n_stack++ ] = bvhnode->right;
+			bvh->stack[ n_stack++ ] = ( unsigned int )( bvhnode - bvh->bvhnode ) + 1;
+		}
+		else
+		{
+			unsigned int i = bvhnode->first;
+			
+			while( i != bvhnode->first + bvhnode->count )
+			{
+				BVHOBJECT *bvhobject = &bvh->bvhobject[ bvh->index[ i ] ];
+				
+				if( bvhobject->min.x <= max->x && bvhobject->max.x >= min->x &&
+					bvhobject->min.y <= max->y && bvhobject->max.y >= min->y &&
+					bvhobject->min.z <= max->z && bvhobject->max.z >= min->z )
+				{ bvh->result[ bvh->n_result++ ] = bvh->index[ i ]; }
+				
+				++i;
+			}
+		}
+	}
+	
+	return bvh->n_result;
+}
+
+
+/*!
+	Function internally used to intersect a ray with a bounding box (slab test).
+	
+	\param[in] min The bottom left corner of the box.
+	\param[in] max The upper right corner of the box.
+	\param[in] origin The origin of the ray.
+	\param[in] inv_direction The inverse of the direction of the ray.
+	\param[in] distance The maximum distance along the ray.
+	
+	\return Return the distance along the ray where it enters the box (0 if the origin is inside),
+	or a negative value if the box is missed or further than distance.
+*/
+float BVH_ray_box( vec3 *min, vec3 *max, vec3 *origin, vec3 *inv_direction, float distance )
+{
+	float t0 = ( min->x - origin->x ) * inv_direction->x,
+		  t1 = ( max->x - origin->x ) * inv_direction->x,
+		  tmin = fminf( t0, t1 ),
+		  tmax = fmaxf( t0, t1 );
+	
+	t0 = ( min->y - origin->y ) * inv_direction->y;
+	t1 = ( max->y - origin->y ) * inv_direction->y;
+	
+	tmin = fmaxf( tmin, fminf( t0, t1 ) );
+	tmax = fminf( tmax, fmaxf( t0, t1 ) );
+
+	t0 = ( min->z - origin->z ) * inv_direction->z;
+	t1 = ( max->z - origin->z ) * inv_direction->z;
+	
+	tmin = fmaxf( tmin, fminf( t0, t1 ) );
+	tmax = fminf( tmax, fmaxf( t0, t1 ) );
+	
+	tmin = fmaxf( tmin, 0.0f );
+	
+	return ( tmin <= tmax && tmin <= distance ) ? tmin : -1.0f;
+}
+
+
+/*!
+	Find the closest object of a BVH whose bounding box is hit by a ray. The nodes are
+	visited front to back, and the nodes further than the closest hit so far are skipped.
+	
+	\param[in,out] bvh A valid BVH structure pointer.
+	\param[in] origin The origin of the ray in world coordinates.
+	\param[in] direction The direction of the ray (does not need to be normalized).
+	\param[in,out] distance Return the distance of the hit along the ray, in multiples of the direction length (can be NULL).
+	
+	\return Return the object index of the closest hit, or -1 if no object was hit.
+	
+	\note Only the object bounding boxes are tested, not their triangles.
+*/
+int BVH_query_ray( BVH *bvh, vec3 *origin, vec3 *direction, float *distance )
+{
+	unsigned int n_stack = 0;
+	
+	int hit = -1;
+	
+	float best = 3.402823466e+38f;
+	
+	vec3 inv_direction = { 1.0f / direction->x,
+						   1.0f / direction->y,
+						   1.0f / direction->z };
+	
+	if( !bvh->n_bvhnode ) return -1;
+	
+	if( BVH_ray_box( &bvh->bvhnode[ 0 ].min, &bvh->bvhnode[ 0 ].max, origin, &inv_direction, best ) < 0.0f ) return -1;
+	
+	bvh->stack[ n_stack++ ] = 0;
+	
+	while( n_stack )
+	{
+		BVHNODE *bvhnode = &bvh->bvhnode[ bvh->stack[ --n_stack ] ];
+		
+		if( bvhnode->right )
+		{
+			unsigned int left  = ( unsigned int )( bvhnode - bvh->bvhnode ) + 1,
+						 right = bvhnode->right;
+			
+			float tl = BVH_ray_box( &bvh->bvhnode[ left  ].min, &bvh->bvhnode[ left  ].max, origin, &inv_direction, best ),
+				  tr = BVH_ray_box( &bvh->bvhnode[ right ].min, &bvh->bvhnode[ right ].max, origin, &inv_direction, best );
+			
+			// Push the furthest child first so the closest one is visited first.
+			if( tl >= 0.0f && tr >= 0.0f )
+			{
+				if( tl < tr )
+				{
+					bvh->stack[ n_stack++ ] = right;
+					bvh->stack[ n_stack++ ] = left;
+				}
+				else
+				{
+					bvh->stack[ n_stack++ ] = left;
+					bvh->stack[ n_stack++ ] = right;
+				}
+			}
+			else if( tl >= 0.0f ) bvh->stack[ n_stack++ ] = left;
+			else if( tr >= 0.0f ) bvh->stack[ n_stack++ ] = right;
+		}
+		else
+		{
+			unsigned int i = bvhnode->first;
+			
+			while( i != bvhnode->first + bvhnode->count )
+			{
+				BVHOBJECT *bvhobject = &bvh->bvhobject[ bvh->index[ i ] ];
+				
+				float t = BVH_ray_box( &bvhobject->min, &bvhobject->max, origin, &inv_direction, best );
+				
+				if( t >= 0.0f && ( hit == -1 || t < best ) )
+				{
+					best = t;
+					hit  = bvh->index[ i ];
+				}
+				
+				++i;
+			}
+		}
+	}
+	
+	if( distance && hit != -1 ) *distance = best;
+	
+	return hit;
+}
+
+
+/*!
+	Find the closest object of a BVH under a window coordinate. The picking ray is built by
+	unprojecting the window coordinate on the near and far clipping planes with GFX_unproject.
+	
+	\param[in,out] bvh A valid BVH structure pointer.
+	\param[in] x The window X coordinate.
+	\param[in] y The window Y coordinate.
+	\param[in] modelview_matrix The modelview (camera) matrix the scene was drawn with.
+	\param[in] projection_matrix The projection matrix the scene was drawn with.
+	\param[in] viewport_matrix The viewport the scene was drawn with.
+	\param[in,out] distance Return the distance in world units from the near plane to the hit (can be NULL).
+	
+	\return Return the object index of the closest hit, or -1 if no object was hit.
+*/
+int BVH_pick( BVH *bvh, float x, float y, mat4 *modelview_matrix, mat4 *projection_matrix, int *viewport_matrix, float *distance )
+{
+	int hit;
+	
+	float l;
+	
+	vec3 origin,
+		 direction;
+	
+	if( !GFX_unproject( x, y, 0.0f, modelview_matrix, projection_matrix, viewport_matrix, &origin.x, &origin.y, &origin.z ) ||
+		!GFX_unproject( x, y, 1.0f, modelview_matrix, projection_matrix, viewport_matrix, &direction.x, &direction.y, &direction.z ) ) return -1;
+	
+	vec3_diff( &direction, &direction, &origin );
+	
+	l = vec3_normalize( &direction, &direction );
+	
+	if( !l ) return -1;
+	
+	hit = BVH_query_ray( bvh, &origin, &direction, distance );
+	
+	return hit;
+}
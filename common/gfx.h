@@ -194,8 +194,17 @@ framework can provide.
 #include <ctype.h>
 #include <stdarg.h>
 #include <sys/time.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <unistd.h>
 
+#if defined( __SSE__ )
+	#include <xmmintrin.h>
+#elif defined( __ARM_NEON__ ) || defined( __ARM_NEON )
+	#include <arm_neon.h>
+#endif
+
 #include "thread.h"
 #include "types.h"
 #include "matrix.h"
@@ -213,14 +222,26 @@ framework can provide.
 #include "light.h"
 #include "md5.h"
 
-//! The depth of the modelview matrix stack.
-#define MAX_MODELVIEW_MATRIX	8
+//! The depth of the modelview matrix stack (can be defined in the project settings).
+#ifndef MAX_MODELVIEW_MATRIX
+	#define MAX_MODELVIEW_MATRIX	32
+#endif
 
-//! The depth of the projection matrix stack.
-#define MAX_PROJECTION_MATRIX	2
+//! The depth of the projection matrix stack (can be defined in the project settings).
+#ifndef MAX_PROJECTION_MATRIX
+	#define MAX_PROJECTION_MATRIX	4
+#endif
 
-//! The depth of the texture matrix stack.
-#define MAX_TEXTURE_MATRIX		2
+//! The depth of the texture matrix stack (can be defined in the project settings).
+#ifndef MAX_TEXTURE_MATRIX
+	#define MAX_TEXTURE_MATRIX		4
+#endif
+
+//! The number of texture units tracked by the GLES state cache.
+#define MAX_TEXTURE_UNIT		8
+
+//! Value used by the GLES state cache for a binding that is not known.
+#define GFX_STATE_UNKNOWN		0xFFFFFFFF
 
 enum
 {
@@ -235,6 +256,42 @@ enum
 };
 
 
+//! Cache of the GLES bindings, used to skip the state changes that would not change anything.
+typedef struct
+{
+	//! The GLSL program id in use.
+	unsigned int	program;
+	
+	//! The VAO id bound.
+	unsigned int	vao;
+	
+	//! The VBO id bound to GL_ARRAY_BUFFER.
+	unsigned int	array_buffer;
+	
+	//! The VBO id bound to GL_ELEMENT_ARRAY_BUFFER (part of the VAO state).
+	unsigned int	element_array_buffer;
+	
+	//! The active texture unit index.
+	unsigned int	active_texture;
+	
+	//! The GL_TEXTURE_2D (0) and GL_TEXTURE_CUBE_MAP (1) texture ids bound to each texture unit.
+	unsigned int	texture[ MAX_TEXTURE_UNIT ][ 2 ];
+	
+	//! The number of GLES state changes sent to the driver since the last GFX_reset_state_counter.
+	unsigned int	n_issued;
+	
+	//! The number of GLES state changes skipped since the last GFX_reset_state_counter.
+	unsigned int	n_elided;
+	
+	//! The number of uniform uploads sent to the driver since the last GFX_reset_state_counter.
+	unsigned int	n_uniform_issued;
+	
+	//! The number of uniform uploads skipped by PROGRAM_set_uniform since the last GFX_reset_state_counter.
+	unsigned int	n_uniform_elided;
+
+} GFXSTATE;
+
+
 //! The definition of the global GFX structure. This structure maintain the matrix stacks and current indexes. 
 typedef struct
 {
@@ -242,13 +299,25 @@ typedef struct
 	unsigned char	matrix_mode;
 	
 	//! The current modelview matrix index in the stack.
-	unsigned char	modelview_matrix_index;
+	unsigned int	modelview_matrix_index;
 
 	//! The current projection matrix index in the stack.
-	unsigned char	projection_matrix_index;
+	unsigned int	projection_matrix_index;
 	
 	//! The current texture matrix index in the stack.	
-	unsigned char	texture_matrix_index;
+	unsigned int	texture_matrix_index;
+	
+	//! The number of pushes that did not fit in each matrix stack (indexed by matrix mode), ignored by the matching pops.
+	unsigned int	matrix_overflow[ 3 ];
+
+	//! The top most matrix of each stack saved by its first overflowing push, restored once all the ignored pushes are popped.
+	mat4			overflow_matrix[ 3 ];
+
+	//! The modelview (0) and projection (1) serial numbers saved along with overflow_matrix.
+	unsigned int	overflow_serial[ 2 ];
+
+	//! The modelview orthonormal flag saved along with overflow_matrix.
+	unsigned char	overflow_orthonormal;
 
 	//! Array of 4x4 matrix that represent the modelview matrix stack.
 	mat4			modelview_matrix[ MAX_MODELVIEW_MATRIX ];
@@ -264,6 +333,33 @@ typedef struct
 	
 	//! Used to store the result of the inverse, tranposed modelview matrix. \sa GFX_get_normal_matrix
 	mat3			normal_matrix;
+	
+	//! The serial number of each modelview matrix stack level, renewed every time the level is modified.
+	unsigned int	modelview_serial[ MAX_MODELVIEW_MATRIX ];
+	
+	//! Determine if each modelview matrix stack level is only made of rotations and translations.
+	unsigned char	modelview_orthonormal[ MAX_MODELVIEW_MATRIX ];
+	
+	//! The serial number of each projection matrix stack level.
+	unsigned int	projection_serial[ MAX_PROJECTION_MATRIX ];
+	
+	//! The last serial number given to a matrix stack level.
+	unsigned int	serial;
+	
+	//! The modelview (0) and projection (1) serial numbers the modelview_projection_matrix have been computed with.
+	unsigned int	modelview_projection_serial[ 2 ];
+	
+	//! The modelview serial number the normal_matrix have been computed with.
+	unsigned int	normal_serial;
+	
+	//! Flag to determine if the GLES driver support 32 bits indices (GL_OES_element_index_uint).
+	unsigned char	index_uint;
+	
+	//! Flag to determine if the GLES driver support half float vertex attributes (GL_OES_vertex_half_float).
+	unsigned char	half_float;
+	
+	//! The GLES state cache.
+	GFXSTATE		state;
 
 } GFX;
 
@@ -271,18 +367,207 @@ typedef struct
 extern GFX gfx;
 
 
+enum
+{
+	//! Opaque geometry (OBJMATERIAL dissolve equal to 1).
+	RENDERQUEUE_PASS_SOLID			= 0,
+	
+	//! Alpha tested geometry (OBJMATERIAL dissolve equal to 0).
+	RENDERQUEUE_PASS_ALPHA_TESTED	= 1,
+	
+	//! Alpha blended geometry, drawn back to front (any other OBJMATERIAL dissolve value).
+	RENDERQUEUE_PASS_TRANSPARENT	= 2
+};
+
+
+//! Render queue pass callback prototype, called every time RENDERQUEUE_draw start to draw a new pass (ideal to toggle blending).
+typedef void( RENDERQUEUEPASSCALLBACK( unsigned char pass ) );
+
+
+//! Structure definition of a single draw submitted to a RENDERQUEUE.
+typedef struct
+{
+	//! The sort key (pass, program, textures, VBO and depth for opaque passes, pass and back to front depth for the transparent pass).
+	unsigned long long	key;
+	
+	//! The OBJ pointer if the item is an OBJMESH triangle list, else NULL.
+	OBJ					*obj;
+	
+	//! The OBJMESH index in the OBJ.
+	unsigned int		mesh_index;
+	
+	//! The OBJTRIANGLELIST index in the OBJMESH.
+	unsigned int		triangle_list_index;
+	
+	//! The MD5MESH pointer if the item is an MD5MESH, else NULL.
+	MD5MESH				*md5mesh;
+	
+	//! The OBJMATERIAL to use to draw the item.
+	OBJMATERIAL			*objmaterial;
+	
+	//! The pass of the item (RENDERQUEUE_PASS_SOLID, RENDERQUEUE_PASS_ALPHA_TESTED or RENDERQUEUE_PASS_TRANSPARENT).
+	unsigned char		pass;
+	
+	//! The modelview matrix to load before drawing the item.
+	mat4				modelview_matrix;
+
+} RENDERITEM;
+
+
+//! Structure definition of a render queue, collecting the draws of a frame to submit them sorted by state.
+typedef struct
+{
+	//! The number of RENDERITEM submitted for the current frame.
+	unsigned int			n_renderitem;
+	
+	//! The allocated size of the RENDERITEM and index arrays.
+	unsigned int			max_renderitem;
+	
+	//! Array of RENDERITEM.
+	RENDERITEM				*renderitem;
+	
+	//! The RENDERITEM indices in drawing order (valid after RENDERQUEUE_sort).
+	unsigned int			*index;
+	
+	//! Scratch buffer used by the radix sort.
+	unsigned int			*index_tmp;
+	
+	//! The pass callback function pointer to use.
+	RENDERQUEUEPASSCALLBACK	*renderqueuepasscallback;
+	
+	//! The time in microseconds spent in the last RENDERQUEUE_sort call.
+	unsigned int			sort_time;
+	
+	//! The time in microseconds spent in the last RENDERQUEUE_draw call.
+	unsigned int			draw_time;
+	
+	//! The number of GLES state changes sent to the driver by the last RENDERQUEUE_draw call.
+	unsigned int			n_issued;
+	
+	//! The number of GLES state changes skipped by the last RENDERQUEUE_draw call.
+	unsigned int			n_elided;
+
+} RENDERQUEUE;
+
+
+//! The maximum number of objects stored in a BVH leaf node.
+#define BVH_LEAF_SIZE 4
+
+
+//! Structure definition of a BVH node.
+typedef struct
+{
+	//! The bottom left corner of the node bounding box in world coordinates.
+	vec3			min;
+	
+	//! The upper right corner of the node bounding box in world coordinates.
+	vec3			max;
+	
+	//! The parent node index, -1 for the root node.
+	int				parent;
+	
+	//! The right child node index, the left child always directly follows its parent. 0 for leaf nodes.
+	unsigned int	right;
+	
+	//! The first entry of the BVH index array covered by the node.
+	unsigned int	first;
+	
+	//! The number of objects covered by the node.
+	unsigned int	count;
+
+} BVHNODE;
+
+
+//! Structure definition of an object stored in a BVH.
+typedef struct
+{
+	//! The OBJMESH pointer if the object is an OBJMESH, else NULL.
+	OBJMESH			*objmesh;
+	
+	//! The MD5 pointer if the object is an MD5, else NULL.
+	MD5				*md5;
+	
+	//! The bottom left corner of the object bounding box in world coordinates.
+	vec3			min;
+	
+	//! The upper right corner of the object bounding box in world coordinates.
+	vec3			max;
+	
+	//! The index of the leaf node containing the object.
+	unsigned int	node;
+
+} BVHOBJECT;
+
+
+//! Structure definition of a bounding volume hierarchy over the world bounding boxes of OBJMESH and MD5.
+typedef struct
+{
+	//! The number of objects in the BVH.
+	unsigned int	n_bvhobject;
+	
+	//! The allocated size of the BVHOBJECT array.
+	unsigned int	max_bvhobject;
+	
+	//! Array of BVHOBJECT.
+	BVHOBJECT		*bvhobject;
+	
+	//! The BVHOBJECT indices sorted by leaf nodes (valid after BVH_build).
+	unsigned int	*index;
+	
+	//! The number of nodes.
+	unsigned int	n_bvhnode;
+	
+	//! Array of BVHNODE, the root node is always the first one.
+	BVHNODE			*bvhnode;
+	
+	//! The traversal stack.
+	unsigned int	*stack;
+	
+	//! The number of objects returned by the last query.
+	unsigned int	n_result;
+	
+	//! The BVHOBJECT indices returned by the last query.
+	unsigned int	*result;
+
+} BVH;
+
+
 void GFX_start( void );
 
 void GFX_error( void );
 
+void GFX_reset_state( void );
+
+void GFX_reset_state_counter( void );
+
+void GFX_get_state_counter( unsigned int *n_issued, unsigned int *n_elided );
+
+void GFX_get_uniform_counter( unsigned int *n_issued, unsigned int *n_elided );
+
+void GFX_use_program( unsigned int pid );
+
+void GFX_bind_vertex_array( unsigned int vao );
+
+void GFX_bind_buffer( unsigned int target, unsigned int buffer );
+
+void GFX_active_texture( unsigned int unit );
+
+void GFX_bind_texture( unsigned int target, unsigned int tid );
+
+void GFX_bind_texture_unit( unsigned int unit, unsigned int target, unsigned int tid );
+
 void GFX_set_matrix_mode( unsigned int mode );
 
+void GFX_dirty_matrix( unsigned char orthonormal );
+
 void GFX_load_identity( void );
 
 void GFX_push_matrix( void );
 
 void GFX_pop_matrix( void );
 
+void GFX_push_transform( vec3 *location, vec3 *rotation, vec3 *scale );
+
 void GFX_load_matrix( mat4 *m );
 
 void GFX_multiply_matrix( mat4 *m );
@@ -319,4 +604,42 @@ int GFX_project( float objx, float objy, float objz, mat4 *modelview_matrix, mat
 
 int GFX_unproject( float winx, float winy, float winz, mat4 *modelview_matrix, mat4 *projection_matrix, int *viewport_matrix, float *objx, float *objy, float *objz );
 
+RENDERQUEUE *RENDERQUEUE_init( RENDERQUEUEPASSCALLBACK *renderqueuepasscallback );
+
+RENDERQUEUE *RENDERQUEUE_free( RENDERQUEUE *renderqueue );
+
+void RENDERQUEUE_clear( RENDERQUEUE *renderqueue );
+
+void RENDERQUEUE_add_mesh( RENDERQUEUE *renderqueue, OBJ *obj, unsigned int mesh_index, mat4 *modelview_matrix );
+
+void RENDERQUEUE_add_md5( RENDERQUEUE *renderqueue, MD5 *md5, mat4 *modelview_matrix );
+
+void RENDERQUEUE_sort( RENDERQUEUE *renderqueue );
+
+unsigned int RENDERQUEUE_draw( RENDERQUEUE *renderqueue );
+
+BVH *BVH_init( void );
+
+BVH *BVH_free( BVH *bvh );
+
+unsigned int BVH_add_mesh( BVH *bvh, OBJMESH *objmesh );
+
+unsigned int BVH_add_md5( BVH *bvh, MD5 *md5 );
+
+void BVH_build( BVH *bvh );
+
+void BVH_update( BVH *bvh, unsigned int object_index );
+
+void BVH_refit( BVH *bvh );
+
+unsigned int BVH_query_frustum( BVH *bvh, vec4 *frustum );
+
+unsigned int BVH_query_sphere( BVH *bvh, vec3 *location, float radius );
+
+unsigned int BVH_query_box( BVH *bvh, vec3 *min, vec3 *max );
+
+int BVH_query_ray( BVH *bvh, vec3 *origin, vec3 *direction, float *distance );
+
+int BVH_pick( BVH *bvh, float x, float y, mat4 *modelview_matrix, mat4 *projection_matrix, int *viewport_matrix, float *distance );
+
 #endif
@@ -66,17 +66,43 @@ void vec3_multiply_mat3( vec3 *dst, vec3 *v, mat3 *m )
 */
 void vec3_multiply_mat4( vec3 *dst, vec3 *v, mat4 *m )
 {
-	dst->x = ( v->x * m->m[ 0 ].x ) +
-			 ( v->y * m->m[ 1 ].x ) +
-			 ( v->z * m->m[ 2 ].x );
+	#if defined( __SSE__ )
 
-	dst->y = ( v->x * m->m[ 0 ].y ) +
-			 ( v->y * m->m[ 1 ].y ) +
-			 ( v->z * m->m[ 2 ].y );
+		__m128 r = _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( &m->m[ 0 ].x ), _mm_set1_ps( v->x ) ),
+										   _mm_mul_ps( _mm_loadu_ps( &m->m[ 1 ].x ), _mm_set1_ps( v->y ) ) ),
+										   _mm_mul_ps( _mm_loadu_ps( &m->m[ 2 ].x ), _mm_set1_ps( v->z ) ) );
 
-	dst->z = ( v->x * m->m[ 0 ].z ) +
-			 ( v->y * m->m[ 1 ].z ) +
-			 ( v->z * m->m[ 2 ].z );
+		_mm_storel_pi( ( __m64 * )&dst->x, r );
+		_mm_store_ss( &dst->z, _mm_movehl_ps( r, r ) );
+
+	#elif defined( __ARM_NEON__ ) || defined( __ARM_NEON )
+
+		float32x4_t r = vmlaq_n_f32( vmlaq_n_f32( vmulq_n_f32( vld1q_f32( &m->m[ 0 ].x ), v->x ),
+															   vld1q_f32( &m->m[ 1 ].x ), v->y ),
+															   vld1q_f32( &m->m[ 2 ].x ), v->z );
+
+		vst1_f32( &dst->x, vget_low_f32( r ) );
+		vst1q_lane_f32( &dst->z, r, 2 );
+
+	#else
+
+		vec3 r;
+
+		r.x = ( v->x * m->m[ 0 ].x ) +
+			  ( v->y * m->m[ 1 ].x ) +
+			  ( v->z * m->m[ 2 ].x );
+
+		r.y = ( v->x * m->m[ 0 ].y ) +
+			  ( v->y * m->m[ 1 ].y ) +
+			  ( v->z * m->m[ 2 ].y );
+
+		r.z = ( v->x * m->m[ 0 ].z ) +
+			  ( v->y * m->m[ 1 ].z ) +
+			  ( v->z * m->m[ 2 ].z );
+
+		memcpy( dst, &r, sizeof( vec3 ) );
+
+	#endif
 }
 
 
@@ -89,25 +115,228 @@ void vec3_multiply_mat4( vec3 *dst, vec3 *v, mat4 *m )
 */
 void vec4_multiply_mat4( vec4 *dst, vec4 *v, mat4 *m )
 {
-	dst->x = ( v->x * m->m[ 0 ].x ) +
-			 ( v->y * m->m[ 1 ].x ) +
-			 ( v->z * m->m[ 2 ].x ) + 
-			 ( v->w * m->m[ 3 ].x );
+	#if defined( __SSE__ )
 
-	dst->y = ( v->x * m->m[ 0 ].y ) +
-			 ( v->y * m->m[ 1 ].y ) +
-			 ( v->z * m->m[ 2 ].y ) + 
-			 ( v->w * m->m[ 3 ].y );
+		__m128 p = _mm_loadu_ps( &v->x );
 
-	dst->z = ( v->x * m->m[ 0 ].z ) +
-			 ( v->y * m->m[ 1 ].z ) +
-			 ( v->z * m->m[ 2 ].z ) + 
-			 ( v->w * m->m[ 3 ].z );
+		_mm_storeu_ps( &dst->x, _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( &m->m[ 0 ].x ), _mm_shuffle_ps( p, p, _MM_SHUFFLE( 0, 0, 0, 0 ) ) ),
+														_mm_mul_ps( _mm_loadu_ps( &m->m[ 1 ].x ), _mm_shuffle_ps( p, p, _MM_SHUFFLE( 1, 1, 1, 1 ) ) ) ),
+											_mm_add_ps( _mm_mul_ps( _mm_loadu_ps( &m->m[ 2 ].x ), _mm_shuffle_ps( p, p, _MM_SHUFFLE( 2, 2, 2, 2 ) ) ),
+														_mm_mul_ps( _mm_loadu_ps( &m->m[ 3 ].x ), _mm_shuffle_ps( p, p, _MM_SHUFFLE( 3, 3, 3, 3 ) ) ) ) ) );
+
+	#elif defined( __ARM_NEON__ ) || defined( __ARM_NEON )
+
+		float32x4_t p  = vld1q_f32( &v->x );
+		float32x2_t lo = vget_low_f32 ( p ),
+					hi = vget_high_f32( p );
+
+		vst1q_f32( &dst->x, vmlaq_lane_f32( vmlaq_lane_f32( vmlaq_lane_f32( vmulq_lane_f32( vld1q_f32( &m->m[ 0 ].x ), lo, 0 ),
+																						  vld1q_f32( &m->m[ 1 ].x ), lo, 1 ),
+																						  vld1q_f32( &m->m[ 2 ].x ), hi, 0 ),
+																						  vld1q_f32( &m->m[ 3 ].x ), hi, 1 ) );
+
+	#else
+
+		vec4 r;
+
+		r.x = ( v->x * m->m[ 0 ].x ) +
+			  ( v->y * m->m[ 1 ].x ) +
+			  ( v->z * m->m[ 2 ].x ) + 
+			  ( v->w * m->m[ 3 ].x );
+
+		r.y = ( v->x * m->m[ 0 ].y ) +
+			  ( v->y * m->m[ 1 ].y ) +
+			  ( v->z * m->m[ 2 ].y ) + 
+			  ( v->w * m->m[ 3 ].y );
+
+		r.z = ( v->x * m->m[ 0 ].z ) +
+			  ( v->y * m->m[ 1 ].z ) +
+			  ( v->z * m->m[ 2 ].z ) + 
+			  ( v->w * m->m[ 3 ].z );
+
+		r.w = ( v->x * m->m[ 0 ].w ) +
+			  ( v->y * m->m[ 1 ].w ) +
+			  ( v->z * m->m[ 2 ].w ) + 
+			  ( v->w * m->m[ 3 ].w );
+
+		memcpy( dst, &r, sizeof( vec4 ) );
+
+	#endif
+}
+
+
+/*!
+	Multiply an array of vec3 by a 4x4 matrix. On SSE and NEON capable CPUs the vectors are
+	processed four at a time, use 16 bytes aligned arrays for the best throughput.
+	
+	\param[in,out] dst The array used to store the result of the operation (can be the same as v).
+	\param[in] v The array of vec3 to multiply.
+	\param[in] n The number of vectors in the array.
+	\param[in] m A valid 4x4 matrix pointer.
+	\param[in] w The implicit w component of the vectors, use 0.0f to only rotate and scale them
+	just like vec3_multiply_mat4, or 1.0f to also translate them (positions).
+*/
+void vec3_multiply_mat4_array( vec3 *dst, vec3 *v, unsigned int n, mat4 *m, float w )
+{
+	unsigned int i = 0;
+
+	#if defined( __SSE__ )
+	
+		__m128 m0x = _mm_set1_ps( m->m[ 0 ].x ), m0y = _mm_set1_ps( m->m[ 0 ].y ), m0z = _mm_set1_ps( m->m[ 0 ].z ),
+			   m1x = _mm_set1_ps( m->m[ 1 ].x ), m1y = _mm_set1_ps( m->m[ 1 ].y ), m1z = _mm_set1_ps( m->m[ 1 ].z ),
+			   m2x = _mm_set1_ps( m->m[ 2 ].x ), m2y = _mm_set1_ps( m->m[ 2 ].y ), m2z = _mm_set1_ps( m->m[ 2 ].z ),
+			   m3x = _mm_set1_ps( m->m[ 3 ].x * w ),
+			   m3y = _mm_set1_ps( m->m[ 3 ].y * w ),
+			   m3z = _mm_set1_ps( m->m[ 3 ].z * w );
+	
+		while( ( i + 4 ) <= n )
+		{
+			float *src = ( float * )&v  [ i ],
+				  *out = ( float * )&dst[ i ];
+			
+			__m128 a = _mm_loadu_ps( src	 ),
+				   b = _mm_loadu_ps( src + 4 ),
+				   c = _mm_loadu_ps( src + 8 ),
+				   x, y, z, rx, ry, rz, t, u;
+			
+			// Transpose x0y0z0x1 y1z1x2y2 z2x3y3z3 to xxxx yyyy zzzz.
+			x = _mm_shuffle_ps( a, _mm_shuffle_ps( b, c, _MM_SHUFFLE( 1, 1, 2, 2 ) ), _MM_SHUFFLE( 2, 0, 3, 0 ) );
+			y = _mm_shuffle_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 0, 0, 1, 1 ) ),
+								_mm_shuffle_ps( b, c, _MM_SHUFFLE( 2, 2, 3, 3 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+			z = _mm_shuffle_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 1, 1, 2, 2 ) ),
+								_mm_shuffle_ps( c, c, _MM_SHUFFLE( 3, 3, 0, 0 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+			
+			rx = _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, m0x ), _mm_mul_ps( y, m1x ) ), _mm_add_ps( _mm_mul_ps( z, m2x ), m3x ) );
+			ry = _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, m0y ), _mm_mul_ps( y, m1y ) ), _mm_add_ps( _mm_mul_ps( z, m2y ), m3y ) );
+			rz = _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, m0z ), _mm_mul_ps( y, m1z ) ), _mm_add_ps( _mm_mul_ps( z, m2z ), m3z ) );
+			
+			// Transpose back to x0y0z0x1 y1z1x2y2 z2x3y3z3.
+			t = _mm_shuffle_ps( rx, ry, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+			u = _mm_shuffle_ps( rz, rx, _MM_SHUFFLE( 1, 1, 0, 0 ) );
+			_mm_storeu_ps( out, _mm_shuffle_ps( t, u, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+			
+			t = _mm_shuffle_ps( ry, rz, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+			u = _mm_shuffle_ps( rx, ry, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+			_mm_storeu_ps( out + 4, _mm_shuffle_ps( t, u, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+			
+			t = _mm_shuffle_ps( rz, rx, _MM_SHUFFLE( 3, 3, 2, 2 ) );
+			u = _mm_shuffle_ps( ry, rz, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+			_mm_storeu_ps( out + 8, _mm_shuffle_ps( t, u, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+			
+			i += 4;
+		}
+
+	#elif defined( __ARM_NEON__ ) || defined( __ARM_NEON )
+
+		float32x4_t m0 = vld1q_f32( &m->m[ 0 ].x ),
+					m1 = vld1q_f32( &m->m[ 1 ].x ),
+					m2 = vld1q_f32( &m->m[ 2 ].x ),
+					m3 = vmulq_n_f32( vld1q_f32( &m->m[ 3 ].x ), w );
+
+		while( ( i + 4 ) <= n )
+		{
+			float32x4x3_t p = vld3q_f32( ( float * )&v[ i ] ),
+						  r;
+			
+			r.val[ 0 ] = vmlaq_lane_f32( vmlaq_lane_f32( vmlaq_lane_f32( vdupq_lane_f32( vget_low_f32( m3 ), 0 ),
+																		 p.val[ 0 ], vget_low_f32( m0 ), 0 ),
+																		 p.val[ 1 ], vget_low_f32( m1 ), 0 ),
+																		 p.val[ 2 ], vget_low_f32( m2 ), 0 );
+			
+			r.val[ 1 ] = vmlaq_lane_f32( vmlaq_lane_f32( vmlaq_lane_f32( vdupq_lane_f32( vget_low_f32( m3 ), 1 ),
+																		 p.val[ 0 ], vget_low_f32( m0 ), 1 ),
+																		 p.val[ 1 ], vget_low_f32( m1 ), 1 ),
+																		 p.val[ 2 ], vget_low_f32( m2 ), 1 );
+			
+			r.val[ 2 ] = vmlaq_lane_f32( vmlaq_lane_f32( vmlaq_lane_f32( vdupq_lane_f32( vget_high_f32( m3 ), 0 ),
+																		 p.val[ 0 ], vget_high_f32( m0 ), 0 ),
+																		 p.val[ 1 ], vget_high_f32( m1 ), 0 ),
+																		 p.val[ 2 ], vget_high_f32( m2 ), 0 );
+			
+			vst3q_f32( ( float * )&dst[ i ], r );
+			
+			i += 4;
+		}
+
+	#endif
+	
+	while( i != n )
+	{
+		vec3 t = { m->m[ 3 ].x * w,
+				   m->m[ 3 ].y * w,
+				   m->m[ 3 ].z * w };
+		
+		vec3_multiply_mat4( &dst[ i ], &v[ i ], m );
+		
+		vec3_add( &dst[ i ], &dst[ i ], &t );
+		
+		++i;
+	}
+}
+
+
+/*!
+	Multiply an array of vec4 by a 4x4 matrix. On SSE and NEON capable CPUs the matrix
+	columns are kept in registers for the whole array, use 16 bytes aligned arrays for
+	the best throughput.
+	
+	\param[in,out] dst The array used to store the result of the operation (can be the same as v).
+	\param[in] v The array of vec4 to multiply.
+	\param[in] n The number of vectors in the array.
+	\param[in] m A valid 4x4 matrix pointer.
+*/
+void vec4_multiply_mat4_array( vec4 *dst, vec4 *v, unsigned int n, mat4 *m )
+{
+	unsigned int i = 0;
+
+	#if defined( __SSE__ )
+
+		__m128 c0 = _mm_loadu_ps( &m->m[ 0 ].x ),
+			   c1 = _mm_loadu_ps( &m->m[ 1 ].x ),
+			   c2 = _mm_loadu_ps( &m->m[ 2 ].x ),
+			   c3 = _mm_loadu_ps( &m->m[ 3 ].x );
+
+		while( i != n )
+		{
+			__m128 p = _mm_loadu_ps( &v[ i ].x );
+
+			_mm_storeu_ps( &dst[ i ].x, _mm_add_ps( _mm_add_ps( _mm_mul_ps( c0, _mm_shuffle_ps( p, p, _MM_SHUFFLE( 0, 0, 0, 0 ) ) ),
+																_mm_mul_ps( c1, _mm_shuffle_ps( p, p, _MM_SHUFFLE( 1, 1, 1, 1 ) ) ) ),
+													_mm_add_ps( _mm_mul_ps( c2, _mm_shuffle_ps( p, p, _MM_SHUFFLE( 2, 2, 2, 2 ) ) ),
+																_mm_mul_ps( c3, _mm_shuffle_ps( p, p, _MM_SHUFFLE( 3, 3, 3, 3 ) ) ) ) ) );
+			++i;
+		}
+
+	#elif defined( __ARM_NEON__ ) || defined( __ARM_NEON )
+
+		float32x4_t c0 = vld1q_f32( &m->m[ 0 ].x ),
+					c1 = vld1q_f32( &m->m[ 1 ].x ),
+					c2 = vld1q_f32( &m->m[ 2 ].x ),
+					c3 = vld1q_f32( &m->m[ 3 ].x );
+
+		while( i != n )
+		{
+			float32x4_t p  = vld1q_f32( &v[ i ].x );
+			float32x2_t lo = vget_low_f32 ( p ),
+						hi = vget_high_f32( p );
+
+			vst1q_f32( &dst[ i ].x, vmlaq_lane_f32( vmlaq_lane_f32( vmlaq_lane_f32( vmulq_lane_f32( c0, lo, 0 ),
+																							  c1, lo, 1 ),
+																							  c2, hi, 0 ),
+																							  c3, hi, 1 ) );
+			++i;
+		}
+
+	#else
+
+		while( i != n )
+		{
+			vec4_multiply_mat4( &dst[ i ], &v[ i ], m );
+			
+			++i;
+		}
 
-	dst->w = ( v->x * m->m[ 0 ].w ) +
-			 ( v->y * m->m[ 1 ].w ) +
-			 ( v->z * m->m[ 2 ].w ) + 
-			 ( v->w * m->m[ 3 ].w );
+	#endif
 }
 
 
@@ -142,6 +371,46 @@ void mat3_copy_mat4( mat3 *dst, mat4 *m )
 }
 
 
+/*!
+	Compute the inverse transpose of the rotation part of a 4x4 matrix. The columns of the
+	result are the cross products of the columns of the source divided by its determinant,
+	which is cheaper than a full 4x4 inverse followed by a transpose for affine matrices.
+	
+	\param[in,out] dst A valid mat3 pointer where the result will be stored.
+	\param[in] m A valid 4x4 matrix pointer.
+	
+	\return Return 1 if the inverse is successfull, instead return 0.
+*/
+unsigned char mat3_invert_transpose_mat4( mat3 *dst, mat4 *m )
+{
+	vec3 *a = ( vec3 * )&m->m[ 0 ],
+		 *b = ( vec3 * )&m->m[ 1 ],
+		 *c = ( vec3 * )&m->m[ 2 ];
+	
+	mat3 mat;
+	
+	float d;
+
+	vec3_cross( &mat.m[ 0 ], b, c );
+	vec3_cross( &mat.m[ 1 ], c, a );
+	vec3_cross( &mat.m[ 2 ], a, b );
+	
+	d = vec3_dot_vec3( a, &mat.m[ 0 ] );
+	
+	if( !d ) return 0;
+	
+	d = 1.0f / d;
+	
+	mat.m[ 0 ].x *= d; mat.m[ 0 ].y *= d; mat.m[ 0 ].z *= d;
+	mat.m[ 1 ].x *= d; mat.m[ 1 ].y *= d; mat.m[ 1 ].z *= d;
+	mat.m[ 2 ].x *= d; mat.m[ 2 ].y *= d; mat.m[ 2 ].z *= d;
+	
+	memcpy( dst, &mat, sizeof( mat3 ) );
+	
+	return 1;
+}
+
+
 /*!
 	Set a 4x4 matrix to the identity matrix.
 	
@@ -319,6 +588,46 @@ void mat4_rotate( mat4 *dst, mat4 *m, vec4 *v )
 }
 
 
+/*!
+	Build a transformation matrix from a translation, euler rotation (applied on the Z, Y then X axis,
+	as GFX_rotate would) and a scale. \sa GFX_push_transform
+	
+	\param[in,out] dst A valid 4x4 matrix pointer that will be use as the destination matrix.
+	\param[in] location The translation vector.
+	\param[in] rotation The euler angles in degrees.
+	\param[in] scale The scale factor on each axis.
+*/
+void mat4_transform( mat4 *dst, vec3 *location, vec3 *rotation, vec3 *scale )
+{
+	float sx = sinf( rotation->x * DEG_TO_RAD ),
+		  cx = cosf( rotation->x * DEG_TO_RAD ),
+		  sy = sinf( rotation->y * DEG_TO_RAD ),
+		  cy = cosf( rotation->y * DEG_TO_RAD ),
+		  sz = sinf( rotation->z * DEG_TO_RAD ),
+		  cz = cosf( rotation->z * DEG_TO_RAD );
+
+	dst->m[ 0 ].x = ( cy * cz ) * scale->x;
+	dst->m[ 0 ].y = ( cy * sz ) * scale->x;
+	dst->m[ 0 ].z = ( -sy     ) * scale->x;
+	dst->m[ 0 ].w = 0.0f;
+
+	dst->m[ 1 ].x = ( sx * sy * cz - cx * sz ) * scale->y;
+	dst->m[ 1 ].y = ( sx * sy * sz + cx * cz ) * scale->y;
+	dst->m[ 1 ].z = ( sx * cy				 ) * scale->y;
+	dst->m[ 1 ].w = 0.0f;
+
+	dst->m[ 2 ].x = ( cx * sy * cz + sx * sz ) * scale->z;
+	dst->m[ 2 ].y = ( cx * sy * sz - sx * cz ) * scale->z;
+	dst->m[ 2 ].z = ( cx * cy				 ) * scale->z;
+	dst->m[ 2 ].w = 0.0f;
+
+	dst->m[ 3 ].x = location->x;
+	dst->m[ 3 ].y = location->y;
+	dst->m[ 3 ].z = location->z;
+	dst->m[ 3 ].w = 1.0f;
+}
+
+
 /*!
 	Multiply the current matrix by a scale vector.
 	
@@ -404,154 +713,246 @@ unsigned char mat4_invert( mat4 *m )
 */
 unsigned char mat4_invert_full( mat4 *m )
 {
-	mat4 inv;
-
-	float d;
-
-	inv.m[ 0 ].x = m->m[ 1 ].y * m->m[ 2 ].z * m->m[ 3 ].w - 
-				   m->m[ 1 ].y * m->m[ 2 ].w * m->m[ 3 ].z - 
-				   m->m[ 2 ].y * m->m[ 1 ].z * m->m[ 3 ].w +
-				   m->m[ 2 ].y * m->m[ 1 ].w * m->m[ 3 ].z + 
-				   m->m[ 3 ].y * m->m[ 1 ].z * m->m[ 2 ].w - 
-				   m->m[ 3 ].y * m->m[ 1 ].w * m->m[ 2 ].z;
+	#if defined( __SSE__ )
+
+		// Blockwise inversion using the 2x2 sub matrices A B C D of m (each packed in
+		// one register as x0 x1 y0 y1), the inverse of the transpose being the transpose
+		// of the inverse the same code works for column major matrices.
+		__m128 c0 = _mm_loadu_ps( &m->m[ 0 ].x ),
+			   c1 = _mm_loadu_ps( &m->m[ 1 ].x ),
+			   c2 = _mm_loadu_ps( &m->m[ 2 ].x ),
+			   c3 = _mm_loadu_ps( &m->m[ 3 ].x ),
+			   a  = _mm_movelh_ps( c0, c1 ),
+			   b  = _mm_movehl_ps( c1, c0 ),
+			   c  = _mm_movelh_ps( c2, c3 ),
+			   d  = _mm_movehl_ps( c3, c2 ),
+			   det_sub,
+			   det_a,
+			   det_b,
+			   det_c,
+			   det_d,
+			   det,
+			   a_b,
+			   d_c,
+			   x,
+			   y,
+			   z,
+			   w,
+			   t;
+
+		// |A| |B| |C| |D|
+		det_sub = _mm_sub_ps( _mm_mul_ps( _mm_shuffle_ps( c0, c2, _MM_SHUFFLE( 2, 0, 2, 0 ) ), _mm_shuffle_ps( c1, c3, _MM_SHUFFLE( 3, 1, 3, 1 ) ) ),
+							  _mm_mul_ps( _mm_shuffle_ps( c0, c2, _MM_SHUFFLE( 3, 1, 3, 1 ) ), _mm_shuffle_ps( c1, c3, _MM_SHUFFLE( 2, 0, 2, 0 ) ) ) );
+
+		det_a = _mm_shuffle_ps( det_sub, det_sub, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+		det_b = _mm_shuffle_ps( det_sub, det_sub, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+		det_c = _mm_shuffle_ps( det_sub, det_sub, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+		det_d = _mm_shuffle_ps( det_sub, det_sub, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+
+		// adj(D)C and adj(A)B
+		d_c = _mm_sub_ps( _mm_mul_ps( _mm_shuffle_ps( d, d, _MM_SHUFFLE( 0, 0, 3, 3 ) ), c ),
+						  _mm_mul_ps( _mm_shuffle_ps( d, d, _MM_SHUFFLE( 2, 2, 1, 1 ) ), _mm_shuffle_ps( c, c, _MM_SHUFFLE( 1, 0, 3, 2 ) ) ) );
+
+		a_b = _mm_sub_ps( _mm_mul_ps( _mm_shuffle_ps( a, a, _MM_SHUFFLE( 0, 0, 3, 3 ) ), b ),
+						  _mm_mul_ps( _mm_shuffle_ps( a, a, _MM_SHUFFLE( 2, 2, 1, 1 ) ), _mm_shuffle_ps( b, b, _MM_SHUFFLE( 1, 0, 3, 2 ) ) ) );
+
+		// |D|A - B adj(D)C
+		x = _mm_sub_ps( _mm_mul_ps( det_d, a ),
+						_mm_add_ps( _mm_mul_ps( b, _mm_shuffle_ps( d_c, d_c, _MM_SHUFFLE( 3, 0, 3, 0 ) ) ),
+									_mm_mul_ps( _mm_shuffle_ps( b, b, _MM_SHUFFLE( 2, 3, 0, 1 ) ), _mm_shuffle_ps( d_c, d_c, _MM_SHUFFLE( 1, 2, 1, 2 ) ) ) ) );
+
+		// |A|D - C adj(A)B
+		w = _mm_sub_ps( _mm_mul_ps( det_a, d ),
+						_mm_add_ps( _mm_mul_ps( c, _mm_shuffle_ps( a_b, a_b, _MM_SHUFFLE( 3, 0, 3, 0 ) ) ),
+									_mm_mul_ps( _mm_shuffle_ps( c, c, _MM_SHUFFLE( 2, 3, 0, 1 ) ), _mm_shuffle_ps( a_b, a_b, _MM_SHUFFLE( 1, 2, 1, 2 ) ) ) ) );
+
+		// |B|C - D adj(adj(A)B)
+		y = _mm_sub_ps( _mm_mul_ps( det_b, c ),
+						_mm_sub_ps( _mm_mul_ps( d, _mm_shuffle_ps( a_b, a_b, _MM_SHUFFLE( 0, 3, 0, 3 ) ) ),
+									_mm_mul_ps( _mm_shuffle_ps( d, d, _MM_SHUFFLE( 2, 3, 0, 1 ) ), _mm_shuffle_ps( a_b, a_b, _MM_SHUFFLE( 1, 2, 1, 2 ) ) ) ) );
+
+		// |C|B - A adj(adj(D)C)
+		z = _mm_sub_ps( _mm_mul_ps( det_c, b ),
+						_mm_sub_ps( _mm_mul_ps( a, _mm_shuffle_ps( d_c, d_c, _MM_SHUFFLE( 0, 3, 0, 3 ) ) ),
+									_mm_mul_ps( _mm_shuffle_ps( a, a, _MM_SHUFFLE( 2, 3, 0, 1 ) ), _mm_shuffle_ps( d_c, d_c, _MM_SHUFFLE( 1, 2, 1, 2 ) ) ) ) );
+
+		// |M| = |A||D| + |B||C| - tr( adj(A)B adj(D)C )
+		t = _mm_mul_ps( a_b, _mm_shuffle_ps( d_c, d_c, _MM_SHUFFLE( 3, 1, 2, 0 ) ) );
+		t = _mm_add_ps( t, _mm_shuffle_ps( t, t, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+		t = _mm_add_ps( t, _mm_shuffle_ps( t, t, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+
+		det = _mm_sub_ps( _mm_add_ps( _mm_mul_ps( det_a, det_d ),
+									  _mm_mul_ps( det_b, det_c ) ), t );
+
+		if( !_mm_cvtss_f32( det ) ) return 0;
+
+		det = _mm_div_ps( _mm_setr_ps( 1.0f, -1.0f, -1.0f, 1.0f ), det );
+
+		x = _mm_mul_ps( x, det );
+		y = _mm_mul_ps( y, det );
+		z = _mm_mul_ps( z, det );
+		w = _mm_mul_ps( w, det );
+
+		// Apply the final adjugate and transpose the blocks back.
+		_mm_storeu_ps( &m->m[ 0 ].x, _mm_shuffle_ps( x, y, _MM_SHUFFLE( 1, 3, 1, 3 ) ) );
+		_mm_storeu_ps( &m->m[ 1 ].x, _mm_shuffle_ps( x, y, _MM_SHUFFLE( 0, 2, 0, 2 ) ) );
+		_mm_storeu_ps( &m->m[ 2 ].x, _mm_shuffle_ps( z, w, _MM_SHUFFLE( 1, 3, 1, 3 ) ) );
+		_mm_storeu_ps( &m->m[ 3 ].x, _mm_shuffle_ps( z, w, _MM_SHUFFLE( 0, 2, 0, 2 ) ) );
+
+		return 1;
+
+	#else
+
+		mat4 inv;
+
+		float d;
+
+		inv.m[ 0 ].x = m->m[ 1 ].y * m->m[ 2 ].z * m->m[ 3 ].w - 
+					   m->m[ 1 ].y * m->m[ 2 ].w * m->m[ 3 ].z - 
+					   m->m[ 2 ].y * m->m[ 1 ].z * m->m[ 3 ].w +
+					   m->m[ 2 ].y * m->m[ 1 ].w * m->m[ 3 ].z + 
+					   m->m[ 3 ].y * m->m[ 1 ].z * m->m[ 2 ].w - 
+					   m->m[ 3 ].y * m->m[ 1 ].w * m->m[ 2 ].z;
 		 
-	inv.m[ 1 ].x = -m->m[ 1 ].x * m->m[ 2 ].z * m->m[ 3 ].w +
-					m->m[ 1 ].x * m->m[ 2 ].w * m->m[ 3 ].z +
-					m->m[ 2 ].x * m->m[ 1 ].z * m->m[ 3 ].w -
-					m->m[ 2 ].x * m->m[ 1 ].w * m->m[ 3 ].z -
-					m->m[ 3 ].x * m->m[ 1 ].z * m->m[ 2 ].w +
-					m->m[ 3 ].x * m->m[ 1 ].w * m->m[ 2 ].z;
+		inv.m[ 1 ].x = -m->m[ 1 ].x * m->m[ 2 ].z * m->m[ 3 ].w +
+						m->m[ 1 ].x * m->m[ 2 ].w * m->m[ 3 ].z +
+						m->m[ 2 ].x * m->m[ 1 ].z * m->m[ 3 ].w -
+						m->m[ 2 ].x * m->m[ 1 ].w * m->m[ 3 ].z -
+						m->m[ 3 ].x * m->m[ 1 ].z * m->m[ 2 ].w +
+						m->m[ 3 ].x * m->m[ 1 ].w * m->m[ 2 ].z;
 		 
-	inv.m[ 2 ].x = m->m[ 1 ].x * m->m[ 2 ].y * m->m[ 3 ].w -
-				   m->m[ 1 ].x * m->m[ 2 ].w * m->m[ 3 ].y -
-				   m->m[ 2 ].x * m->m[ 1 ].y * m->m[ 3 ].w +
-				   m->m[ 2 ].x * m->m[ 1 ].w * m->m[ 3 ].y +
-				   m->m[ 3 ].x * m->m[ 1 ].y * m->m[ 2 ].w -
-				   m->m[ 3 ].x * m->m[ 1 ].w * m->m[ 2 ].y;
+		inv.m[ 2 ].x = m->m[ 1 ].x * m->m[ 2 ].y * m->m[ 3 ].w -
+					   m->m[ 1 ].x * m->m[ 2 ].w * m->m[ 3 ].y -
+					   m->m[ 2 ].x * m->m[ 1 ].y * m->m[ 3 ].w +
+					   m->m[ 2 ].x * m->m[ 1 ].w * m->m[ 3 ].y +
+					   m->m[ 3 ].x * m->m[ 1 ].y * m->m[ 2 ].w -
+					   m->m[ 3 ].x * m->m[ 1 ].w * m->m[ 2 ].y;
 		 
-	inv.m[ 3 ].x = -m->m[ 1 ].x * m->m[ 2 ].y * m->m[ 3 ].z +
-					m->m[ 1 ].x * m->m[ 2 ].z * m->m[ 3 ].y +
-					m->m[ 2 ].x * m->m[ 1 ].y * m->m[ 3 ].z -
-					m->m[ 2 ].x * m->m[ 1 ].z * m->m[ 3 ].y -
-					m->m[ 3 ].x * m->m[ 1 ].y * m->m[ 2 ].z +
-					m->m[ 3 ].x * m->m[ 1 ].z * m->m[ 2 ].y;
+		inv.m[ 3 ].x = -m->m[ 1 ].x * m->m[ 2 ].y * m->m[ 3 ].z +
+						m->m[ 1 ].x * m->m[ 2 ].z * m->m[ 3 ].y +
+						m->m[ 2 ].x * m->m[ 1 ].y * m->m[ 3 ].z -
+						m->m[ 2 ].x * m->m[ 1 ].z * m->m[ 3 ].y -
+						m->m[ 3 ].x * m->m[ 1 ].y * m->m[ 2 ].z +
+						m->m[ 3 ].x * m->m[ 1 ].z * m->m[ 2 ].y;
 		 
-	inv.m[ 0 ].y = -m->m[ 0 ].y * m->m[ 2 ].z * m->m[ 3 ].w +
-					m->m[ 0 ].y * m->m[ 2 ].w * m->m[ 3 ].z +
-					m->m[ 2 ].y * m->m[ 0 ].z * m->m[ 3 ].w -
-					m->m[ 2 ].y * m->m[ 0 ].w * m->m[ 3 ].z -
-					m->m[ 3 ].y * m->m[ 0 ].z * m->m[ 2 ].w +
-					m->m[ 3 ].y * m->m[ 0 ].w * m->m[ 2 ].z;
+		inv.m[ 0 ].y = -m->m[ 0 ].y * m->m[ 2 ].z * m->m[ 3 ].w +
+						m->m[ 0 ].y * m->m[ 2 ].w * m->m[ 3 ].z +
+						m->m[ 2 ].y * m->m[ 0 ].z * m->m[ 3 ].w -
+						m->m[ 2 ].y * m->m[ 0 ].w * m->m[ 3 ].z -
+						m->m[ 3 ].y * m->m[ 0 ].z * m->m[ 2 ].w +
+						m->m[ 3 ].y * m->m[ 0 ].w * m->m[ 2 ].z;
 		 
-	inv.m[ 1 ].y = m->m[ 0 ].x * m->m[ 2 ].z * m->m[ 3 ].w -
-				   m->m[ 0 ].x * m->m[ 2 ].w * m->m[ 3 ].z -
-				   m->m[ 2 ].x * m->m[ 0 ].z * m->m[ 3 ].w +
-				   m->m[ 2 ].x * m->m[ 0 ].w * m->m[ 3 ].z +
-				   m->m[ 3 ].x * m->m[ 0 ].z * m->m[ 2 ].w -
-				   m->m[ 3 ].x * m->m[ 0 ].w * m->m[ 2 ].z;
+		inv.m[ 1 ].y = m->m[ 0 ].x * m->m[ 2 ].z * m->m[ 3 ].w -
+					   m->m[ 0 ].x * m->m[ 2 ].w * m->m[ 3 ].z -
+					   m->m[ 2 ].x * m->m[ 0 ].z * m->m[ 3 ].w +
+					   m->m[ 2 ].x * m->m[ 0 ].w * m->m[ 3 ].z +
+					   m->m[ 3 ].x * m->m[ 0 ].z * m->m[ 2 ].w -
+					   m->m[ 3 ].x * m->m[ 0 ].w * m->m[ 2 ].z;
 		 
-	inv.m[ 2 ].y = -m->m[ 0 ].x * m->m[ 2 ].y * m->m[ 3 ].w +
-					m->m[ 0 ].x * m->m[ 2 ].w * m->m[ 3 ].y +
-					m->m[ 2 ].x * m->m[ 0 ].y * m->m[ 3 ].w -
-					m->m[ 2 ].x * m->m[ 0 ].w * m->m[ 3 ].y -
-					m->m[ 3 ].x * m->m[ 0 ].y * m->m[ 2 ].w +
-					m->m[ 3 ].x * m->m[ 0 ].w * m->m[ 2 ].y;
+		inv.m[ 2 ].y = -m->m[ 0 ].x * m->m[ 2 ].y * m->m[ 3 ].w +
+						m->m[ 0 ].x * m->m[ 2 ].w * m->m[ 3 ].y +
+						m->m[ 2 ].x * m->m[ 0 ].y * m->m[ 3 ].w -
+						m->m[ 2 ].x * m->m[ 0 ].w * m->m[ 3 ].y -
+						m->m[ 3 ].x * m->m[ 0 ].y * m->m[ 2 ].w +
+						m->m[ 3 ].x * m->m[ 0 ].w * m->m[ 2 ].y;
 		 
-	inv.m[ 3 ].y = m->m[ 0 ].x * m->m[ 2 ].y * m->m[ 3 ].z - 
-				   m->m[ 0 ].x * m->m[ 2 ].z * m->m[ 3 ].y -
-				   m->m[ 2 ].x * m->m[ 0 ].y * m->m[ 3 ].z +
-				   m->m[ 2 ].x * m->m[ 0 ].z * m->m[ 3 ].y +
-				   m->m[ 3 ].x * m->m[ 0 ].y * m->m[ 2 ].z -
-				   m->m[ 3 ].x * m->m[ 0 ].z * m->m[ 2 ].y;
+		inv.m[ 3 ].y = m->m[ 0 ].x * m->m[ 2 ].y * m->m[ 3 ].z - 
+					   m->m[ 0 ].x * m->m[ 2 ].z * m->m[ 3 ].y -
+					   m->m[ 2 ].x * m->m[ 0 ].y * m->m[ 3 ].z +
+					   m->m[ 2 ].x * m->m[ 0 ].z * m->m[ 3 ].y +
+					   m->m[ 3 ].x * m->m[ 0 ].y * m->m[ 2 ].z -
+					   m->m[ 3 ].x * m->m[ 0 ].z * m->m[ 2 ].y;
 		 
-	inv.m[ 0 ].z = m->m[ 0 ].y * m->m[ 1 ].z * m->m[ 3 ].w -
-				   m->m[ 0 ].y * m->m[ 1 ].w * m->m[ 3 ].z -
-				   m->m[ 1 ].y * m->m[ 0 ].z * m->m[ 3 ].w +
-				   m->m[ 1 ].y * m->m[ 0 ].w * m->m[ 3 ].z +
-				   m->m[ 3 ].y * m->m[ 0 ].z * m->m[ 1 ].w -
-				   m->m[ 3 ].y * m->m[ 0 ].w * m->m[ 1 ].z;
+		inv.m[ 0 ].z = m->m[ 0 ].y * m->m[ 1 ].z * m->m[ 3 ].w -
+					   m->m[ 0 ].y * m->m[ 1 ].w * m->m[ 3 ].z -
+					   m->m[ 1 ].y * m->m[ 0 ].z * m->m[ 3 ].w +
+					   m->m[ 1 ].y * m->m[ 0 ].w * m->m[ 3 ].z +
+					   m->m[ 3 ].y * m->m[ 0 ].z * m->m[ 1 ].w -
+					   m->m[ 3 ].y * m->m[ 0 ].w * m->m[ 1 ].z;
 		 
-	inv.m[ 1 ].z = -m->m[ 0 ].x * m->m[ 1 ].z * m->m[ 3 ].w +
-					m->m[ 0 ].x * m->m[ 1 ].w * m->m[ 3 ].z +
-					m->m[ 1 ].x * m->m[ 0 ].z * m->m[ 3 ].w -
-					m->m[ 1 ].x * m->m[ 0 ].w * m->m[ 3 ].z -
-					m->m[ 3 ].x * m->m[ 0 ].z * m->m[ 1 ].w +
-					m->m[ 3 ].x * m->m[ 0 ].w * m->m[ 1 ].z;
+		inv.m[ 1 ].z = -m->m[ 0 ].x * m->m[ 1 ].z * m->m[ 3 ].w +
+						m->m[ 0 ].x * m->m[ 1 ].w * m->m[ 3 ].z +
+						m->m[ 1 ].x * m->m[ 0 ].z * m->m[ 3 ].w -
+						m->m[ 1 ].x * m->m[ 0 ].w * m->m[ 3 ].z -
+						m->m[ 3 ].x * m->m[ 0 ].z * m->m[ 1 ].w +
+						m->m[ 3 ].x * m->m[ 0 ].w * m->m[ 1 ].z;
 		 
-	inv.m[ 2 ].z = m->m[ 0 ].x * m->m[ 1 ].y * m->m[ 3 ].w -
-				   m->m[ 0 ].x * m->m[ 1 ].w * m->m[ 3 ].y -
-				   m->m[ 1 ].x * m->m[ 0 ].y * m->m[ 3 ].w +
-				   m->m[ 1 ].x * m->m[ 0 ].w * m->m[ 3 ].y +
-				   m->m[ 3 ].x * m->m[ 0 ].y * m->m[ 1 ].w -
-				   m->m[ 3 ].x * m->m[ 0 ].w * m->m[ 1 ].y;
+		inv.m[ 2 ].z = m->m[ 0 ].x * m->m[ 1 ].y * m->m[ 3 ].w -
+					   m->m[ 0 ].x * m->m[ 1 ].w * m->m[ 3 ].y -
+					   m->m[ 1 ].x * m->m[ 0 ].y * m->m[ 3 ].w +
+					   m->m[ 1 ].x * m->m[ 0 ].w * m->m[ 3 ].y +
+					   m->m[ 3 ].x * m->m[ 0 ].y * m->m[ 1 ].w -
+					   m->m[ 3 ].x * m->m[ 0 ].w * m->m[ 1 ].y;
 		 
-	inv.m[ 3 ].z = -m->m[ 0 ].x * m->m[ 1 ].y * m->m[ 3 ].z +
-					m->m[ 0 ].x * m->m[ 1 ].z * m->m[ 3 ].y +
-					m->m[ 1 ].x * m->m[ 0 ].y * m->m[ 3 ].z -
-					m->m[ 1 ].x * m->m[ 0 ].z * m->m[ 3 ].y -
-					m->m[ 3 ].x * m->m[ 0 ].y * m->m[ 1 ].z +
-					m->m[ 3 ].x * m->m[ 0 ].z * m->m[ 1 ].y;
+		inv.m[ 3 ].z = -m->m[ 0 ].x * m->m[ 1 ].y * m->m[ 3 ].z +
+						m->m[ 0 ].x * m->m[ 1 ].z * m->m[ 3 ].y +
+						m->m[ 1 ].x * m->m[ 0 ].y * m->m[ 3 ].z -
+						m->m[ 1 ].x * m->m[ 0 ].z * m->m[ 3 ].y -
+						m->m[ 3 ].x * m->m[ 0 ].y * m->m[ 1 ].z +
+						m->m[ 3 ].x * m->m[ 0 ].z * m->m[ 1 ].y;
 		 
-	inv.m[ 0 ].w = -m->m[ 0 ].y * m->m[ 1 ].z * m->m[ 2 ].w +
-					m->m[ 0 ].y * m->m[ 1 ].w * m->m[ 2 ].z +
-					m->m[ 1 ].y * m->m[ 0 ].z * m->m[ 2 ].w -
-					m->m[ 1 ].y * m->m[ 0 ].w * m->m[ 2 ].z -
-					m->m[ 2 ].y * m->m[ 0 ].z * m->m[ 1 ].w +
-					m->m[ 2 ].y * m->m[ 0 ].w * m->m[ 1 ].z;
+		inv.m[ 0 ].w = -m->m[ 0 ].y * m->m[ 1 ].z * m->m[ 2 ].w +
+						m->m[ 0 ].y * m->m[ 1 ].w * m->m[ 2 ].z +
+						m->m[ 1 ].y * m->m[ 0 ].z * m->m[ 2 ].w -
+						m->m[ 1 ].y * m->m[ 0 ].w * m->m[ 2 ].z -
+						m->m[ 2 ].y * m->m[ 0 ].z * m->m[ 1 ].w +
+						m->m[ 2 ].y * m->m[ 0 ].w * m->m[ 1 ].z;
 		 
-	inv.m[ 1 ].w = m->m[ 0 ].x * m->m[ 1 ].z * m->m[ 2 ].w -
-				   m->m[ 0 ].x * m->m[ 1 ].w * m->m[ 2 ].z -
-				   m->m[ 1 ].x * m->m[ 0 ].z * m->m[ 2 ].w +
-				   m->m[ 1 ].x * m->m[ 0 ].w * m->m[ 2 ].z +
-				   m->m[ 2 ].x * m->m[ 0 ].z * m->m[ 1 ].w -
-				   m->m[ 2 ].x * m->m[ 0 ].w * m->m[ 1 ].z;
+		inv.m[ 1 ].w = m->m[ 0 ].x * m->m[ 1 ].z * m->m[ 2 ].w -
+					   m->m[ 0 ].x * m->m[ 1 ].w * m->m[ 2 ].z -
+					   m->m[ 1 ].x * m->m[ 0 ].z * m->m[ 2 ].w +
+					   m->m[ 1 ].x * m->m[ 0 ].w * m->m[ 2 ].z +
+					   m->m[ 2 ].x * m->m[ 0 ].z * m->m[ 1 ].w -
+					   m->m[ 2 ].x * m->m[ 0 ].w * m->m[ 1 ].z;
 		 
-	inv.m[ 2 ].w = -m->m[ 0 ].x * m->m[ 1 ].y * m->m[ 2 ].w +
-					m->m[ 0 ].x * m->m[ 1 ].w * m->m[ 2 ].y +
-					m->m[ 1 ].x * m->m[ 0 ].y * m->m[ 2 ].w -
-					m->m[ 1 ].x * m->m[ 0 ].w * m->m[ 2 ].y -
-					m->m[ 2 ].x * m->m[ 0 ].y * m->m[ 1 ].w +
-					m->m[ 2 ].x * m->m[ 0 ].w * m->m[ 1 ].y;
+		inv.m[ 2 ].w = -m->m[ 0 ].x * m->m[ 1 ].y * m->m[ 2 ].w +
+						m->m[ 0 ].x * m->m[ 1 ].w * m->m[ 2 ].y +
+						m->m[ 1 ].x * m->m[ 0 ].y * m->m[ 2 ].w -
+						m->m[ 1 ].x * m->m[ 0 ].w * m->m[ 2 ].y -
+						m->m[ 2 ].x * m->m[ 0 ].y * m->m[ 1 ].w +
+						m->m[ 2 ].x * m->m[ 0 ].w * m->m[ 1 ].y;
 		 
-	inv.m[ 3 ].w = m->m[ 0 ].x * m->m[ 1 ].y * m->m[ 2 ].z -
-				   m->m[ 0 ].x * m->m[ 1 ].z * m->m[ 2 ].y -
-				   m->m[ 1 ].x * m->m[ 0 ].y * m->m[ 2 ].z +
-				   m->m[ 1 ].x * m->m[ 0 ].z * m->m[ 2 ].y +
-				   m->m[ 2 ].x * m->m[ 0 ].y * m->m[ 1 ].z -
-				   m->m[ 2 ].x * m->m[ 0 ].z * m->m[ 1 ].y;
-
-	d = m->m[ 0 ].x * inv.m[ 0 ].x + 
-		m->m[ 0 ].y * inv.m[ 1 ].x +
-		m->m[ 0 ].z * inv.m[ 2 ].x +
-		m->m[ 0 ].w * inv.m[ 3 ].x;
+		inv.m[ 3 ].w = m->m[ 0 ].x * m->m[ 1 ].y * m->m[ 2 ].z -
+					   m->m[ 0 ].x * m->m[ 1 ].z * m->m[ 2 ].y -
+					   m->m[ 1 ].x * m->m[ 0 ].y * m->m[ 2 ].z +
+					   m->m[ 1 ].x * m->m[ 0 ].z * m->m[ 2 ].y +
+					   m->m[ 2 ].x * m->m[ 0 ].y * m->m[ 1 ].z -
+					   m->m[ 2 ].x * m->m[ 0 ].z * m->m[ 1 ].y;
+
+		d = m->m[ 0 ].x * inv.m[ 0 ].x + 
+			m->m[ 0 ].y * inv.m[ 1 ].x +
+			m->m[ 0 ].z * inv.m[ 2 ].x +
+			m->m[ 0 ].w * inv.m[ 3 ].x;
 	
-	if( !d ) return 0;
+		if( !d ) return 0;
 
-	d = 1.0f / d;
+		d = 1.0f / d;
 
-	inv.m[ 0 ].x *= d;
-	inv.m[ 0 ].y *= d;
-	inv.m[ 0 ].z *= d;
-	inv.m[ 0 ].w *= d;
+		inv.m[ 0 ].x *= d;
+		inv.m[ 0 ].y *= d;
+		inv.m[ 0 ].z *= d;
+		inv.m[ 0 ].w *= d;
 
-	inv.m[ 1 ].x *= d;
-	inv.m[ 1 ].y *= d;
-	inv.m[ 1 ].z *= d;
-	inv.m[ 1 ].w *= d;
+		inv.m[ 1 ].x *= d;
+		inv.m[ 1 ].y *= d;
+		inv.m[ 1 ].z *= d;
+		inv.m[ 1 ].w *= d;
 
-	inv.m[ 2 ].x *= d;
-	inv.m[ 2 ].y *= d;
-	inv.m[ 2 ].z *= d;
-	inv.m[ 2 ].w *= d;
+		inv.m[ 2 ].x *= d;
+		inv.m[ 2 ].y *= d;
+		inv.m[ 2 ].z *= d;
+		inv.m[ 2 ].w *= d;
 
-	inv.m[ 3 ].x *= d;
-	inv.m[ 3 ].y *= d;
-	inv.m[ 3 ].z *= d;
-	inv.m[ 3 ].w *= d;
+		inv.m[ 3 ].x *= d;
+		inv.m[ 3 ].y *= d;
+		inv.m[ 3 ].z *= d;
+		inv.m[ 3 ].w *= d;
 	
-	mat4_copy_mat4( m, &inv ); 
+		mat4_copy_mat4( m, &inv ); 
 	
-	return 1;
+		return 1;
+
+	#endif
 }
 
 
@@ -679,27 +1080,87 @@ void mat4_multiply_mat3( mat4 *dst, mat4 *m0, mat3 *m1 )
 */
 void mat4_multiply_mat4( mat4 *dst, mat4 *m0, mat4 *m1 )
 {
-	mat4 mat;
+	#if defined( __SSE__ )
+
+		// Each column of the result is a linear combination of the columns of m0, all
+		// the columns are computed before storing so dst can be the same as m0 or m1.
+		__m128 c0 = _mm_loadu_ps( &m0->m[ 0 ].x ),
+			   c1 = _mm_loadu_ps( &m0->m[ 1 ].x ),
+			   c2 = _mm_loadu_ps( &m0->m[ 2 ].x ),
+			   c3 = _mm_loadu_ps( &m0->m[ 3 ].x ),
+			   r[ 4 ];
+
+		unsigned int i = 0;
+
+		while( i != 4 )
+		{
+			__m128 p = _mm_loadu_ps( &m1->m[ i ].x );
+
+			r[ i ] = _mm_add_ps( _mm_add_ps( _mm_mul_ps( c0, _mm_shuffle_ps( p, p, _MM_SHUFFLE( 0, 0, 0, 0 ) ) ),
+											 _mm_mul_ps( c1, _mm_shuffle_ps( p, p, _MM_SHUFFLE( 1, 1, 1, 1 ) ) ) ),
+								 _mm_add_ps( _mm_mul_ps( c2, _mm_shuffle_ps( p, p, _MM_SHUFFLE( 2, 2, 2, 2 ) ) ),
+											 _mm_mul_ps( c3, _mm_shuffle_ps( p, p, _MM_SHUFFLE( 3, 3, 3, 3 ) ) ) ) );
+			++i;
+		}
+
+		_mm_storeu_ps( &dst->m[ 0 ].x, r[ 0 ] );
+		_mm_storeu_ps( &dst->m[ 1 ].x, r[ 1 ] );
+		_mm_storeu_ps( &dst->m[ 2 ].x, r[ 2 ] );
+		_mm_storeu_ps( &dst->m[ 3 ].x, r[ 3 ] );
+
+	#elif defined( __ARM_NEON__ ) || defined( __ARM_NEON )
+
+		float32x4_t c0 = vld1q_f32( &m0->m[ 0 ].x ),
+					c1 = vld1q_f32( &m0->m[ 1 ].x ),
+					c2 = vld1q_f32( &m0->m[ 2 ].x ),
+					c3 = vld1q_f32( &m0->m[ 3 ].x ),
+					r[ 4 ];
+
+		unsigned int i = 0;
+
+		while( i != 4 )
+		{
+			float32x4_t p  = vld1q_f32( &m1->m[ i ].x );
+			float32x2_t lo = vget_low_f32 ( p ),
+						hi = vget_high_f32( p );
+
+			r[ i ] = vmlaq_lane_f32( vmlaq_lane_f32( vmlaq_lane_f32( vmulq_lane_f32( c0, lo, 0 ),
+																	 c1, lo, 1 ),
+																	 c2, hi, 0 ),
+																	 c3, hi, 1 );
+			++i;
+		}
+
+		vst1q_f32( &dst->m[ 0 ].x, r[ 0 ] );
+		vst1q_f32( &dst->m[ 1 ].x, r[ 1 ] );
+		vst1q_f32( &dst->m[ 2 ].x, r[ 2 ] );
+		vst1q_f32( &dst->m[ 3 ].x, r[ 3 ] );
+
+	#else
+
+		mat4 mat;
+
+		mat.m[ 0 ].x = m0->m[ 0 ].x * m1->m[ 0 ].x + m0->m[ 1 ].x * m1->m[ 0 ].y + m0->m[ 2 ].x * m1->m[ 0 ].z + m0->m[ 3 ].x * m1->m[ 0 ].w;
+		mat.m[ 0 ].y = m0->m[ 0 ].y * m1->m[ 0 ].x + m0->m[ 1 ].y * m1->m[ 0 ].y + m0->m[ 2 ].y * m1->m[ 0 ].z + m0->m[ 3 ].y * m1->m[ 0 ].w;
+		mat.m[ 0 ].z = m0->m[ 0 ].z * m1->m[ 0 ].x + m0->m[ 1 ].z * m1->m[ 0 ].y + m0->m[ 2 ].z * m1->m[ 0 ].z + m0->m[ 3 ].z * m1->m[ 0 ].w;
+		mat.m[ 0 ].w = m0->m[ 0 ].w * m1->m[ 0 ].x + m0->m[ 1 ].w * m1->m[ 0 ].y + m0->m[ 2 ].w * m1->m[ 0 ].z + m0->m[ 3 ].w * m1->m[ 0 ].w;
 
-	mat.m[ 0 ].x = m0->m[ 0 ].x * m1->m[ 0 ].x + m0->m[ 1 ].x * m1->m[ 0 ].y + m0->m[ 2 ].x * m1->m[ 0 ].z + m0->m[ 3 ].x * m1->m[ 0 ].w;
-	mat.m[ 0 ].y = m0->m[ 0 ].y * m1->m[ 0 ].x + m0->m[ 1 ].y * m1->m[ 0 ].y + m0->m[ 2 ].y * m1->m[ 0 ].z + m0->m[ 3 ].y * m1->m[ 0 ].w;
-	mat.m[ 0 ].z = m0->m[ 0 ].z * m1->m[ 0 ].x + m0->m[ 1 ].z * m1->m[ 0 ].y + m0->m[ 2 ].z * m1->m[ 0 ].z + m0->m[ 3 ].z * m1->m[ 0 ].w;
-	mat.m[ 0 ].w = m0->m[ 0 ].w * m1->m[ 0 ].x + m0->m[ 1 ].w * m1->m[ 0 ].y + m0->m[ 2 ].w * m1->m[ 0 ].z + m0->m[ 3 ].w * m1->m[ 0 ].w;
+		mat.m[ 1 ].x = m0->m[ 0 ].x * m1->m[ 1 ].x + m0->m[ 1 ].x * m1->m[ 1 ].y + m0->m[ 2 ].x * m1->m[ 1 ].z + m0->m[ 3 ].x * m1->m[ 1 ].w;
+		mat.m[ 1 ].y = m0->m[ 0 ].y * m1->m[ 1 ].x + m0->m[ 1 ].y * m1->m[ 1 ].y + m0->m[ 2 ].y * m1->m[ 1 ].z + m0->m[ 3 ].y * m1->m[ 1 ].w;
+		mat.m[ 1 ].z = m0->m[ 0 ].z * m1->m[ 1 ].x + m0->m[ 1 ].z * m1->m[ 1 ].y + m0->m[ 2 ].z * m1->m[ 1 ].z + m0->m[ 3 ].z * m1->m[ 1 ].w;
+		mat.m[ 1 ].w = m0->m[ 0 ].w * m1->m[ 1 ].x + m0->m[ 1 ].w * m1->m[ 1 ].y + m0->m[ 2 ].w * m1->m[ 1 ].z + m0->m[ 3 ].w * m1->m[ 1 ].w;
 
-	mat.m[ 1 ].x = m0->m[ 0 ].x * m1->m[ 1 ].x + m0->m[ 1 ].x * m1->m[ 1 ].y + m0->m[ 2 ].x * m1->m[ 1 ].z + m0->m[ 3 ].x * m1->m[ 1 ].w;
-	mat.m[ 1 ].y = m0->m[ 0 ].y * m1->m[ 1 ].x + m0->m[ 1 ].y * m1->m[ 1 ].y + m0->m[ 2 ].y * m1->m[ 1 ].z + m0->m[ 3 ].y * m1->m[ 1 ].w;
-	mat.m[ 1 ].z = m0->m[ 0 ].z * m1->m[ 1 ].x + m0->m[ 1 ].z * m1->m[ 1 ].y + m0->m[ 2 ].z * m1->m[ 1 ].z + m0->m[ 3 ].z * m1->m[ 1 ].w;
-	mat.m[ 1 ].w = m0->m[ 0 ].w * m1->m[ 1 ].x + m0->m[ 1 ].w * m1->m[ 1 ].y + m0->m[ 2 ].w * m1->m[ 1 ].z + m0->m[ 3 ].w * m1->m[ 1 ].w;
+		mat.m[ 2 ].x = m0->m[ 0 ].x * m1->m[ 2 ].x + m0->m[ 1 ].x * m1->m[ 2 ].y + m0->m[ 2 ].x * m1->m[ 2 ].z + m0->m[ 3 ].x * m1->m[ 2 ].w;
+		mat.m[ 2 ].y = m0->m[ 0 ].y * m1->m[ 2 ].x + m0->m[ 1 ].y * m1->m[ 2 ].y + m0->m[ 2 ].y * m1->m[ 2 ].z + m0->m[ 3 ].y * m1->m[ 2 ].w;
+		mat.m[ 2 ].z = m0->m[ 0 ].z * m1->m[ 2 ].x + m0->m[ 1 ].z * m1->m[ 2 ].y + m0->m[ 2 ].z * m1->m[ 2 ].z + m0->m[ 3 ].z * m1->m[ 2 ].w;
+		mat.m[ 2 ].w = m0->m[ 0 ].w * m1->m[ 2 ].x + m0->m[ 1 ].w * m1->m[ 2 ].y + m0->m[ 2 ].w * m1->m[ 2 ].z + m0->m[ 3 ].w * m1->m[ 2 ].w;
 
-	mat.m[ 2 ].x = m0->m[ 0 ].x * m1->m[ 2 ].x + m0->m[ 1 ].x * m1->m[ 2 ].y + m0->m[ 2 ].x * m1->m[ 2 ].z + m0->m[ 3 ].x * m1->m[ 2 ].w;
-	mat.m[ 2 ].y = m0->m[ 0 ].y * m1->m[ 2 ].x + m0->m[ 1 ].y * m1->m[ 2 ].y + m0->m[ 2 ].y * m1->m[ 2 ].z + m0->m[ 3 ].y * m1->m[ 2 ].w;
-	mat.m[ 2 ].z = m0->m[ 0 ].z * m1->m[ 2 ].x + m0->m[ 1 ].z * m1->m[ 2 ].y + m0->m[ 2 ].z * m1->m[ 2 ].z + m0->m[ 3 ].z * m1->m[ 2 ].w;
-	mat.m[ 2 ].w = m0->m[ 0 ].w * m1->m[ 2 ].x + m0->m[ 1 ].w * m1->m[ 2 ].y + m0->m[ 2 ].w * m1->m[ 2 ].z + m0->m[ 3 ].w * m1->m[ 2 ].w;
+		mat.m[ 3 ].x = m0->m[ 0 ].x * m1->m[ 3 ].x + m0->m[ 1 ].x * m1->m[ 3 ].y + m0->m[ 2 ].x * m1->m[ 3 ].z + m0->m[ 3 ].x * m1->m[ 3 ].w;
+		mat.m[ 3 ].y = m0->m[ 0 ].y * m1->m[ 3 ].x + m0->m[ 1 ].y * m1->m[ 3 ].y + m0->m[ 2 ].y * m1->m[ 3 ].z + m0->m[ 3 ].y * m1->m[ 3 ].w;
+		mat.m[ 3 ].z = m0->m[ 0 ].z * m1->m[ 3 ].x + m0->m[ 1 ].z * m1->m[ 3 ].y + m0->m[ 2 ].z * m1->m[ 3 ].z + m0->m[ 3 ].z * m1->m[ 3 ].w;
+		mat.m[ 3 ].w = m0->m[ 0 ].w * m1->m[ 3 ].x + m0->m[ 1 ].w * m1->m[ 3 ].y + m0->m[ 2 ].w * m1->m[ 3 ].z + m0->m[ 3 ].w * m1->m[ 3 ].w;
 
-	mat.m[ 3 ].x = m0->m[ 0 ].x * m1->m[ 3 ].x + m0->m[ 1 ].x * m1->m[ 3 ].y + m0->m[ 2 ].x * m1->m[ 3 ].z + m0->m[ 3 ].x * m1->m[ 3 ].w;
-	mat.m[ 3 ].y = m0->m[ 0 ].y * m1->m[ 3 ].x + m0->m[ 1 ].y * m1->m[ 3 ].y + m0->m[ 2 ].y * m1->m[ 3 ].z + m0->m[ 3 ].y * m1->m[ 3 ].w;
-	mat.m[ 3 ].z = m0->m[ 0 ].z * m1->m[ 3 ].x + m0->m[ 1 ].z * m1->m[ 3 ].y + m0->m[ 2 ].z * m1->m[ 3 ].z + m0->m[ 3 ].z * m1->m[ 3 ].w;
-	mat.m[ 3 ].w = m0->m[ 0 ].w * m1->m[ 3 ].x + m0->m[ 1 ].w * m1->m[ 3 ].y + m0->m[ 2 ].w * m1->m[ 3 ].z + m0->m[ 3 ].w * m1->m[ 3 ].w;
+		mat4_copy_mat4( dst, &mat );
 
-	mat4_copy_mat4( dst, &mat );
+	#endif
 }
@@ -37,10 +37,16 @@ void vec3_multiply_mat4( vec3 *dst, vec3 *v, mat4 *m );
 
 void vec4_multiply_mat4( vec4 *dst, vec4 *v, mat4 *m );
 
+void vec3_multiply_mat4_array( vec3 *dst, vec3 *v, unsigned int n, mat4 *m, float w );
+
+void vec4_multiply_mat4_array( vec4 *dst, vec4 *v, unsigned int n, mat4 *m );
+
 void mat3_identity( mat3 *m );
 
 void mat3_copy_mat4( mat3 *dst, mat4 *m );
 
+unsigned char mat3_invert_transpose_mat4( mat3 *dst, mat4 *m );
+
 void mat4_identity( mat4 *m );
 
 void mat4_copy_mat4( mat4 *dst, mat4 *m );
@@ -53,6 +59,8 @@ void mat4_rotate( mat4 *dst, mat4 *m, vec4 *v );
 
 void mat4_scale( mat4 *dst, mat4 *m, vec3 *v );
 
+void mat4_transform( mat4 *dst, vec3 *location, vec3 *rotation, vec3 *scale );
+
 unsigned char mat4_invert( mat4 *m );
 
 unsigned char mat4_invert_full( mat4 *m );
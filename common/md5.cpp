@@ -74,7 +74,9 @@ MD5 *MD5_load_mesh( char *filename, unsigned char relative_path )
 		
 		else if( sscanf( line, "numJoints %d", &md5->n_joint ) == 1 )
 		{
-			md5->bind_pose = ( MD5JOINT * ) calloc( md5->n_joint, sizeof( MD5JOINT ) );
+			md5->md5joint = ( MD5JOINT * ) calloc( md5->n_joint, sizeof( MD5JOINT ) );
+			
+			MD5_init_pose( md5, &md5->bind_pose );
 		}
 		
 		else if( sscanf( line, "numMeshes %d", &md5->n_mesh ) == 1 )
@@ -101,16 +103,16 @@ MD5 *MD5_load_mesh( char *filename, unsigned char relative_path )
 			{
 				if( sscanf( line,
 							"%s %d ( %f %f %f ) ( %f %f %f )",
-							 md5->bind_pose[ i ].name,
-							&md5->bind_pose[ i ].parent,
-							&md5->bind_pose[ i ].location.x,
-							&md5->bind_pose[ i ].location.y,
-							&md5->bind_pose[ i ].location.z,
-							&md5->bind_pose[ i ].rotation.x,
-							&md5->bind_pose[ i ].rotation.y,
-							&md5->bind_pose[ i ].rotation.z ) == 8 )
+							 md5->md5joint[ i ].name,
+							&md5->md5joint[ i ].parent,
+							&md5->bind_pose.location[ i ].x,
+							&md5->bind_pose.location[ i ].y,
+							&md5->bind_pose.location[ i ].z,
+							&md5->bind_pose.rotation[ i ].x,
+							&md5->bind_pose.rotation[ i ].y,
+							&md5->bind_pose.rotation[ i ].z ) == 8 )
 				{
-					vec4_build_w( &md5->bind_pose[ i ].rotation );
+					vec4_build_w( &md5->bind_pose.rotation[ i ] );
 				
 					++i;
 				}
@@ -230,6 +232,42 @@ cleanup:
 }
 
 
+/*!
+	Function internally used to convert the location and rotation of a joint from its parent space
+	to object space. The parent joint have to be converted first.
+	
+	\param[in] md5 A valid MD5 structure pointer to have access to the skeleton.
+	\param[in,out] md5pose A valid MD5POSE structure pointer, its rotations must not be quantized.
+	\param[in] joint_index The index of the joint in the skeleton.
+*/
+void MD5_build_object_space_joint( MD5 *md5, MD5POSE *md5pose, unsigned int joint_index )
+{
+	int parent = md5->md5joint[ joint_index ].parent;
+	
+	vec3 location;
+	
+	vec4 rotation;
+	
+	if( parent > -1 )
+	{
+		vec3_rotate_vec4( &location,
+						  &md5pose->location[ joint_index ],
+						  &md5pose->rotation[ parent ] );
+		
+		md5pose->location[ joint_index ].x = location.x + md5pose->location[ parent ].x;
+		md5pose->location[ joint_index ].y = location.y + md5pose->location[ parent ].y;
+		md5pose->location[ joint_index ].z = location.z + md5pose->location[ parent ].z;
+		
+		vec4_multiply_vec4( &rotation,
+							&md5pose->rotation[ parent ],
+							&md5pose->rotation[ joint_index ] );
+		
+		vec4_normalize( &md5pose->rotation[ joint_index ],
+						&rotation );
+	}
+}
+
+
 /*!
 	Load an .md5action file from disk. If the operation is successfull the function
 	will return the index used by this action MD5 structure pointer action database,
@@ -278,14 +316,19 @@ int MD5_load_action( MD5 *md5, char *name, char *filename, unsigned char relativ
 		
 		else if( sscanf( line, "numFrames %d", &md5action->n_frame ) == 1 )
 		{
-			md5action->frame = ( MD5JOINT ** ) malloc( md5action->n_frame *
-													   sizeof( MD5JOINT * ) );
+			md5action->frame = ( MD5POSE * ) calloc( md5action->n_frame,
+													 sizeof( MD5POSE ) );
+			
+			vec3 *location = ( vec3 * ) malloc( md5action->n_frame * md5->n_joint * sizeof( vec3 ) );
+			
+			vec4 *rotation = ( vec4 * ) malloc( md5action->n_frame * md5->n_joint * sizeof( vec4 ) );
+			
 			unsigned int i = 0;
 			
 			while( i != md5action->n_frame )
 			{
-				md5action->frame[ i ] = ( MD5JOINT * ) malloc( md5->n_joint *
-															   sizeof( MD5JOINT ) );
+				md5action->frame[ i ].location = &location[ i * md5->n_joint ];
+				md5action->frame[ i ].rotation = &rotation[ i * md5->n_joint ];
 				++i;
 			}
 		}
@@ -294,17 +337,7 @@ int MD5_load_action( MD5 *md5, char *name, char *filename, unsigned char relativ
 		{
 			if( md5->n_joint != int_val ) goto cleanup;
 			
-			md5action->pose = ( MD5JOINT * ) malloc( md5->n_joint *
-													 sizeof( MD5JOINT ) );
-			
-			unsigned int i = 0;
-			
-			while( i != md5->n_joint )
-			{
-				strcpy( md5action->pose[ i ].name, md5->bind_pose[ i ].name );
-				
-				++i;
-			}			
+			MD5_init_pose( md5, &md5action->pose );
 		}
 		
 		else if( sscanf( line, "frameRate %d", &int_val ) == 1 )
@@ -312,7 +345,7 @@ int MD5_load_action( MD5 *md5, char *name, char *filename, unsigned char relativ
 
 		else if( sscanf( line, "frame %d", &int_val ) )
 		{
-			MD5JOINT *md5joint = md5action->frame[ int_val ];
+			MD5POSE *md5pose = &md5action->frame[ int_val ];
 			
 			line = strtok( NULL, "\n" );
 			
@@ -322,16 +355,14 @@ int MD5_load_action( MD5 *md5, char *name, char *filename, unsigned char relativ
 			{
 				if( sscanf( line,
 							" %f %f %f %f %f %f",
-							&md5joint[ i ].location.x,
-							&md5joint[ i ].location.y,
-							&md5joint[ i ].location.z,
-							&md5joint[ i ].rotation.x,
-							&md5joint[ i ].rotation.y,
-							&md5joint[ i ].rotation.z ) == 6 )
+							&md5pose->location[ i ].x,
+							&md5pose->location[ i ].y,
+							&md5pose->location[ i ].z,
+							&md5pose->rotation[ i ].x,
+							&md5pose->rotation[ i ].y,
+							&md5pose->rotation[ i ].z ) == 6 )
 				{
-					strcpy( md5joint[ i ].name, md5->bind_pose[ i ].name );
-					
-					vec4_build_w( &md5joint[ i ].rotation );				
+					vec4_build_w( &md5pose->rotation[ i ] );				
 				}
 				
 				line = strtok( NULL, "\n" );
@@ -340,33 +371,10 @@ int MD5_load_action( MD5 *md5, char *name, char *filename, unsigned char relativ
 			}
 			
 			
-			vec3 location;
-			
-			vec4 rotation;
-			
 			i = 0;
 			while( i != md5->n_joint )
 			{
-				if( md5->bind_pose[ i ].parent > -1 )
-				{
-					MD5JOINT *md5joint = &md5action->frame[ int_val ][ md5->bind_pose[ i ].parent ];
-				
-					vec3_rotate_vec4( &location,
-									  &md5action->frame[ int_val ][ i ].location,
-									  &md5joint->rotation );
-					
-					md5action->frame[ int_val ][ i ].location.x = location.x + md5joint->location.x;
-					md5action->frame[ int_val ][ i ].location.y = location.y + md5joint->location.y;
-					md5action->frame[ int_val ][ i ].location.z = location.z + md5joint->location.z;
-					
-					vec4_multiply_vec4( &rotation,
-										&md5joint->rotation,
-										&md5action->frame[ int_val ][ i ].rotation );
-					
-					vec4_normalize( &md5action->frame[ int_val ][ i ].rotation,
-									&rotation );
-				}
-				
+				MD5_build_object_space_joint( md5, md5pose, i );
 				++i;
 			}
 		}
@@ -394,6 +402,65 @@ cleanup:
 }
 
 
+/*!
+	Function internally used to free an MD5 instance, only the per-instance data is freed and
+	the resources shared with the original MD5 are left untouched. \sa MD5_create_instance
+	
+	\param[in,out] md5 A valid MD5 instance structure pointer.
+	
+	\return Return a NULL MD5 structure pointer.
+*/
+MD5 *MD5_free_instance( MD5 *md5 )
+{
+	unsigned int i = 0,
+				 j;
+	
+	while( i != md5->n_mesh )
+	{
+		MD5MESH *md5mesh = &md5->md5mesh[ i ];
+		
+		if( md5mesh->n_md5palette )
+		{
+			j = 0;
+			while( j != md5mesh->n_md5palette )
+			{
+				free( md5mesh->md5palette[ j ].matrix );
+				++j;
+			}
+			
+			free( md5mesh->md5palette );
+		}
+		else
+		{
+			if( md5mesh->vertex_data ) free( md5mesh->vertex_data );
+			
+			if( md5mesh->vbo ) glDeleteBuffers( 1, &md5mesh->vbo );
+			
+			if( md5mesh->vao ) glDeleteVertexArraysOES( 1, &md5mesh->vao );
+		}
+		
+		++i;
+	}
+	
+	GFX_reset_state();
+	
+	if( md5->md5mesh ) free( md5->md5mesh );
+	
+	
+	i = 0;
+	while( i != md5->n_action )
+	{
+		MD5_free_pose( &md5->md5action[ i ].pose );
+		++i;
+	}
+	
+	if( md5->md5action ) free( md5->md5action );
+	
+	free( md5 );
+	return NULL;
+}
+
+
 /*!
 	Free a valid MD5 structure pointer previously initialized with MD5_load_mesh.
 	
@@ -406,6 +473,8 @@ MD5 *MD5_free( MD5 *md5 )
 	unsigned int i = 0,
 			     j;
 
+	if( md5->instance ) return MD5_free_instance( md5 );
+
 	MD5_free_mesh_data( md5 );
 
 	while( i != md5->n_mesh )
@@ -419,6 +488,17 @@ MD5 *MD5_free( MD5 *md5 )
 		if( md5mesh->md5triangle ) free( md5mesh->md5triangle );
 		
 		if( md5mesh->md5weight ) free( md5mesh->md5weight );
+		
+		j = 0;
+		while( j != md5mesh->n_md5palette )
+		{
+			free( md5mesh->md5palette[ j ].joint );
+			
+			free( md5mesh->md5palette[ j ].matrix );
+			++j;
+		}
+		
+		if( md5mesh->md5palette ) free( md5mesh->md5palette );
 
 		if( md5mesh->vbo ) glDeleteBuffers( 1, &md5mesh->vbo );
 
@@ -428,6 +508,8 @@ MD5 *MD5_free( MD5 *md5 )
 		
 		++i;
 	}
+	
+	GFX_reset_state();
 
 	if( md5->md5mesh ) free( md5->md5mesh );
 	
@@ -437,16 +519,29 @@ MD5 *MD5_free( MD5 *md5 )
 	{
 		MD5ACTION *md5action = &md5->md5action[ i ];
 		
+		if( md5action->frame )
+		{
+			// The first frame owns the arrays of all the frames.
+			MD5_free_pose( &md5action->frame[ 0 ] );
+			
+			free( md5action->frame );
+		}
+		
+		MD5_free_pose( &md5action->pose );
+		
 		j = 0;
-		while( j != md5action->n_frame )
+		while( md5action->md5track && j != md5->n_joint )
 		{
-			free( md5action->frame[ j ] );
+			MD5TRACK *md5track = &md5action->md5track[ j ];
+			
+			free( md5track->location_frame );
+			free( md5track->qlocation );
+			free( md5track->rotation_frame );
+			free( md5track->qrotation );
 			++j;
 		}
 		
-		if( md5action->frame ) free( md5action->frame );
-		
-		if( md5action->pose ) free( md5action->pose );
+		if( md5action->md5track ) free( md5action->md5track );
 
 		++i;
 	}
@@ -454,12 +549,18 @@ MD5 *MD5_free( MD5 *md5 )
 	if( md5->md5action ) free( md5->md5action );
 
 	
-	if( md5->bind_pose )
+	if( md5->md5joint )
 	{
-		free( md5->bind_pose );
-		md5->bind_pose = NULL;
+		free( md5->md5joint );
+		md5->md5joint = NULL;
 	}
 	
+	MD5_free_pose( &md5->bind_pose );
+	
+	if( md5->inverse_bind_matrix ) free( md5->inverse_bind_matrix );
+	
+	if( md5->joint_bound ) free( md5->joint_bound );
+	
 
 	free( md5 );
 	return NULL;
@@ -470,7 +571,8 @@ MD5 *MD5_free( MD5 *md5 )
 	Free all the indices and triangle data used by the different MD5MESH contains
 	in the MD5 structure pointer pass in parameter. This function should only be
 	called after you call MD5_build as theses data are not necessary anymore for
-	drawing and can help you to save memory.
+	drawing and can help you to save memory. The data of an instance belongs to its
+	original MD5, so nothing is freed for an instance.
 	
 	\param[in,out] md5 A valid MD5 structure pointer.
 */
@@ -478,6 +580,8 @@ void MD5_free_mesh_data( MD5 *md5 )
 {
 	unsigned int i = 0;	
 
+	if( md5->instance ) return;
+
 	while( i != md5->n_mesh )
 	{
 		MD5MESH *md5mesh = &md5->md5mesh[ i ];
@@ -624,7 +728,7 @@ void MD5_set_action_fps( MD5ACTION *md5action, float fps )
 */
 void MD5_set_mesh_attributes( MD5MESH *md5mesh )
 {
-	glBindBuffer( GL_ARRAY_BUFFER, md5mesh->vbo );
+	GFX_bind_buffer( GL_ARRAY_BUFFER, md5mesh->vbo );
 	
 	glEnableVertexAttribArray( 0 );
 	
@@ -665,7 +769,29 @@ void MD5_set_mesh_attributes( MD5MESH *md5mesh )
 						   0,
 						   BUFFER_OFFSET( md5mesh->offset[ 3 ] ) );
 
-	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, md5mesh->vbo_indice );
+	if( md5mesh->n_md5palette )
+	{
+		glEnableVertexAttribArray( 4 );
+		
+		glVertexAttribPointer( 4,
+							   4,
+							   GL_UNSIGNED_BYTE,
+							   GL_FALSE,
+							   0,
+							   BUFFER_OFFSET( md5mesh->offset[ 4 ] ) );
+
+
+		glEnableVertexAttribArray( 5 );
+		
+		glVertexAttribPointer( 5,
+							   4,
+							   GL_FLOAT,
+							   GL_FALSE,
+							   0,
+							   BUFFER_OFFSET( md5mesh->offset[ 5 ] ) );
+	}
+
+	GFX_bind_buffer( GL_ELEMENT_ARRAY_BUFFER, md5mesh->vbo_indice );
 }
 
 
@@ -743,15 +869,133 @@ void MD5_optimize( MD5 *md5, unsigned int vertex_cache_size )
 
 
 /*!
-	Build the VBO for a specific MD5MESH index.
+	Optimize all the MD5MESH contained in the MD5 structure pointer received in parameter for the
+	post-transform vertex cache, then reorder their MD5VERTEX in their order of first use. Unlike
+	MD5_optimize the MD5MESH stay indexed GL_TRIANGLES. The cache efficiency before and after the
+	optimization is printed on the console.
 	
 	\param[in,out] md5 A valid MD5 structure pointer.
-	\param[in] mesh_index The MD5MESH index inside the mesh database of the MD5 to build the VBO for.
+	\param[in] vertex_cache_size The size of the vertex cache to optimize for, pass 0 to use
+	OBJ_VERTEX_CACHE_SIZE.
+	
+	\note Must be called before MD5_build or MD5_build2.
 */
-void MD5_build_vbo( MD5 *md5, unsigned int mesh_index )
+void MD5_optimize2( MD5 *md5, unsigned int vertex_cache_size )
 {
-	MD5MESH *md5mesh = &md5->md5mesh[ mesh_index ];
+	unsigned int i = 0,
+				 j,
+				 n_remap,
+				 *indice;
+	
+	int *remap;
+	
+	float acmr[ 2 ],
+		  atvr[ 2 ];
+	
+	if( !vertex_cache_size ) vertex_cache_size = OBJ_VERTEX_CACHE_SIZE;
+	
+	else if( vertex_cache_size < 4 ) vertex_cache_size = 4;
+
+	while( i != md5->n_mesh )
+	{
+		MD5MESH *md5mesh = &md5->md5mesh[ i ];
+		
+		MD5VERTEX *md5vertex;
+		
+		if( md5mesh->mode != GL_TRIANGLES || !md5mesh->n_vertex ) { ++i; continue; }
+		
+		indice = ( unsigned int * ) malloc( md5mesh->n_indice * sizeof( unsigned int ) );
+		
+		j = 0;
+		while( j != md5mesh->n_indice )
+		{
+			indice[ j ] = md5mesh->indice[ j ];
+			++j;
+		}
+		
+		OBJ_get_vertex_cache_ratio( indice,
+									md5mesh->n_indice,
+									md5mesh->n_vertex,
+									vertex_cache_size,
+									&acmr[ 0 ],
+									&atvr[ 0 ] );
+
+		OBJ_optimize_vertex_cache( indice,
+								   md5mesh->n_indice,
+								   md5mesh->n_vertex,
+								   vertex_cache_size );
+
+		OBJ_get_vertex_cache_ratio( indice,
+									md5mesh->n_indice,
+									md5mesh->n_vertex,
+									vertex_cache_size,
+									&acmr[ 1 ],
+									&atvr[ 1 ] );
+
+		console_print( "%s[ %d ]: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+					   md5->name,
+					   i,
+					   acmr[ 0 ], acmr[ 1 ],
+					   atvr[ 0 ], atvr[ 1 ] );
+		
+		remap = ( int * ) malloc( md5mesh->n_vertex * sizeof( int ) );
+
+		memset( remap, -1, md5mesh->n_vertex * sizeof( int ) );
+		
+		n_remap = OBJ_optimize_vertex_fetch( remap, 0, indice, md5mesh->n_indice );
+		
+		j = 0;
+		while( j != md5mesh->n_vertex )
+		{
+			if( remap[ j ] == -1 )
+			{
+				remap[ j ] = n_remap;
+				++n_remap;
+			}
+			
+			++j;
+		}
+		
+		md5vertex = ( MD5VERTEX * ) malloc( md5mesh->n_vertex * sizeof( MD5VERTEX ) );
+		
+		j = 0;
+		while( j != md5mesh->n_vertex )
+		{
+			memcpy( &md5vertex[ remap[ j ] ], &md5mesh->md5vertex[ j ], sizeof( MD5VERTEX ) );
+			++j;
+		}
+		
+		free( md5mesh->md5vertex );
+		md5mesh->md5vertex = md5vertex;
+		
+		j = 0;
+		while( j != md5mesh->n_indice )
+		{
+			md5mesh->indice[ j ] = indice[ j ];
+			++j;
+		}
+		
+		/* Keep the triangles used by MD5_build_bind_pose_weighted_normals_tangents in sync. */
+		memcpy( md5mesh->md5triangle,
+				md5mesh->indice,
+				md5mesh->n_indice * sizeof( unsigned short ) );
+		
+		free( indice );
+		free( remap );
+	
+		++i;
+	}
+}
+
 
+/*!
+	Function internally used to allocate the vertex data array of an MD5MESH skinned on the CPU
+	and set its offsets.
+	
+	\param[in,out] md5mesh A valid MD5MESH structure pointer.
+*/
+void MD5_build_vertex_data( MD5MESH *md5mesh )
+{
 	md5mesh->size = md5mesh->n_vertex * ( sizeof( vec3 ) +  // Vertex
 										  sizeof( vec3 ) +  // Normals
 										  sizeof( vec2 ) +  // Texcoord0
@@ -768,11 +1012,24 @@ void MD5_build_vbo( MD5 *md5, unsigned int mesh_index )
 		
 	md5mesh->offset[ 3 ] =   md5mesh->offset[ 2 ] +
 						   ( md5mesh->n_vertex * sizeof( vec2 ) );
-						   
+}
+
+
+/*!
+	Build the VBO for a specific MD5MESH index.
+	
+	\param[in,out] md5 A valid MD5 structure pointer.
+	\param[in] mesh_index The MD5MESH index inside the mesh database of the MD5 to build the VBO for.
+*/
+void MD5_build_vbo( MD5 *md5, unsigned int mesh_index )
+{
+	MD5MESH *md5mesh = &md5->md5mesh[ mesh_index ];
+
+	if( !md5mesh->vertex_data ) MD5_build_vertex_data( md5mesh );
 		
 	glGenBuffers( 1, &md5mesh->vbo );
 	
-	glBindBuffer( GL_ARRAY_BUFFER, md5mesh->vbo );
+	GFX_bind_buffer( GL_ARRAY_BUFFER, md5mesh->vbo );
 	
 	glBufferData( GL_ARRAY_BUFFER,
 				  md5mesh->size,
@@ -782,7 +1039,7 @@ void MD5_build_vbo( MD5 *md5, unsigned int mesh_index )
 
 	glGenBuffers( 1, &md5mesh->vbo_indice );
 
-	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, md5mesh->vbo_indice );
+	GFX_bind_buffer( GL_ELEMENT_ARRAY_BUFFER, md5mesh->vbo_indice );
 
 	glBufferData( GL_ELEMENT_ARRAY_BUFFER,
 				  md5mesh->n_indice * sizeof( unsigned short ),
@@ -949,7 +1206,7 @@ void MD5_build_bind_pose_weighted_normals_tangents( MD5 *md5 )
 			{
 				MD5WEIGHT *md5weight = &md5mesh->md5weight[ md5vertex->start + k ];
 				
-				MD5JOINT *md5joint = &md5->bind_pose[ md5weight->joint ];	
+				vec4 *joint_rotation = &md5->bind_pose.rotation[ md5weight->joint ];
 				
 				vec3 normal = { md5vertex->normal.x,
 								md5vertex->normal.y,
@@ -959,10 +1216,10 @@ void MD5_build_bind_pose_weighted_normals_tangents( MD5 *md5 )
 								 md5vertex->tangent.y,
 								 md5vertex->tangent.z };
 				
-				vec4 rotation = { md5joint->rotation.x,
-								  md5joint->rotation.y,
-								  md5joint->rotation.z,
-								  md5joint->rotation.w };
+				vec4 rotation = { joint_rotation->x,
+								  joint_rotation->y,
+								  joint_rotation->z,
+								  joint_rotation->w };
 
 				
 				vec4_conjugate( &rotation, &rotation );
@@ -1005,350 +1262,3188 @@ void MD5_build_bind_pose_weighted_normals_tangents( MD5 *md5 )
 
 		++i;
 	}
+	
+	md5->weighted_normals_tangents = 1;
 }
 
 
 /*!
-	Set all the MD5MESH inside an MD5 to a specific pose specified by an array of joints.
+	Allocate the arrays of an MD5POSE for the number of joints of an MD5. The rotations are
+	not quantized.
 	
-	\param[in,out] md5 A valid MD5 structure pointer.
-	\param[in] pose An array of MD5JOINT where the number of individual joints are the
-	same as the one contained in the MD5 structure.
+	\param[in] md5 A valid MD5 structure pointer to have access to the number of joints the MD5 contains.
+	\param[in,out] md5pose The MD5POSE to initialize.
 */
-void MD5_set_pose( MD5 *md5, MD5JOINT *pose )
+void MD5_init_pose( MD5 *md5, MD5POSE *md5pose )
 {
-	unsigned int i = 0,
-				 j,
-				 k;
-				 
-	while( i != md5->n_mesh )
-	{
-		MD5MESH *md5mesh = &md5->md5mesh[ i ];
-
-		vec3 *vertex_array  = ( vec3 * )md5mesh->vertex_data,
-			 *normal_array  = ( vec3 * )&md5mesh->vertex_data[ md5mesh->offset[ 1 ] ],
-			 *tangent_array = ( vec3 * )&md5mesh->vertex_data[ md5mesh->offset[ 3 ] ];
-			 
-		vec2 *uv_array = ( vec2 * )&md5mesh->vertex_data[ md5mesh->offset[ 2 ] ];
-		
-		memset( vertex_array , 0, md5mesh->offset[ 1 ] );
-		memset( normal_array , 0, md5mesh->offset[ 1 ] );
-		memset( tangent_array, 0, md5mesh->offset[ 1 ] );
-		
+	md5pose->location  = ( vec3 * ) calloc( md5->n_joint, sizeof( vec3 ) );
+	md5pose->rotation  = ( vec4 * ) calloc( md5->n_joint, sizeof( vec4 ) );
+	md5pose->qrotation = NULL;
+}
 
-		j = 0;
-		while( j != md5mesh->n_vertex )
-		{
-			MD5VERTEX *md5vertex = &md5mesh->md5vertex[ j ];
-		
-			k = 0;
-			while( k != md5vertex->count )
-			{
-				vec3 location = { 0.0f, 0.0f, 0.0f },
-					 normal   = { 0.0f, 0.0f, 0.0f },
-					 tangent  = { 0.0f, 0.0f, 0.0f };
-					 
 
-				MD5WEIGHT *md5weight = &md5mesh->md5weight[ md5vertex->start + k ];
-				
-				MD5JOINT *md5joint = &pose[ md5weight->joint ];
+/*!
+	Free the arrays of an MD5POSE previously initialized with MD5_init_pose.
+	
+	\param[in,out] md5pose A valid MD5POSE structure pointer.
+*/
+void MD5_free_pose( MD5POSE *md5pose )
+{
+	if( md5pose->location ) free( md5pose->location );
+	
+	if( md5pose->rotation ) free( md5pose->rotation );
+	
+	if( md5pose->qrotation ) free( md5pose->qrotation );
+	
+	memset( md5pose, 0, sizeof( MD5POSE ) );
+}
 
-				vec3_rotate_vec4( &location,
-								  &md5weight->location,
-								  &md5joint->rotation );
-								  
-				vec3_rotate_vec4( &normal,
-								  &md5weight->normal,
-								  &md5joint->rotation );
 
-				vec3_rotate_vec4( &tangent,
-								  &md5weight->tangent,
-								  &md5joint->rotation );
-								  
-				vertex_array[ j ].x += ( md5joint->location.x + location.x ) * md5weight->bias;
-				vertex_array[ j ].y += ( md5joint->location.y + location.y ) * md5weight->bias;
-				vertex_array[ j ].z += ( md5joint->location.z + location.z ) * md5weight->bias;
-
-				normal_array[ j ].x += normal.x * md5weight->bias;
-				normal_array[ j ].y += normal.y * md5weight->bias;
-				normal_array[ j ].z += normal.z * md5weight->bias;
-
-				tangent_array[ j ].x += tangent.x * md5weight->bias;
-				tangent_array[ j ].y += tangent.y * md5weight->bias;
-				tangent_array[ j ].z += tangent.z * md5weight->bias;
-								
-				++k;
-			}
+/*!
+	Function internally used to quantize a rotation quaternion to 4 signed normalized shorts.
+	
+	\param[in,out] q The 4 shorts that will receive the quantized rotation (XYZW).
+	\param[in] rotation The rotation quaternion.
+*/
+void MD5_encode_rotation( short *q, vec4 *rotation )
+{
+	q[ 0 ] = float_to_snorm( rotation->x, 16 );
+	q[ 1 ] = float_to_snorm( rotation->y, 16 );
+	q[ 2 ] = float_to_snorm( rotation->z, 16 );
+	q[ 3 ] = float_to_snorm( rotation->w, 16 );
+}
 
-			uv_array[ j ].x = md5vertex->uv.x;
-			uv_array[ j ].y = md5vertex->uv.y;
-			
-			++j;
-		}
-		
-		
-		glBindBuffer( GL_ARRAY_BUFFER, md5mesh->vbo );
 
-		glBufferSubData( GL_ARRAY_BUFFER,
-						 0,
-						 md5mesh->size,
-						 md5mesh->vertex_data );
+/*!
+	Function internally used to convert a rotation quantized with MD5_encode_rotation back to float.
+	
+	\param[in,out] rotation The rotation quaternion.
+	\param[in] q The 4 shorts of the quantized rotation (XYZW).
+*/
+void MD5_decode_rotation( vec4 *rotation, short *q )
+{
+	// Inverse of float_to_snorm.
+	rotation->x = ( 2.0f * q[ 0 ] + 1.0f ) * ( 1.0f / 65535.0f );
+	rotation->y = ( 2.0f * q[ 1 ] + 1.0f ) * ( 1.0f / 65535.0f );
+	rotation->z = ( 2.0f * q[ 2 ] + 1.0f ) * ( 1.0f / 65535.0f );
+	rotation->w = ( 2.0f * q[ 3 ] + 1.0f ) * ( 1.0f / 65535.0f );
+}
 
-		++i;
-	}
 
-	glBindBuffer( GL_ARRAY_BUFFER, 0 );
+/*!
+	Get the rotation quaternion of a joint of an MD5POSE. The quantized rotations are
+	converted back to float but not normalized, their length stays very close to 1 and the
+	skinning scales each joint rotation by 1 / | q | anyway.
+	
+	\param[in] md5pose A valid MD5POSE structure pointer.
+	\param[in] joint_index The index of the joint in the skeleton.
+	\param[in,out] rotation The rotation quaternion of the joint.
+*/
+void MD5_get_pose_rotation( MD5POSE *md5pose, unsigned int joint_index, vec4 *rotation )
+{
+	if( md5pose->qrotation ) MD5_decode_rotation( rotation, &md5pose->qrotation[ joint_index << 2 ] );
+	
+	else memcpy( rotation, &md5pose->rotation[ joint_index ], sizeof( vec4 ) );
 }
 
 
 /*!
-	Blender two skeleton pose togheter and assign it to the final pose parameter.
+	Copy a pose to another one. If the source pose is quantized its rotations are converted
+	back to float.
 	
 	\param[in] md5 A valid MD5 structure pointer to have access to the number of joints the MD5 contains.
-	\param[in,out] final_pose The final pose MD5JOINT array that will store the result of the blending operation between pose0 and pose1.
-	\param[in] pose0 The first pose to use for the blending operation.
-	\param[in] pose1 The second pose to use for the blending operation.
-	\param[in] joint_interpolation_method The method to use to interpolate the rotation, for location lerp will always be used.
-	\param[in] blend The blending factor (a value between 0 and 1).
+	\param[in,out] dst The destination MD5POSE, its rotations must not be quantized.
+	\param[in] src The source MD5POSE.
 */
-void MD5_blend_pose( MD5 *md5, MD5JOINT *final_pose, MD5JOINT *pose0, MD5JOINT *pose1, unsigned char joint_interpolation_method, float blend )
+void MD5_copy_pose( MD5 *md5, MD5POSE *dst, MD5POSE *src )
 {
 	unsigned int i = 0;
-
-	while( i != md5->n_joint )
-	{
-		vec3_lerp( &final_pose[ i ].location,
-				   &pose0[ i ].location,
-				   &pose1[ i ].location,
-				   blend );
 	
-		switch( joint_interpolation_method )
+	memcpy( dst->location, src->location, md5->n_joint * sizeof( vec3 ) );
+	
+	if( !src->qrotation ) memcpy( dst->rotation, src->rotation, md5->n_joint * sizeof( vec4 ) );
+	
+	else
+	{
+		while( i != md5->n_joint )
 		{
-			case MD5_METHOD_FRAME:
-			case MD5_METHOD_LERP:
-			{
-				vec4_lerp( &final_pose[ i ].rotation, 
-						   &pose0[ i ].rotation,
-						   &pose1[ i ].rotation,
-						   blend );
-				break;
-			}
+			MD5_get_pose_rotation( src, i, &dst->rotation[ i ] );
+			++i;
+		}
+	}
+}
+
+
+/*!
+	Quantize the rotations of all the frames of an MD5ACTION to 4 signed normalized shorts, which
+	reduce the size of each frame from 28 to 20 bytes per joint. The rotations lose about 5 digits
+	of precision and are converted back to float when the frames are blended.
+	
+	\param[in] md5 A valid MD5 structure pointer to have access to the number of joints the MD5 contains.
+	\param[in,out] md5action A valid MD5ACTION structure pointer.
+*/
+void MD5_quantize_action( MD5 *md5, MD5ACTION *md5action )
+{
+	unsigned int i = 0,
+				 n = md5action->n_frame * md5->n_joint;
+	
+	short *qrotation;
+	
+	vec4 *rotation;
+	
+	if( !md5action->frame || md5action->frame[ 0 ].qrotation ) return;
+	
+	qrotation = ( short * ) malloc( n * 4 * sizeof( short ) );
+	
+	rotation = md5action->frame[ 0 ].rotation;
+	
+	while( i != n )
+	{
+		MD5_encode_rotation( &qrotation[ i << 2 ], &rotation[ i ] );
+		++i;
+	}
+	
+	free( rotation );
+	
+	i = 0;
+	while( i != md5action->n_frame )
+	{
+		md5action->frame[ i ].rotation  = NULL;
+		md5action->frame[ i ].qrotation = &qrotation[ i * md5->n_joint * 4 ];
+		++i;
+	}
+}
+
+
+/*!
+	Function internally used to measure the angle in radians between two rotation quaternions.
+	
+	\param[in] q0 The first quaternion.
+	\param[in] q1 The second quaternion.
+	
+	\return Return the angle between the two rotations.
+*/
+float MD5_get_rotation_error( vec4 *q0, vec4 *q1 )
+{
+	vec4 n0,
+		 n1;
+	
+	vec4_normalize( &n0, q0 );
+	vec4_normalize( &n1, q1 );
+	
+	if( vec4_dot_vec4( &n0, &n1 ) < 0.0f )
+	{
+		n1.x = -n1.x;
+		n1.y = -n1.y;
+		n1.z = -n1.z;
+		n1.w = -n1.w;
+	}
+	
+	n0.x -= n1.x;
+	n0.y -= n1.y;
+	n0.z -= n1.z;
+	n0.w -= n1.w;
+	
+	// The half chord between the two unit quaternions, acosf of their dot product is not accurate
+	// enough for small angles.
+	return 4.0f * asinf( fminf( vec4_length( &n0 ) * 0.5f, 1.0f ) );
+}
+
+
+/*!
+	Function internally used to interpolate two rotation keys. The keys are close to each other so
+	a normalized linear interpolation is used, which is much cheaper than vec4_lerp.
+	
+	\param[in,out] dst The interpolated rotation quaternion.
+	\param[in] q0 The first rotation quaternion.
+	\param[in] q1 The second rotation quaternion.
+	\param[in] t The interpolation factor (a value between 0 and 1).
+*/
+void MD5_interpolate_rotation( vec4 *dst, vec4 *q0, vec4 *q1, float t )
+{
+	float k0 = 1.0f - t,
+		  k1 = vec4_dot_vec4( q0, q1 ) < 0.0f ? -t : t,
+		  l;
+	
+	dst->x = ( k0 * q0->x ) + ( k1 * q1->x );
+	dst->y = ( k0 * q0->y ) + ( k1 * q1->y );
+	dst->z = ( k0 * q0->z ) + ( k1 * q1->z );
+	dst->w = ( k0 * q0->w ) + ( k1 * q1->w );
+	
+	l = vec4_length( dst );
+	
+	if( l )
+	{
+		l = 1.0f / l;
+		
+		dst->x *= l;
+		dst->y *= l;
+		dst->z *= l;
+		dst->w *= l;
+	}
+}
+
+
+/*!
+	Function internally used to quantize a joint location to 3 signed normalized shorts inside the
+	location range of an MD5TRACK.
+	
+	\param[in] md5track A valid MD5TRACK structure pointer.
+	\param[in,out] q The 3 shorts that will receive the quantized location.
+	\param[in] location The joint location.
+*/
+void MD5_encode_location( MD5TRACK *md5track, short *q, vec3 *location )
+{
+	q[ 0 ] = md5track->location_scale.x ? float_to_snorm( ( location->x - md5track->location_offset.x ) / md5track->location_scale.x, 16 ) : 0;
+	q[ 1 ] = md5track->location_scale.y ? float_to_snorm( ( location->y - md5track->location_offset.y ) / md5track->location_scale.y, 16 ) : 0;
+	q[ 2 ] = md5track->location_scale.z ? float_to_snorm( ( location->z - md5track->location_offset.z ) / md5track->location_scale.z, 16 ) : 0;
+}
+
+
+/*!
+	Function internally used to convert a location quantized with MD5_encode_location back to float.
+	
+	\param[in] md5track A valid MD5TRACK structure pointer.
+	\param[in,out] location The joint location.
+	\param[in] q The 3 shorts of the quantized location.
+*/
+void MD5_decode_location( MD5TRACK *md5track, vec3 *location, short *q )
+{
+	location->x = md5track->location_offset.x + md5track->location_scale.x * ( 2.0f * q[ 0 ] + 1.0f ) * ( 1.0f / 65535.0f );
+	location->y = md5track->location_offset.y + md5track->location_scale.y * ( 2.0f * q[ 1 ] + 1.0f ) * ( 1.0f / 65535.0f );
+	location->z = md5track->location_offset.z + md5track->location_scale.z * ( 2.0f * q[ 2 ] + 1.0f ) * ( 1.0f / 65535.0f );
+}
+
+
+/*!
+	Function internally used to find the key of a track to use for a specific frame.
+	
+	\param[in] key_frame The frame index of each key.
+	\param[in] n_key The number of keys.
+	\param[in] frame The frame index.
+	
+	\return Return the index of the last key that is not after the frame.
+*/
+unsigned int MD5_find_key( unsigned short *key_frame, unsigned int n_key, unsigned int frame )
+{
+	unsigned int k = 0,
+				 l = n_key - 1;
+	
+	while( k != l )
+	{
+		unsigned int m = ( k + l + 1 ) >> 1;
 		
+		if( key_frame[ m ] <= frame ) k = m;
 		
-			case MD5_METHOD_SLERP:
-			{
-				vec4_slerp( &final_pose[ i ].rotation, 
-							&pose0[ i ].rotation,
-							&pose1[ i ].rotation,
-							blend );
+		else l = m - 1;
+	}
+	
+	return k;
+}
 
-				break;
-			}
-		}
+
+/*!
+	Function internally used to evaluate the location of an MD5TRACK at a specific frame.
+	
+	\param[in] md5track A valid MD5TRACK structure pointer.
+	\param[in] frame The frame index, can be in between two frames.
+	\param[in,out] location The joint location, relative to its parent, at this frame.
+*/
+void MD5_sample_track_location( MD5TRACK *md5track, float frame, vec3 *location )
+{
+	unsigned int k;
+	
+	if( md5track->n_location == 1 )
+	{
+		memcpy( location, &md5track->location_offset, sizeof( vec3 ) );
+		return;
+	}
+	
+	k = MD5_find_key( md5track->location_frame, md5track->n_location, ( unsigned int )frame );
+	
+	if( md5track->location_frame[ k ] == frame || k == md5track->n_location - 1 ) MD5_decode_location( md5track, location, &md5track->qlocation[ k * 3 ] );
+	
+	else
+	{
+		vec3 v0,
+			 v1;
+		
+		MD5_decode_location( md5track, &v0, &md5track->qlocation[   k		* 3 ] );
+		MD5_decode_location( md5track, &v1, &md5track->qlocation[ ( k + 1 ) * 3 ] );
+		
+		vec3_lerp( location,
+				   &v0,
+				   &v1,
+				   ( frame - md5track->location_frame[ k ] ) /
+				   ( float )( md5track->location_frame[ k + 1 ] - md5track->location_frame[ k ] ) );
+	}
+}
 
 
-		++i;
+/*!
+	Function internally used to evaluate the rotation of an MD5TRACK at a specific frame.
+	
+	\param[in] md5track A valid MD5TRACK structure pointer.
+	\param[in] frame The frame index, can be in between two frames.
+	\param[in,out] rotation The joint rotation quaternion, relative to its parent, at this frame.
+*/
+void MD5_sample_track_rotation( MD5TRACK *md5track, float frame, vec4 *rotation )
+{
+	unsigned int k = md5track->n_rotation == 1 ? 0 : MD5_find_key( md5track->rotation_frame, md5track->n_rotation, ( unsigned int )frame );
+	
+	if( md5track->rotation_frame[ k ] == frame || k == md5track->n_rotation - 1 ) MD5_decode_rotation( rotation, &md5track->qrotation[ k << 2 ] );
+	
+	else
+	{
+		vec4 q0,
+			 q1;
+		
+		MD5_decode_rotation( &q0, &md5track->qrotation[   k		<< 2 ] );
+		MD5_decode_rotation( &q1, &md5track->qrotation[ ( k + 1 ) << 2 ] );
+		
+		MD5_interpolate_rotation( rotation,
+								  &q0,
+								  &q1,
+								  ( frame - md5track->rotation_frame[ k ] ) /
+								  ( float )( md5track->rotation_frame[ k + 1 ] - md5track->rotation_frame[ k ] ) );
 	}
 }
 
 
 /*!
-	Add two action together. Please take note that the additive blending of each bone is evaluated on if the
-	current action1 frame is different than the next frame. If yes it means that the action1 is taking over
-	the control of the bone and will be blended by the action weight factor.
+	Function internally used to sample all the tracks of a compressed MD5ACTION at a specific
+	frame and convert the result to object space.
 	
-	\param[in] md5 A valid MD5 structure pointer to gain access to the maximum number of MD5JOINTS each actions contains.
-	\param[in,out] final_pose Array of MD5JOINTs to use as the destination. The resulting skeleton of the operation executed in this function will use this array as destination.
-	\param[in] action0 A valid MD5ACTION pointer that will be use as the base action to use.
-	\param[in] action1 A valid MD5ACTION pointer that will be use as the second action that will additively be blended to action0.
-	\param[in] joint_interpolation_method The method to use to interpolate the action weight between action0 and action1.
-	\param[in] action_weight The weight factor of the action1 if the bone is animated. This value will have impact on the blending between action0 and action1.
+	\param[in] md5 A valid MD5 structure pointer to have access to the skeleton.
+	\param[in] md5action A valid MD5ACTION structure pointer that is compressed.
+	\param[in] frame The frame index, can be in between two frames.
+	\param[in,out] pose The MD5POSE that will receive the result, its rotations must not be quantized.
 */
-void MD5_add_pose( MD5 *md5, MD5JOINT *final_pose, MD5ACTION *action0, MD5ACTION *action1, unsigned char joint_interpolation_method, float action_weight )
+void MD5_sample_tracks( MD5 *md5, MD5ACTION *md5action, float frame, MD5POSE *pose )
 {
 	unsigned int i = 0;
 	
 	while( i != md5->n_joint )
 	{
-		if( memcmp( &action1->frame[ action1->curr_frame ][ i ].location, &action1->frame[ action1->next_frame ][ i ].location, sizeof( vec3 ) ) ||
-			memcmp( &action1->frame[ action1->curr_frame ][ i ].rotation, &action1->frame[ action1->next_frame ][ i ].rotation, sizeof( vec4 ) ) )
+		MD5_sample_track_location( &md5action->md5track[ i ], frame, &pose->location[ i ] );
+		
+		MD5_sample_track_rotation( &md5action->md5track[ i ], frame, &pose->rotation[ i ] );
+		
+		MD5_build_object_space_joint( md5, pose, i );
+		
+		++i;
+	}
+}
+
+
+/*!
+	Function internally used by MD5_compress_action to select the keys of a track. Each key is
+	extended as far as the frames in between can be interpolated from the key to the next one
+	within the tolerance. The error is measured using the quantized keys, so it includes the
+	quantization error.
+	
+	\param[in] location The joint location of each frame, relative to its parent.
+	\param[in] rotation The joint rotation of each frame, relative to its parent.
+	\param[in] n_frame The number of frames.
+	\param[in] location_tolerance The maximum distance between an interpolated and an original location.
+	\param[in] rotation_tolerance The maximum angle between an interpolated and an original rotation.
+	\param[in,out] key An array of n_frame unsigned short used as temporary storage.
+	\param[in,out] quantized An array of n_frame vec4 used as temporary storage.
+	\param[in,out] md5track The MD5TRACK to build, its previous keys are freed.
+*/
+void MD5_build_track( vec3			 *location,
+					  vec4			 *rotation,
+					  unsigned int	 n_frame,
+					  float			 location_tolerance,
+					  float			 rotation_tolerance,
+					  unsigned short *key,
+					  vec4			 *quantized,
+					  MD5TRACK		 *md5track )
+{
+	unsigned int i,
+				 j,
+				 e,
+				 last = n_frame - 1;
+	
+	vec3 min = { location[ 0 ].x, location[ 0 ].y, location[ 0 ].z },
+		 max = { location[ 0 ].x, location[ 0 ].y, location[ 0 ].z };
+	
+	short q[ 4 ];
+	
+	if( md5track->location_frame ) free( md5track->location_frame );
+	if( md5track->qlocation		 ) free( md5track->qlocation	  );
+	if( md5track->rotation_frame ) free( md5track->rotation_frame );
+	if( md5track->qrotation		 ) free( md5track->qrotation	  );
+	
+	memset( md5track, 0, sizeof( MD5TRACK ) );
+	
+	
+	// Location keys, with a constant track when possible.
+	i = 0;
+	while( i != n_frame )
+	{
+		if( vec3_dist( &location[ 0 ], &location[ i ] ) > location_tolerance ) break;
+		++i;
+	}
+	
+	if( i == n_frame )
+	{
+		md5track->n_location = 1;
+		
+		memcpy( &md5track->location_offset, &location[ 0 ], sizeof( vec3 ) );
+	}
+	else
+	{
+		i = 1;
+		while( i != n_frame )
 		{
-			vec3_lerp( &final_pose[ i ].location,
-					   &action0->pose[ i ].location,
-					   &action1->pose[ i ].location,
-					   action_weight );
+			min.x = fminf( min.x, location[ i ].x ); max.x = fmaxf( max.x, location[ i ].x );
+			min.y = fminf( min.y, location[ i ].y ); max.y = fmaxf( max.y, location[ i ].y );
+			min.z = fminf( min.z, location[ i ].z ); max.z = fmaxf( max.z, location[ i ].z );
+			++i;
+		}
+		
+		md5track->location_offset.x = ( min.x + max.x ) * 0.5f;
+		md5track->location_offset.y = ( min.y + max.y ) * 0.5f;
+		md5track->location_offset.z = ( min.z + max.z ) * 0.5f;
+		
+		md5track->location_scale.x = ( max.x - min.x ) * 0.5f;
+		md5track->location_scale.y = ( max.y - min.y ) * 0.5f;
+		md5track->location_scale.z = ( max.z - min.z ) * 0.5f;
+		
+		// The locations as they will be decoded from a key.
+		i = 0;
+		while( i != n_frame )
+		{
+			MD5_encode_location( md5track, q, &location[ i ] );
 			
-			switch( joint_interpolation_method )
+			MD5_decode_location( md5track, ( vec3 * )&quantized[ i ], q );
+			++i;
+		}
+		
+		key[ 0 ] = 0;
+		md5track->n_location = 1;
+		
+		i = 0;
+		while( i != last )
+		{
+			e = i + 1;
+			
+			while( e != last )
 			{
-				case MD5_METHOD_FRAME:
-				case MD5_METHOD_LERP:
+				j = i + 1;
+				while( j != e + 1 )
 				{
-					vec4_lerp( &final_pose[ i ].rotation, 
-							   &action0->pose[ i ].rotation,
-							   &action1->pose[ i ].rotation,
-							   action_weight );
-					break;
+					vec3 v;
+					
+					vec3_lerp( &v, ( vec3 * )&quantized[ i ], ( vec3 * )&quantized[ e + 1 ], ( float )( j - i ) / ( float )( e + 1 - i ) );
+					
+					if( vec3_dist( &v, &location[ j ] ) > location_tolerance ) break;
+					
+					++j;
 				}
+				
+				if( j != e + 1 ) break;
+				
+				++e;
+			}
 			
+			key[ md5track->n_location ] = e;
+			++md5track->n_location;
 			
-				case MD5_METHOD_SLERP:
+			i = e;
+		}
+		
+		md5track->location_frame = ( unsigned short * ) malloc( md5track->n_location * sizeof( unsigned short ) );
+		
+		md5track->qlocation = ( short * ) malloc( md5track->n_location * 3 * sizeof( short ) );
+		
+		i = 0;
+		while( i != md5track->n_location )
+		{
+			md5track->location_frame[ i ] = key[ i ];
+			
+			MD5_encode_location( md5track, &md5track->qlocation[ i * 3 ], &location[ key[ i ] ] );
+			++i;
+		}
+	}
+	
+	
+	// Rotation keys.
+	i = 0;
+	while( i != n_frame )
+	{
+		MD5_encode_rotation( q, &rotation[ i ] );
+		
+		MD5_decode_rotation( &quantized[ i ], q );
+		++i;
+	}
+	
+	key[ 0 ] = 0;
+	md5track->n_rotation = 1;
+	
+	i = 0;
+	while( i != n_frame )
+	{
+		if( MD5_get_rotation_error( &quantized[ 0 ], &rotation[ i ] ) > rotation_tolerance ) break;
+		++i;
+	}
+	
+	if( i != n_frame )
+	{
+		i = 0;
+		while( i != last )
+		{
+			e = i + 1;
+			
+			while( e != last )
+			{
+				j = i + 1;
+				while( j != e + 1 )
 				{
-					vec4_slerp( &final_pose[ i ].rotation, 
-								&action0->pose[ i ].rotation,
-								&action1->pose[ i ].rotation,
-								action_weight );
-					break;
+					vec4 v;
+					
+					MD5_interpolate_rotation( &v, &quantized[ i ], &quantized[ e + 1 ], ( float )( j - i ) / ( float )( e + 1 - i ) );
+					
+					if( MD5_get_rotation_error( &v, &rotation[ j ] ) > rotation_tolerance ) break;
+					
+					++j;
 				}
+				
+				if( j != e + 1 ) break;
+				
+				++e;
+			}
+			
+			key[ md5track->n_rotation ] = e;
+			++md5track->n_rotation;
+			
+			i = e;
+		}
+	}
+	
+	md5track->rotation_frame = ( unsigned short * ) malloc( md5track->n_rotation * sizeof( unsigned short ) );
+	
+	md5track->qrotation = ( short * ) malloc( md5track->n_rotation * 4 * sizeof( short ) );
+	
+	i = 0;
+	while( i != md5track->n_rotation )
+	{
+		md5track->rotation_frame[ i ] = key[ i ];
+		
+		MD5_encode_rotation( &md5track->qrotation[ i << 2 ], &rotation[ key[ i ] ] );
+		++i;
+	}
+}
+
+
+/*!
+	Compress the frames of an MD5ACTION to one MD5TRACK per joint. The tracks store the joints
+	relative to their parent, so a joint that does not move relative to its parent more than the
+	tolerance is stored as a single key, and the other ones only keep the keys that are needed
+	to interpolate the original frames. The keys are quantized. The object space error of every
+	frame is then verified against the original frames, and the tracks of the joints (and their
+	parents) that are out of tolerance are rebuilt using a tighter tolerance.
+	
+	Once compressed the frames of the action are freed, and the action have to be sampled using
+	MD5_sample_action (which is what MD5_draw_action does). In between two frames the joints are
+	interpolated relative to their parent, which can slightly differ from blending the original
+	object space frames.
+	
+	\param[in] md5 A valid MD5 structure pointer to have access to the skeleton.
+	\param[in,out] md5action A valid MD5ACTION structure pointer.
+	\param[in] location_tolerance The maximum distance between a decompressed and an original joint
+	location in object space (should be above the quantization error of the rotations multiplied by
+	the distance of the joint from the root, else the tolerance cannot always be reached).
+	\param[in] rotation_tolerance The maximum angle in radians between a decompressed and an original
+	joint rotation in object space (should be above 0.0001, the quantization error).
+	
+	\note A compressed action cannot be saved using MD5_save_action_bin, compress the action after
+	loading it instead.
+*/
+void MD5_compress_action( MD5 *md5, MD5ACTION *md5action, float location_tolerance, float rotation_tolerance )
+{
+	unsigned int i,
+				 j,
+				 n_pass = 0,
+				 n_frame = md5action->n_frame;
+	
+	unsigned short *key;
+	
+	unsigned char *rebuild;
+	
+	float *tolerance;
+	
+	vec3 *location;
+	
+	vec4 *rotation,
+		 *quantized;
+	
+	MD5POSE md5pose;
+	
+	if( !md5action->frame || n_frame > 65536 ) return;
+	
+	key = ( unsigned short * ) malloc( n_frame * sizeof( unsigned short ) );
+	
+	quantized = ( vec4 * ) malloc( n_frame * sizeof( vec4 ) );
+	
+	// The tracks of each joint, relative to its parent.
+	location = ( vec3 * ) malloc( md5->n_joint * n_frame * sizeof( vec3 ) );
+	
+	rotation = ( vec4 * ) malloc( md5->n_joint * n_frame * sizeof( vec4 ) );
+	
+	i = 0;
+	while( i != n_frame )
+	{
+		MD5POSE *frame = &md5action->frame[ i ];
+		
+		j = 0;
+		while( j != md5->n_joint )
+		{
+			int parent = md5->md5joint[ j ].parent;
+			
+			vec3 *l = &location[ j * n_frame + i ];
+			
+			vec4 *r = &rotation[ j * n_frame + i ],
+				 p;
+			
+			MD5_get_pose_rotation( frame, j, r );
+			
+			memcpy( l, &frame->location[ j ], sizeof( vec3 ) );
+			
+			if( parent > -1 )
+			{
+				vec4 q;
+				
+				vec3 v;
+				
+				MD5_get_pose_rotation( frame, parent, &p );
+				
+				vec4_conjugate( &p, &p );
+				
+				vec3_diff( &v, l, &frame->location[ parent ] );
+				
+				vec3_rotate_vec4( l, &v, &p );
+				
+				vec4_multiply_vec4( &q, &p, r );
+				
+				vec4_normalize( r, &q );
+			}
+			
+			++j;
+		}
+		
+		++i;
+	}
+	
+	
+	md5action->md5track = ( MD5TRACK * ) calloc( md5->n_joint, sizeof( MD5TRACK ) );
+	
+	rebuild = ( unsigned char * ) malloc( md5->n_joint );
+	
+	memset( rebuild, 3, md5->n_joint );
+	
+	tolerance = ( float * ) malloc( md5->n_joint * 2 * sizeof( float ) );
+	
+	// A rotation error moves the children joints proportionally to their distance, so the initial
+	// rotation tolerance of a joint also depends on the distance of its furthest child.
+	i = 0;
+	while( i != md5->n_joint )
+	{
+		tolerance[ ( i << 1 )	  ] = location_tolerance;
+		tolerance[ ( i << 1 ) + 1 ] = 0.0f;
+		++i;
+	}
+	
+	i = 0;
+	while( i != md5->n_joint )
+	{
+		int k = md5->md5joint[ i ].parent;
+		
+		while( k > -1 )
+		{
+			tolerance[ ( k << 1 ) + 1 ] = fmaxf( tolerance[ ( k << 1 ) + 1 ],
+												 vec3_dist( &md5->bind_pose.location[ i ], &md5->bind_pose.location[ k ] ) );
+			
+			k = md5->md5joint[ k ].parent;
+		}
+		
+		++i;
+	}
+	
+	i = 0;
+	while( i != md5->n_joint )
+	{
+		float d = tolerance[ ( i << 1 ) + 1 ];
+		
+		tolerance[ ( i << 1 ) + 1 ] = d ? fminf( rotation_tolerance, location_tolerance / d ) : rotation_tolerance;
+		++i;
+	}
+	
+	MD5_init_pose( md5, &md5pose );
+	
+	while( n_pass != 16 )
+	{
+		unsigned char done = 1;
+		
+		i = 0;
+		while( i != md5->n_joint )
+		{
+			if( rebuild[ i ] )
+			{
+				MD5_build_track( &location[ i * n_frame ],
+								 &rotation[ i * n_frame ],
+								 n_frame,
+								 tolerance[ ( i << 1 )	   ],
+								 tolerance[ ( i << 1 ) + 1 ],
+								 key,
+								 quantized,
+								 &md5action->md5track[ i ] );
+				rebuild[ i ] = 0;
+			}
+			++i;
+		}
+		
+		// Tighten the tolerances of the joints that are out of tolerance in object space, and of their
+		// parents (bit 0 of rebuild for the location, bit 1 for the rotation).
+		i = 0;
+		while( i != n_frame )
+		{
+			MD5_sample_tracks( md5, md5action, ( float )i, &md5pose );
+			
+			j = 0;
+			while( j != md5->n_joint )
+			{
+				vec4 r;
+				
+				int k = j;
+				
+				MD5_get_pose_rotation( &md5action->frame[ i ], j, &r );
+				
+				// A location error can come from the location of the joint and of its parents or from
+				// the rotation of its parents, a rotation error only from the rotations.
+				if( vec3_dist( &md5pose.location[ j ], &md5action->frame[ i ].location[ j ] ) > location_tolerance )
+				{
+					if( !( rebuild[ k ] & 1 ) ) tolerance[ k << 1 ] *= 0.5f;
+					
+					rebuild[ k ] |= 1;
+					
+					k = md5->md5joint[ k ].parent;
+					
+					while( k > -1 )
+					{
+						if( !( rebuild[ k ] & 1 ) ) tolerance[ ( k << 1 )	 ] *= 0.5f;
+						if( !( rebuild[ k ] & 2 ) ) tolerance[ ( k << 1 ) + 1 ] *= 0.5f;
+						
+						rebuild[ k ] = 3;
+						
+						k = md5->md5joint[ k ].parent;
+					}
+					
+					done = 0;
+				}
+				
+				else if( MD5_get_rotation_error( &md5pose.rotation[ j ], &r ) > rotation_tolerance )
+				{
+					while( k > -1 )
+					{
+						if( !( rebuild[ k ] & 2 ) ) tolerance[ ( k << 1 ) + 1 ] *= 0.5f;
+						
+						rebuild[ k ] |= 2;
+						
+						k = md5->md5joint[ k ].parent;
+					}
+					
+					done = 0;
+				}
+				
+				++j;
+			}
+			
+			++i;
+		}
+		
+		if( done ) break;
+		
+		++n_pass;
+	}
+	
+	MD5_free_pose( &md5pose );
+	
+	free( tolerance );
+	
+	free( rebuild );
+	
+	free( rotation );
+	
+	free( location );
+	
+	free( quantized );
+	
+	free( key );
+	
+	MD5_free_pose( &md5action->frame[ 0 ] );
+	
+	free( md5action->frame );
+	
+	md5action->frame = NULL;
+}
+
+
+/*!
+	Sample the current pose of an MD5ACTION, by blending its current frame with its next frame.
+	The action can be compressed or not. \sa MD5_compress_action
+	
+	\param[in] md5 A valid MD5 structure pointer to have access to the number of joints the MD5 contains.
+	\param[in] md5action A valid MD5ACTION structure pointer.
+	\param[in,out] pose The MD5POSE that will receive the result, its rotations must not be quantized.
+	\param[in] blend The blending factor between the current and the next frame (a value between 0 and 1),
+	the joint rotations are blended using the MD5ACTION method. The tracks of a compressed action are
+	directly sampled in between the two frames, except when looping back to the first frame.
+*/
+void MD5_sample_action( MD5 *md5, MD5ACTION *md5action, MD5POSE *pose, float blend )
+{
+	unsigned int i = 0;
+	
+	if( !md5action->md5track )
+	{
+		if( blend )
+		{
+			MD5_blend_pose( md5,
+							pose,
+							&md5action->frame[ md5action->curr_frame ],
+							&md5action->frame[ md5action->next_frame ],
+							md5action->method,
+							blend );
+		}
+		else MD5_copy_pose( md5, pose, &md5action->frame[ md5action->curr_frame ] );
+		
+		return;
+	}
+	
+	if( !blend || md5action->next_frame == md5action->curr_frame + 1 )
+	{
+		MD5_sample_tracks( md5, md5action, md5action->curr_frame + blend, pose );
+		return;
+	}
+	
+	// Blend the joints relative to their parent between the last and the first frame.
+	while( i != md5->n_joint )
+	{
+		MD5TRACK *md5track = &md5action->md5track[ i ];
+		
+		vec3 location;
+		
+		vec4 rotation0,
+			 rotation1;
+		
+		MD5_sample_track_location( md5track, md5action->curr_frame, &pose->location[ i ] );
+		
+		MD5_sample_track_location( md5track, md5action->next_frame, &location );
+		
+		vec3_lerp( &pose->location[ i ], &pose->location[ i ], &location, blend );
+		
+		MD5_sample_track_rotation( md5track, md5action->curr_frame, &rotation0 );
+		
+		MD5_sample_track_rotation( md5track, md5action->next_frame, &rotation1 );
+		
+		if( md5action->method == MD5_METHOD_SLERP ) vec4_slerp( &pose->rotation[ i ], &rotation0, &rotation1, blend );
+		
+		else vec4_lerp( &pose->rotation[ i ], &rotation0, &rotation1, blend );
+		
+		MD5_build_object_space_joint( md5, pose, i );
+		
+		++i;
+	}
+}
+
+
+/*!
+	Function internally used to convert a pose to an array of joint matrices. The upper 3x3 of
+	each matrix holds the joint rotation (with the same 1 / | q | scaling as vec3_rotate_vec4) and
+	the last column the joint location, the w row is unused.
+	
+	\param[in] md5 A valid MD5 structure pointer to have access to the number of joints the MD5 contains.
+	\param[in] pose A valid MD5POSE structure pointer.
+	\param[in,out] joint_matrix The array of mat4 that will receive the joint matrices.
+*/
+void MD5_build_joint_matrices( MD5 *md5, MD5POSE *pose, mat4 *joint_matrix )
+{
+	unsigned int i = 0;
+	
+	vec4 rotation;
+	
+	while( i != md5->n_joint )
+	{
+		vec4 *q = &rotation;
+		
+		if( pose->qrotation ) MD5_get_pose_rotation( pose, i, q );
+		
+		else q = &pose->rotation[ i ];
+		
+		mat4 *m = &joint_matrix[ i ];
+		
+		float uu = ( q->x * q->x ) + ( q->y * q->y ) + ( q->z * q->z ),
+			  l  = sqrtf( uu + ( q->w * q->w ) ),
+			  s  = l ? 1.0f / l : 0.0f,
+			  d  = ( ( q->w * q->w ) - uu ) * s,
+			  x2 = 2.0f * q->x * s,
+			  y2 = 2.0f * q->y * s,
+			  z2 = 2.0f * q->z * s,
+			  xx = q->x * x2,
+			  yy = q->y * y2,
+			  zz = q->z * z2,
+			  xy = q->x * y2,
+			  xz = q->x * z2,
+			  yz = q->y * z2,
+			  wx = q->w * x2,
+			  wy = q->w * y2,
+			  wz = q->w * z2;
+		
+		m->m[ 0 ].x = d + xx;
+		m->m[ 0 ].y = xy + wz;
+		m->m[ 0 ].z = xz - wy;
+		m->m[ 0 ].w = 0.0f;
+
+		m->m[ 1 ].x = xy - wz;
+		m->m[ 1 ].y = d + yy;
+		m->m[ 1 ].z = yz + wx;
+		m->m[ 1 ].w = 0.0f;
+		
+		m->m[ 2 ].x = xz + wy;
+		m->m[ 2 ].y = yz - wx;
+		m->m[ 2 ].z = d + zz;
+		m->m[ 2 ].w = 0.0f;
+
+		m->m[ 3 ].x = pose->location[ i ].x;
+		m->m[ 3 ].y = pose->location[ i ].y;
+		m->m[ 3 ].z = pose->location[ i ].z;
+		m->m[ 3 ].w = 1.0f;
+		
+		++i;
+	}
+}
+
+
+//! Internal structure used to share the skinning of an MD5MESH between threads.
+typedef struct
+{
+	//! The MD5MESH to skin.
+	MD5MESH			*md5mesh;
+	
+	//! The joint matrices of the pose. \sa MD5_build_joint_matrices
+	mat4			*joint_matrix;
+	
+	//! The maximum number of weights per vertex (0 to use all the weights). \sa MD5LOD
+	unsigned int	max_weight;
+	
+	//! Determine if the tangents are skinned.
+	unsigned char	tangent;
+
+} MD5SKINTASK;
+
+
+/*!
+	Function internally used as THREAD_dispatch callback to skin a contiguous range of vertices
+	of an MD5MESH. Each weight is transformed by the matrix of its joint pre-multiplied by the
+	weight bias, and the vertex positions, normals and tangents are written directly inside
+	the MD5MESH vertex data array.
+	
+	\param[in,out] userdata The MD5SKINTASK.
+	\param[in] index The worker index.
+	\param[in] n_thread The number of workers.
+*/
+void MD5_skin_vertices( void *userdata, unsigned int index, unsigned int n_thread )
+{
+	MD5SKINTASK *md5skintask = ( MD5SKINTASK * )userdata;
+	
+	MD5MESH *md5mesh = md5skintask->md5mesh;
+
+	unsigned int j = ( unsigned int )( ( ( unsigned long long )md5mesh->n_vertex *   index		  ) / n_thread ),
+				 last = ( unsigned int )( ( ( unsigned long long )md5mesh->n_vertex * ( index + 1 ) ) / n_thread ),
+				 k;
+
+	vec3 *vertex_array  = ( vec3 * )md5mesh->vertex_data,
+		 *normal_array  = ( vec3 * )&md5mesh->vertex_data[ md5mesh->offset[ 1 ] ],
+		 *tangent_array = ( vec3 * )&md5mesh->vertex_data[ md5mesh->offset[ 3 ] ];
+		 
+	vec2 *uv_array = ( vec2 * )&md5mesh->vertex_data[ md5mesh->offset[ 2 ] ];
+	
+	while( j != last )
+	{
+		MD5VERTEX *md5vertex = &md5mesh->md5vertex[ j ];
+
+		MD5WEIGHT *md5weight = &md5mesh->md5weight[ md5vertex->start ];
+		
+		unsigned int count = md5vertex->count;
+		
+		float scale = 1.0f;
+		
+		// The weights are sorted by decreasing bias, so only the first ones are kept and
+		// renormalized. \sa MD5_set_lod
+		if( md5skintask->max_weight && md5skintask->max_weight < count )
+		{
+			float bias = 0.0f;
+			
+			count = md5skintask->max_weight;
+			
+			k = 0;
+			while( k != count )
+			{
+				bias += md5weight[ k ].bias;
+				++k;
+			}
+			
+			scale = 1.0f / bias;
+		}
+		
+		#if defined( __SSE__ )
+		
+			__m128 p = _mm_setzero_ps(),
+				   n = _mm_setzero_ps(),
+				   t = _mm_setzero_ps();
+			
+			k = 0;
+			while( k != count )
+			{
+				mat4 *m = &md5skintask->joint_matrix[ md5weight->joint ];
+				
+				__m128 b  = _mm_set1_ps( md5weight->bias * scale ),
+					   c0 = _mm_mul_ps( _mm_loadu_ps( &m->m[ 0 ].x ), b ),
+					   c1 = _mm_mul_ps( _mm_loadu_ps( &m->m[ 1 ].x ), b ),
+					   c2 = _mm_mul_ps( _mm_loadu_ps( &m->m[ 2 ].x ), b );
+
+				p = _mm_add_ps( p, _mm_add_ps( _mm_add_ps( _mm_mul_ps( c0, _mm_set1_ps( md5weight->location.x ) ),
+														   _mm_mul_ps( c1, _mm_set1_ps( md5weight->location.y ) ) ),
+											   _mm_add_ps( _mm_mul_ps( c2, _mm_set1_ps( md5weight->location.z ) ),
+														   _mm_mul_ps( _mm_loadu_ps( &m->m[ 3 ].x ), b ) ) ) );
+				
+				n = _mm_add_ps( n, _mm_add_ps( _mm_add_ps( _mm_mul_ps( c0, _mm_set1_ps( md5weight->normal.x ) ),
+														   _mm_mul_ps( c1, _mm_set1_ps( md5weight->normal.y ) ) ),
+														   _mm_mul_ps( c2, _mm_set1_ps( md5weight->normal.z ) ) ) );
+
+				if( md5skintask->tangent )
+				{
+					t = _mm_add_ps( t, _mm_add_ps( _mm_add_ps( _mm_mul_ps( c0, _mm_set1_ps( md5weight->tangent.x ) ),
+															   _mm_mul_ps( c1, _mm_set1_ps( md5weight->tangent.y ) ) ),
+															   _mm_mul_ps( c2, _mm_set1_ps( md5weight->tangent.z ) ) ) );
+				}
+				++md5weight;
+				++k;
+			}
+			
+			_mm_storel_pi( ( __m64 * )&vertex_array[ j ].x, p );
+			_mm_store_ss( &vertex_array[ j ].z, _mm_movehl_ps( p, p ) );
+
+			_mm_storel_pi( ( __m64 * )&normal_array[ j ].x, n );
+			_mm_store_ss( &normal_array[ j ].z, _mm_movehl_ps( n, n ) );
+
+			if( md5skintask->tangent )
+			{
+				_mm_storel_pi( ( __m64 * )&tangent_array[ j ].x, t );
+				_mm_store_ss( &tangent_array[ j ].z, _mm_movehl_ps( t, t ) );
+			}
+
+		#elif defined( __ARM_NEON__ ) || defined( __ARM_NEON )
+
+			float32x4_t p = vdupq_n_f32( 0.0f ),
+						n = vdupq_n_f32( 0.0f ),
+						t = vdupq_n_f32( 0.0f );
+			
+			k = 0;
+			while( k != count )
+			{
+				mat4 *m = &md5skintask->joint_matrix[ md5weight->joint ];
+				
+				float b = md5weight->bias * scale;
+				
+				float32x4_t c0 = vmulq_n_f32( vld1q_f32( &m->m[ 0 ].x ), b ),
+							c1 = vmulq_n_f32( vld1q_f32( &m->m[ 1 ].x ), b ),
+							c2 = vmulq_n_f32( vld1q_f32( &m->m[ 2 ].x ), b );
+
+				p = vmlaq_n_f32( p, vld1q_f32( &m->m[ 3 ].x ), b );
+				p = vmlaq_n_f32( p, c0, md5weight->location.x );
+				p = vmlaq_n_f32( p, c1, md5weight->location.y );
+				p = vmlaq_n_f32( p, c2, md5weight->location.z );
+				
+				n = vmlaq_n_f32( n, c0, md5weight->normal.x );
+				n = vmlaq_n_f32( n, c1, md5weight->normal.y );
+				n = vmlaq_n_f32( n, c2, md5weight->normal.z );
+
+				if( md5skintask->tangent )
+				{
+					t = vmlaq_n_f32( t, c0, md5weight->tangent.x );
+					t = vmlaq_n_f32( t, c1, md5weight->tangent.y );
+					t = vmlaq_n_f32( t, c2, md5weight->tangent.z );
+				}
+				
+				++md5weight;
+				++k;
+			}
+			
+			vst1_f32( &vertex_array[ j ].x, vget_low_f32( p ) );
+			vst1q_lane_f32( &vertex_array[ j ].z, p, 2 );
+
+			vst1_f32( &normal_array[ j ].x, vget_low_f32( n ) );
+			vst1q_lane_f32( &normal_array[ j ].z, n, 2 );
+
+			if( md5skintask->tangent )
+			{
+				vst1_f32( &tangent_array[ j ].x, vget_low_f32( t ) );
+				vst1q_lane_f32( &tangent_array[ j ].z, t, 2 );
+			}
+
+		#else
+		
+			vec3 p = { 0.0f, 0.0f, 0.0f },
+				 n = { 0.0f, 0.0f, 0.0f },
+				 t = { 0.0f, 0.0f, 0.0f };
+			
+			k = 0;
+			while( k != count )
+			{
+				mat4 *m = &md5skintask->joint_matrix[ md5weight->joint ];
+
+				vec3 *v = &md5weight->location;
+				
+				float b = md5weight->bias * scale;
+				
+				p.x += ( m->m[ 0 ].x * v->x + m->m[ 1 ].x * v->y + m->m[ 2 ].x * v->z + m->m[ 3 ].x ) * b;
+				p.y += ( m->m[ 0 ].y * v->x + m->m[ 1 ].y * v->y + m->m[ 2 ].y * v->z + m->m[ 3 ].y ) * b;
+				p.z += ( m->m[ 0 ].z * v->x + m->m[ 1 ].z * v->y + m->m[ 2 ].z * v->z + m->m[ 3 ].z ) * b;
+				
+				v = &md5weight->normal;
+
+				n.x += ( m->m[ 0 ].x * v->x + m->m[ 1 ].x * v->y + m->m[ 2 ].x * v->z ) * b;
+				n.y += ( m->m[ 0 ].y * v->x + m->m[ 1 ].y * v->y + m->m[ 2 ].y * v->z ) * b;
+				n.z += ( m->m[ 0 ].z * v->x + m->m[ 1 ].z * v->y + m->m[ 2 ].z * v->z ) * b;
+
+				if( md5skintask->tangent )
+				{
+					v = &md5weight->tangent;
+
+					t.x += ( m->m[ 0 ].x * v->x + m->m[ 1 ].x * v->y + m->m[ 2 ].x * v->z ) * b;
+					t.y += ( m->m[ 0 ].y * v->x + m->m[ 1 ].y * v->y + m->m[ 2 ].y * v->z ) * b;
+					t.z += ( m->m[ 0 ].z * v->x + m->m[ 1 ].z * v->y + m->m[ 2 ].z * v->z ) * b;
+				}
+				
+				++md5weight;
+				++k;
+			}
+			
+			memcpy( &vertex_array [ j ], &p, sizeof( vec3 ) );
+			memcpy( &normal_array [ j ], &n, sizeof( vec3 ) );
+			
+			if( md5skintask->tangent ) memcpy( &tangent_array[ j ], &t, sizeof( vec3 ) );
+		
+		#endif
+
+		uv_array[ j ].x = md5vertex->uv.x;
+		uv_array[ j ].y = md5vertex->uv.y;
+		
+		++j;
+	}
+}
+
+
+/*!
+	Function internally used to update the skinning matrices of all the MD5PALETTE of an MD5. The
+	skinning matrix of a joint is its pose matrix multiplied by the inverse of its bind pose matrix.
+	
+	\param[in,out] md5 A valid MD5 structure pointer.
+	\param[in] joint_matrix The joint matrices of the pose. \sa MD5_build_joint_matrices
+*/
+void MD5_update_palette( MD5 *md5, mat4 *joint_matrix )
+{
+	unsigned int i = 0,
+				 j,
+				 k;
+	
+	while( i != md5->n_mesh )
+	{
+		MD5MESH *md5mesh = &md5->md5mesh[ i ];
+		
+		j = 0;
+		while( j != md5mesh->n_md5palette )
+		{
+			MD5PALETTE *md5palette = &md5mesh->md5palette[ j ];
+			
+			vec4 *row = md5palette->matrix;
+			
+			k = 0;
+			while( k != md5palette->n_joint )
+			{
+				mat4 m;
+				
+				mat4_multiply_mat4( &m,
+									&joint_matrix[ md5palette->joint[ k ] ],
+									&md5->inverse_bind_matrix[ md5palette->joint[ k ] ] );
+				
+				row[ 0 ].x = m.m[ 0 ].x;
+				row[ 0 ].y = m.m[ 1 ].x;
+				row[ 0 ].z = m.m[ 2 ].x;
+				row[ 0 ].w = m.m[ 3 ].x;
+
+				row[ 1 ].x = m.m[ 0 ].y;
+				row[ 1 ].y = m.m[ 1 ].y;
+				row[ 1 ].z = m.m[ 2 ].y;
+				row[ 1 ].w = m.m[ 3 ].y;
+
+				row[ 2 ].x = m.m[ 0 ].z;
+				row[ 2 ].y = m.m[ 1 ].z;
+				row[ 2 ].z = m.m[ 2 ].z;
+				row[ 2 ].w = m.m[ 3 ].z;
+				
+				row += 3;
+				++k;
+			}
+			
+			++j;
+		}
+		
+		++i;
+	}
+}
+
+
+/*!
+	Skin all the MD5MESH inside an MD5 to a specific pose without uploading the result to
+	the VBOs. The pose is first converted to one matrix per joint, then the vertices of the
+	large meshes are split in contiguous ranges between multiple threads. For the MD5MESH
+	skinned on the GPU only the palette matrices are updated. The number of weights per vertex
+	and the tangents follow the current MD5LOD of the MD5. Since this function does not make
+	any OpenGLES calls it can be called from any thread. \sa MD5_set_pose
+	
+	\param[in,out] md5 A valid MD5 structure pointer.
+	\param[in] pose A valid MD5POSE structure pointer.
+	\param[in] n_thread The maximum number of threads to use (0 to use one thread per processor).
+*/
+void MD5_skin_pose( MD5 *md5, MD5POSE *pose, unsigned int n_thread )
+{
+	unsigned int i = 0,
+				 n;
+	
+	MD5SKINTASK md5skintask;
+	
+	md5skintask.joint_matrix = ( mat4 * ) malloc( md5->n_joint * sizeof( mat4 ) );
+	
+	md5skintask.max_weight = md5->md5lod ? md5->md5lod[ md5->lod ].max_weight : 0;
+	
+	md5skintask.tangent = md5->md5lod ? md5->md5lod[ md5->lod ].tangent : 1;
+	
+	MD5_build_joint_matrices( md5, pose, md5skintask.joint_matrix );
+	
+	if( md5->inverse_bind_matrix ) MD5_update_palette( md5, md5skintask.joint_matrix );
+	
+	if( !n_thread ) n_thread = THREAD_get_cpu_count();
+	
+	while( i != md5->n_mesh )
+	{
+		md5skintask.md5mesh = &md5->md5mesh[ i ];
+		
+		// The MD5MESH skinned on the GPU keep their bind pose.
+		if( md5skintask.md5mesh->n_md5palette )
+		{
+			++i;
+			continue;
+		}
+
+		// Not worth splitting small meshes.
+		n = md5skintask.md5mesh->n_vertex >> 12;
+		
+		if( n > n_thread ) n = n_thread;
+		
+		THREAD_dispatch( MD5_skin_vertices, &md5skintask, n ? n : 1 );
+		
+		++i;
+	}
+	
+	free( md5skintask.joint_matrix );
+}
+
+
+/*!
+	Function internally used to upload the vertex data of all the MD5MESH skinned on the CPU to
+	their VBO. \sa MD5_skin_pose
+	
+	\param[in] md5 A valid MD5 structure pointer.
+*/
+void MD5_upload_vertex_data( MD5 *md5 )
+{
+	unsigned int i = 0;
+	
+	while( i != md5->n_mesh )
+	{
+		MD5MESH *md5mesh = &md5->md5mesh[ i ];
+		
+		if( md5mesh->n_md5palette )
+		{
+			++i;
+			continue;
+		}
+
+		GFX_bind_buffer( GL_ARRAY_BUFFER, md5mesh->vbo );
+
+		glBufferSubData( GL_ARRAY_BUFFER,
+						 0,
+						 md5mesh->size,
+						 md5mesh->vertex_data );
+
+		++i;
+	}
+
+	GFX_bind_buffer( GL_ARRAY_BUFFER, 0 );
+}
+
+
+/*!
+	Set all the MD5MESH inside an MD5 to a specific pose.
+	
+	\param[in,out] md5 A valid MD5 structure pointer.
+	\param[in] pose A valid MD5POSE structure pointer.
+*/
+void MD5_set_pose( MD5 *md5, MD5POSE *pose )
+{
+	MD5_skin_pose( md5, pose, 0 );
+	
+	MD5_upload_vertex_data( md5 );
+}
+
+
+/*!
+	Blender two skeleton pose togheter and assign it to the final pose parameter.
+	
+	\param[in] md5 A valid MD5 structure pointer to have access to the number of joints the MD5 contains.
+	\param[in,out] final_pose The final MD5POSE that will store the result of the blending operation between pose0 and pose1, its rotations must not be quantized.
+	\param[in] pose0 The first pose to use for the blending operation.
+	\param[in] pose1 The second pose to use for the blending operation.
+	\param[in] joint_interpolation_method The method to use to interpolate the rotation, for location lerp will always be used.
+	\param[in] blend The blending factor (a value between 0 and 1).
+*/
+void MD5_blend_pose( MD5 *md5, MD5POSE *final_pose, MD5POSE *pose0, MD5POSE *pose1, unsigned char joint_interpolation_method, float blend )
+{
+	unsigned int i = 0;
+	
+	vec4 rotation0,
+		 rotation1;
+
+	while( i != md5->n_joint )
+	{
+		vec3_lerp( &final_pose->location[ i ],
+				   &pose0->location[ i ],
+				   &pose1->location[ i ],
+				   blend );
+		++i;
+	}
+	
+	i = 0;
+	while( i != md5->n_joint )
+	{
+		vec4 *q0 = &rotation0,
+			 *q1 = &rotation1;
+		
+		if( pose0->qrotation ) MD5_get_pose_rotation( pose0, i, q0 );
+		else q0 = &pose0->rotation[ i ];
+		
+		if( pose1->qrotation ) MD5_get_pose_rotation( pose1, i, q1 );
+		else q1 = &pose1->rotation[ i ];
+	
+		switch( joint_interpolation_method )
+		{
+			case MD5_METHOD_FRAME:
+			case MD5_METHOD_LERP:
+			{
+				vec4_lerp( &final_pose->rotation[ i ], q0, q1, blend );
+				break;
+			}
+		
+		
+			case MD5_METHOD_SLERP:
+			{
+				vec4_slerp( &final_pose->rotation[ i ], q0, q1, blend );
+				break;
+			}
+		}
+
+
+		++i;
+	}
+}
+
+
+/*!
+	Add two action together. Please take note that the additive blending of each bone is evaluated on if the
+	current action1 frame is different than the next frame. If yes it means that the action1 is taking over
+	the control of the bone and will be blended by the action weight factor.
+	
+	\param[in] md5 A valid MD5 structure pointer to gain access to the maximum number of joints each actions contains.
+	\param[in,out] final_pose The MD5POSE to use as the destination. The resulting skeleton of the operation executed in this function will use this pose as destination.
+	\param[in] action0 A valid MD5ACTION pointer that will be use as the base action to use.
+	\param[in] action1 A valid MD5ACTION pointer that will be use as the second action that will additively be blended to action0.
+	\param[in] joint_interpolation_method The method to use to interpolate the action weight between action0 and action1.
+	\param[in] action_weight The weight factor of the action1 if the bone is animated. This value will have impact on the blending between action0 and action1.
+*/
+void MD5_add_pose( MD5 *md5, MD5POSE *final_pose, MD5ACTION *action0, MD5ACTION *action1, unsigned char joint_interpolation_method, float action_weight )
+{
+	unsigned int i = 0;
+	
+	unsigned char animated,
+				  *joint_animated = NULL;
+	
+	// The tracks are relative to the parent joints, so a joint is also animated if its parent is.
+	if( action1->md5track ) joint_animated = ( unsigned char * ) malloc( md5->n_joint );
+	
+	while( i != md5->n_joint )
+	{
+		if( action1->md5track )
+		{
+			MD5TRACK *md5track = &action1->md5track[ i ];
+			
+			int parent = md5->md5joint[ i ].parent;
+			
+			vec3 location0,
+				 location1;
+			
+			vec4 rotation0,
+				 rotation1;
+			
+			animated = parent > -1 ? joint_animated[ parent ] : 0;
+			
+			if( !animated && md5track->n_location != 1 )
+			{
+				MD5_sample_track_location( md5track, action1->curr_frame, &location0 );
+				MD5_sample_track_location( md5track, action1->next_frame, &location1 );
+				
+				animated = memcmp( &location0, &location1, sizeof( vec3 ) ) != 0;
+			}
+			
+			if( !animated && md5track->n_rotation != 1 )
+			{
+				MD5_sample_track_rotation( md5track, action1->curr_frame, &rotation0 );
+				MD5_sample_track_rotation( md5track, action1->next_frame, &rotation1 );
+				
+				animated = memcmp( &rotation0, &rotation1, sizeof( vec4 ) ) != 0;
+			}
+			
+			joint_animated[ i ] = animated;
+		}
+		else
+		{
+			MD5POSE *curr = &action1->frame[ action1->curr_frame ],
+					*next = &action1->frame[ action1->next_frame ];
+			
+			animated = memcmp( &curr->location[ i ], &next->location[ i ], sizeof( vec3 ) ) ||
+					   ( curr->qrotation ?
+						 memcmp( &curr->qrotation[ i << 2 ], &next->qrotation[ i << 2 ], 4 * sizeof( short ) ) :
+						 memcmp( &curr->rotation[ i ], &next->rotation[ i ], sizeof( vec4 ) ) );
+		}
+		
+		if( animated )
+		{
+			vec3_lerp( &final_pose->location[ i ],
+					   &action0->pose.location[ i ],
+					   &action1->pose.location[ i ],
+					   action_weight );
+			
+			switch( joint_interpolation_method )
+			{
+				case MD5_METHOD_FRAME:
+				case MD5_METHOD_LERP:
+				{
+					vec4_lerp( &final_pose->rotation[ i ], 
+							   &action0->pose.rotation[ i ],
+							   &action1->pose.rotation[ i ],
+							   action_weight );
+					break;
+				}
+			
+			
+				case MD5_METHOD_SLERP:
+				{
+					vec4_slerp( &final_pose->rotation[ i ], 
+								&action0->pose.rotation[ i ],
+								&action1->pose.rotation[ i ],
+								action_weight );
+					break;
+				}
+			}
+		}
+		else
+		{
+			memcpy( &final_pose->location[ i ], &action0->pose.location[ i ], sizeof( vec3 ) );
+			memcpy( &final_pose->rotation[ i ], &action0->pose.rotation[ i ], sizeof( vec4 ) );
+		}
+
+		++i;
+	}
+	
+	if( joint_animated ) free( joint_animated );
+}
+
+
+/*!
+	Function internally used to calculate the bounding box dimension and the bounding sphere of
+	an MD5 from its min and max position.
+	
+	\param[in,out] md5 A valid MD5 structure pointer.
+*/
+void MD5_update_bound_dimension( MD5 *md5 )
+{
+	// Mesh dimension
+	vec3_diff( &md5->dimension,
+			   &md5->max,
+			   &md5->min );
+
+
+	// Bounding sphere radius
+	md5->radius = md5->dimension.x > md5->dimension.y ?
+				  md5->dimension.x:
+				  md5->dimension.y;
+	
+	md5->radius = md5->radius > md5->dimension.z ?
+				  md5->radius * 0.5f:
+				  md5->dimension.z * 0.5f;
+	
+	/*
+	md5->radius = vec3_dist( &md5->min,
+							 &md5->max ) * 0.5f;
+	*/
+}
+
+
+/*!
+	Calculate the min and max position of the MD5 mesh in bind position, as well as the bounding
+	box and bounding sphere.
+	
+	\param[in] md5 A valid MD5 structure pointer that the vertex data is available.
+*/
+void MD5_update_bound_mesh( MD5 *md5 )
+{
+	unsigned int i = 0,
+				 j;
+
+
+	// Get the mesh min and max.
+	md5->min.x =
+	md5->min.y =
+	md5->min.z = 99999.999f;
+
+	md5->max.x =
+	md5->max.y =
+	md5->max.z = -99999.999f;
+
+
+	while( i != md5->n_mesh )
+	{
+		MD5MESH *md5mesh = &md5->md5mesh[ i ];
+		
+		vec3 *vertex_array = ( vec3 * )md5mesh->vertex_data;
+		
+		j = 0;
+		while( j != md5mesh->n_vertex )
+		{
+			if( vertex_array[ j ].x < md5->min.x ) md5->min.x = vertex_array[ j ].x;
+			if( vertex_array[ j ].y < md5->min.y ) md5->min.y = vertex_array[ j ].y;
+			if( vertex_array[ j ].z < md5->min.z ) md5->min.z = vertex_array[ j ].z;
+
+			if( vertex_array[ j ].x > md5->max.x ) md5->max.x = vertex_array[ j ].x;
+			if( vertex_array[ j ].y > md5->max.y ) md5->max.y = vertex_array[ j ].y;
+			if( vertex_array[ j ].z > md5->max.z ) md5->max.z = vertex_array[ j ].z;
+	
+			++j;
+		}
+		
+		++i;
+	}
+
+	MD5_update_bound_dimension( md5 );
+}
+
+
+/*!
+	Function internally used to calculate the bounding sphere of the weights of each joint,
+	relative to the joint, and the range of the sum of the weight biases of a vertex.
+	\sa MD5_update_bound_pose
+	
+	\param[in,out] md5 A valid MD5 structure pointer (not an instance).
+*/
+void MD5_build_joint_bounds( MD5 *md5 )
+{
+	unsigned int i = 0,
+				 j,
+				 k;
+	
+	vec3 *min,
+		 *max;
+	
+	if( md5->instance ) return;
+	
+	if( !md5->joint_bound ) md5->joint_bound = ( vec4 * ) malloc( md5->n_joint * sizeof( vec4 ) );
+	
+	min = ( vec3 * ) malloc( md5->n_joint * sizeof( vec3 ) );
+	max = ( vec3 * ) malloc( md5->n_joint * sizeof( vec3 ) );
+	
+	while( i != md5->n_joint )
+	{
+		min[ i ].x =
+		min[ i ].y =
+		min[ i ].z = 99999.999f;
+		
+		max[ i ].x =
+		max[ i ].y =
+		max[ i ].z = -99999.999f;
+		
+		md5->joint_bound[ i ].w = -1.0f;
+		++i;
+	}
+	
+	md5->bias_range.x =
+	md5->bias_range.y = 1.0f;
+	
+	// The center of each sphere is the center of the box of the weights of the joint.
+	i = 0;
+	while( i != md5->n_mesh )
+	{
+		MD5MESH *md5mesh = &md5->md5mesh[ i ];
+		
+		j = 0;
+		while( j != md5mesh->n_weight )
+		{
+			MD5WEIGHT *md5weight = &md5mesh->md5weight[ j ];
+			
+			vec3 *l = &md5weight->location;
+			
+			min[ md5weight->joint ].x = fminf( min[ md5weight->joint ].x, l->x );
+			min[ md5weight->joint ].y = fminf( min[ md5weight->joint ].y, l->y );
+			min[ md5weight->joint ].z = fminf( min[ md5weight->joint ].z, l->z );
+			
+			max[ md5weight->joint ].x = fmaxf( max[ md5weight->joint ].x, l->x );
+			max[ md5weight->joint ].y = fmaxf( max[ md5weight->joint ].y, l->y );
+			max[ md5weight->joint ].z = fmaxf( max[ md5weight->joint ].z, l->z );
+			
+			md5->joint_bound[ md5weight->joint ].w = 0.0f;
+			++j;
+		}
+		
+		j = 0;
+		while( j != md5mesh->n_vertex )
+		{
+			float bias = 0.0f;
+			
+			k = 0;
+			while( k != md5mesh->md5vertex[ j ].count )
+			{
+				bias += md5mesh->md5weight[ md5mesh->md5vertex[ j ].start + k ].bias;
+				++k;
+			}
+			
+			md5->bias_range.x = fminf( md5->bias_range.x, bias );
+			md5->bias_range.y = fmaxf( md5->bias_range.y, bias );
+			++j;
+		}
+		
+		++i;
+	}
+	
+	i = 0;
+	while( i != md5->n_joint )
+	{
+		md5->joint_bound[ i ].x = ( min[ i ].x + max[ i ].x ) * 0.5f;
+		md5->joint_bound[ i ].y = ( min[ i ].y + max[ i ].y ) * 0.5f;
+		md5->joint_bound[ i ].z = ( min[ i ].z + max[ i ].z ) * 0.5f;
+		++i;
+	}
+	
+	i = 0;
+	while( i != md5->n_mesh )
+	{
+		MD5MESH *md5mesh = &md5->md5mesh[ i ];
+		
+		j = 0;
+		while( j != md5mesh->n_weight )
+		{
+			MD5WEIGHT *md5weight = &md5mesh->md5weight[ j ];
+			
+			vec4 *b = &md5->joint_bound[ md5weight->joint ];
+			
+			vec3 c = { b->x, b->y, b->z };
+			
+			b->w = fmaxf( b->w, vec3_dist( &c, &md5weight->location ) );
+			++j;
+		}
+		
+		++i;
+	}
+	
+	free( min );
+	free( max );
+}
+
+
+/*!
+	Calculate the min and max position of the MD5 mesh in a specific pose, as well as the
+	bounding box and bounding sphere, without looking at the vertices. A skinned vertex is a
+	weighted average of the locations of its weights transformed by their joint, so it is always
+	inside the bounding spheres of the weights of the joints moved to the pose (scaled by the sum
+	of its weight biases when it is not exactly 1). The bound is conservative, and its cost only
+	depends on the number of joints. It is valid for any pose, including blended poses and the
+	reduced weights of an MD5LOD or an MD5PALETTE.
+	
+	\param[in,out] md5 A valid MD5 structure pointer that have been built.
+	\param[in] pose A valid MD5POSE structure pointer, usually the one used to skin the MD5.
+*/
+void MD5_update_bound_pose( MD5 *md5, MD5POSE *pose )
+{
+	unsigned int i = 0;
+	
+	if( !md5->joint_bound ) return;
+	
+	md5->min.x =
+	md5->min.y =
+	md5->min.z = 99999.999f;
+
+	md5->max.x =
+	md5->max.y =
+	md5->max.z = -99999.999f;
+	
+	while( i != md5->n_joint )
+	{
+		vec4 *b = &md5->joint_bound[ i ];
+		
+		if( b->w >= 0.0f )
+		{
+			vec3 c = { b->x, b->y, b->z },
+				 v;
+			
+			vec4 rotation;
+			
+			MD5_get_pose_rotation( pose, i, &rotation );
+			
+			vec3_rotate_vec4( &v, &c, &rotation );
+			
+			vec3_add( &v, &v, &pose->location[ i ] );
+			
+			md5->min.x = fminf( md5->min.x, v.x - b->w );
+			md5->min.y = fminf( md5->min.y, v.y - b->w );
+			md5->min.z = fminf( md5->min.z, v.z - b->w );
+			
+			md5->max.x = fmaxf( md5->max.x, v.x + b->w );
+			md5->max.y = fmaxf( md5->max.y, v.y + b->w );
+			md5->max.z = fmaxf( md5->max.z, v.z + b->w );
+		}
+		
+		++i;
+	}
+	
+	// The vertices with a bias sum different than 1 are scaled toward (or away from) the origin.
+	if( md5->bias_range.x != 1.0f || md5->bias_range.y != 1.0f )
+	{
+		vec3 min = { md5->min.x, md5->min.y, md5->min.z },
+			 max = { md5->max.x, md5->max.y, md5->max.z };
+		
+		md5->min.x = fminf( min.x * md5->bias_range.x, min.x * md5->bias_range.y );
+		md5->min.y = fminf( min.y * md5->bias_range.x, min.y * md5->bias_range.y );
+		md5->min.z = fminf( min.z * md5->bias_range.x, min.z * md5->bias_range.y );
+		
+		md5->max.x = fmaxf( max.x * md5->bias_range.x, max.x * md5->bias_range.y );
+		md5->max.y = fmaxf( max.y * md5->bias_range.x, max.y * md5->bias_range.y );
+		md5->max.z = fmaxf( max.z * md5->bias_range.x, max.z * md5->bias_range.y );
+	}
+	
+	MD5_update_bound_dimension( md5 );
+}
+
+
+/*!
+	Function internally used to split an MD5MESH in joint matrix palettes and build its VBOs for
+	GPU skinning. The palettes are filled one after the other with the remaining triangles whose
+	joints still fit, keeping the triangles in their original order inside a palette. A vertex
+	keep its index in the first palette that use it and is duplicated at the end of the vertex
+	array for the next palettes. Only the 4 most influent weights of each vertex are kept
+	and renormalized. The vertex data array must contain the bind pose. \sa MD5_skin_pose
+	
+	\param[in,out] md5 A valid MD5 structure pointer.
+	\param[in] mesh_index The MD5MESH index inside the mesh database of the MD5.
+	\param[in] palette_size The maximum number of joints of a palette (between 12 and 256).
+	
+	\return Return 1 if the MD5MESH have been built, or 0 if it would need more than 65536
+	vertices or indices, in which case the MD5MESH is left untouched.
+*/
+unsigned char MD5_build_palette_mesh( MD5 *md5, unsigned int mesh_index, unsigned int palette_size )
+{
+	MD5MESH *md5mesh = &md5->md5mesh[ mesh_index ];
+
+	unsigned int i,
+				 j,
+				 k,
+				 n_vertex	= md5mesh->n_vertex,
+				 max_vertex = md5mesh->n_vertex,
+				 n_indice	= md5mesh->n_triangle * 3,
+				 n_triangle = 0,
+				 n_joint	= 0,
+				 n_new,
+				 new_joint[ 12 ];
+	
+	if( n_vertex > 65536 || n_indice > 65535 ) return 0;
+
+	unsigned short *joint	  = ( unsigned short * ) calloc( n_vertex * 4, sizeof( unsigned short ) ),
+				   *indice	  = ( unsigned short * ) malloc( ( n_indice ? n_indice : 1 ) * sizeof( unsigned short ) );
+	
+	float *weight = ( float * ) calloc( n_vertex * 4, sizeof( float ) );
+	
+	int *local	= ( int * ) malloc( md5->n_joint * sizeof( int ) ),
+		*owner	= ( int * ) malloc( n_vertex * sizeof( int ) ),
+		*copy	= ( int * ) malloc( n_vertex * sizeof( int ) ),
+		*stamp	= ( int * ) malloc( n_vertex * sizeof( int ) ),
+		*source = ( int * ) malloc( max_vertex * sizeof( int ) );
+	
+	unsigned char *local_joint = ( unsigned char * ) calloc( max_vertex * 4, 1 ),
+				  *done		   = ( unsigned char * ) calloc( md5mesh->n_triangle ? md5mesh->n_triangle : 1, 1 ),
+				  *vertex_data,
+				  added		   = 0;
+	
+	MD5PALETTE *md5palette = ( MD5PALETTE * ) calloc( 1, sizeof( MD5PALETTE ) );
+	
+	md5mesh->md5palette   = md5palette;
+	md5mesh->n_md5palette = 1;
+	
+	md5palette->joint = ( unsigned short * ) malloc( palette_size * sizeof( unsigned short ) );
+	
+	
+	// Keep the 4 most influent weights of each vertex.
+	i = 0;
+	while( i != n_vertex )
+	{
+		MD5VERTEX *md5vertex = &md5mesh->md5vertex[ i ];
+		
+		unsigned short *j4 = &joint [ i * 4 ];
+		
+		float *w4 = &weight[ i * 4 ],
+			  sum = 0.0f;
+		
+		j = 0;
+		while( j != md5vertex->count )
+		{
+			MD5WEIGHT *md5weight = &md5mesh->md5weight[ md5vertex->start + j ];
+			
+			k = 4;
+			while( k && md5weight->bias > w4[ k - 1 ] )
+			{
+				if( k != 4 )
+				{
+					j4[ k ] = j4[ k - 1 ];
+					w4[ k ] = w4[ k - 1 ];
+				}
+				
+				--k;
+			}
+			
+			if( k != 4 )
+			{
+				j4[ k ] = md5weight->joint;
+				w4[ k ] = md5weight->bias;
+			}
+			
+			++j;
+		}
+		
+		sum = w4[ 0 ] + w4[ 1 ] + w4[ 2 ] + w4[ 3 ];
+		
+		if( sum )
+		{
+			w4[ 0 ] /= sum;
+			w4[ 1 ] /= sum;
+			w4[ 2 ] /= sum;
+			w4[ 3 ] /= sum;
+		}
+		else w4[ 0 ] = 1.0f;
+		
+		owner [ i ] = -1;
+		stamp [ i ] = -1;
+		source[ i ] = i;
+		
+		++i;
+	}
+	
+	i = 0;
+	while( i != md5->n_joint )
+	{
+		local[ i ] = -1;
+		++i;
+	}
+	
+	
+	// Fill the palettes one after the other, each pass over the remaining triangles adds the
+	// ones whose joints still fit in the palette, until a pass cannot add any triangle.
+	i = 0;
+	while( n_triangle != md5mesh->n_triangle )
+	{
+		int p = md5mesh->n_md5palette - 1;
+		
+		unsigned short *t;
+		
+		if( i == md5mesh->n_triangle )
+		{
+			if( !added )
+			{
+				md5palette = &md5mesh->md5palette[ p ];
+				
+				md5palette->n_joint  = n_joint;
+				md5palette->n_indice = ( n_triangle * 3 ) - md5palette->first;
+				
+				md5mesh->md5palette = ( MD5PALETTE * ) realloc( md5mesh->md5palette,
+																++md5mesh->n_md5palette * sizeof( MD5PALETTE ) );
+				
+				md5palette = &md5mesh->md5palette[ ++p ];
+				
+				memset( md5palette, 0, sizeof( MD5PALETTE ) );
+				
+				md5palette->joint = ( unsigned short * ) malloc( palette_size * sizeof( unsigned short ) );
+				
+				md5palette->first = n_triangle * 3;
+				
+				j = 0;
+				while( j != n_joint )
+				{
+					local[ md5mesh->md5palette[ p - 1 ].joint[ j ] ] = -1;
+					++j;
+				}
+				
+				n_joint = 0;
+			}
+			
+			added = 0;
+			i = 0;
+			continue;
+		}
+		
+		if( done[ i ] )
+		{
+			++i;
+			continue;
+		}
+		
+		t = md5mesh->md5triangle[ i ].indice;
+		
+		// Gather the joints of the triangle that are not in the current palette yet.
+		n_new = 0;
+		
+		j = 0;
+		while( j != 12 )
+		{
+			unsigned short index = joint[ t[ j >> 2 ] * 4 + ( j & 3 ) ];
+			
+			if( weight[ t[ j >> 2 ] * 4 + ( j & 3 ) ] && local[ index ] == -1 )
+			{
+				k = 0;
+				while( k != n_new && new_joint[ k ] != index ) ++k;
+				
+				if( k == n_new ) new_joint[ n_new++ ] = index;
+			}
+			
+			++j;
+		}
+		
+		if( n_joint + n_new > palette_size )
+		{
+			++i;
+			continue;
+		}
+		
+		md5palette = &md5mesh->md5palette[ p ];
+		
+		j = 0;
+		while( j != n_new )
+		{
+			local[ new_joint[ j ] ] = n_joint;
+			
+			md5palette->joint[ n_joint++ ] = new_joint[ j ];
+			++j;
+		}
+		
+		
+		// Assign the vertices of the triangle to the palette, or duplicate them.
+		j = 0;
+		while( j != 3 )
+		{
+			unsigned int v = t[ j ],
+						 index;
+			
+			if( owner[ v ] == p ) index = v;
+			
+			else if( owner[ v ] == -1 )
+			{
+				owner[ v ] = p;
+				index = v;
+			}
+			else if( stamp[ v ] == p ) index = copy[ v ];
+			
+			else
+			{
+				if( n_vertex == max_vertex )
+				{
+					max_vertex <<= 1;
+					
+					source = ( int * ) realloc( source, max_vertex * sizeof( int ) );
+					
+					local_joint = ( unsigned char * ) realloc( local_joint, max_vertex * 4 );
+				}
+				
+				stamp [ v ] = p;
+				copy  [ v ] = n_vertex;
+				source[ n_vertex ] = v;
+				
+				index = n_vertex++;
+			}
+			
+			k = 0;
+			while( k != 4 )
+			{
+				local_joint[ index * 4 + k ] = weight[ v * 4 + k ] ? local[ joint[ v * 4 + k ] ] : 0;
+				++k;
+			}
+			
+			indice[ n_triangle * 3 + j ] = index;
+			++j;
+		}
+		
+		done[ i ] = 1;
+		added	  = 1;
+		
+		++n_triangle;
+		++i;
+	}
+	
+	md5palette = &md5mesh->md5palette[ md5mesh->n_md5palette - 1 ];
+	
+	md5palette->n_joint  = n_joint;
+	md5palette->n_indice = n_indice - md5palette->first;
+	
+	
+	if( n_vertex <= 65536 && n_indice <= 65535 )
+	{
+		vec3 *vertex_array  = ( vec3 * )md5mesh->vertex_data,
+			 *normal_array  = ( vec3 * )&md5mesh->vertex_data[ md5mesh->offset[ 1 ] ],
+			 *tangent_array = ( vec3 * )&md5mesh->vertex_data[ md5mesh->offset[ 3 ] ];
+		
+		vec2 *uv_array = ( vec2 * )&md5mesh->vertex_data[ md5mesh->offset[ 2 ] ];
+		
+		md5mesh->offset[ 0 ] = 0;
+		md5mesh->offset[ 1 ] = n_vertex * sizeof( vec3 );
+		md5mesh->offset[ 2 ] = md5mesh->offset[ 1 ] + ( n_vertex * sizeof( vec3 ) );
+		md5mesh->offset[ 3 ] = md5mesh->offset[ 2 ] + ( n_vertex * sizeof( vec2 ) );
+		md5mesh->offset[ 4 ] = md5mesh->offset[ 3 ] + ( n_vertex * sizeof( vec3 ) );
+		md5mesh->offset[ 5 ] = md5mesh->offset[ 4 ] + ( n_vertex * 4 );
+		
+		md5mesh->size = md5mesh->offset[ 5 ] + ( n_vertex * sizeof( vec4 ) );
+		
+		vertex_data = ( unsigned char * ) malloc( md5mesh->size );
+		
+		i = 0;
+		while( i != n_vertex )
+		{
+			MD5VERTEX *md5vertex = &md5mesh->md5vertex[ source[ i ] ];
+			
+			vec3 *position = ( vec3 * )&vertex_data[ i * sizeof( vec3 ) ];
+			
+			float bias = 0.0f;
+			
+			memcpy( position, &vertex_array[ source[ i ] ], sizeof( vec3 ) );
+			
+			// The weights are renormalized, so remove the sum of the biases from the bind pose position too.
+			k = 0;
+			while( k != md5vertex->count )
+			{
+				bias += md5mesh->md5weight[ md5vertex->start + k ].bias;
+				++k;
+			}
+			
+			if( bias && bias != 1.0f )
+			{
+				position->x /= bias;
+				position->y /= bias;
+				position->z /= bias;
+			}
+			
+			memcpy( &vertex_data[ md5mesh->offset[ 1 ] + i * sizeof( vec3 ) ], &normal_array[ source[ i ] ], sizeof( vec3 ) );
+			
+			memcpy( &vertex_data[ md5mesh->offset[ 2 ] + i * sizeof( vec2 ) ], &uv_array[ source[ i ] ], sizeof( vec2 ) );
+			
+			memcpy( &vertex_data[ md5mesh->offset[ 3 ] + i * sizeof( vec3 ) ], &tangent_array[ source[ i ] ], sizeof( vec3 ) );
+
+			memcpy( &vertex_data[ md5mesh->offset[ 4 ] + i * 4 ], &local_joint[ i * 4 ], 4 );
+
+			memcpy( &vertex_data[ md5mesh->offset[ 5 ] + i * sizeof( vec4 ) ], &weight[ source[ i ] * 4 ], sizeof( vec4 ) );
+			
+			++i;
+		}
+		
+		free( md5mesh->vertex_data );
+		md5mesh->vertex_data = vertex_data;
+		
+		if( md5mesh->indice ) free( md5mesh->indice );
+		md5mesh->indice = indice;
+		
+		md5mesh->n_indice = n_indice;
+		md5mesh->mode	  = GL_TRIANGLES;
+		
+		i = 0;
+		while( i != md5mesh->n_md5palette )
+		{
+			md5palette = &md5mesh->md5palette[ i ];
+			
+			md5palette->joint = ( unsigned short * ) realloc( md5palette->joint, ( md5palette->n_joint ? md5palette->n_joint : 1 ) * sizeof( unsigned short ) );
+			
+			md5palette->matrix = ( vec4 * ) calloc( ( md5palette->n_joint ? md5palette->n_joint : 1 ) * 3, sizeof( vec4 ) );
+			++i;
+		}
+		
+		
+		glGenBuffers( 1, &md5mesh->vbo );
+		
+		GFX_bind_buffer( GL_ARRAY_BUFFER, md5mesh->vbo );
+
+		glBufferData( GL_ARRAY_BUFFER,
+					  md5mesh->size,
+					  md5mesh->vertex_data,
+					  GL_STATIC_DRAW );
+
+		glGenBuffers( 1, &md5mesh->vbo_indice );
+
+		GFX_bind_buffer( GL_ELEMENT_ARRAY_BUFFER, md5mesh->vbo_indice );
+
+		glBufferData( GL_ELEMENT_ARRAY_BUFFER,
+					  md5mesh->n_indice * sizeof( unsigned short ),
+					  md5mesh->indice,
+					  GL_STATIC_DRAW );
+	}
+	else
+	{
+		i = 0;
+		while( i != md5mesh->n_md5palette )
+		{
+			free( md5mesh->md5palette[ i ].joint );
+			++i;
+		}
+		
+		free( md5mesh->md5palette );
+		
+		md5mesh->md5palette   = NULL;
+		md5mesh->n_md5palette = 0;
+		
+		free( indice );
+	}
+	
+	free( local_joint );
+	free( done );
+	free( source );
+	free( stamp );
+	free( copy );
+	free( owner );
+	free( local );
+	free( weight );
+	free( joint );
+	
+	return md5mesh->n_md5palette != 0;
+}
+
+
+/*!
+	Function internally used by MD5_save_bin and MD5_save_action_bin to write a buffer to disk.
+	
+	\param[in] buffer The buffer to write.
+	\param[in] size The size of the buffer in bytes.
+	\param[in] filename The filename to create.
+	
+	\return Return 1 if the file was created successfully, else return 0.
+*/
+unsigned char MD5_write_bin( unsigned char *buffer, unsigned int size, char *filename )
+{
+	unsigned int i = 0;
+	
+	FILE *f = fopen( filename, "wb" );
+	
+	if( f )
+	{
+		i = fwrite( buffer, size, 1, f );
+		
+		fclose( f );
+	}
+	
+	return f && i == 1;
+}
+
+
+/*!
+	Function internally used by MD5_load_bin and MD5_load_action_bin to check that an array
+	stored in a memory mapped file is entirely inside the file, without overflowing while
+	computing its size.
+	
+	\param[in] m The memory mapped file.
+	\param[in] offset The location in bytes of the array from the beginning of the file.
+	\param[in] count The number of elements of the array.
+	\param[in] stride The size of an element in bytes.
+	
+	\return Return 1 if the array is valid, else return 0.
+*/
+unsigned char MD5_check_bin( MEMORY *m, unsigned int offset, unsigned int count, unsigned int stride )
+{
+	if( !count ) return 1;
+	
+	return offset <= m->size && count <= ( m->size - offset ) / stride;
+}
+
+
+/*!
+	Function internally used by MD5_load_bin to check that the joint, weight and vertex indices
+	stored in a .gfxmd5 file are in range, once its arrays have been validated using MD5_check_bin:
+	the parent of each joint have to precede it (or be -1), the weights of each vertex have to be
+	inside the weight array, the joint of each weight and the vertices of each triangle and index
+	have to exist. The arrays are read in place, so they also have to be aligned.
+	
+	\param[in] m The memory mapped file.
+	\param[in] md5binheader The header of the file.
+	
+	\return Return 1 if the indices are valid, else return 0.
+*/
+unsigned char MD5_check_bin_indices( MEMORY *m, MD5BINHEADER *md5binheader )
+{
+	unsigned int i = 0,
+				 j;
+	
+	MD5JOINT *md5joint = ( MD5JOINT * )&m->buffer[ md5binheader->md5joint ];
+	
+	MD5BINMESH *md5binmesh = ( MD5BINMESH * )&m->buffer[ md5binheader->md5mesh ];
+	
+	if( ( md5binheader->md5joint & 3 ) || ( md5binheader->md5mesh & 3 ) ) return 0;
+	
+	while( i != md5binheader->n_joint )
+	{
+		if( md5joint[ i ].parent < -1 || md5joint[ i ].parent >= ( int )i ) return 0;
+		++i;
+	}
+	
+	i = 0;
+	while( i != md5binheader->n_mesh )
+	{
+		MD5BINMESH *b = &md5binmesh[ i ];
+		
+		MD5VERTEX *md5vertex = ( MD5VERTEX * )&m->buffer[ b->md5vertex ];
+		
+		MD5WEIGHT *md5weight = ( MD5WEIGHT * )&m->buffer[ b->md5weight ];
+		
+		unsigned short *indice = ( unsigned short * )&m->buffer[ b->md5triangle ];
+		
+		if( ( b->md5vertex & 3 ) || ( b->md5weight & 3 ) || ( b->md5triangle & 1 ) || ( b->indice & 1 ) ) return 0;
+		
+		j = 0;
+		while( j != b->n_vertex )
+		{
+			if( md5vertex[ j ].start > b->n_weight || md5vertex[ j ].count > b->n_weight - md5vertex[ j ].start ) return 0;
+			++j;
+		}
+		
+		j = 0;
+		while( j != b->n_weight )
+		{
+			if( md5weight[ j ].joint < 0 || md5weight[ j ].joint >= ( int )md5binheader->n_joint ) return 0;
+			++j;
+		}
+		
+		j = 0;
+		while( j != b->n_triangle * 3 )
+		{
+			if( indice[ j ] >= b->n_vertex ) return 0;
+			++j;
+		}
+		
+		indice = ( unsigned short * )&m->buffer[ b->indice ];
+		
+		j = 0;
+		while( j != b->n_indice )
+		{
+			if( indice[ j ] >= b->n_vertex ) return 0;
+			++j;
+		}
+		
+		++i;
+	}
+	
+	return 1;
+}
+
+
+/*!
+	Function internally used by MD5_load_bin and MD5_load_action_bin to copy an array out of
+	a memory mapped file. The array must have been validated using MD5_check_bin.
+	
+	\param[in] m The memory mapped file.
+	\param[in] offset The location in bytes of the array from the beginning of the file.
+	\param[in] size The size of the array in bytes.
+	
+	\return Return a new array, or NULL if the size is 0.
+*/
+void *MD5_copy_bin( MEMORY *m, unsigned int offset, unsigned int size )
+{
+	void *data;
+	
+	if( !size ) return NULL;
+	
+	data = malloc( size );
+	
+	memcpy( data, &m->buffer[ offset ], size );
+	
+	return data;
+}
+
+
+/*!
+	Compile the skeleton and the meshes of an MD5 to a .gfxmd5 binary file. The file contains
+	the joints, the bind pose, the vertices, the weights with their bind pose weighted normals
+	and tangents, the triangles and the index arrays, so it can be loaded back using MD5_load_bin
+	without any parsing and without calling MD5_build_bind_pose_weighted_normals_tangents.
+	
+	The function have to be called before MD5_build, MD5_build2 or MD5_build3. If you want to
+	optimize the MD5MESH do it before saving.
+	
+	\param[in,out] md5 A valid MD5 structure pointer.
+	\param[in] filename The .gfxmd5 filename to create.
+	
+	\return Return 1 if the file was created successfully, else return 0.
+*/
+unsigned char MD5_save_bin( MD5 *md5, char *filename )
+{
+	unsigned int i,
+				 size = 0;
+	
+	unsigned char *buffer = NULL,
+				  result;
+	
+	MD5BINHEADER md5binheader;
+	
+	
+	if( !md5->weighted_normals_tangents )
+	{
+		i = 0;
+		while( i != md5->n_mesh )
+		{
+			if( !md5->md5mesh[ i ].vertex_data ) MD5_build_vertex_data( &md5->md5mesh[ i ] );
+			++i;
+		}
+		
+		MD5_skin_pose( md5, &md5->bind_pose, 0 );
+		
+		MD5_build_bind_pose_weighted_normals_tangents( md5 );
+	}
+	
+	
+	memset( &md5binheader, 0, sizeof( MD5BINHEADER ) );
+	
+	OBJ_append_bin( &buffer, &size, NULL, sizeof( MD5BINHEADER ), 4 );
+	
+	md5binheader.md5joint = OBJ_append_bin( &buffer, &size, md5->md5joint, md5->n_joint * sizeof( MD5JOINT ), 4 );
+	
+	md5binheader.location = OBJ_append_bin( &buffer, &size, md5->bind_pose.location, md5->n_joint * sizeof( vec3 ), OBJ_BIN_ALIGNMENT );
+	
+	md5binheader.rotation = OBJ_append_bin( &buffer, &size, md5->bind_pose.rotation, md5->n_joint * sizeof( vec4 ), OBJ_BIN_ALIGNMENT );
+	
+	if( md5->n_mesh ) md5binheader.md5mesh = OBJ_append_bin( &buffer, &size, NULL, md5->n_mesh * sizeof( MD5BINMESH ), 4 );
+	
+	i = 0;
+	while( i != md5->n_mesh )
+	{
+		MD5MESH *md5mesh = &md5->md5mesh[ i ];
+		
+		MD5BINMESH md5binmesh;
+		
+		memset( &md5binmesh, 0, sizeof( MD5BINMESH ) );
+		
+		strcpy( md5binmesh.shader, md5mesh->shader );
+		
+		md5binmesh.n_vertex	  = md5mesh->n_vertex;
+		md5binmesh.n_triangle = md5mesh->md5triangle ? md5mesh->n_triangle : 0;
+		md5binmesh.n_weight	  = md5mesh->n_weight;
+		md5binmesh.mode		  = md5mesh->mode;
+		md5binmesh.n_indice	  = md5mesh->indice ? md5mesh->n_indice : 0;
+		
+		md5binmesh.md5vertex   = OBJ_append_bin( &buffer, &size, md5mesh->md5vertex  , md5binmesh.n_vertex   * sizeof( MD5VERTEX )		, OBJ_BIN_ALIGNMENT );
+		md5binmesh.md5triangle = OBJ_append_bin( &buffer, &size, md5mesh->md5triangle, md5binmesh.n_triangle * sizeof( MD5TRIANGLE )	, OBJ_BIN_ALIGNMENT );
+		md5binmesh.md5weight   = OBJ_append_bin( &buffer, &size, md5mesh->md5weight  , md5binmesh.n_weight   * sizeof( MD5WEIGHT )		, OBJ_BIN_ALIGNMENT );
+		md5binmesh.indice	   = OBJ_append_bin( &buffer, &size, md5mesh->indice	 , md5binmesh.n_indice   * sizeof( unsigned short ), OBJ_BIN_ALIGNMENT );
+		
+		memcpy( buffer + md5binheader.md5mesh + ( i * sizeof( MD5BINMESH ) ),
+				&md5binmesh,
+				sizeof( MD5BINMESH ) );
+		++i;
+	}
+	
+	
+	strcpy( md5binheader.magic, MD5_BIN_MAGIC );
+	
+	md5binheader.version = MD5_BIN_VERSION;
+	md5binheader.n_joint = md5->n_joint;
+	md5binheader.n_mesh	 = md5->n_mesh;
+	md5binheader.size	 = size;
+	
+	memcpy( buffer, &md5binheader, sizeof( MD5BINHEADER ) );
+	
+	result = MD5_write_bin( buffer, size, filename );
+	
+	free( buffer );
+	
+	return result;
+}
+
+
+/*!
+	Load a .gfxmd5 file created with MD5_save_bin and create an MD5 structure pointer. The
+	arrays are copied as is from the memory mapped file and the weighted normals and tangents
+	are already calculated, so the MD5 is ready for MD5_build, MD5_build2 or MD5_build3.
+	
+	\param[in] filename The .gfxmd5 filename to load.
+	\param[in] relative_path Determine if the filename is relative to the application or an absolute path.
+	
+	\return Return a new MD5 structure pointer, or NULL if the file cannot be loaded.
+*/
+MD5 *MD5_load_bin( char *filename, unsigned char relative_path )
+{
+	unsigned int i;
+	
+	MD5 *md5 = NULL;
+	
+	MD5BINHEADER *md5binheader;
+	
+	MD5BINMESH *md5binmesh;
+	
+	MEMORY *m = mmopen( filename, relative_path );
+	
+	if( !m ) return md5;
+	
+	md5binheader = ( MD5BINHEADER * )m->buffer;
+	
+	if( m->size < sizeof( MD5BINHEADER )						  ||
+		strncmp( md5binheader->magic, MD5_BIN_MAGIC, 8 ) ||
+		md5binheader->version != MD5_BIN_VERSION				  ||
+		md5binheader->size	  != m->size )
+	{
+		mclose( m );
+		return md5;
+	}
+	
+	md5binmesh = ( MD5BINMESH * )&m->buffer[ md5binheader->md5mesh ];
+	
+	// Reject the file if any of its arrays is out of bounds.
+	if( !MD5_check_bin( m, md5binheader->md5joint, md5binheader->n_joint, sizeof( MD5JOINT ) ) ||
+		!MD5_check_bin( m, md5binheader->location, md5binheader->n_joint, sizeof( vec3 )	 ) ||
+		!MD5_check_bin( m, md5binheader->rotation, md5binheader->n_joint, sizeof( vec4 )	 ) ||
+		!MD5_check_bin( m, md5binheader->md5mesh , md5binheader->n_mesh , sizeof( MD5BINMESH ) ) )
+	{
+		mclose( m );
+		return md5;
+	}
+	
+	i = 0;
+	while( i != md5binheader->n_mesh )
+	{
+		if( !MD5_check_bin( m, md5binmesh[ i ].md5vertex  , md5binmesh[ i ].n_vertex  , sizeof( MD5VERTEX )		) ||
+			!MD5_check_bin( m, md5binmesh[ i ].md5triangle, md5binmesh[ i ].n_triangle, sizeof( MD5TRIANGLE )	) ||
+			!MD5_check_bin( m, md5binmesh[ i ].md5weight  , md5binmesh[ i ].n_weight  , sizeof( MD5WEIGHT )		) ||
+			!MD5_check_bin( m, md5binmesh[ i ].indice	  , md5binmesh[ i ].n_indice  , sizeof( unsigned short ) ) ||
+			!memchr( md5binmesh[ i ].shader, 0, sizeof( md5binmesh[ i ].shader ) ) )
+		{
+			mclose( m );
+			return md5;
+		}
+		
+		++i;
+	}
+	
+	// Reject the file if any of its joint, weight or vertex indices is out of range.
+	if( !MD5_check_bin_indices( m, md5binheader ) )
+	{
+		mclose( m );
+		return md5;
+	}
+	
+	md5 = ( MD5 * ) calloc( 1, sizeof( MD5 ) );
+	
+	get_file_name( filename, md5->name );
+	
+	md5->distance =
+	md5->scale.x  =
+	md5->scale.y  =
+	md5->scale.z  = 1.0f;
+	md5->visible  = 1;
+	
+	md5->weighted_normals_tangents = 1;
+	
+	md5->n_joint = md5binheader->n_joint;
+	
+	md5->md5joint = ( MD5JOINT * ) MD5_copy_bin( m, md5binheader->md5joint, md5->n_joint * sizeof( MD5JOINT ) );
+	
+	md5->bind_pose.location = ( vec3 * ) MD5_copy_bin( m, md5binheader->location, md5->n_joint * sizeof( vec3 ) );
+	
+	md5->bind_pose.rotation = ( vec4 * ) MD5_copy_bin( m, md5binheader->rotation, md5->n_joint * sizeof( vec4 ) );
+	
+	
+	md5->n_mesh = md5binheader->n_mesh;
+	
+	if( md5->n_mesh ) md5->md5mesh = ( MD5MESH * ) calloc( md5->n_mesh, sizeof( MD5MESH ) );
+	
+	i = 0;
+	while( i != md5->n_mesh )
+	{
+		MD5MESH *md5mesh = &md5->md5mesh[ i ];
+		
+		strcpy( md5mesh->shader, md5binmesh[ i ].shader );
+		
+		md5mesh->visible	= 1;
+		md5mesh->mode		= md5binmesh[ i ].mode;
+		md5mesh->n_vertex	= md5binmesh[ i ].n_vertex;
+		md5mesh->n_triangle = md5binmesh[ i ].n_triangle;
+		md5mesh->n_weight	= md5binmesh[ i ].n_weight;
+		md5mesh->n_indice	= md5binmesh[ i ].n_indice;
+		
+		md5mesh->md5vertex	 = ( MD5VERTEX *	  ) MD5_copy_bin( m, md5binmesh[ i ].md5vertex  , md5mesh->n_vertex   * sizeof( MD5VERTEX )		 );
+		md5mesh->md5triangle = ( MD5TRIANGLE *	  ) MD5_copy_bin( m, md5binmesh[ i ].md5triangle, md5mesh->n_triangle * sizeof( MD5TRIANGLE )	 );
+		md5mesh->md5weight	 = ( MD5WEIGHT *	  ) MD5_copy_bin( m, md5binmesh[ i ].md5weight  , md5mesh->n_weight   * sizeof( MD5WEIGHT )		 );
+		md5mesh->indice		 = ( unsigned short * ) MD5_copy_bin( m, md5binmesh[ i ].indice	    , md5mesh->n_indice   * sizeof( unsigned short ) );
+		
+		++i;
+	}
+	
+	mclose( m );
+	
+	return md5;
+}
+
+
+/*!
+	Compile an MD5ACTION to a .gfxmd5anim binary file. The file contains the final object space
+	joint locations and rotations of every frame (quantized or not, see MD5_quantize_action),
+	so it can be loaded back using MD5_load_action_bin without any parsing or processing.
+	
+	\param[in] md5 A valid MD5 structure pointer.
+	\param[in] md5action A valid MD5ACTION structure pointer of the MD5.
+	\param[in] filename The .gfxmd5anim filename to create.
+	
+	\return Return 1 if the file was created successfully, else return 0.
+*/
+unsigned char MD5_save_action_bin( MD5 *md5, MD5ACTION *md5action, char *filename )
+{
+	unsigned int size = 0,
+				 n	  = md5action->n_frame * md5->n_joint;
+	
+	unsigned char *buffer = NULL,
+				  result;
+	
+	MD5BINHEADER md5binheader;
+	
+	if( md5action->md5track ) return 0;
+	
+	
+	memset( &md5binheader, 0, sizeof( MD5BINHEADER ) );
+	
+	OBJ_append_bin( &buffer, &size, NULL, sizeof( MD5BINHEADER ), 4 );
+	
+	if( n )
+	{
+		md5binheader.quantized = md5action->frame[ 0 ].qrotation != NULL;
+		
+		md5binheader.location = OBJ_append_bin( &buffer, &size, md5action->frame[ 0 ].location, n * sizeof( vec3 ), OBJ_BIN_ALIGNMENT );
+		
+		md5binheader.rotation = md5binheader.quantized ?
+								OBJ_append_bin( &buffer, &size, md5action->frame[ 0 ].qrotation, n * 4 * sizeof( short ), OBJ_BIN_ALIGNMENT ) :
+								OBJ_append_bin( &buffer, &size, md5action->frame[ 0 ].rotation , n * sizeof( vec4 )		 , OBJ_BIN_ALIGNMENT );
+	}
+	
+	strcpy( md5binheader.magic, MD5_BIN_ACTION_MAGIC );
+	
+	md5binheader.version = MD5_BIN_VERSION;
+	md5binheader.n_joint = md5->n_joint;
+	md5binheader.n_frame = md5action->n_frame;
+	md5binheader.fps	 = md5action->fps;
+	md5binheader.size	 = size;
+	
+	memcpy( buffer, &md5binheader, sizeof( MD5BINHEADER ) );
+	
+	result = MD5_write_bin( buffer, size, filename );
+	
+	free( buffer );
+	
+	return result;
+}
+
+
+/*!
+	Load a .gfxmd5anim file created with MD5_save_action_bin. The frames are copied as is from
+	the memory mapped file, they are already in object space.
+	
+	\param[in] md5 A valid MD5 structure pointer.
+	\param[in] name The internal name to use for the new action.
+	\param[in] filename The .gfxmd5anim filename to load.
+	\param[in] relative_path Determine if the filename is relative to the application or an absolute path.
+	
+	\return Return the new action index (>=0) or -1 if the loading operation fails.
+*/
+int MD5_load_action_bin( MD5 *md5, char *name, char *filename, unsigned char relative_path )
+{
+	unsigned int i = 0,
+				 n;
+	
+	MD5ACTION *md5action;
+	
+	MD5BINHEADER *md5binheader;
+	
+	MEMORY *m = mmopen( filename, relative_path );
+	
+	if( !m ) return -1;
+	
+	md5binheader = ( MD5BINHEADER * )m->buffer;
+	
+	if( m->size < sizeof( MD5BINHEADER )							 ||
+		strncmp( md5binheader->magic, MD5_BIN_ACTION_MAGIC, 8 ) ||
+		md5binheader->version != MD5_BIN_VERSION					 ||
+		md5binheader->size	  != m->size						 ||
+		md5binheader->n_joint != md5->n_joint )
+	{
+		mclose( m );
+		return -1;
+	}
+	
+	// Reject the file if the number of joint poses overflows or if the frames are out of bounds.
+	n = md5binheader->n_frame * md5->n_joint;
+	
+	if( ( md5->n_joint && md5binheader->n_frame > 0xFFFFFFFF / md5->n_joint ) ||
+		!MD5_check_bin( m, md5binheader->location, n, sizeof( vec3 ) ) ||
+		!MD5_check_bin( m, md5binheader->rotation, n, md5binheader->quantized ? 4 * sizeof( short ) : sizeof( vec4 ) ) )
+	{
+		mclose( m );
+		return -1;
+	}
+	
+	++md5->n_action;
+	
+	md5->md5action = ( MD5ACTION * ) realloc( md5->md5action,
+											  md5->n_action * sizeof( MD5ACTION ) );
+
+	md5action = &md5->md5action[ md5->n_action - 1 ];
+
+	memset( md5action, 0, sizeof( MD5ACTION ) );
+
+	strcpy( md5action->name, name );
+	
+	md5action->curr_frame = 0;
+	md5action->next_frame = 1;
+	md5action->fps		  = md5binheader->fps;
+	md5action->n_frame	  = md5binheader->n_frame;
+	
+	MD5_init_pose( md5, &md5action->pose );
+	
+	if( md5action->n_frame )
+	{
+		vec3 *location;
+		
+		vec4 *rotation	= NULL;
+		
+		short *qrotation = NULL;
+		
+		location = ( vec3 * ) MD5_copy_bin( m, md5binheader->location, n * sizeof( vec3 ) );
+		
+		if( md5binheader->quantized ) qrotation = ( short * ) MD5_copy_bin( m, md5binheader->rotation, n * 4 * sizeof( short ) );
+		
+		else rotation = ( vec4 * ) MD5_copy_bin( m, md5binheader->rotation, n * sizeof( vec4 ) );
+		
+		md5action->frame = ( MD5POSE * ) calloc( md5action->n_frame, sizeof( MD5POSE ) );
+		
+		while( i != md5action->n_frame )
+		{
+			md5action->frame[ i ].location = &location[ i * md5->n_joint ];
+			
+			if( qrotation ) md5action->frame[ i ].qrotation = &qrotation[ i * md5->n_joint * 4 ];
+			
+			else md5action->frame[ i ].rotation = &rotation[ i * md5->n_joint ];
+			
+			++i;
+		}
+	}
+	
+	mclose( m );
+	
+	return ( md5->n_action - 1 );
+}
+
+
+/*!
+	Build the VBO and VAO for a specific MD5.
+	
+	\param[in,out] md5 A valid MD5 structure pointer.
+*/
+void MD5_build( MD5 *md5 )
+{
+	unsigned int i = 0;
+	
+	while( i != md5->n_mesh )
+	{
+		MD5MESH *md5mesh = &md5->md5mesh[ i ];
+	
+		MD5_build_vbo( md5, i );
+		
+		glGenVertexArraysOES( 1, &md5mesh->vao );
+		
+		GFX_bind_vertex_array( md5mesh->vao );	
+		
+		MD5_set_mesh_attributes( md5mesh );
+
+		GFX_bind_vertex_array( 0 );
+
+		++i;
+	}
+
+	// The weighted normals and tangents are calculated from the bind pose vertex positions.
+	if( !md5->weighted_normals_tangents )
+	{
+		MD5_skin_pose( md5, &md5->bind_pose, 0 );
+	
+		MD5_build_bind_pose_weighted_normals_tangents( md5 );
+	}
+
+	MD5_set_pose( md5, &md5->bind_pose );
+	
+	MD5_update_bound_mesh( md5 );
+	
+	MD5_build_joint_bounds( md5 );
+}
+
+
+/*!
+	Only build the VBO for a specific MD5 pointer.
+	
+	\param[in,out] md5 A valid MD5 structure pointer.	
+*/
+void MD5_build2( MD5 *md5 )
+{
+	unsigned int i = 0;
+	
+	while( i != md5->n_mesh )
+	{
+		MD5_build_vbo( md5, i );
+
+		++i;
+	}
+
+	// The weighted normals and tangents are calculated from the bind pose vertex positions.
+	if( !md5->weighted_normals_tangents )
+	{
+		MD5_skin_pose( md5, &md5->bind_pose, 0 );
+	
+		MD5_build_bind_pose_weighted_normals_tangents( md5 );
+	}
+
+	MD5_set_pose( md5, &md5->bind_pose );
+	
+	MD5_update_bound_mesh( md5 );	
+	
+	MD5_build_joint_bounds( md5 );
+}
+
+
+/*!
+	Function internally used to get where the PALETTE uniform of an MD5MESH skinned on the GPU is
+	uploaded: the PROGRAM of its OBJMATERIAL if it tracks the uniform, else the program in use. The
+	uniform name id is interned by the first call, and the location in the program in use is only
+	queried again when the program changes.
+	
+	\param[in] md5mesh A valid MD5MESH structure pointer.
+	\param[in,out] id Receive the name id of the PALETTE uniform.
+	\param[in,out] location Receive the location of the uniform in the program in use, or -1 if
+	the program does not expose it. Only set when no PROGRAM is returned.
+	
+	\return Return the PROGRAM tracking the uniform, or NULL to upload it using the location.
+*/
+PROGRAM *MD5_get_palette_program( MD5MESH *md5mesh, unsigned int *id, int *location )
+{
+	static int palette_id		= -1,
+			   palette_location = -1;
+	
+	static unsigned int location_program = 0;
+	
+	PROGRAM *program = md5mesh->objmaterial ? md5mesh->objmaterial->program : NULL;
+	
+	if( palette_id == -1 ) palette_id = PROGRAM_get_name_id( ( char * )"PALETTE" );
+	
+	*id = palette_id;
+	
+	if( program && PROGRAM_get_uniform( program, palette_id ) ) return program;
+	
+	if( location_program != gfx.state.program )
+	{
+		palette_location = gfx.state.program ? glGetUniformLocation( gfx.state.program, "PALETTE" ) : -1;
+		location_program = gfx.state.program;
+	}
+	
+	*location = palette_location;
+	
+	return NULL;
+}
+
+
+/*!
+	Build the VBO and VAO for a specific MD5 to be skinned on the GPU using joint matrix palettes.
+	Each vertex receive the indices of its 4 most influent joints inside the palette (attribute 4,
+	JOINT) and their weights (attribute 5, WEIGHT) on top of its bind pose position, normal, UV
+	and tangent. The MD5MESH are split in palettes that fit the uniform limits, and when drawing
+	only the skinning matrices of each palette are uploaded to the PALETTE uniform, the vertex
+	buffers are never updated. The vertex shader should skin the vertices using:
+	
+	attribute vec4 JOINT;
+	attribute vec4 WEIGHT;
+	uniform vec4 PALETTE[ MD5_PALETTE_SIZE * 3 ];
+	
+	vec3 skin( vec4 v )
+	{
+		vec3 r = vec3( 0.0 );
+		for( int i = 0; i < 4; ++i )
+		{
+			int j = int( JOINT[ i ] ) * 3;
+			r += WEIGHT[ i ] * vec3( dot( PALETTE[ j ], v ), dot( PALETTE[ j + 1 ], v ), dot( PALETTE[ j + 2 ], v ) );
+		}
+		return r;
+	}
+	
+	Using w = 1 for the POSITION and w = 0 for the NORMAL and TANGENT0. The PALETTE is uploaded
+	through the PROGRAM of the OBJMATERIAL of the MD5MESH if any, else to the program in use.
+	
+	\param[in,out] md5 A valid MD5 structure pointer.
+	\param[in] palette_size The maximum number of joints per palette (0 to use MD5_PALETTE_SIZE).
+	Each joint use 3 uniform vectors, so it is clamped to leave 32 of the GL_MAX_VERTEX_UNIFORM_VECTORS
+	of the device to the other uniforms (between 12 and 256 joints).
+	
+	\note An MD5MESH that would need more than 65536 vertices once split, or whose PROGRAM (the
+	program in use without one) does not expose the PALETTE uniform, is skinned on the CPU, so the
+	material or the program should be set before the build. The joints of a vertex should share the same bind pose position, as it is the case for
+	the exporters, else the GPU skinning only approximate the CPU one. Like the reduced weights
+	of an MD5LOD, the weights of a vertex are renormalized to sum to 1.
+*/
+void MD5_build3( MD5 *md5, unsigned int palette_size )
+{
+	unsigned int i = 0;
+	
+	int max_vector = 0;
+	
+	if( !palette_size ) palette_size = MD5_PALETTE_SIZE;
+	
+	glGetIntegerv( GL_MAX_VERTEX_UNIFORM_VECTORS, &max_vector );
+	
+	// OpenGLES 2.0 guarantees at least 128 vectors, and the JOINT indices are stored in bytes.
+	max_vector = CLAMP( max_vector, 128, 32 + 256 * 3 );
+	
+	palette_size = CLAMP( palette_size, 12, ( unsigned int )( max_vector - 32 ) / 3 );
+	
+	while( i != md5->n_mesh )
+	{
+		MD5_build_vertex_data( &md5->md5mesh[ i ] );
+		++i;
+	}
+	
+	if( !md5->weighted_normals_tangents )
+	{
+		MD5_skin_pose( md5, &md5->bind_pose, 0 );
+	
+		MD5_build_bind_pose_weighted_normals_tangents( md5 );
+	}
+
+	MD5_skin_pose( md5, &md5->bind_pose, 0 );
+	
+	MD5_update_bound_mesh( md5 );
+	
+	MD5_build_joint_bounds( md5 );
+	
+	
+	md5->inverse_bind_matrix = ( mat4 * ) malloc( md5->n_joint * sizeof( mat4 ) );
+	
+	MD5_build_joint_matrices( md5, &md5->bind_pose, md5->inverse_bind_matrix );
+	
+	i = 0;
+	while( i != md5->n_joint )
+	{
+		mat4_invert_full( &md5->inverse_bind_matrix[ i ] );
+		++i;
+	}
+	
+	
+	i = 0;
+	while( i != md5->n_mesh )
+	{
+		MD5MESH *md5mesh = &md5->md5mesh[ i ];
+		
+		unsigned int id;
+		
+		int location = -1;
+		
+		// Skinned on the CPU when there is no PALETTE uniform to upload the matrices to.
+		if( ( !MD5_get_palette_program( md5mesh, &id, &location ) && location == -1 ) ||
+			!MD5_build_palette_mesh( md5, i, palette_size ) ) MD5_build_vbo( md5, i );
+		
+		glGenVertexArraysOES( 1, &md5mesh->vao );
+		
+		GFX_bind_vertex_array( md5mesh->vao );	
+		
+		MD5_set_mesh_attributes( md5mesh );
+
+		GFX_bind_vertex_array( 0 );
+
+		++i;
+	}
+	
+	MD5_set_pose( md5, &md5->bind_pose );
+}
+
+
+/*!
+	Create an instance of an MD5 that is ready to be drawn. The instance shares the skeleton, the
+	mesh geometry (vertices, weights and indices), the index VBOs and the action frames of the
+	MD5, and only owns its location, rotation and scale, the play state and pose of its actions
+	and its skinned vertices (with their VBO and VAO). The MD5MESH skinned on the GPU also share
+	their vertex data and VBO, and only own the matrices of their MD5PALETTE.
+	
+	All the actions have to be loaded (and compressed if needed) and the MD5 built before
+	creating instances, and the MD5 must be freed after all its instances. An instance is freed
+	using MD5_free, and can be used with all the other MD5 functions except the ones that load,
+	build or optimize the MD5.
+	
+	\param[in] md5 A valid MD5 structure pointer that have been built (not an instance).
+	\param[in] name The internal name to use for the instance.
+	
+	\return Return a new MD5 structure pointer that is an instance of the MD5.
+*/
+MD5 *MD5_create_instance( MD5 *md5, char *name )
+{
+	unsigned int i = 0,
+				 j;
+	
+	MD5 *instance = ( MD5 * ) malloc( sizeof( MD5 ) );
+	
+	memcpy( instance, md5, sizeof( MD5 ) );
+	
+	strcpy( instance->name, name );
+	
+	instance->distance =
+	instance->scale.x  =
+	instance->scale.y  =
+	instance->scale.z  = 1.0f;
+	instance->visible  = 1;
+	instance->instance = 1;
+	
+	memset( &instance->location, 0, sizeof( vec3 ) );
+	memset( &instance->rotation, 0, sizeof( vec3 ) );
+	
+	instance->btrigidbody = NULL;
+	
+	
+	if( md5->n_mesh )
+	{
+		instance->md5mesh = ( MD5MESH * ) malloc( md5->n_mesh * sizeof( MD5MESH ) );
+		
+		memcpy( instance->md5mesh, md5->md5mesh, md5->n_mesh * sizeof( MD5MESH ) );
+	}
+	
+	while( i != md5->n_mesh )
+	{
+		MD5MESH *md5mesh = &instance->md5mesh[ i ];
+		
+		if( md5mesh->n_md5palette )
+		{
+			md5mesh->md5palette = ( MD5PALETTE * ) malloc( md5mesh->n_md5palette * sizeof( MD5PALETTE ) );
+			
+			memcpy( md5mesh->md5palette, md5->md5mesh[ i ].md5palette, md5mesh->n_md5palette * sizeof( MD5PALETTE ) );
+			
+			j = 0;
+			while( j != md5mesh->n_md5palette )
+			{
+				MD5PALETTE *md5palette = &md5mesh->md5palette[ j ];
+				
+				md5palette->matrix = ( vec4 * ) malloc( md5palette->n_joint * 3 * sizeof( vec4 ) );
+				
+				memcpy( md5palette->matrix, md5->md5mesh[ i ].md5palette[ j ].matrix, md5palette->n_joint * 3 * sizeof( vec4 ) );
+				++j;
+			}
+		}
+		else
+		{
+			md5mesh->vertex_data = ( unsigned char * ) malloc( md5mesh->size );
+			
+			memcpy( md5mesh->vertex_data, md5->md5mesh[ i ].vertex_data, md5mesh->size );
+			
+			glGenBuffers( 1, &md5mesh->vbo );
+			
+			GFX_bind_buffer( GL_ARRAY_BUFFER, md5mesh->vbo );
+			
+			glBufferData( GL_ARRAY_BUFFER,
+						  md5mesh->size,
+						  md5mesh->vertex_data,
+						  GL_DYNAMIC_DRAW );
+			
+			// The VAO of the MD5 is still referenced by the copy, create one if the MD5 have one.
+			if( md5->md5mesh[ i ].vao )
+			{
+				glGenVertexArraysOES( 1, &md5mesh->vao );
+				
+				GFX_bind_vertex_array( md5mesh->vao );
+				
+				MD5_set_mesh_attributes( md5mesh );
+				
+				GFX_bind_vertex_array( 0 );
 			}
 		}
-		else
-		{
-			memcpy( &final_pose[ i ].location, &action0->pose[ i ].location, sizeof( vec3 ) );
-			memcpy( &final_pose[ i ].rotation, &action0->pose[ i ].rotation, sizeof( vec4 ) );
-		}
-
+		
 		++i;
 	}
-}
-
-
-/*!
-	Calculate the min and max position of the MD5 mesh in bind position, as well as the bounding
-	box and bounding sphere.
 	
-	\param[in] md5 A valid MD5 structure pointer that the vertex data is available.
-*/
-void MD5_update_bound_mesh( MD5 *md5 )
-{
-	unsigned int i = 0,
-				 j;
-
-
-	// Get the mesh min and max.
-	md5->min.x =
-	md5->min.y =
-	md5->min.z = 99999.999f;
-
-	md5->max.x =
-	md5->max.y =
-	md5->max.z = -99999.999f;
-
-
-	while( i != md5->n_mesh )
+	GFX_bind_buffer( GL_ARRAY_BUFFER, 0 );
+	
+	
+	if( md5->n_action )
 	{
-		MD5MESH *md5mesh = &md5->md5mesh[ i ];
-		
-		vec3 *vertex_array = ( vec3 * )md5mesh->vertex_data;
+		instance->md5action = ( MD5ACTION * ) malloc( md5->n_action * sizeof( MD5ACTION ) );
 		
-		j = 0;
-		while( j != md5mesh->n_vertex )
-		{
-			if( vertex_array[ j ].x < md5->min.x ) md5->min.x = vertex_array[ j ].x;
-			if( vertex_array[ j ].y < md5->min.y ) md5->min.y = vertex_array[ j ].y;
-			if( vertex_array[ j ].z < md5->min.z ) md5->min.z = vertex_array[ j ].z;
-
-			if( vertex_array[ j ].x > md5->max.x ) md5->max.x = vertex_array[ j ].x;
-			if( vertex_array[ j ].y > md5->max.y ) md5->max.y = vertex_array[ j ].y;
-			if( vertex_array[ j ].z > md5->max.z ) md5->max.z = vertex_array[ j ].z;
+		memcpy( instance->md5action, md5->md5action, md5->n_action * sizeof( MD5ACTION ) );
+	}
 	
-			++j;
-		}
+	i = 0;
+	while( i != md5->n_action )
+	{
+		MD5ACTION *md5action = &instance->md5action[ i ];
+		
+		MD5_init_pose( md5, &md5action->pose );
 		
+		MD5_copy_pose( md5, &md5action->pose, &md5->md5action[ i ].pose );
+		
+		MD5_action_stop( md5action );
 		++i;
 	}
-
-
-	// Mesh dimension
-	vec3_diff( &md5->dimension,
-			   &md5->max,
-			   &md5->min );
-
-
-	// Bounding sphere radius
-	md5->radius = md5->dimension.x > md5->dimension.y ?
-				  md5->dimension.x:
-				  md5->dimension.y;
-	
-	md5->radius = md5->radius > md5->dimension.z ?
-				  md5->radius * 0.5f:
-				  md5->dimension.z * 0.5f;
 	
-	/*
-	md5->radius = vec3_dist( &md5->min,
-							 &md5->max ) * 0.5f;
-	*/
+	return instance;
 }
 
 
 /*!
-	Build the VBO and VAO for a specific MD5.
+	Set the animation levels of detail of an MD5. The level used is selected by MD5_draw_action
+	from the distance of the MD5 to the viewer (MD5::distance), the distant MD5 can then be updated
+	less often, snapped to their frames and skinned with less weights and without tangents. When
+	a level limits the number of weights per vertex, the weights of each vertex are sorted by
+	decreasing bias (which is shared with the instances of the MD5).
 	
 	\param[in,out] md5 A valid MD5 structure pointer.
+	\param[in] md5lod The array of MD5LOD sorted by increasing distance, the first level should
+	be at full detail. The array is not copied so it have to stay valid as long as the MD5 use it
+	(NULL to remove the levels of detail).
+	\param[in] n_md5lod The number of MD5LOD.
 */
-void MD5_build( MD5 *md5 )
+void MD5_set_lod( MD5 *md5, MD5LOD *md5lod, unsigned int n_md5lod )
 {
-	unsigned int i = 0;
+	unsigned int i = 0,
+				 j,
+				 k,
+				 l;
+	
+	unsigned char sort = 0;
+	
+	md5->md5lod		   = n_md5lod ? md5lod : NULL;
+	md5->n_md5lod	   = md5->md5lod ? n_md5lod : 0;
+	md5->lod		   =
+	md5->lod_skip	   = 0;
+	md5->lod_time_step = 0.0f;
 	
+	while( i != md5->n_md5lod )
+	{
+		if( md5->md5lod[ i ].max_weight ) sort = 1;
+		++i;
+	}
+	
+	if( !sort ) return;
+	
+	i = 0;
 	while( i != md5->n_mesh )
 	{
 		MD5MESH *md5mesh = &md5->md5mesh[ i ];
-	
-		MD5_build_vbo( md5, i );
 		
-		glGenVertexArraysOES( 1, &md5mesh->vao );
-		
-		glBindVertexArrayOES( md5mesh->vao );	
+		j = 0;
+		while( j != md5mesh->n_vertex )
+		{
+			MD5WEIGHT *md5weight = &md5mesh->md5weight[ md5mesh->md5vertex[ j ].start ];
+			
+			k = 1;
+			while( k < md5mesh->md5vertex[ j ].count )
+			{
+				MD5WEIGHT w = md5weight[ k ];
+				
+				l = k;
+				while( l && md5weight[ l - 1 ].bias < w.bias )
+				{
+					md5weight[ l ] = md5weight[ l - 1 ];
+					--l;
+				}
+				
+				md5weight[ l ] = w;
+				++k;
+			}
+			
+			++j;
+		}
 		
-		MD5_set_mesh_attributes( md5mesh );
-
-		glBindVertexArrayOES( 0 );
-
 		++i;
 	}
-
-	MD5_set_pose( md5, md5->bind_pose );
-	
-	MD5_build_bind_pose_weighted_normals_tangents( md5 );
-
-	MD5_set_pose( md5, md5->bind_pose );
-	
-	MD5_update_bound_mesh( md5 );
 }
 
 
 /*!
-	Only build the VBO for a specific MD5 pointer.
+	Function internally used to move an LERP or SLERP action to its next frame.
 	
-	\param[in,out] md5 A valid MD5 structure pointer.	
+	\param[in,out] md5action A valid MD5ACTION structure pointer.
+	
+	\return Return 0 if the action reached its end and have been stopped, else return 1.
 */
-void MD5_build2( MD5 *md5 )
+unsigned char MD5_next_frame( MD5ACTION *md5action )
 {
-	unsigned int i = 0;
+	++md5action->curr_frame;
+
+	md5action->next_frame = ( md5action->curr_frame + 1 );
 	
-	while( i != md5->n_mesh )
+	if( md5action->loop )
 	{
-		MD5_build_vbo( md5, i );
+		if( md5action->curr_frame == md5action->n_frame )
+		{
+			md5action->curr_frame = 0;
+			md5action->next_frame = 1;
+		}								
 
-		++i;
+		if( md5action->next_frame == md5action->n_frame )
+		{ md5action->next_frame = 0; }				
+	}
+	else
+	{
+		if( md5action->next_frame == md5action->n_frame )
+		{
+			MD5_action_stop( md5action );
+			return 0;
+		}
 	}
-
-	MD5_set_pose( md5, md5->bind_pose );
-	
-	MD5_build_bind_pose_weighted_normals_tangents( md5 );	
-
-	MD5_set_pose( md5, md5->bind_pose );
 	
-	MD5_update_bound_mesh( md5 );	
+	return 1;
 }
 
 
 /*!
 	Update all actions time. This function will cause to refresh and update all the
-	current MD5ACTIONS that are set to PLAY by the time_step received in parameter.
+	current MD5ACTIONS that are set to PLAY by the time_step received in parameter. If the
+	MD5 have levels of detail, the level matching its distance is selected first. \sa MD5_set_lod
 	
 	\param[in,out] md5 A valid MD5 structure pointer.
 	\param[in] time_step The delta time of the application. In other words a value from 0 to 1 (which is 1 second)
 	that represent how much time have elapsed since the last sync. 
+	
+	\return Return 1 if the pose of at least one action have been updated, else return 0.
 */
 unsigned char MD5_draw_action( MD5 *md5, float time_step )
 {
@@ -1356,6 +4451,29 @@ unsigned char MD5_draw_action( MD5 *md5, float time_step )
 	
 	unsigned char update = 0;
 	
+	MD5LOD *md5lod = NULL;
+	
+	if( md5->md5lod )
+	{
+		md5->lod = 0;
+		
+		while( md5->lod + 1 != md5->n_md5lod && md5->distance >= md5->md5lod[ md5->lod + 1 ].distance ) ++md5->lod;
+		
+		md5lod = &md5->md5lod[ md5->lod ];
+		
+		// Only update the animation once every update_rate calls, using the time accumulated in between.
+		md5->lod_time_step += time_step;
+		
+		++md5->lod_skip;
+		
+		if( md5->lod_skip < md5lod->update_rate ) return 0;
+		
+		time_step = md5->lod_time_step;
+		
+		md5->lod_skip	   = 0;
+		md5->lod_time_step = 0.0f;
+	}
+	
 	while( i != md5->n_action )
 	{
 		MD5ACTION *md5action = &md5->md5action[ i ];
@@ -1368,11 +4486,9 @@ unsigned char MD5_draw_action( MD5 *md5, float time_step )
 			{
 				case MD5_METHOD_FRAME:
 				{
-					if( md5action->frame_time >= md5action->fps )
+					while( md5action->frame_time >= md5action->fps )
 					{
-						memcpy( md5action->pose,
-								md5action->frame[ md5action->curr_frame ],
-								md5->n_joint * sizeof( MD5JOINT ) );
+						MD5_sample_action( md5, md5action, &md5action->pose, 0.0f );
 						
 						++md5action->curr_frame;
 
@@ -1402,45 +4518,36 @@ unsigned char MD5_draw_action( MD5 *md5, float time_step )
 				case MD5_METHOD_LERP:
 				case MD5_METHOD_SLERP:					
 				{
-					float t = CLAMP( md5action->frame_time / md5action->fps, 0.0f, 1.0f );
-
-					MD5_blend_pose( md5,
-							 	    md5action->pose,
-									md5action->frame[ md5action->curr_frame ],
-									md5action->frame[ md5action->next_frame ],
-									md5action->method,
-									t );
-
-					if( t >= 1.0f )
+					float t;
+					
+					unsigned char frame = md5lod && md5lod->frame;
+					
+					// Skip the frames that the time step entirely covers.
+					while( md5action->frame_time >= 2.0f * md5action->fps )
 					{
-						++md5action->curr_frame;
+						md5action->frame_time -= md5action->fps;
+						
+						if( !MD5_next_frame( md5action ) ) break;
+					}
+					
+					if( md5action->state != PLAY ) break;
+					
+					t = CLAMP( md5action->frame_time / md5action->fps, 0.0f, 1.0f );
 
-						md5action->next_frame = ( md5action->curr_frame + 1 );
+					// When snapped to the frames the pose only changes when reaching the next frame.
+					if( !frame || t >= 1.0f )
+					{
+						MD5_sample_action( md5, md5action, &md5action->pose, frame ? 1.0f : t );
 						
-						if( md5action->loop )
-						{
-							if( md5action->curr_frame == md5action->n_frame )
-							{
-								md5action->curr_frame = 0;
-								md5action->next_frame = 1;
-							}								
+						update = 1;
+					}
 
-							if( md5action->next_frame == md5action->n_frame )
-							{ md5action->next_frame = 0; }				
-						}
-						else
-						{
-							if( md5action->next_frame == md5action->n_frame )
-							{
-								MD5_action_stop( md5action );
-								break;
-							}
-						}
+					if( t >= 1.0f )
+					{
+						if( !MD5_next_frame( md5action ) ) break;
 						
 						md5action->frame_time -= md5action->fps;
 					}
-					
-					update = 1;
 
 					break;
 				}
@@ -1454,6 +4561,178 @@ unsigned char MD5_draw_action( MD5 *md5, float time_step )
 }
 
 
+//! Internal structure used to share the MD5UPDATE of MD5_update_batch between threads.
+typedef struct
+{
+	//! The array of MD5UPDATE.
+	MD5UPDATE		*md5update;
+	
+	//! The number of MD5UPDATE.
+	unsigned int	n_md5update;
+	
+	//! The index of the next MD5UPDATE to process, shared by all the workers.
+	unsigned int	next;
+
+} MD5UPDATETASK;
+
+
+/*!
+	Function internally used as THREAD_dispatch callback to update MD5 instances. Each worker
+	takes the next MD5UPDATE that is not processed yet, so the instances that are more expensive
+	to skin do not stall the other workers.
+	
+	\param[in,out] userdata The MD5UPDATETASK.
+	\param[in] index The worker index (unused).
+	\param[in] n_thread The number of workers (unused).
+*/
+void MD5_update_instances( void *userdata, unsigned int index, unsigned int n_thread )
+{
+	MD5UPDATETASK *md5updatetask = ( MD5UPDATETASK * )userdata;
+	
+	unsigned int i = __sync_fetch_and_add( &md5updatetask->next, 1 );
+	
+	( void )index;
+	( void )n_thread;
+	
+	while( i < md5updatetask->n_md5update )
+	{
+		MD5UPDATE *md5update = &md5updatetask->md5update[ i ];
+		
+		md5update->update = MD5_draw_action( md5update->md5, md5update->time_step );
+		
+		if( md5update->update )
+		{
+			if( md5update->action1 )
+			{
+				MD5_add_pose( md5update->md5,
+							  md5update->pose,
+							  md5update->action0,
+							  md5update->action1,
+							  md5update->joint_interpolation_method,
+							  md5update->action_weight );
+				
+				MD5_skin_pose( md5update->md5, md5update->pose, 1 );
+				
+				MD5_update_bound_pose( md5update->md5, md5update->pose );
+			}
+			else
+			{
+				MD5_skin_pose( md5update->md5, &md5update->action0->pose, 1 );
+				
+				MD5_update_bound_pose( md5update->md5, &md5update->action0->pose );
+			}
+		}
+		
+		i = __sync_fetch_and_add( &md5updatetask->next, 1 );
+	}
+}
+
+
+/*!
+	Update the animation of multiple MD5 at once. For each MD5UPDATE the actions of the MD5 are
+	advanced (MD5_draw_action), its pose is evaluated (the pose of action0, or MD5_add_pose when
+	action1 is set), skinned and its bounds updated (MD5_update_bound_pose), and the MD5 instances
+	are shared between multiple threads. Since
+	this function does not make any OpenGLES calls, call MD5_upload_batch from the GL thread
+	afterwards to upload the skinned vertices.
+	
+	\param[in,out] md5update The array of MD5UPDATE, each MD5 must only appear once.
+	\param[in] n_md5update The number of MD5UPDATE.
+	\param[in] n_thread The maximum number of threads to use (0 to use one thread per processor).
+*/
+void MD5_update_batch( MD5UPDATE *md5update, unsigned int n_md5update, unsigned int n_thread )
+{
+	MD5UPDATETASK md5updatetask;
+	
+	if( !n_md5update ) return;
+	
+	md5updatetask.md5update	  = md5update;
+	md5updatetask.n_md5update = n_md5update;
+	md5updatetask.next		  = 0;
+	
+	if( !n_thread ) n_thread = THREAD_get_cpu_count();
+	
+	if( n_thread > n_md5update ) n_thread = n_md5update;
+	
+	THREAD_dispatch( MD5_update_instances, &md5updatetask, n_thread );
+}
+
+
+/*!
+	Upload the vertices skinned by MD5_update_batch to the VBOs. Only the MD5 that have been
+	updated are uploaded, this function have to be called from the GL thread.
+	
+	\param[in] md5update The array of MD5UPDATE used with MD5_update_batch.
+	\param[in] n_md5update The number of MD5UPDATE.
+*/
+void MD5_upload_batch( MD5UPDATE *md5update, unsigned int n_md5update )
+{
+	unsigned int i = 0;
+	
+	while( i != n_md5update )
+	{
+		if( md5update[ i ].update ) MD5_upload_vertex_data( md5update[ i ].md5 );
+		++i;
+	}
+}
+
+
+/*!
+	Set all the necessary GLES machine state to draw a single MD5MESH. Unlike MD5_draw, the visibility
+	is not checked. An MD5MESH skinned on the GPU is drawn with one call per MD5PALETTE, after
+	uploading the palette matrices. \sa RENDERQUEUE_draw
+
+	\param[in] md5mesh A valid MD5MESH structure pointer.
+	
+	\return Return the number of indices sent for drawing. (Divided this number by 3 for knowing how many triangles)
+*/
+unsigned int MD5_draw_mesh( MD5MESH *md5mesh )
+{
+	if( md5mesh->objmaterial ) OBJ_draw_material( md5mesh->objmaterial );
+
+	if( md5mesh->vao ) GFX_bind_vertex_array( md5mesh->vao );
+
+	else MD5_set_mesh_attributes( md5mesh );
+	
+	if( md5mesh->n_md5palette )
+	{
+		unsigned int i = 0,
+					 n = 0,
+					 id;
+		
+		int location = -1;
+		
+		PROGRAM *program = MD5_get_palette_program( md5mesh, &id, &location );
+		
+		while( i != md5mesh->n_md5palette )
+		{
+			MD5PALETTE *md5palette = &md5mesh->md5palette[ i ];
+			
+			if( program ) PROGRAM_set_uniform( program, id, md5palette->matrix, md5palette->n_joint * 3 );
+
+			else if( location != -1 ) glUniform4fv( location, md5palette->n_joint * 3, ( float * )md5palette->matrix );
+			
+			glDrawElements( GL_TRIANGLES,
+							md5palette->n_indice,
+							GL_UNSIGNED_SHORT,
+							BUFFER_OFFSET( md5palette->first * sizeof( unsigned short ) ) );
+			
+			n += md5palette->n_indice;
+			++i;
+		}
+		
+		return n;
+	}
+	
+	glDrawElements( md5mesh->mode,
+					md5mesh->n_indice,
+					GL_UNSIGNED_SHORT,
+					( void * )NULL );
+					
+	return md5mesh->n_indice;
+}
+
+
 /*!
 	Draw an MD5 on screen if the MD5 is visible and its distance from the viewer
 	is greater than 0.
@@ -1472,23 +4751,7 @@ unsigned int MD5_draw( MD5 *md5 )
 	
 		while( i != md5->n_mesh )
 		{
-			MD5MESH *md5mesh = &md5->md5mesh[ i ];
-			
-			if( md5mesh->visible )
-			{
-				if( md5mesh->objmaterial ) OBJ_draw_material( md5mesh->objmaterial );
-			
-				if( md5mesh->vao ) glBindVertexArrayOES( md5mesh->vao );
-			
-				else MD5_set_mesh_attributes( md5mesh );
-				
-				glDrawElements( md5mesh->mode,
-								md5mesh->n_indice,
-								GL_UNSIGNED_SHORT,
-								( void * )NULL );
-								
-				n += md5mesh->n_indice;
-			}
+			if( md5->md5mesh[ i ].visible ) n += MD5_draw_mesh( &md5->md5mesh[ i ] );
 							
 			++i;
 		}
@@ -44,7 +44,7 @@ enum
 };
 
 
-//! Structure definition of a single joint.
+//! Structure definition of a single joint of the skeleton.
 typedef struct
 {
 	//! The internal name of the joint.
@@ -52,15 +52,55 @@ typedef struct
 	
 	//! The joint parent id in the skeleton MD5JOINT array.
 	int		parent;
-	
-	//! Location of the joint.
-	vec3	location;
-	
-	//! Rotation quaternion of the joint.
-	vec4	rotation;
   
 } MD5JOINT;
 
+
+//! Structure definition of a pose of the skeleton. The joint transforms are stored in tightly packed arrays indexed by joint, the names and parents are only stored once in the MD5 skeleton.
+typedef struct
+{
+	//! The location of each joint.
+	vec3	*location;
+	
+	//! The rotation quaternion of each joint, NULL if the rotations are quantized.
+	vec4	*rotation;
+	
+	//! The rotation quaternion of each joint quantized to 4 signed normalized shorts (XYZW), NULL if the rotations are not quantized. \sa MD5_quantize_action
+	short	*qrotation;
+
+} MD5POSE;
+
+
+//! Structure definition of the compressed animation track of a joint. The track stores the joint location and rotation relative to its parent. The keys are linearly interpolated (the rotations are normalized after the interpolation), a constant location or rotation only use one key. \sa MD5_compress_action
+typedef struct
+{
+	//! The number of location keys.
+	unsigned int	n_location;
+	
+	//! The frame index of each location key, the first key is at frame 0 and the last at the last frame of the action.
+	unsigned short	*location_frame;
+	
+	//! The joint location of each location key, quantized to 3 signed normalized shorts between location_offset - location_scale and location_offset + location_scale (NULL if there is only one key).
+	short			*qlocation;
+	
+	//! The center of the range of the location keys, or the joint location if there is only one key.
+	vec3			location_offset;
+	
+	//! The half extent of the range of the location keys.
+	vec3			location_scale;
+	
+	//! The number of rotation keys.
+	unsigned int	n_rotation;
+	
+	//! The frame index of each rotation key.
+	unsigned short	*rotation_frame;
+	
+	//! The joint rotation of each rotation key, quantized to 4 signed normalized shorts (XYZW).
+	short			*qrotation;
+
+} MD5TRACK;
+
+
 //! Structure definition of a single vertex.
 typedef struct
 {
@@ -111,6 +151,31 @@ typedef struct
 } MD5WEIGHT;
 
 
+//! The default maximum number of joints of an MD5PALETTE. Each joint use 3 uniform vectors, leaving 32 of the 128 vectors guaranteed by OpenGLES 2.0 to the other uniforms. \sa MD5_build3
+#define MD5_PALETTE_SIZE	32
+
+
+//! Structure definition of a joint matrix palette, used to draw the part of an MD5MESH skinned on the GPU that is only influenced by the joints of the palette. \sa MD5_build3
+typedef struct
+{
+	//! The number of joints in the palette.
+	unsigned int	n_joint;
+	
+	//! The index in the MD5 skeleton of each joint of the palette.
+	unsigned short	*joint;
+	
+	//! The skinning matrices of the current pose, stored as the 3 rows of a 3x4 matrix for each joint of the palette (ready to upload to the PALETTE uniform).
+	vec4			*matrix;
+	
+	//! The index of the first indice of the palette in the indices VBO.
+	unsigned int	first;
+	
+	//! The number of indices to draw with the palette.
+	unsigned int	n_indice;
+
+} MD5PALETTE;
+
+
 //! Structure that allow you to draw a mesh from an MD5.
 typedef struct
 {
@@ -133,9 +198,9 @@ typedef struct
 	unsigned int	stride;
 
 	//! The VBO buffer offsets.
-	unsigned int	offset[ 4 ];
+	unsigned int	offset[ 6 ];
 
-	//! The vertex data array. (POSITION, NORMAL, UV, TANGENT)
+	//! The vertex data array. (POSITION, NORMAL, UV, TANGENT, and JOINT, WEIGHT when skinned on the GPU)
 	unsigned char	*vertex_data;	
 			
 	//! The number of triangles.
@@ -171,6 +236,12 @@ typedef struct
 	//! The OBJMATERIAL to use to draw the MD5MESH.
 	OBJMATERIAL		*objmaterial;
 	
+	//! The number of joint matrix palettes (0 if the MD5MESH is skinned on the CPU).
+	unsigned int	n_md5palette;
+	
+	//! Array of MD5PALETTE used to skin the MD5MESH on the GPU. \sa MD5_build3
+	MD5PALETTE		*md5palette;
+	
 } MD5MESH;
 
 
@@ -183,11 +254,14 @@ typedef struct
 	//! The number of frame this action contains.
 	unsigned int	n_frame;
 	
-	//! Array of MD5JOINT for each frame of the action.
-	MD5JOINT		**frame;
+	//! Array of MD5POSE for each frame of the action. The arrays of all the frames are allocated as single blocks, owned by the first frame.
+	MD5POSE			*frame;
 	
-	//! The current pose for the current frame.
-	MD5JOINT		*pose;
+	//! The current pose for the current frame (never quantized).
+	MD5POSE			pose;
+	
+	//! Array of MD5TRACK for each joint if the action is compressed, the frames are then freed. \sa MD5_compress_action
+	MD5TRACK		*md5track;
 	
 	//! Current frame index.
 	int				curr_frame;
@@ -213,6 +287,27 @@ typedef struct
 } MD5ACTION;
 
 
+//! Structure definition of an animation level of detail, used to animate the distant MD5 for less. \sa MD5_set_lod
+typedef struct
+{
+	//! The distance from the viewer (MD5::distance) from which the level of detail is used.
+	float			distance;
+	
+	//! The animation is only updated once every update_rate calls to MD5_draw_action (0 or 1 to update it at every call).
+	unsigned int	update_rate;
+	
+	//! Determine if the LERP and SLERP actions are snapped to their frames like MD5_METHOD_FRAME, the pose is then only updated when the frame changes.
+	unsigned char	frame;
+	
+	//! Determine if the tangents are skinned on the CPU, the tangents of the previous pose are kept otherwise.
+	unsigned char	tangent;
+	
+	//! The maximum number of weights per vertex to skin with on the CPU, the weights with the highest bias are used and renormalized (0 to use all the weights).
+	unsigned int	max_weight;
+
+} MD5LOD;
+
+
 //! The main MD5 structure that allow you to load and manipulate .md5mesh and .md5anim files.
 typedef struct
 {
@@ -225,8 +320,23 @@ typedef struct
 	//! The number of joints that should be used as skeleton.
 	unsigned int	n_joint;
 
-	//! The bind pose skeleton.
-	MD5JOINT		*bind_pose;
+	//! The skeleton joints (names and parents).
+	MD5JOINT		*md5joint;
+
+	//! The bind pose of the skeleton.
+	MD5POSE			bind_pose;
+	
+	//! Determine if the weighted normals and tangents of the MD5WEIGHT are already calculated. \sa MD5_build_bind_pose_weighted_normals_tangents
+	unsigned char	weighted_normals_tangents;
+	
+	//! The inverse of the bind pose joint matrices (only used by the MD5MESH skinned on the GPU).
+	mat4			*inverse_bind_matrix;
+	
+	//! The bounding sphere of the weights of each joint, relative to the joint (XYZ center, W radius, negative if the joint has no weight). \sa MD5_update_bound_pose
+	vec4			*joint_bound;
+	
+	//! The minimum (X) and maximum (Y) sum of the weight biases of a vertex, including 1.
+	vec2			bias_range;
 
 	//! The number of mesh this MD5 consist of.
 	unsigned int	n_mesh;
@@ -249,13 +359,13 @@ typedef struct
 	//! The XYZ scale vector of the MD5.
 	vec3			scale;
 	
-	//! The bottom left corner of the bounding box. (in bind pose)
+	//! The bottom left corner of the bounding box. (in bind pose, or in the last pose passed to MD5_update_bound_pose)
 	vec3			min;
 	
-	//! The up right corner of the bounding box. (in bind pose)
+	//! The up right corner of the bounding box. (in bind pose, or in the last pose passed to MD5_update_bound_pose)
 	vec3			max;
 	
-	//! The dimension of the bounding box. (in bind pose)
+	//! The dimension of the bounding box. (in bind pose, or in the last pose passed to MD5_update_bound_pose)
 	vec3			dimension;
 	
 	//! The bounding sphere.
@@ -267,13 +377,151 @@ typedef struct
 	//! btRigidBody pointer of the current MD5 (if used in physics simulation).
 	btRigidBody		*btrigidbody;
 	
+	//! Determine if the MD5 is an instance that shares its skeleton, geometry and actions with another MD5. \sa MD5_create_instance
+	unsigned char	instance;
+	
+	//! The number of animation levels of detail.
+	unsigned int	n_md5lod;
+	
+	//! Array of MD5LOD sorted by increasing distance (NULL to always animate at full detail). \sa MD5_set_lod
+	MD5LOD			*md5lod;
+	
+	//! The index of the current MD5LOD, selected by MD5_draw_action.
+	unsigned int	lod;
+	
+	//! The number of calls to MD5_draw_action since the last animation update.
+	unsigned int	lod_skip;
+	
+	//! The time step accumulated since the last animation update.
+	float			lod_time_step;
+	
 } MD5;
 
 
+//! Structure definition of the animation update of one MD5 instance. \sa MD5_update_batch
+typedef struct
+{
+	//! The MD5 to update.
+	MD5				*md5;
+	
+	//! The time step to advance the actions of the MD5 with. \sa MD5_draw_action
+	float			time_step;
+	
+	//! The action that drives the pose.
+	MD5ACTION		*action0;
+	
+	//! The action to add on top of action0 using MD5_add_pose (NULL to only use action0).
+	MD5ACTION		*action1;
+	
+	//! The method to use to interpolate the joint rotations between action0 and action1.
+	unsigned char	joint_interpolation_method;
+	
+	//! The weight of action1.
+	float			action_weight;
+	
+	//! The pose that receives the blend of action0 and action1 (only used with action1).
+	MD5POSE			*pose;
+	
+	//! Set by MD5_update_batch to 1 if the MD5 was skinned and have to be uploaded. \sa MD5_upload_batch
+	unsigned char	update;
+
+} MD5UPDATE;
+
+
+//! The .gfxmd5 (skeleton and meshes) file signature.
+#define MD5_BIN_MAGIC			"GFXMD5"
+
+//! The .gfxmd5anim (action) file signature.
+#define MD5_BIN_ACTION_MAGIC	"GFXMD5A"
+
+//! The .gfxmd5 and .gfxmd5anim file format version.
+#define MD5_BIN_VERSION			1
+
+
+//! The .gfxmd5 and .gfxmd5anim file header.
+typedef struct
+{
+	//! The file signature (MD5_BIN_MAGIC or MD5_BIN_ACTION_MAGIC).
+	char			magic[ 8 ];
+	
+	//! The file format version (MD5_BIN_VERSION).
+	unsigned int	version;
+	
+	//! The number of joints of the skeleton.
+	unsigned int	n_joint;
+	
+	//! The number of MD5BINMESH (0 for a .gfxmd5anim).
+	unsigned int	n_mesh;
+	
+	//! The number of frames (0 for a .gfxmd5).
+	unsigned int	n_frame;
+	
+	//! The action frame per second (.gfxmd5anim only).
+	float			fps;
+	
+	//! Determine if the rotations are quantized to 4 signed normalized shorts per joint. \sa MD5_quantize_action
+	unsigned int	quantized;
+	
+	//! The location in bytes of the MD5JOINT array from the beginning of the file (.gfxmd5 only).
+	unsigned int	md5joint;
+	
+	//! The location in bytes of the joint locations of the bind pose, or of all the frames one after the other.
+	unsigned int	location;
+	
+	//! The location in bytes of the joint rotations of the bind pose, or of all the frames one after the other.
+	unsigned int	rotation;
+	
+	//! The location in bytes of the MD5BINMESH array from the beginning of the file.
+	unsigned int	md5mesh;
+	
+	//! The total size of the file in bytes.
+	unsigned int	size;
+
+} MD5BINHEADER;
+
+
+//! The .gfxmd5 representation of an MD5MESH.
+typedef struct
+{
+	char			shader[ MAX_CHAR ];
+	
+	unsigned int	n_vertex;
+	
+	//! The location in bytes of the MD5VERTEX array from the beginning of the file.
+	unsigned int	md5vertex;
+	
+	unsigned int	n_triangle;
+	
+	//! The location in bytes of the MD5TRIANGLE array from the beginning of the file (0 if the triangles were freed).
+	unsigned int	md5triangle;
+	
+	unsigned int	n_weight;
+	
+	//! The location in bytes of the MD5WEIGHT array (with their weighted normals and tangents) from the beginning of the file.
+	unsigned int	md5weight;
+	
+	unsigned int	mode;
+	
+	unsigned int	n_indice;
+	
+	//! The location in bytes of the index array from the beginning of the file.
+	unsigned int	indice;
+
+} MD5BINMESH;
+
+
 MD5 *MD5_load_mesh( char *filename, unsigned char relative_path );
 
 int MD5_load_action( MD5 *md5, char *name, char *filename, unsigned char relative_path );
 
+unsigned char MD5_save_bin( MD5 *md5, char *filename );
+
+MD5 *MD5_load_bin( char *filename, unsigned char relative_path );
+
+unsigned char MD5_save_action_bin( MD5 *md5, MD5ACTION *md5action, char *filename );
+
+int MD5_load_action_bin( MD5 *md5, char *name, char *filename, unsigned char relative_path );
+
 MD5 *MD5_free( MD5 *md5 );
 
 void MD5_free_mesh_data( MD5 *md5 );
@@ -298,22 +546,54 @@ void MD5_set_mesh_material( MD5MESH *md5mesh, OBJMATERIAL *objmaterial );
 
 void MD5_optimize( MD5 *md5, unsigned int vertex_cache_size );
 
+void MD5_optimize2( MD5 *md5, unsigned int vertex_cache_size );
+
 void MD5_build_vbo( MD5 *md5, unsigned int mesh_index );
 
 void MD5_build_bind_pose_weighted_normals_tangents( MD5 *md5 );
 
-void MD5_set_pose( MD5 *md5, MD5JOINT *pose );
+void MD5_init_pose( MD5 *md5, MD5POSE *md5pose );
+
+void MD5_free_pose( MD5POSE *md5pose );
+
+void MD5_get_pose_rotation( MD5POSE *md5pose, unsigned int joint_index, vec4 *rotation );
+
+void MD5_copy_pose( MD5 *md5, MD5POSE *dst, MD5POSE *src );
+
+void MD5_quantize_action( MD5 *md5, MD5ACTION *md5action );
+
+void MD5_compress_action( MD5 *md5, MD5ACTION *md5action, float location_tolerance, float rotation_tolerance );
+
+void MD5_sample_action( MD5 *md5, MD5ACTION *md5action, MD5POSE *pose, float blend );
+
+void MD5_skin_pose( MD5 *md5, MD5POSE *pose, unsigned int n_thread );
 
-void MD5_blend_pose( MD5 *md5, MD5JOINT *final_pose, MD5JOINT *pose0, MD5JOINT *pose1, unsigned char joint_interpolation_method, float blend );
+void MD5_set_pose( MD5 *md5, MD5POSE *pose );
 
-void MD5_add_pose( MD5 *md5, MD5JOINT *final_pose, MD5ACTION *action0, MD5ACTION *action1, unsigned char joint_interpolation_method, float action_weight );
+void MD5_blend_pose( MD5 *md5, MD5POSE *final_pose, MD5POSE *pose0, MD5POSE *pose1, unsigned char joint_interpolation_method, float blend );
+
+void MD5_add_pose( MD5 *md5, MD5POSE *final_pose, MD5ACTION *action0, MD5ACTION *action1, unsigned char joint_interpolation_method, float action_weight );
+
+void MD5_update_bound_pose( MD5 *md5, MD5POSE *pose );
 
 void MD5_build( MD5 *md5 );
 
 void MD5_build2( MD5 *md5 );
 
+void MD5_build3( MD5 *md5, unsigned int palette_size );
+
+MD5 *MD5_create_instance( MD5 *md5, char *name );
+
+void MD5_set_lod( MD5 *md5, MD5LOD *md5lod, unsigned int n_md5lod );
+
 unsigned char MD5_draw_action( MD5 *md5, float time_step );
 
+void MD5_update_batch( MD5UPDATE *md5update, unsigned int n_md5update, unsigned int n_thread );
+
+void MD5_upload_batch( MD5UPDATE *md5update, unsigned int n_md5update );
+
+unsigned int MD5_draw_mesh( MD5MESH *md5mesh );
+
 unsigned int MD5_draw( MD5 *md5 );
 
 #endif
@@ -143,6 +143,76 @@ MEMORY *mopen( char *filename, unsigned char relative_path )
 }
 
 
+/*!
+	Open a file as a read-only memory mapping. Contrarily to mopen, the content of the
+	file is not copied: pages are loaded on demand by the system, and the buffer
+	can be passed as is to functions such as glBufferData. The buffer is NOT null
+	terminated and must never be modified.
+	
+	On Android the files are stored inside the .apk and cannot be mapped, the
+	function then fall back to a regular mopen.
+	
+	\param[in] filename The file to map.
+	\param[in] relative_path Determine if the filename is an absolute or relative path.
+	
+	\return Return a MEMORY structure pointer if the file is found and mapped, instead will return
+	NULL.
+*/
+MEMORY *mmopen( char *filename, unsigned char relative_path )
+{
+	#ifdef __IPHONE_4_0
+
+		char fname[ MAX_PATH ] = {""};
+		
+		struct stat st;
+		
+		void *buffer;
+		
+		int f;
+		
+		if( relative_path )
+		{
+			get_file_path( getenv( "FILESYSTEM" ), fname );
+			
+			strcat( fname, filename );
+		}
+		else strcpy( fname, filename );
+
+		f = open( fname, O_RDONLY );
+		
+		if( f == -1 ) return NULL;
+		
+		if( fstat( f, &st ) || !st.st_size )
+		{
+			close( f );
+			return NULL;
+		}
+		
+		buffer = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, f, 0 );
+		
+		close( f );
+		
+		if( buffer == MAP_FAILED ) return NULL;
+		
+		
+		MEMORY *memory = ( MEMORY * ) calloc( 1, sizeof( MEMORY ) );
+		
+		strcpy( memory->filename, fname );
+		
+		memory->size   = st.st_size;
+		memory->buffer = ( unsigned char * )buffer;
+		memory->mapped = 1;
+		
+		return memory;
+	
+	#else
+	
+		return mopen( filename, relative_path );
+		
+	#endif
+}
+
+
 /*!
 	Close and free a previously initialized MEMORY stream.
 	
@@ -152,7 +222,12 @@ MEMORY *mopen( char *filename, unsigned char relative_path )
 */
 MEMORY *mclose( MEMORY *memory )
 {
-	if( memory->buffer ) free( memory->buffer );
+	if( memory->buffer )
+	{
+		if( memory->mapped ) munmap( memory->buffer, memory->size );
+		
+		else free( memory->buffer );
+	}
 	
 	free( memory );
 	return NULL;
@@ -47,11 +47,16 @@ typedef struct
 	//! The memory buffer.
 	unsigned char	*buffer;
 
+	//! Flag to determine if the buffer is a read-only memory mapping of the file (see mmopen).
+	unsigned char	mapped;
+
 } MEMORY;
 
 
 MEMORY *mopen( char *filename, unsigned char relative_path );
 
+MEMORY *mmopen( char *filename, unsigned char relative_path );
+
 MEMORY *mclose( MEMORY *memory );
 
 unsigned int mread( MEMORY *memory, void *dst, unsigned int size );
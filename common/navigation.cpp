@@ -172,7 +172,9 @@ unsigned char NAVIGATION_build( NAVIGATION *navigation, OBJ *obj, unsigned int m
 		j = 0;
 		while( j != objmesh->objtrianglelist[ i ].n_indice_array )
 		{
-			indices[ k ] = objmesh->objtrianglelist[ i ].indice_array[ j ];
+			indices[ k ] = objmesh->objtrianglelist[ i ].indice_type == GL_UNSIGNED_INT ?
+						   objmesh->objtrianglelist[ i ].indice_array32[ j ] :
+						   objmesh->objtrianglelist[ i ].indice_array  [ j ];
 		
 			++k;
 			++j;
@@ -517,14 +519,14 @@ void NAVIGATION_draw( NAVIGATION *navigation )
 		PROGRAM_link( navigation->program, 0 );	
 	}
 
-	char vertex_attribute = PROGRAM_get_vertex_attrib_location( navigation->program,
-															    ( char * )"POSITION" );
+	int vertex_attribute = PROGRAM_get_vertex_attrib_location( navigation->program,
+															   ( char * )"POSITION" );
 
-	glBindVertexArrayOES( 0 );
+	GFX_bind_vertex_array( 0 );
 
-	glBindBuffer( GL_ARRAY_BUFFER, 0 );
+	GFX_bind_buffer( GL_ARRAY_BUFFER, 0 );
 	
-	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+	GFX_bind_buffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
 	
 	glEnable( GL_BLEND );
 		
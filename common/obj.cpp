@@ -34,54 +34,361 @@ as being the original software.
 */
 
 
+//! Internal hash table used by OBJ_load to find duplicate OBJVERTEXDATA in constant time.
+typedef struct
+{
+	//! The number of buckets (always a power of 2).
+	unsigned int	size;
+
+	//! The number of buckets currently in use.
+	unsigned int	count;
+
+	//! The vertex index used as key for each bucket (-1 if the bucket is empty).
+	int				*key;
+
+	//! The first OBJVERTEXDATA index using the bucket vertex index.
+	int				*value;
+
+	//! For each OBJVERTEXDATA, the next OBJVERTEXDATA index sharing the same vertex index (-1 if none).
+	int				*next;
+
+} OBJVERTEXHASH;
+
+
 /*!
-	Function internally use to build the vertex data array for each OBJMESH.
+	Function internally used to grow an array geometrically. The capacity of the array is never
+	stored, it is deduced from the number of elements: the array is only reallocated (to twice its
+	size) when the element count is a power of 2, turning a series of appends into a linear operation.
+
+	\param[in] array The array to grow (can be NULL).
+	\param[in] count The number of elements currently used in the array.
+	\param[in] size The size in bytes of one element.
+
+	\return Return the array pointer ready to receive the element at index count.
+*/
+void *OBJ_grow_array( void *array, unsigned int count, unsigned int size )
+{
+	if( count & ( count - 1 ) ) return array;
+
+	return realloc( array, ( count ? count << 1 : 1 ) * size );
+}
+
+
+/*!
+	Function internally used to (re)initialize an OBJVERTEXHASH for a new OBJMESH.
+
+	\param[in,out] objvertexhash A valid OBJVERTEXHASH structure pointer.
+	\param[in] size The number of buckets, must be a power of 2.
+*/
+void OBJVERTEXHASH_init( OBJVERTEXHASH *objvertexhash, unsigned int size )
+{
+	objvertexhash->size  = size;
+	objvertexhash->count = 0;
+
+	objvertexhash->key   = ( int * ) realloc( objvertexhash->key  , size * sizeof( int ) );
+	objvertexhash->value = ( int * ) realloc( objvertexhash->value, size * sizeof( int ) );
+
+	memset( objvertexhash->key, -1, size * sizeof( int ) );
+}
+
+
+/*!
+	Function internally used to free the memory used by an OBJVERTEXHASH.
+
+	\param[in,out] objvertexhash A valid OBJVERTEXHASH structure pointer.
+*/
+void OBJVERTEXHASH_free( OBJVERTEXHASH *objvertexhash )
+{
+	if( objvertexhash->key	 ) free( objvertexhash->key   );
+	if( objvertexhash->value ) free( objvertexhash->value );
+	if( objvertexhash->next	 ) free( objvertexhash->next  );
+
+	memset( objvertexhash, 0, sizeof( OBJVERTEXHASH ) );
+}
+
+
+/*!
+	Function internally used to find the bucket of a specific vertex index.
+
+	\param[in] objvertexhash A valid OBJVERTEXHASH structure pointer.
+	\param[in] vertex_index The vertex index to look for.
+
+	\return Return the bucket that contains the vertex index, or the empty bucket where it should be inserted.
+*/
+unsigned int OBJVERTEXHASH_get_bucket( OBJVERTEXHASH *objvertexhash, int vertex_index )
+{
+	unsigned int mask   = objvertexhash->size - 1,
+				 bucket = ( ( unsigned int )vertex_index * 2654435761u ) & mask;
+
+	while( objvertexhash->key[ bucket ] != -1 &&
+		   objvertexhash->key[ bucket ] != vertex_index )
+	{ bucket = ( bucket + 1 ) & mask; }
+
+	return bucket;
+}
+
+
+/*!
+	Function internally used to double the number of buckets of an OBJVERTEXHASH.
+
+	\param[in,out] objvertexhash A valid OBJVERTEXHASH structure pointer.
+*/
+void OBJVERTEXHASH_grow( OBJVERTEXHASH *objvertexhash )
+{
+	unsigned int i		= 0,
+				 size	= objvertexhash->size,
+				 bucket;
+
+	int *key   = objvertexhash->key,
+		*value = objvertexhash->value;
+
+	objvertexhash->key	 = NULL;
+	objvertexhash->value = NULL;
+
+	OBJVERTEXHASH_init( objvertexhash, size << 1 );
+
+	while( i != size )
+	{
+		if( key[ i ] != -1 )
+		{
+			bucket = OBJVERTEXHASH_get_bucket( objvertexhash, key[ i ] );
+
+			objvertexhash->key  [ bucket ] = key  [ i ];
+			objvertexhash->value[ bucket ] = value[ i ];
+
+			++objvertexhash->count;
+		}
+
+		++i;
+	}
+
+	free( key );
+	free( value );
+}
+
+
+/*!
+	Return the size in bytes of one indice of an OBJTRIANGLELIST.
+
+	\param[in] objtrianglelist A valid OBJTRIANGLELIST structure pointer.
 	
+	\return Return sizeof( unsigned int ) for GL_UNSIGNED_INT triangle lists, else sizeof( unsigned short ).
+*/
+unsigned int OBJTRIANGLELIST_get_indice_size( OBJTRIANGLELIST *objtrianglelist )
+{
+	return objtrianglelist->indice_type == GL_UNSIGNED_INT ? sizeof( unsigned int ) : sizeof( unsigned short );
+}
+
+
+/*!
+	Function internally used to append an indice to an OBJTRIANGLELIST. The indices are
+	stored as GL_UNSIGNED_SHORT until an indice is over 65535, then the whole list is
+	converted to GL_UNSIGNED_INT.
+
+	\param[in,out] objtrianglelist A valid OBJTRIANGLELIST structure pointer.
+	\param[in] index The zero based vertex data index to append.
+*/
+void OBJTRIANGLELIST_add_indice( OBJTRIANGLELIST *objtrianglelist, unsigned int index )
+{
+	if( objtrianglelist->indice_type != GL_UNSIGNED_INT )
+	{
+		if( index < 65536 )
+		{
+			objtrianglelist->indice_array = ( unsigned short * ) OBJ_grow_array( objtrianglelist->indice_array,
+																				 objtrianglelist->n_indice_array,
+																				 sizeof( unsigned short ) );
+
+			objtrianglelist->indice_array[ objtrianglelist->n_indice_array ] = index;
+
+			++objtrianglelist->n_indice_array;
+			
+			return;
+		}
+		else
+		{
+			/* Promote the list to 32 bits, keep the same power of 2 capacity used by OBJ_grow_array. */
+			unsigned int i		  = objtrianglelist->n_indice_array,
+						 capacity = 1;
+			
+			unsigned int *indice_array32;
+			
+			while( capacity < i ) capacity <<= 1;
+			
+			indice_array32 = ( unsigned int * ) malloc( capacity * sizeof( unsigned int ) );
+			
+			while( i-- ) indice_array32[ i ] = objtrianglelist->indice_array[ i ];
+			
+			free( objtrianglelist->indice_array );
+			
+			objtrianglelist->indice_array32 = indice_array32;
+			objtrianglelist->indice_type	= GL_UNSIGNED_INT;
+		}
+	}
+
+	objtrianglelist->indice_array32 = ( unsigned int * ) OBJ_grow_array( objtrianglelist->indice_array32,
+																		 objtrianglelist->n_indice_array,
+																		 sizeof( unsigned int ) );
+
+	objtrianglelist->indice_array32[ objtrianglelist->n_indice_array ] = index;
+
+	++objtrianglelist->n_indice_array;
+}
+
+
+/*!
+	Function internally use to build the vertex data array for each OBJMESH.
+
+	The OBJVERTEXDATA sharing the same vertex index are chained together in order of creation,
+	so the first entry matching the vertex and UV index is the same one a linear scan of the
+	objvertexdata array would find.
+
 	\param[in,out] objmesh A valid OBJMESH structure pointer.
 	\param[in] objtrianglelist A valid OBJTRIANGLELIST structure pointer.
+	\param[in,out] objvertexhash The OBJVERTEXHASH of the OBJMESH.
 	\param[in] vertex_index The current vertex index to include in the vertex data.
 	\param[in] uv_index The current UV index to include in the vertex data.
 */
 void OBJMESH_add_vertex_data( OBJMESH		  *objmesh,
 							  OBJTRIANGLELIST *objtrianglelist,
+							  OBJVERTEXHASH   *objvertexhash,
 							  int			  vertex_index,
 							  int			  uv_index )
 {
-	unsigned short index = 0;
-	
-	while( index != objmesh->n_objvertexdata )
+	unsigned int bucket = OBJVERTEXHASH_get_bucket( objvertexhash, vertex_index );
+
+	int index = -1,
+		last  = -1;
+
+	if( objvertexhash->key[ bucket ] != -1 )
 	{
-		if( vertex_index == objmesh->objvertexdata[ index ].vertex_index )
+		index = objvertexhash->value[ bucket ];
+
+		while( index != -1 )
 		{
 			if( uv_index == -1 ) goto add_index_to_triangle_list;
-			
+
 			else if( uv_index == objmesh->objvertexdata[ index ].uv_index ) goto add_index_to_triangle_list;
+
+			last  = index;
+			index = objvertexhash->next[ index ];
 		}
-		
-		++index;
 	}
-	
+
 	index = objmesh->n_objvertexdata;
-	
+
+	objmesh->objvertexdata = ( OBJVERTEXDATA * ) OBJ_grow_array( objmesh->objvertexdata,
+																 objmesh->n_objvertexdata,
+																 sizeof( OBJVERTEXDATA ) );
+
+	objvertexhash->next = ( int * ) OBJ_grow_array( objvertexhash->next,
+													objmesh->n_objvertexdata,
+													sizeof( int ) );
 	++objmesh->n_objvertexdata;
-	
-	objmesh->objvertexdata = ( OBJVERTEXDATA * ) realloc( objmesh->objvertexdata, 
-														  objmesh->n_objvertexdata *
-														  sizeof( OBJVERTEXDATA ) );
-	
+
 	objmesh->objvertexdata[ index ].vertex_index = vertex_index;
 	objmesh->objvertexdata[ index ].uv_index	   = uv_index;
 
+	objvertexhash->next[ index ] = -1;
+
+	if( last != -1 ) objvertexhash->next[ last ] = index;
+
+	else
+	{
+		objvertexhash->key  [ bucket ] = vertex_index;
+		objvertexhash->value[ bucket ] = index;
+
+		++objvertexhash->count;
+
+		if( ( objvertexhash->count << 1 ) > objvertexhash->size ) OBJVERTEXHASH_grow( objvertexhash );
+	}
+
 
 add_index_to_triangle_list:
-	
-	++objtrianglelist->n_indice_array;
-	
-	objtrianglelist->indice_array = ( unsigned short * ) realloc( objtrianglelist->indice_array,
-																  objtrianglelist->n_indice_array *
-																  sizeof( unsigned short ) );
 
-	objtrianglelist->indice_array[ objtrianglelist->n_indice_array - 1 ] = index;	
+	OBJTRIANGLELIST_add_indice( objtrianglelist, index );
+}
+
+
+/*!
+	Function internally used to add a triangle to an OBJTRIANGLELIST.
+
+	\param[in,out] objmesh A valid OBJMESH structure pointer.
+	\param[in,out] objtrianglelist A valid OBJTRIANGLELIST structure pointer.
+	\param[in,out] objvertexhash The OBJVERTEXHASH of the OBJMESH.
+	\param[in] vertex_index The three zero based vertex indices of the triangle.
+	\param[in] uv_index The three zero based UV indices of the triangle (-1 if unused).
+*/
+void OBJMESH_add_triangle( OBJMESH		   *objmesh,
+						   OBJTRIANGLELIST *objtrianglelist,
+						   OBJVERTEXHASH   *objvertexhash,
+						   int			   *vertex_index,
+						   int			   *uv_index )
+{
+	unsigned int i = 0,
+				 triangle_index = objtrianglelist->n_objtriangleindex;
+
+	while( i != 3 )
+	{
+		OBJMESH_add_vertex_data( objmesh,
+								 objtrianglelist,
+								 objvertexhash,
+								 vertex_index[ i ],
+								 uv_index	 [ i ] );
+		++i;
+	}
+
+	objtrianglelist->objtriangleindex = ( OBJTRIANGLEINDEX * ) OBJ_grow_array( objtrianglelist->objtriangleindex,
+																			   objtrianglelist->n_objtriangleindex,
+																			   sizeof( OBJTRIANGLEINDEX ) );
+	++objtrianglelist->n_objtriangleindex;
+
+	memcpy( objtrianglelist->objtriangleindex[ triangle_index ].vertex_index,
+			vertex_index,
+			3 * sizeof( int ) );
+
+	memcpy( objtrianglelist->objtriangleindex[ triangle_index ].uv_index,
+			uv_index,
+			3 * sizeof( int ) );
+}
+
+
+/*!
+	Function internally used to release the extra memory allocated by OBJ_grow_array
+	once an OBJMESH is fully loaded.
+
+	\param[in,out] objmesh A valid OBJMESH structure pointer.
+*/
+void OBJMESH_shrink_vertex_data( OBJMESH *objmesh )
+{
+	unsigned int i = 0;
+
+	if( objmesh->n_objvertexdata )
+	{
+		objmesh->objvertexdata = ( OBJVERTEXDATA * ) realloc( objmesh->objvertexdata,
+															  objmesh->n_objvertexdata *
+															  sizeof( OBJVERTEXDATA ) );
+	}
+
+	while( i != objmesh->n_objtrianglelist )
+	{
+		OBJTRIANGLELIST *objtrianglelist = &objmesh->objtrianglelist[ i ];
+
+		if( objtrianglelist->n_indice_array )
+		{
+			objtrianglelist->indice_array = ( unsigned short * ) realloc( objtrianglelist->indice_array,
+																		  objtrianglelist->n_indice_array *
+																		  OBJTRIANGLELIST_get_indice_size( objtrianglelist ) );
+		}
+
+		if( objtrianglelist->n_objtriangleindex )
+		{
+			objtrianglelist->objtriangleindex = ( OBJTRIANGLEINDEX * ) realloc( objtrianglelist->objtriangleindex,
+																				objtrianglelist->n_objtriangleindex *
+																				sizeof( OBJTRIANGLEINDEX ) );
+		}
+
+		++i;
+	}
 }
 
 
@@ -468,28 +775,193 @@ void OBJ_update_bound_mesh( OBJ *obj, unsigned int mesh_index )
 
 
 /*!
-	Build the vertex data array buffer VBO for a specific OBJMESH index.
+	Set the OBJ_VERTEX_FORMAT flags to use when building the vertex buffer of a specific
+	OBJMESH index. Must be called before OBJ_build_mesh, OBJ_build_mesh2 or OBJ_save_bin.
 	
 	\param[in] obj A valid OBJ structure pointer.
 	\param[in] mesh_index The mesh index in the OBJ OBJMESH database.
+	\param[in] vertex_format A combination of OBJ_VERTEX_FORMAT flags. OBJ_VERTEX_FORMAT_SHORT_POSITION
+	have priority over OBJ_VERTEX_FORMAT_HALF_POSITION, and OBJ_VERTEX_FORMAT_OCT_NORMAL over
+	OBJ_VERTEX_FORMAT_BYTE_NORMAL.
+	
+	\note When using OBJ_VERTEX_FORMAT_OCT_NORMAL the NORMAL, FNORMAL and TANGENT0 attributes are
+	vec2, decode them in the vertex shader using:
+	
+	n = vec3( e.xy, 1.0 - abs( e.x ) - abs( e.y ) );
+	if( n.z < 0.0 ) n.xy = ( 1.0 - abs( n.yx ) ) * sign( n.xy );
+	n = normalize( n );
+	
+	When using OBJ_VERTEX_FORMAT_SHORT_POSITION the POSITION attribute is normalized to the OBJMESH
+	bounding box, OBJ_draw_mesh uploads its scale to the VERTEX_SCALE uniform and the vertex shader
+	have to apply it before any other transformation:
+	
+	uniform vec3 VERTEX_SCALE;
+	
+	gl_Position = MODELVIEWPROJECTIONMATRIX * vec4( POSITION * VERTEX_SCALE, 1.0 );
 */
-void OBJ_build_vbo_mesh( OBJ *obj, unsigned int mesh_index )
+void OBJ_set_vertex_format_mesh( OBJ *obj, unsigned int mesh_index, unsigned int vertex_format )
+{
+	if( vertex_format & OBJ_VERTEX_FORMAT_SHORT_POSITION ) vertex_format &= ~OBJ_VERTEX_FORMAT_HALF_POSITION;
+
+	if( vertex_format & OBJ_VERTEX_FORMAT_OCT_NORMAL ) vertex_format &= ~OBJ_VERTEX_FORMAT_BYTE_NORMAL;
+
+	obj->objmesh[ mesh_index ].vertex_format = vertex_format;
+}
+
+
+/*!
+	Function internally used to write a position to a vertex array.
+	
+	\param[in,out] dst The location in the vertex array to write to.
+	\param[in] v The position, relative to the OBJMESH pivot.
+	\param[in] objmesh A valid OBJMESH structure pointer.
+*/
+void OBJ_pack_position( unsigned char *dst, vec3 *v, OBJMESH *objmesh )
+{
+	if( objmesh->vertex_format & OBJ_VERTEX_FORMAT_SHORT_POSITION )
+	{
+		short *s = ( short * )dst;
+		
+		s[ 0 ] = float_to_snorm( v->x / objmesh->vertex_scale.x, 16 );
+		s[ 1 ] = float_to_snorm( v->y / objmesh->vertex_scale.y, 16 );
+		s[ 2 ] = float_to_snorm( v->z / objmesh->vertex_scale.z, 16 );
+		s[ 3 ] = 0;
+	}
+	else if( objmesh->vertex_format & OBJ_VERTEX_FORMAT_HALF_POSITION )
+	{
+		unsigned short *h = ( unsigned short * )dst;
+		
+		h[ 0 ] = float_to_half( v->x );
+		h[ 1 ] = float_to_half( v->y );
+		h[ 2 ] = float_to_half( v->z );
+		h[ 3 ] = 0;
+	}
+	else memcpy( dst, v, sizeof( vec3 ) );
+}
+
+
+/*!
+	Function internally used to write a normal or a tangent to a vertex array.
+	
+	\param[in,out] dst The location in the vertex array to write to.
+	\param[in] v The normalized vector.
+	\param[in] vertex_format The OBJ_VERTEX_FORMAT flags of the OBJMESH.
+*/
+void OBJ_pack_normal( unsigned char *dst, vec3 *v, unsigned int vertex_format )
+{
+	if( vertex_format & OBJ_VERTEX_FORMAT_OCT_NORMAL )
+	{
+		short *s = ( short * )dst;
+		
+		float l = fabsf( v->x ) + fabsf( v->y ) + fabsf( v->z );
+		
+		vec2 e = { 0.0f, 0.0f };
+		
+		if( l )
+		{
+			e.x = v->x / l;
+			e.y = v->y / l;
+		}
+		
+		// Fold the lower hemisphere over the diagonals.
+		if( v->z < 0.0f )
+		{
+			float x = e.x;
+			
+			e.x = ( 1.0f - fabsf( e.y ) ) * ( x   >= 0.0f ? 1.0f : -1.0f );
+			e.y = ( 1.0f - fabsf( x   ) ) * ( e.y >= 0.0f ? 1.0f : -1.0f );
+		}
+		
+		s[ 0 ] = float_to_snorm( e.x, 16 );
+		s[ 1 ] = float_to_snorm( e.y, 16 );
+	}
+	else if( vertex_format & OBJ_VERTEX_FORMAT_BYTE_NORMAL )
+	{
+		signed char *b = ( signed char * )dst;
+		
+		b[ 0 ] = float_to_snorm( v->x, 8 );
+		b[ 1 ] = float_to_snorm( v->y, 8 );
+		b[ 2 ] = float_to_snorm( v->z, 8 );
+		b[ 3 ] = 0;
+	}
+	else memcpy( dst, v, sizeof( vec3 ) );
+}
+
+
+/*!
+	Function internally used to write a UV to a vertex array.
+	
+	\param[in,out] dst The location in the vertex array to write to.
+	\param[in] v The UV coordinate.
+	\param[in] vertex_format The OBJ_VERTEX_FORMAT flags of the OBJMESH.
+*/
+void OBJ_pack_uv( unsigned char *dst, vec2 *v, unsigned int vertex_format )
+{
+	if( vertex_format & OBJ_VERTEX_FORMAT_HALF_UV )
+	{
+		unsigned short *h = ( unsigned short * )dst;
+		
+		h[ 0 ] = float_to_half( v->x );
+		h[ 1 ] = float_to_half( v->y );
+	}
+	else memcpy( dst, v, sizeof( vec2 ) );
+}
+
+
+/*!
+	Build the interleaved vertex data array of a specific OBJMESH index using the OBJMESH
+	OBJ_VERTEX_FORMAT flags, and set the OBJMESH stride, size and offsets.
+	
+	\param[in] obj A valid OBJ structure pointer.
+	\param[in] mesh_index The mesh index in the OBJ OBJMESH database.
+	
+	\return Return the vertex data array, the caller is responsible to free it.
+*/
+unsigned char *OBJ_build_vertex_array_mesh( OBJ *obj, unsigned int mesh_index )
 {
-	// Build the VBO for the vertex data
 	unsigned int i,
 				 index,
-				 offset;
+				 normal_size;
 	
 	OBJMESH *objmesh = &obj->objmesh[ mesh_index ];
 	
-	objmesh->stride  = sizeof( vec3 ); // Vertex
-	objmesh->stride += sizeof( vec3 ); // Normals
-	objmesh->stride += sizeof( vec3 ); // Face Normals
+	unsigned char single_normal = ( objmesh->vertex_format & OBJ_VERTEX_FORMAT_SINGLE_NORMAL ) != 0,
+				  useuvs		= objmesh->objvertexdata[ 0 ].uv_index != -1;
+	
+	vec3 *indexed_normal = ( single_normal && !objmesh->use_smooth_normals ) ?
+						   obj->indexed_fnormal :
+						   obj->indexed_normal;
+	
+	objmesh->vertex_scale.x =
+	objmesh->vertex_scale.y =
+	objmesh->vertex_scale.z = 1.0f;
+	
+	if( objmesh->vertex_format & OBJ_VERTEX_FORMAT_SHORT_POSITION )
+	{
+		if( objmesh->dimension.x ) objmesh->vertex_scale.x = objmesh->dimension.x * 0.5f;
+		if( objmesh->dimension.y ) objmesh->vertex_scale.y = objmesh->dimension.y * 0.5f;
+		if( objmesh->dimension.z ) objmesh->vertex_scale.z = objmesh->dimension.z * 0.5f;
+	}
+	
+	normal_size = ( objmesh->vertex_format & ( OBJ_VERTEX_FORMAT_BYTE_NORMAL | OBJ_VERTEX_FORMAT_OCT_NORMAL ) ) ? 4 : sizeof( vec3 );
+	
+
+	// Packed positions are padded to 4 components to keep the next attribute 4 bytes aligned.
+	objmesh->offset[ 0 ] = 0;
+	
+	objmesh->offset[ 1 ] = ( objmesh->vertex_format & ( OBJ_VERTEX_FORMAT_HALF_POSITION | OBJ_VERTEX_FORMAT_SHORT_POSITION ) ) ? 8 : sizeof( vec3 ); // Vertex
+	
+	objmesh->offset[ 2 ] = objmesh->offset[ 1 ] + ( single_normal ? 0 : normal_size ); // Normals
+	
+	objmesh->stride = objmesh->offset[ 2 ] + normal_size; // Face Normals
 		
-	if( objmesh->objvertexdata[ 0 ].uv_index != -1 )
+	if( useuvs )
 	{
-		objmesh->stride += sizeof( vec3 ); // Tangent
-		objmesh->stride += sizeof( vec2 ); // Uv
+		objmesh->offset[ 3 ] = objmesh->stride;
+		
+		objmesh->offset[ 4 ] = objmesh->offset[ 3 ] + ( ( objmesh->vertex_format & OBJ_VERTEX_FORMAT_HALF_UV ) ? 4 : sizeof( vec2 ) ); // Uv
+		
+		objmesh->stride = objmesh->offset[ 4 ] + normal_size; // Tangent
 	}
 	
 	objmesh->size = objmesh->n_objvertexdata * objmesh->stride;
@@ -500,86 +972,110 @@ void OBJ_build_vbo_mesh( OBJ *obj, unsigned int mesh_index )
 	i = 0;
 	while( i != objmesh->n_objvertexdata )
 	{ 
+		vec3 v;
+		
 		index = objmesh->objvertexdata[ i ].vertex_index;
 		
-		memcpy( vertex_array,
-				&obj->indexed_vertex[ index ],
-				sizeof( vec3 ) );
-
 		// Center the pivot
-		vec3_diff( ( vec3 * )vertex_array,
-				   ( vec3 * )vertex_array,
+		vec3_diff( &v,
+				   &obj->indexed_vertex[ index ],
 				   &objmesh->location );
 
-		vertex_array += sizeof( vec3 );
-
+		OBJ_pack_position( vertex_array, &v, objmesh );
 
-		memcpy( vertex_array,
-				&obj->indexed_normal[ index ],
-				sizeof( vec3 ) );
+		OBJ_pack_normal( vertex_array + objmesh->offset[ 1 ],
+						 &indexed_normal[ index ],
+						 objmesh->vertex_format );
 		
-		vertex_array += sizeof( vec3 );
-
-
-		memcpy( vertex_array,
-				&obj->indexed_fnormal[ index ],
-				sizeof( vec3 ) );
-		
-		vertex_array += sizeof( vec3 );
-
+		if( !single_normal )
+		{
+			OBJ_pack_normal( vertex_array + objmesh->offset[ 2 ],
+							 &obj->indexed_fnormal[ index ],
+							 objmesh->vertex_format );
+		}
 	
-		if( objmesh->objvertexdata[ 0 ].uv_index != -1 )
+		if( useuvs )
 		{
-			memcpy( vertex_array,
-					&obj->indexed_uv[ objmesh->objvertexdata[ i ].uv_index ],
-					sizeof( vec2 ) );
+			OBJ_pack_uv( vertex_array + objmesh->offset[ 3 ],
+						 &obj->indexed_uv[ objmesh->objvertexdata[ i ].uv_index ],
+						 objmesh->vertex_format );
 
-			vertex_array += sizeof( vec2 );
-			
-			memcpy( vertex_array,
-					&obj->indexed_tangent[ index ],
-					sizeof( vec3 ) );
-
-			vertex_array += sizeof( vec3 );				
+			OBJ_pack_normal( vertex_array + objmesh->offset[ 4 ],
+							 &obj->indexed_tangent[ index ],
+							 objmesh->vertex_format );
 		}
+		
+		vertex_array += objmesh->stride;
 					
 		++i;
 	}
 	
+	return vertex_start;
+}
+
+
+
+/*!
+	Build the vertex data array buffer VBO for a specific OBJMESH index. If the OBJMESH
+	have been loaded from a .gfxmesh file, the interleaved vertex array and the index arrays
+	are sent as is to GLES.
 	
-	glGenBuffers( 1, &objmesh->vbo );
+	\param[in] obj A valid OBJ structure pointer.
+	\param[in] mesh_index The mesh index in the OBJ OBJMESH database.
 	
-	glBindBuffer( GL_ARRAY_BUFFER, objmesh->vbo );
+	\return Return 1 if the VBO have been built, else return 0 if the OBJMESH is using 32 bits
+	indices, or a .gfxmesh vertex array is using half floats, and the GLES driver does not support
+	them (nothing is built and the OBJMESH is not drawn).
+*/
+unsigned char OBJ_build_vbo_mesh( OBJ *obj, unsigned int mesh_index )
+{
+	// Build the VBO for the vertex data
+	unsigned int i = 0;
 	
-	glBufferData( GL_ARRAY_BUFFER,
-				  objmesh->size,
-				  vertex_start,
-				  GL_STATIC_DRAW );	
+	OBJMESH *objmesh = &obj->objmesh[ mesh_index ];
 	
-	free( vertex_start );
+	unsigned char *vertex_array;
 	
-
-	objmesh->offset[ 0 ] = 0;
-			
-	offset = sizeof( vec3 );
-
-	objmesh->offset[ 1 ] = offset;
-			
-	offset += sizeof( vec3 );
-
-	objmesh->offset[ 2 ] = offset;
+	while( i != objmesh->n_objtrianglelist )
+	{
+		if( objmesh->objtrianglelist[ i ].indice_type == GL_UNSIGNED_INT && !gfx.index_uint )
+		{
+			console_print( "ERROR: %s is using 32 bits indices which are not supported by the GLES driver.\n", objmesh->name );
 			
-	offset += sizeof( vec3 );
-
+			return 0;
+		}
+		
+		++i;
+	}
 	
-	if( objmesh->objvertexdata[ 0 ].uv_index != -1 )
+	if( !gfx.half_float && ( objmesh->vertex_format & ( OBJ_VERTEX_FORMAT_HALF_POSITION | OBJ_VERTEX_FORMAT_HALF_UV ) ) )
 	{
-		objmesh->offset[ 3 ] = offset;
+		// The vertex array of a .gfxmesh is used as is, it has to be cooked without half floats.
+		if( objmesh->vertex_array )
+		{
+			console_print( "ERROR: %s is using half float vertex attributes which are not supported by the GLES driver.\n", objmesh->name );
+			
+			return 0;
+		}
 		
-		offset += sizeof( vec2 );
-
-		objmesh->offset[ 4 ] = offset;
+		// Fallback to float positions and UVs.
+		objmesh->vertex_format &= ~( OBJ_VERTEX_FORMAT_HALF_POSITION | OBJ_VERTEX_FORMAT_HALF_UV );
 	}
+	
+	vertex_array = objmesh->vertex_array ?
+				   objmesh->vertex_array :
+				   OBJ_build_vertex_array_mesh( obj, mesh_index );
+	
+	glGenBuffers( 1, &objmesh->vbo );
+	
+	GFX_bind_buffer( GL_ARRAY_BUFFER, objmesh->vbo );
+	
+	glBufferData( GL_ARRAY_BUFFER,
+				  objmesh->size,
+				  vertex_array,
+				  GL_STATIC_DRAW );	
+	
+	if( vertex_array != objmesh->vertex_array ) free( vertex_array );
 		
 	
 	i = 0;
@@ -587,14 +1083,16 @@ void OBJ_build_vbo_mesh( OBJ *obj, unsigned int mesh_index )
 	{
 		glGenBuffers( 1, &objmesh->objtrianglelist[ i ].vbo );
 		
-		glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, objmesh->objtrianglelist[ i ].vbo );
+		GFX_bind_buffer( GL_ELEMENT_ARRAY_BUFFER, objmesh->objtrianglelist[ i ].vbo );
 		
 		glBufferData( GL_ELEMENT_ARRAY_BUFFER,
-					  objmesh->objtrianglelist[ i ].n_indice_array * sizeof( unsigned short ),
+					  objmesh->objtrianglelist[ i ].n_indice_array * OBJTRIANGLELIST_get_indice_size( &objmesh->objtrianglelist[ i ] ),
 					  objmesh->objtrianglelist[ i ].indice_array,
 					  GL_STATIC_DRAW );
 		++i;
 	}
+	
+	return 1;
 }
 
 
@@ -607,15 +1105,44 @@ void OBJ_build_vbo_mesh( OBJ *obj, unsigned int mesh_index )
 void OBJ_set_attributes_mesh( OBJ *obj, unsigned int mesh_index )
 {
 	OBJMESH *objmesh = &obj->objmesh[ mesh_index ];
+	
+	unsigned int position_type = GL_FLOAT,
+				 normal_type   = GL_FLOAT,
+				 normal_size   = 3,
+				 uv_type	   = GL_FLOAT;
+	
+	unsigned char position_normalized = GL_FALSE,
+				  normal_normalized	  = GL_FALSE;
+	
+	if( objmesh->vertex_format & OBJ_VERTEX_FORMAT_SHORT_POSITION )
+	{
+		position_type		= GL_SHORT;
+		position_normalized = GL_TRUE;
+	}
+	else if( objmesh->vertex_format & OBJ_VERTEX_FORMAT_HALF_POSITION ) position_type = GL_HALF_FLOAT_OES;
+	
+	if( objmesh->vertex_format & OBJ_VERTEX_FORMAT_OCT_NORMAL )
+	{
+		normal_type		  = GL_SHORT;
+		normal_size		  = 2;
+		normal_normalized = GL_TRUE;
+	}
+	else if( objmesh->vertex_format & OBJ_VERTEX_FORMAT_BYTE_NORMAL )
+	{
+		normal_type		  = GL_BYTE;
+		normal_normalized = GL_TRUE;
+	}
+	
+	if( objmesh->vertex_format & OBJ_VERTEX_FORMAT_HALF_UV ) uv_type = GL_HALF_FLOAT_OES;
 
-	glBindBuffer( GL_ARRAY_BUFFER, objmesh->vbo );			
+	GFX_bind_buffer( GL_ARRAY_BUFFER, objmesh->vbo );			
 
 	glEnableVertexAttribArray( 0 );
 	
 	glVertexAttribPointer( 0,
 						   3,
-						   GL_FLOAT,
-						   GL_FALSE,
+						   position_type,
+						   position_normalized,
 						   objmesh->stride,
 						   ( void * )NULL );
 
@@ -623,9 +1150,9 @@ void OBJ_set_attributes_mesh( OBJ *obj, unsigned int mesh_index )
 	glEnableVertexAttribArray( 1 );
 
 	glVertexAttribPointer( 1,
-						   3,
-						   GL_FLOAT,
-						   GL_FALSE, 
+						   normal_size,
+						   normal_type,
+						   normal_normalized,
 						   objmesh->stride,
 						   BUFFER_OFFSET( objmesh->offset[ 1 ] ) );
 
@@ -633,9 +1160,9 @@ void OBJ_set_attributes_mesh( OBJ *obj, unsigned int mesh_index )
 	glEnableVertexAttribArray( 4 );
 
 	glVertexAttribPointer( 4,
-						   3,
-						   GL_FLOAT,
-						   GL_FALSE, 
+						   normal_size,
+						   normal_type,
+						   normal_normalized,
 						   objmesh->stride,
 						   BUFFER_OFFSET( objmesh->offset[ 2 ] ) );
 
@@ -646,7 +1173,7 @@ void OBJ_set_attributes_mesh( OBJ *obj, unsigned int mesh_index )
 
 		glVertexAttribPointer( 2,
 							   2,
-							   GL_FLOAT,
+							   uv_type,
 							   GL_FALSE,
 							   objmesh->stride,
 							   BUFFER_OFFSET( objmesh->offset[ 3 ] ) );
@@ -654,9 +1181,9 @@ void OBJ_set_attributes_mesh( OBJ *obj, unsigned int mesh_index )
 		glEnableVertexAttribArray( 3 );
 
 		glVertexAttribPointer( 3,
-							   3,
-							   GL_FLOAT,
-							   GL_FALSE, 
+							   normal_size,
+							   normal_type,
+							   normal_normalized,
 							   objmesh->stride,
 							   BUFFER_OFFSET( objmesh->offset[ 4 ] ) );
 	}
@@ -668,30 +1195,35 @@ void OBJ_set_attributes_mesh( OBJ *obj, unsigned int mesh_index )
 	
 	\param[in] obj A valid OBJ structure pointer.
 	\param[in] mesh_index The mesh index in the OBJ OBJMESH database.
+	
+	\return Return 1 if the mesh have been built, else return 0. \sa OBJ_build_vbo_mesh
 */
-void OBJ_build_mesh( OBJ *obj, unsigned int mesh_index )
+unsigned char OBJ_build_mesh( OBJ *obj, unsigned int mesh_index )
 {
 	OBJMESH *objmesh = &obj->objmesh[ mesh_index ];
 
 
-	OBJ_update_bound_mesh( obj, mesh_index );
+	// The bounds of an OBJMESH loaded from a .gfxmesh are already computed.
+	if( !objmesh->vertex_array ) OBJ_update_bound_mesh( obj, mesh_index );
 	
-	OBJ_build_vbo_mesh( obj, mesh_index );
+	if( !OBJ_build_vbo_mesh( obj, mesh_index ) ) return 0;
 	
 
 	glGenVertexArraysOES( 1, &objmesh->vao );
 	
-	glBindVertexArrayOES( objmesh->vao );
+	GFX_bind_vertex_array( objmesh->vao );
 	
 	
 	OBJ_set_attributes_mesh( obj, mesh_index );
 	
 	
 	if( objmesh->n_objtrianglelist == 1 )
-	{ glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, objmesh->objtrianglelist[ 0 ].vbo ); }
+	{ GFX_bind_buffer( GL_ELEMENT_ARRAY_BUFFER, objmesh->objtrianglelist[ 0 ].vbo ); }
 	
 	
-	glBindVertexArrayOES( 0 );
+	GFX_bind_vertex_array( 0 );
+	
+	return 1;
 }
 
 
@@ -700,12 +1232,14 @@ void OBJ_build_mesh( OBJ *obj, unsigned int mesh_index )
 	
 	\param[in] obj A valid OBJ structure pointer.
 	\param[in] mesh_index The mesh index in the OBJ OBJMESH database.
+	
+	\return Return 1 if the mesh have been built, else return 0. \sa OBJ_build_vbo_mesh
 */
-void OBJ_build_mesh2( OBJ *obj, unsigned int mesh_index )
+unsigned char OBJ_build_mesh2( OBJ *obj, unsigned int mesh_index )
 {
-	OBJ_update_bound_mesh( obj, mesh_index );
+	if( !obj->objmesh[ mesh_index ].vertex_array ) OBJ_update_bound_mesh( obj, mesh_index );
 	
-	OBJ_build_vbo_mesh( obj, mesh_index );
+	return OBJ_build_vbo_mesh( obj, mesh_index );
 }
 
 
@@ -717,6 +1251,9 @@ void OBJ_build_mesh2( OBJ *obj, unsigned int mesh_index )
 	\param[in] mesh_index The mesh index in the OBJ OBJMESH database.
 	\param[in] vertex_cache_size The size of the vertex cache, the higher the more
 	optimized the triangle list(s) will be but the slower it will take to process.
+	
+	\note The index arrays of an OBJ loaded from a .gfxmesh file are read-only, optimize
+	the OBJMESH before calling OBJ_save_bin instead.
 */
 void OBJ_optimize_mesh( OBJ *obj, unsigned int mesh_index, unsigned int vertex_cache_size )
 {
@@ -727,11 +1264,16 @@ void OBJ_optimize_mesh( OBJ *obj, unsigned int mesh_index, unsigned int vertex_c
 	
 	unsigned short n_group = 0;
 
+	if( obj->memory ) return;
+
 	if( vertex_cache_size ) SetCacheSize( vertex_cache_size );
 	
 	while( i != objmesh->n_objtrianglelist )
 	{
 		PrimitiveGroup *primitivegroup;
+		
+		/* NvTriStrip only deal with 16 bits indices. */
+		if( objmesh->objtrianglelist[ i ].indice_type == GL_UNSIGNED_INT ) { ++i; continue; }
 	
 		if( GenerateStrips( objmesh->objtrianglelist[ i ].indice_array,
 							objmesh->objtrianglelist[ i ].n_indice_array,
@@ -763,938 +1305,2425 @@ void OBJ_optimize_mesh( OBJ *obj, unsigned int mesh_index, unsigned int vertex_c
 
 
 /*!
-	Get an OBJMESH pointer for a specific mesh name.
-	
-	\param[in] obj A valid OBJ structure pointer.
-	\param[in] name The name or partial name of the OBJMESH to get the pointer for.
-	\param[in] exact_name Determine if the name if the search should use the partial name or exact name receive in parameter.
-		
-	\return Return the OBJMESH structure pointer if found, else return NULL.
+	Function internally used to compute the Forsyth score of a vertex.
+
+	\param[in] n_active The number of triangles not yet added that are using the vertex.
+	\param[in] cache_position The position of the vertex in the simulated cache (-1 if not in cache).
+	\param[in] vertex_cache_size The size of the simulated vertex cache.
+
+	\return Return the score of the vertex, -1 if the vertex is not used anymore.
 */
-OBJMESH *OBJ_get_mesh( OBJ *obj, const char *name, unsigned char exact_name )
+float OBJ_get_vertex_score( unsigned int n_active, int cache_position, unsigned int vertex_cache_size )
 {
-	unsigned int i = 0;
-	
-	while( i != obj->n_objmesh )
+	float score = 0.0f;
+
+	if( !n_active ) return -1.0f;
+
+	if( cache_position > -1 )
 	{
-		if( exact_name )
-		{ if( !strcmp( obj->objmesh[ i ].name, name ) ) return &obj->objmesh[ i ]; }
-		
-		else
-		{ if( strstr( obj->objmesh[ i ].name, name ) ) return &obj->objmesh[ i ]; }
-	
-		++i;
+		/* The last triangle vertices get a fixed score so the next triangle doesn't
+		just reuse the same edge. */
+		if( cache_position < 3 ) score = 0.75f;
+
+		else score = powf( 1.0f - ( float )( cache_position - 3 ) / ( float )( vertex_cache_size - 3 ), 1.5f );
 	}
-	
-	return NULL;
+
+	/* Boost vertices with only a few triangles left to clear them out of the way. */
+	return score + 2.0f / sqrtf( ( float )n_active );
 }
 
 
 /*!
-	Get a OBJMESH index for a specific mesh name.
-	
-	\param[in] obj A valid OBJ structure pointer.
-	\param[in] name The name or partial name of the OBJMESH to get the pointer for.
-	\param[in] exact_name Determine if the name if the search should use the partial name or exact name receive in parameter.
-		
-	\return Return the OBJMESH index inside the OBJ OBJMESH database if found, else return -1.
+	Simulate a FIFO post-transform vertex cache to compute the efficiency of an index array.
+
+	\param[in] indice The triangle list index array.
+	\param[in] n_indice The number of indices.
+	\param[in] n_vertex The number of vertices that the index array is referencing.
+	\param[in] vertex_cache_size The size of the vertex cache to simulate.
+	\param[out] acmr The average cache miss ratio, the number of transformed vertices per triangle (0.5 is optimal, 3.0 is the worst).
+	\param[out] atvr The average transformed vertex ratio, the number of transformed vertices per vertex (1.0 is optimal).
 */
-int OBJ_get_mesh_index( OBJ *obj, const char *name, unsigned char exact_name )
+void OBJ_get_vertex_cache_ratio( unsigned int *indice, unsigned int n_indice, unsigned int n_vertex, unsigned int vertex_cache_size, float *acmr, float *atvr )
 {
-	unsigned int i = 0;
-	
-	while( i != obj->n_objmesh )
+	unsigned int i		  = 0,
+				 n_miss	  = 0,
+				 n_unique = 0,
+				 time	  = vertex_cache_size + 1,
+				 *timestamp = ( unsigned int * ) calloc( n_vertex, sizeof( unsigned int ) );
+
+	while( i != n_indice )
 	{
-		if( exact_name )
-		{ if( !strcmp( obj->objmesh[ i ].name, name ) ) return i; }
-		
-		else
-		{ if( strstr( obj->objmesh[ i ].name, name ) ) return i; }
-	
+		unsigned int v = indice[ i ];
+
+		if( !timestamp[ v ] ) ++n_unique;
+
+		if( time - timestamp[ v ] > vertex_cache_size )
+		{
+			timestamp[ v ] = time;
+			++time;
+			++n_miss;
+		}
+
 		++i;
 	}
-	
-	return -1;
+
+	*acmr = n_indice ? ( float )n_miss / ( float )( n_indice / 3 ) : 0.0f;
+	*atvr = n_unique ? ( float )n_miss / ( float )n_unique : 0.0f;
+
+	free( timestamp );
 }
 
 
 /*!
-	Get a PROGRAM pointer for a specific shader program name.
-	
-	\param[in] obj A valid OBJ structure pointer.
-	\param[in] name The name or partial name of the shader PROGRAM to get the pointer for.
-	\param[in] exact_name Determine if the name if the search should use the partial name or exact name receive in parameter.
-		
-	\return Return the PROGRAM structure pointer if found, else return NULL.
+	Reorder the triangles of a triangle list index array to maximize the post-transform vertex
+	cache hits, using Tom Forsyth's linear-speed vertex cache optimization.
+
+	\param[in,out] indice The GL_TRIANGLES index array to reorder.
+	\param[in] n_indice The number of indices.
+	\param[in] n_vertex The number of vertices that the index array is referencing.
+	\param[in] vertex_cache_size The size of the vertex cache to optimize for (at least 4).
 */
-PROGRAM *OBJ_get_program( OBJ *obj, const char *name, unsigned char exact_name )
+void OBJ_optimize_vertex_cache( unsigned int *indice, unsigned int n_indice, unsigned int n_vertex, unsigned int vertex_cache_size )
 {
-	unsigned int i = 0;
-	
-	while( i != obj->n_program )
+	unsigned int i,
+				 j,
+				 n_triangle  = n_indice / 3,
+				 n_added	 = 0,
+				 n_cache	 = 0,
+				 n_new_cache = 0,
+				 cursor		 = 0,
+				 *n_active	 = ( unsigned int * ) calloc( n_vertex, sizeof( unsigned int ) ),
+				 *offset	 = ( unsigned int * ) malloc( n_vertex * sizeof( unsigned int ) ),
+				 *adjacency	 = ( unsigned int * ) malloc( n_indice * sizeof( unsigned int ) ),
+				 *output	 = ( unsigned int * ) malloc( n_indice * sizeof( unsigned int ) ),
+				 *cache		 = ( unsigned int * ) malloc( ( vertex_cache_size + 3 ) * sizeof( unsigned int ) ),
+				 *new_cache	 = ( unsigned int * ) malloc( ( vertex_cache_size + 3 ) * sizeof( unsigned int ) );
+
+	int best = -1,
+		*cache_position = ( int * ) malloc( n_vertex * sizeof( int ) );
+
+	float best_score,
+		  *vertex_score	  = ( float * ) malloc( n_vertex   * sizeof( float ) ),
+		  *triangle_score = ( float * ) malloc( n_triangle * sizeof( float ) );
+
+	unsigned char *added = ( unsigned char * ) calloc( n_triangle, sizeof( unsigned char ) );
+
+
+	/* Build the vertex to triangle adjacency. */
+	i = 0;
+	while( i != n_indice )
 	{
-		if( exact_name )
-		{ if( !strcmp( obj->program[ i ]->name, name ) ) return obj->program[ i ]; }
-		
-		else
-		{ if( strstr( obj->program[ i ]->name, name ) ) return obj->program[ i ]; }
-	
+		++n_active[ indice[ i ] ];
 		++i;
 	}
-	
-	return NULL;
-}
 
+	j = 0;
+	i = 0;
+	while( i != n_vertex )
+	{
+		offset[ i ] = j;
+		j += n_active[ i ];
 
-/*!
-	Get a MATERIAL pointer for a specific material name.
-	
-	\param[in] obj A valid OBJ structure pointer.
-	\param[in] name The name or partial name of the OBJMATERIAL to get the pointer for.
-	\param[in] exact_name Determine if the name if the search should use the partial name or exact name receive in parameter.
-		
-	\return Return the OBJMATERIAL structure pointer if found, else return NULL.
-*/
-OBJMATERIAL *OBJ_get_material( OBJ *obj, const char *name, unsigned char exact_name )
-{
-	unsigned int i = 0;
-	
-	while( i != obj->n_objmaterial )
+		n_active	  [ i ] = 0;
+		cache_position[ i ] = -1;
+		++i;
+	}
+
+	i = 0;
+	while( i != n_indice )
 	{
-		if( exact_name )
-		{ if( !strcmp( obj->objmaterial[ i ].name, name ) ) return &obj->objmaterial[ i ]; }
-		
-		else
-		{ if( strstr( obj->objmaterial[ i ].name, name ) ) return &obj->objmaterial[ i ]; }
-	
+		unsigned int v = indice[ i ];
+
+		adjacency[ offset[ v ] + n_active[ v ] ] = i / 3;
+		++n_active[ v ];
 		++i;
 	}
-	
-	return NULL;
-}
 
 
-/*!
-	Get a TEXTURE pointer for a specific texture file name.
-	
-	\param[in] obj A valid OBJ structure pointer.
-	\param[in] name The name or partial name of the TEXTURE to get the pointer for.
-	\param[in] exact_name Determine if the name if the search should use the partial name or exact name receive in parameter.
-		
-	\return Return the TEXTURE structure pointer if found, else return NULL.
-*/
-TEXTURE *OBJ_get_texture( OBJ *obj, const char *name, unsigned char exact_name )
-{
-	unsigned int i = 0;
-	
-	while( i != obj->n_texture )
+	i = 0;
+	while( i != n_vertex )
 	{
-		if( exact_name )
-		{ if( !strcmp( obj->texture[ i ]->name, name ) ) return obj->texture[ i ]; }
-		
-		else
-		{ if( strstr(obj->texture[ i ]->name, name ) ) return obj->texture[ i ]; }
-	
+		vertex_score[ i ] = OBJ_get_vertex_score( n_active[ i ], -1, vertex_cache_size );
 		++i;
 	}
-	
-	return NULL;
-}
 
+	best_score = -1.0f;
 
-/*!
-	Set all the necessary GLES machine state to draw a specific OBJMATERIAL.
-	
-	\param[in] objmaterial A valid OBJMATERIAL structure pointer.
-*/
-void OBJ_draw_material( OBJMATERIAL *objmaterial )
-{
-	if( objmaterial )
+	i = 0;
+	while( i != n_triangle )
 	{
-		if( objmaterial->program ) PROGRAM_draw( objmaterial->program );
+		triangle_score[ i ] = vertex_score[ indice[ i * 3	 ] ] +
+							  vertex_score[ indice[ i * 3 + 1 ] ] +
+							  vertex_score[ indice[ i * 3 + 2 ] ];
 
-
-		if( objmaterial->texture_ambient )
+		if( triangle_score[ i ] > best_score )
 		{
-			glActiveTexture( GL_TEXTURE0 );
-
-			TEXTURE_draw( objmaterial->texture_ambient );
+			best	   = i;
+			best_score = triangle_score[ i ];
 		}
 
-		
-		if( objmaterial->texture_diffuse )
+		++i;
+	}
+
+
+	while( n_added != n_triangle )
+	{
+		unsigned int *triangle,
+					 *tmp;
+
+		/* No triangle left around the cache, pick the next one in order. */
+		if( best == -1 )
 		{
-			glActiveTexture( GL_TEXTURE1 );
+			while( added[ cursor ] ) ++cursor;
 
-			TEXTURE_draw( objmaterial->texture_diffuse );
+			best = cursor;
 		}
 
-		
-		if( objmaterial->texture_specular )
+		triangle = &indice[ best * 3 ];
+
+		memcpy( &output[ n_added * 3 ], triangle, 3 * sizeof( unsigned int ) );
+
+		added[ best ] = 1;
+		++n_added;
+
+
+		/* Remove the triangle from the adjacency of its vertices. */
+		i = 0;
+		while( i != 3 )
 		{
-			glActiveTexture( GL_TEXTURE2 );
+			unsigned int v	 = triangle[ i ],
+						 *a	 = &adjacency[ offset[ v ] ];
+
+			j = 0;
+			while( j != n_active[ v ] )
+			{
+				if( a[ j ] == ( unsigned int )best )
+				{
+					a[ j ] = a[ n_active[ v ] - 1 ];
+					--n_active[ v ];
+					break;
+				}
 
-			TEXTURE_draw( objmaterial->texture_specular );
+				++j;
+			}
+
+			++i;
 		}
 
 
-		if( objmaterial->texture_disp )
-		{
-			glActiveTexture( GL_TEXTURE3 );
+		/* Push the triangle vertices in front of the LRU cache. */
+		n_new_cache = 0;
 
-			TEXTURE_draw( objmaterial->texture_disp );
-		}	
-		
-		
-		if( objmaterial->texture_bump )
+		i = 0;
+		while( i != 3 )
 		{
-			glActiveTexture( GL_TEXTURE4 );
+			j = 0;
+			while( j != n_new_cache && new_cache[ j ] != triangle[ i ] ) ++j;
 
-			TEXTURE_draw( objmaterial->texture_bump );
-		}
+			if( j == n_new_cache )
+			{
+				new_cache[ n_new_cache ] = triangle[ i ];
+				++n_new_cache;
+			}
 
+			++i;
+		}
 
-		if( objmaterial->texture_translucency )
+		i = 0;
+		while( i != n_cache )
 		{
-			glActiveTexture( GL_TEXTURE5 );
+			if( cache[ i ] != triangle[ 0 ] &&
+				cache[ i ] != triangle[ 1 ] &&
+				cache[ i ] != triangle[ 2 ] )
+			{
+				new_cache[ n_new_cache ] = cache[ i ];
+				++n_new_cache;
+			}
 
-			TEXTURE_draw( objmaterial->texture_translucency );
+			++i;
 		}
-		
 
-		if( objmaterial->materialdrawcallback ) objmaterial->materialdrawcallback( objmaterial );
-	}
-}
+
+		/* Update the vertices score, including the ones that just got evicted. */
+		i = 0;
+		while( i != n_new_cache )
+		{
+			unsigned int v = new_cache[ i ];
+
+			cache_position[ v ] = i < vertex_cache_size ? ( int )i : -1;
+
+			vertex_score[ v ] = OBJ_get_vertex_score( n_active[ v ], cache_position[ v ], vertex_cache_size );
+
+			++i;
+		}
+
+
+		/* Rescore the triangles around the cache and find the best candidate. */
+		best	   = -1;
+		best_score = -1.0f;
+
+		i = 0;
+		while( i != n_new_cache )
+		{
+			unsigned int v = new_cache[ i ];
+
+			j = 0;
+			while( j != n_active[ v ] )
+			{
+				unsigned int t = adjacency[ offset[ v ] + j ];
+
+				triangle_score[ t ] = vertex_score[ indice[ t * 3	 ] ] +
+									  vertex_score[ indice[ t * 3 + 1 ] ] +
+									  vertex_score[ indice[ t * 3 + 2 ] ];
+
+				if( triangle_score[ t ] > best_score )
+				{
+					best	   = t;
+					best_score = triangle_score[ t ];
+				}
+
+				++j;
+			}
+
+			++i;
+		}
+
+		tmp		  = cache;
+		cache	  = new_cache;
+		new_cache = tmp;
+
+		n_cache = n_new_cache < vertex_cache_size ? n_new_cache : vertex_cache_size;
+	}
+
+	memcpy( indice, output, n_triangle * 3 * sizeof( unsigned int ) );
+
+	free( n_active );
+	free( offset );
+	free( adjacency );
+	free( output );
+	free( cache );
+	free( new_cache );
+	free( cache_position );
+	free( vertex_score );
+	free( triangle_score );
+	free( added );
+}
 
 
 /*!
-	Set all the necessary GLES machine state to draw the OBJMESH specified by the index received in parameter.
-	
+	Remap the vertices referenced by an index array in their order of first use, so the
+	vertex fetches are as linear as possible in memory. Can be called on multiple index
+	arrays sharing the same vertices by passing the same remap table.
+
+	\param[in,out] remap The old to new vertex index table, initialized to -1 for the first call.
+	\param[in] n_remap The number of vertices already remapped (0 for the first call).
+	\param[in,out] indice The index array to remap.
+	\param[in] n_indice The number of indices.
+
+	\return Return the number of vertices remapped so far.
+*/
+unsigned int OBJ_optimize_vertex_fetch( int *remap, unsigned int n_remap, unsigned int *indice, unsigned int n_indice )
+{
+	unsigned int i = 0;
+
+	while( i != n_indice )
+	{
+		if( remap[ indice[ i ] ] == -1 )
+		{
+			remap[ indice[ i ] ] = n_remap;
+			++n_remap;
+		}
+
+		indice[ i ] = remap[ indice[ i ] ];
+
+		++i;
+	}
+
+	return n_remap;
+}
+
+
+/*!
+	Optimize the GL_TRIANGLES OBJTRIANGLELIST of a specific OBJMESH index for the post-transform
+	vertex cache, then reorder the OBJVERTEXDATA of the OBJMESH in their order of first use. Unlike
+	OBJ_optimize_mesh the triangle lists stay indexed GL_TRIANGLES. The cache efficiency before
+	and after the optimization is printed on the console.
+
 	\param[in] obj A valid OBJ structure pointer.
 	\param[in] mesh_index The mesh index in the OBJ OBJMESH database.
+	\param[in] vertex_cache_size The size of the vertex cache to optimize for, pass 0 to use
+	OBJ_VERTEX_CACHE_SIZE.
 
-	\return Return the number of indices sent for drawing. (Divided this number by 3 for knowing how many triangles)
+	\note Must be called before building the OBJMESH. The index arrays of an OBJ loaded from a
+	.gfxmesh file are read-only, optimize the OBJMESH before calling OBJ_save_bin instead.
 */
-unsigned int OBJ_draw_mesh( OBJ *obj, unsigned int mesh_index )
+void OBJ_optimize_mesh2( OBJ *obj, unsigned int mesh_index, unsigned int vertex_cache_size )
 {
 	OBJMESH *objmesh = &obj->objmesh[ mesh_index ];
 
-	unsigned int n = 0;
+	OBJVERTEXDATA *objvertexdata;
+
+	unsigned int i = 0,
+				 j,
+				 n_remap = 0,
+				 *indice;
+
+	int *remap;
 
-	if( objmesh->visible && objmesh->distance )
+	float acmr[ 2 ],
+		  atvr[ 2 ];
+
+	if( obj->memory || !objmesh->n_objvertexdata ) return;
+
+	if( !vertex_cache_size ) vertex_cache_size = OBJ_VERTEX_CACHE_SIZE;
+
+	else if( vertex_cache_size < 4 ) vertex_cache_size = 4;
+
+	remap = ( int * ) malloc( objmesh->n_objvertexdata * sizeof( int ) );
+
+	memset( remap, -1, objmesh->n_objvertexdata * sizeof( int ) );
+
+	while( i != objmesh->n_objtrianglelist )
 	{
-		unsigned int i = 0;
-		
-		if( objmesh->vao ) glBindVertexArrayOES( objmesh->vao );
+		OBJTRIANGLELIST *objtrianglelist = &objmesh->objtrianglelist[ i ];
 
-		else OBJ_set_attributes_mesh( obj, mesh_index );
-		
-		
-		while( i != objmesh->n_objtrianglelist )
+		unsigned int max = 0;
+
+		indice = ( unsigned int * ) malloc( objtrianglelist->n_indice_array * sizeof( unsigned int ) );
+
+		j = 0;
+		while( j != objtrianglelist->n_indice_array )
 		{
-			objmesh->current_material = objmesh->objtrianglelist[ i ].objmaterial;
-		
-			if( objmesh->current_material ) OBJ_draw_material( objmesh->current_material );
-			
-			if( objmesh->vao )
+			indice[ j ] = objtrianglelist->indice_type == GL_UNSIGNED_INT ?
+						  objtrianglelist->indice_array32[ j ] :
+						  objtrianglelist->indice_array  [ j ];
+			++j;
+		}
+
+		/* Strips from OBJ_optimize_mesh only get their vertex fetch remapped. */
+		if( objtrianglelist->mode == GL_TRIANGLES )
+		{
+			OBJ_get_vertex_cache_ratio( indice,
+										objtrianglelist->n_indice_array,
+										objmesh->n_objvertexdata,
+										vertex_cache_size,
+										&acmr[ 0 ],
+										&atvr[ 0 ] );
+
+			OBJ_optimize_vertex_cache( indice,
+									   objtrianglelist->n_indice_array,
+									   objmesh->n_objvertexdata,
+									   vertex_cache_size );
+
+			OBJ_get_vertex_cache_ratio( indice,
+										objtrianglelist->n_indice_array,
+										objmesh->n_objvertexdata,
+										vertex_cache_size,
+										&acmr[ 1 ],
+										&atvr[ 1 ] );
+
+			console_print( "%s[ %d ]: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+						   objmesh->name,
+						   i,
+						   acmr[ 0 ], acmr[ 1 ],
+						   atvr[ 0 ], atvr[ 1 ] );
+		}
+
+		n_remap = OBJ_optimize_vertex_fetch( remap,
+											 n_remap,
+											 indice,
+											 objtrianglelist->n_indice_array );
+
+		j = 0;
+		while( j != objtrianglelist->n_indice_array )
+		{
+			if( indice[ j ] > max ) max = indice[ j ];
+			++j;
+		}
+
+		/* The remapped indices of a 16 bits list can now be over 65535. */
+		if( objtrianglelist->indice_type != GL_UNSIGNED_INT && max > 65535 )
+		{
+			free( objtrianglelist->indice_array );
+
+			objtrianglelist->indice_array32 = indice;
+			objtrianglelist->indice_type	= GL_UNSIGNED_INT;
+		}
+		else
+		{
+			j = 0;
+			while( j != objtrianglelist->n_indice_array )
 			{
-				if( objmesh->n_objtrianglelist != 1 )
-				{ glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, objmesh->objtrianglelist[ i ].vbo ); }
+				if( objtrianglelist->indice_type == GL_UNSIGNED_INT ) objtrianglelist->indice_array32[ j ] = indice[ j ];
+
+				else objtrianglelist->indice_array[ j ] = indice[ j ];
+
+				++j;
 			}
-			else
-			{ glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, objmesh->objtrianglelist[ i ].vbo ); }
-  			
-			
-			glDrawElements( objmesh->objtrianglelist[ i ].mode,
-							objmesh->objtrianglelist[ i ].n_indice_array,
-							GL_UNSIGNED_SHORT,
-							( void * )NULL );
-			
-			n += objmesh->objtrianglelist[ i ].n_indice_array;
-			
-			++i;
+
+			free( indice );
 		}
-		
-		return n;
+
+		++i;
 	}
-	
-	return n;
+
+
+	/* Vertices that are not referenced by any triangle list go at the end. */
+	i = 0;
+	while( i != objmesh->n_objvertexdata )
+	{
+		if( remap[ i ] == -1 )
+		{
+			remap[ i ] = n_remap;
+			++n_remap;
+		}
+
+		++i;
+	}
+
+	objvertexdata = ( OBJVERTEXDATA * ) malloc( objmesh->n_objvertexdata * sizeof( OBJVERTEXDATA ) );
+
+	i = 0;
+	while( i != objmesh->n_objvertexdata )
+	{
+		memcpy( &objvertexdata[ remap[ i ] ], &objmesh->objvertexdata[ i ], sizeof( OBJVERTEXDATA ) );
+		++i;
+	}
+
+	free( objmesh->objvertexdata );
+	objmesh->objvertexdata = objvertexdata;
+
+	free( remap );
 }
 
 
 /*!
-	Set all the necessary GLES machine state to draw the OBJMESH specified by the OBJMESH pointer received in parameter.
+	Get an OBJMESH pointer for a specific mesh name.
 	
 	\param[in] obj A valid OBJ structure pointer.
-	\param[in] objmesh A valid OBJMESH structure pointer to use for drawing the OBJMESH.
-	
-	\return Return the number of indices sent for drawing. (Divided this number by 3 for knowing how many triangles)
+	\param[in] name The name or partial name of the OBJMESH to get the pointer for.
+	\param[in] exact_name Determine if the name if the search should use the partial name or exact name receive in parameter.
+		
+	\return Return the OBJMESH structure pointer if found, else return NULL.
 */
-unsigned int OBJ_draw_mesh2( OBJ *obj, OBJMESH *objmesh )
+OBJMESH *OBJ_get_mesh( OBJ *obj, const char *name, unsigned char exact_name )
 {
 	unsigned int i = 0;
 	
 	while( i != obj->n_objmesh )
 	{
-		if( &obj->objmesh[ i ] == objmesh )
-		{
-			return OBJ_draw_mesh( obj, i );
-		}
+		if( exact_name )
+		{ if( !strcmp( obj->objmesh[ i ].name, name ) ) return &obj->objmesh[ i ]; }
 		
+		else
+		{ if( strstr( obj->objmesh[ i ].name, name ) ) return &obj->objmesh[ i ]; }
+	
 		++i;
 	}
 	
-	return 0;
+	return NULL;
 }
 
 
 /*!
-	Set all the necessary GLES machine state to draw the OBJMESH specified by the OBJMESH pointer received in parameter.
-	In addition this function will push the current matrix, translate, rotate and scale the OBJMESH then pop back the
-	current matrix.
+	Get a OBJMESH index for a specific mesh name.
 	
 	\param[in] obj A valid OBJ structure pointer.
-	\param[in] objmesh A valid OBJMESH structure pointer to use for drawing the OBJMESH.
-	
-	\return Return the number of indices sent for drawing. (Divided this number by 3 for knowing how many triangles)
+	\param[in] name The name or partial name of the OBJMESH to get the pointer for.
+	\param[in] exact_name Determine if the name if the search should use the partial name or exact name receive in parameter.
+		
+	\return Return the OBJMESH index inside the OBJ OBJMESH database if found, else return -1.
 */
-unsigned int OBJ_draw_mesh3( OBJ *obj, OBJMESH *objmesh )
+int OBJ_get_mesh_index( OBJ *obj, const char *name, unsigned char exact_name )
 {
-	unsigned int n = 0,
-				 i = 0;
+	unsigned int i = 0;
 	
 	while( i != obj->n_objmesh )
 	{
-		if( &obj->objmesh[ i ] == objmesh )
-		{
-			GFX_push_matrix();
-			
-			GFX_translate( objmesh->location.x,
-						   objmesh->location.y,
-						   objmesh->location.z );
-
-			GFX_rotate( objmesh->rotation.z, 0.0f, 0.0f, 1.0f );
-			GFX_rotate( objmesh->rotation.y, 0.0f, 1.0f, 0.0f );
-			GFX_rotate( objmesh->rotation.x, 1.0f, 0.0f, 0.0f );
-			
-			GFX_scale( objmesh->scale.x,
-					   objmesh->scale.y,
-					   objmesh->scale.z );
-
-			n = OBJ_draw_mesh( obj, i );
-			
-			GFX_pop_matrix();
-			
-			return n;
-		}
+		if( exact_name )
+		{ if( !strcmp( obj->objmesh[ i ].name, name ) ) return i; }
 		
+		else
+		{ if( strstr( obj->objmesh[ i ].name, name ) ) return i; }
+	
 		++i;
 	}
 	
-	return n;
+	return -1;
 }
 
 
 /*!
-	Free the vertex data for a specific OBJMESH index.
+	Get a PROGRAM pointer for a specific shader program name.
 	
-	\param[in,out] obj A valid OBJ structure pointer.
-	\param[in] mesh_index The OBJMESH index to flush the vertex data for.
+	\param[in] obj A valid OBJ structure pointer.
+	\param[in] name The name or partial name of the shader PROGRAM to get the pointer for.
+	\param[in] exact_name Determine if the name if the search should use the partial name or exact name receive in parameter.
+		
+	\return Return the PROGRAM structure pointer if found, else return NULL.
 */
-void OBJ_free_mesh_vertex_data( OBJ *obj, unsigned int mesh_index )
+PROGRAM *OBJ_get_program( OBJ *obj, const char *name, unsigned char exact_name )
 {
 	unsigned int i = 0;
 	
-	OBJMESH *objmesh = &obj->objmesh[ mesh_index ];
-
-	if( objmesh->objvertexdata )
+	while( i != obj->n_program )
 	{
-		free( objmesh->objvertexdata );
-		objmesh->objvertexdata = NULL;
+		if( exact_name )
+		{ if( !strcmp( obj->program[ i ]->name, name ) ) return obj->program[ i ]; }
+		
+		else
+		{ if( strstr( obj->program[ i ]->name, name ) ) return obj->program[ i ]; }
+	
+		++i;
 	}
 	
-	objmesh->n_objvertexdata = 0;
+	return NULL;
+}
+
+
+/*!
+	Get a MATERIAL pointer for a specific material name.
 	
-	while( i != objmesh->n_objtrianglelist )
-	{
-		free( objmesh->objtrianglelist[ i ].objtriangleindex );
-		objmesh->objtrianglelist[ i ].objtriangleindex = NULL;
-		
-		objmesh->objtrianglelist[ i ].n_objtriangleindex = 0;
+	\param[in] obj A valid OBJ structure pointer.
+	\param[in] name The name or partial name of the OBJMATERIAL to get the pointer for.
+	\param[in] exact_name Determine if the name if the search should use the partial name or exact name receive in parameter.
 		
-		free( objmesh->objtrianglelist[ i ].indice_array );
-		objmesh->objtrianglelist[ i ].indice_array = NULL;
+	\return Return the OBJMATERIAL structure pointer if found, else return NULL.
+*/
+OBJMATERIAL *OBJ_get_material( OBJ *obj, const char *name, unsigned char exact_name )
+{
+	unsigned int i = 0;
+	
+	while( i != obj->n_objmaterial )
+	{
+		if( exact_name )
+		{ if( !strcmp( obj->objmaterial[ i ].name, name ) ) return &obj->objmaterial[ i ]; }
 		
+		else
+		{ if( strstr( obj->objmaterial[ i ].name, name ) ) return &obj->objmaterial[ i ]; }
+	
 		++i;
 	}
+	
+	return NULL;
 }
 
 
 /*!
-	Helper function to load an MTL file.
-
-	\param[in,out] obj A valid OBJ structure pointer.
-	\param[in] filename The .MTL filename to load.
-	\param[in] relative_path Determine if the filename is relative to the application or an absolute path.
+	Get a TEXTURE pointer for a specific texture file name.
 	
-	\return Return 1 if the file was loaded successfully, else return 0.
+	\param[in] obj A valid OBJ structure pointer.
+	\param[in] name The name or partial name of the TEXTURE to get the pointer for.
+	\param[in] exact_name Determine if the name if the search should use the partial name or exact name receive in parameter.
+		
+	\return Return the TEXTURE structure pointer if found, else return NULL.
+*/
+TEXTURE *OBJ_get_texture( OBJ *obj, const char *name, unsigned char exact_name )
+{
+	unsigned int i = 0;
+	
+	while( i != obj->n_texture )
+	{
+		if( exact_name )
+		{ if( !strcmp( obj->texture[ i ]->name, name ) ) return obj->texture[ i ]; }
+		
+		else
+		{ if( strstr(obj->texture[ i ]->name, name ) ) return obj->texture[ i ]; }
+	
+		++i;
+	}
+	
+	return NULL;
+}
+
+
+/*!
+	Set all the necessary GLES machine state to draw a specific OBJMATERIAL.
+	
+	\param[in] objmaterial A valid OBJMATERIAL structure pointer.
+*/
+void OBJ_draw_material( OBJMATERIAL *objmaterial )
+{
+	if( objmaterial )
+	{
+		if( objmaterial->program ) PROGRAM_draw( objmaterial->program );
+
+
+		if( objmaterial->texture_ambient	  ) TEXTURE_draw2( objmaterial->texture_ambient	, 0 );
+		
+		if( objmaterial->texture_diffuse	  ) TEXTURE_draw2( objmaterial->texture_diffuse	, 1 );
+		
+		if( objmaterial->texture_specular	  ) TEXTURE_draw2( objmaterial->texture_specular	, 2 );
+		
+		if( objmaterial->texture_disp		  ) TEXTURE_draw2( objmaterial->texture_disp		, 3 );
+		
+		if( objmaterial->texture_bump		  ) TEXTURE_draw2( objmaterial->texture_bump		, 4 );
+		
+		if( objmaterial->texture_translucency ) TEXTURE_draw2( objmaterial->texture_translucency, 5 );
+
+
+		if( objmaterial->materialdrawcallback ) objmaterial->materialdrawcallback( objmaterial );
+	}
+}
+
+
+/*!
+	Function internally used to upload the dequantization scale of the normalized short positions
+	of an OBJMESH to the VERTEX_SCALE uniform, through the PROGRAM of its current material if any,
+	else to the program in use. The scale is not part of the modelview matrix, so the normal matrix
+	stays valid. The uniform name id is interned by the first call, and the location in the
+	program in use is only queried again when the program changes.
+	
+	\param[in] objmesh A valid OBJMESH structure pointer.
+*/
+void OBJ_set_vertex_scale( OBJMESH *objmesh )
+{
+	static int id		= -1,
+			   location = -1;
+	
+	static unsigned int location_program = 0;
+	
+	PROGRAM *program = objmesh->current_material ? objmesh->current_material->program : NULL;
+	
+	if( id == -1 ) id = PROGRAM_get_name_id( ( char * )"VERTEX_SCALE" );
+	
+	if( program && PROGRAM_get_uniform( program, id ) )
+	{ PROGRAM_set_uniform_vec3( program, id, &objmesh->vertex_scale ); }
+
+	else if( gfx.state.program )
+	{
+		if( location_program != gfx.state.program )
+		{
+			location		 = glGetUniformLocation( gfx.state.program, "VERTEX_SCALE" );
+			location_program = gfx.state.program;
+		}
+		
+		if( location != -1 ) glUniform3fv( location, 1, ( float * )&objmesh->vertex_scale );
+	}
+}
+
+
+/*!
+	Set all the necessary GLES machine state to draw the OBJMESH specified by the index received in parameter.
+	
+	\param[in] obj A valid OBJ structure pointer.
+	\param[in] mesh_index The mesh index in the OBJ OBJMESH database.
+
+	\return Return the number of indices sent for drawing. (Divided this number by 3 for knowing how many triangles)
+*/
+unsigned int OBJ_draw_mesh( OBJ *obj, unsigned int mesh_index )
+{
+	OBJMESH *objmesh = &obj->objmesh[ mesh_index ];
+
+	unsigned int n = 0;
+
+	if( objmesh->visible && objmesh->distance && objmesh->vbo )
+	{
+		unsigned int i = 0;
+		
+		if( objmesh->vao ) GFX_bind_vertex_array( objmesh->vao );
+
+		else OBJ_set_attributes_mesh( obj, mesh_index );
+		
+		while( i != objmesh->n_objtrianglelist )
+		{
+			objmesh->current_material = objmesh->objtrianglelist[ i ].objmaterial;
+		
+			if( objmesh->current_material ) OBJ_draw_material( objmesh->current_material );
+			
+			if( objmesh->vertex_format & OBJ_VERTEX_FORMAT_SHORT_POSITION ) OBJ_set_vertex_scale( objmesh );
+			
+			if( objmesh->vao )
+			{
+				if( objmesh->n_objtrianglelist != 1 )
+				{ GFX_bind_buffer( GL_ELEMENT_ARRAY_BUFFER, objmesh->objtrianglelist[ i ].vbo ); }
+			}
+			else
+			{ GFX_bind_buffer( GL_ELEMENT_ARRAY_BUFFER, objmesh->objtrianglelist[ i ].vbo ); }
+  			
+			
+			glDrawElements( objmesh->objtrianglelist[ i ].mode,
+							objmesh->objtrianglelist[ i ].n_indice_array,
+							objmesh->objtrianglelist[ i ].indice_type,
+							( void * )NULL );
+			
+			n += objmesh->objtrianglelist[ i ].n_indice_array;
+			
+			++i;
+		}
+		
+		return n;
+	}
+	
+	return n;
+}
+
+
+/*!
+	Set all the necessary GLES machine state to draw the OBJMESH specified by the OBJMESH pointer received in parameter.
+	
+	\param[in] obj A valid OBJ structure pointer.
+	\param[in] objmesh A valid OBJMESH structure pointer to use for drawing the OBJMESH.
+	
+	\return Return the number of indices sent for drawing. (Divided this number by 3 for knowing how many triangles)
+*/
+unsigned int OBJ_draw_mesh2( OBJ *obj, OBJMESH *objmesh )
+{
+	unsigned int i = 0;
+	
+	while( i != obj->n_objmesh )
+	{
+		if( &obj->objmesh[ i ] == objmesh )
+		{
+			return OBJ_draw_mesh( obj, i );
+		}
+		
+		++i;
+	}
+	
+	return 0;
+}
+
+
+/*!
+	Set all the necessary GLES machine state to draw a single OBJTRIANGLELIST of a specific OBJMESH index.
+	Unlike OBJ_draw_mesh, the OBJMESH visibility and distance are not checked. \sa RENDERQUEUE_draw
+	
+	\param[in] obj A valid OBJ structure pointer.
+	\param[in] mesh_index The mesh index in the OBJ OBJMESH database.
+	\param[in] triangle_list_index The OBJTRIANGLELIST index in the OBJMESH.
+
+	\return Return the number of indices sent for drawing. (Divided this number by 3 for knowing how many triangles)
+*/
+unsigned int OBJ_draw_triangle_list( OBJ *obj, unsigned int mesh_index, unsigned int triangle_list_index )
+{
+	OBJMESH *objmesh = &obj->objmesh[ mesh_index ];
+	
+	OBJTRIANGLELIST *objtrianglelist = &objmesh->objtrianglelist[ triangle_list_index ];
+
+	if( !objmesh->vbo ) return 0;
+
+	if( objmesh->vao ) GFX_bind_vertex_array( objmesh->vao );
+
+	else OBJ_set_attributes_mesh( obj, mesh_index );
+	
+	objmesh->current_material = objtrianglelist->objmaterial;
+
+	if( objmesh->current_material ) OBJ_draw_material( objmesh->current_material );
+	
+	if( objmesh->vertex_format & OBJ_VERTEX_FORMAT_SHORT_POSITION ) OBJ_set_vertex_scale( objmesh );
+	
+	if( !objmesh->vao || objmesh->n_objtrianglelist != 1 )
+	{ GFX_bind_buffer( GL_ELEMENT_ARRAY_BUFFER, objtrianglelist->vbo ); }
+
+	glDrawElements( objtrianglelist->mode,
+					objtrianglelist->n_indice_array,
+					objtrianglelist->indice_type,
+					( void * )NULL );
+
+	return objtrianglelist->n_indice_array;
+}
+
+
+/*!
+	Set all the necessary GLES machine state to draw the OBJMESH specified by the OBJMESH pointer received in parameter.
+	In addition this function will push the current matrix, translate, rotate and scale the OBJMESH then pop back the
+	current matrix.
+	
+	\param[in] obj A valid OBJ structure pointer.
+	\param[in] objmesh A valid OBJMESH structure pointer to use for drawing the OBJMESH.
+	
+	\return Return the number of indices sent for drawing. (Divided this number by 3 for knowing how many triangles)
+*/
+unsigned int OBJ_draw_mesh3( OBJ *obj, OBJMESH *objmesh )
+{
+	unsigned int n = 0,
+				 i = 0;
+	
+	while( i != obj->n_objmesh )
+	{
+		if( &obj->objmesh[ i ] == objmesh )
+		{
+			GFX_push_transform( &objmesh->location,
+								&objmesh->rotation,
+								&objmesh->scale );
+
+			n = OBJ_draw_mesh( obj, i );
+			
+			GFX_pop_matrix();
+			
+			return n;
+		}
+		
+		++i;
+	}
+	
+	return n;
+}
+
+
+/*!
+	Free the vertex data for a specific OBJMESH index.
+	
+	\param[in,out] obj A valid OBJ structure pointer.
+	\param[in] mesh_index The OBJMESH index to flush the vertex data for.
+*/
+void OBJ_free_mesh_vertex_data( OBJ *obj, unsigned int mesh_index )
+{
+	unsigned int i = 0;
+	
+	OBJMESH *objmesh = &obj->objmesh[ mesh_index ];
+
+	if( objmesh->objvertexdata )
+	{
+		free( objmesh->objvertexdata );
+		objmesh->objvertexdata = NULL;
+	}
+	
+	objmesh->n_objvertexdata = 0;
+	
+	while( i != objmesh->n_objtrianglelist )
+	{
+		free( objmesh->objtrianglelist[ i ].objtriangleindex );
+		objmesh->objtrianglelist[ i ].objtriangleindex = NULL;
+		
+		objmesh->objtrianglelist[ i ].n_objtriangleindex = 0;
+		
+		// The index arrays of a .gfxmesh are owned by the OBJ memory stream.
+		if( !obj->memory ) free( objmesh->objtrianglelist[ i ].indice_array );
+		objmesh->objtrianglelist[ i ].indice_array = NULL;
+		
+		++i;
+	}
+	
+	objmesh->vertex_array = NULL;
+}
+
+
+/*!
+	Function internally used to register the texture or shader program (.GFX) used by
+	a material channel.
+	
+	\param[in,out] obj A valid OBJ structure pointer.
+	\param[in] map The material channel filename.
+*/
+void OBJ_add_map( OBJ *obj, char *map )
+{
+	char ext[ MAX_CHAR ] = {""};
+	
+	get_file_extension( map, ext, 1 );
+	
+	if( !strcmp( ext, "GFX" ) ) OBJ_add_program( obj, map );
+	
+	else OBJ_add_texture( obj, map );
+}
+
+
+/*!
+	Function internally used by the OBJ and MTL parsers to skip the blank characters of a line.
+
+	\param[in] ptr The current read position.
+	\param[in] end The end of the current line.
+
+	\return Return the position of the first non blank character (or the end of the line).
+*/
+const char *OBJ_skip_space( const char *ptr, const char *end )
+{
+	while( ptr != end && ( *ptr == ' ' || *ptr == '\t' || *ptr == '\r' ) ) ++ptr;
+
+	return ptr;
+}
+
+
+/*!
+	Function internally used by the OBJ and MTL parsers to check if a line starts with a specific
+	keyword followed by at least one blank character.
+
+	\param[in] ptr The beginning of the line.
+	\param[in] end The end of the line.
+	\param[in] keyword The keyword to look for.
+
+	\return Return the position of the first argument following the keyword, or NULL if the line
+	does not start with the keyword.
+*/
+const char *OBJ_parse_keyword( const char *ptr, const char *end, const char *keyword )
+{
+	while( *keyword )
+	{
+		if( ptr == end || *ptr != *keyword ) return NULL;
+
+		++ptr;
+		++keyword;
+	}
+
+	if( ptr == end || ( *ptr != ' ' && *ptr != '\t' ) ) return NULL;
+
+	return OBJ_skip_space( ptr, end );
+}
+
+
+/*!
+	Function internally used by the OBJ and MTL parsers to read a signed integer.
+
+	\param[in] ptr The current read position.
+	\param[in] end The end of the current line.
+	\param[out] value Return the integer value.
+
+	\return Return the position following the integer, or NULL if no integer can be read.
+*/
+const char *OBJ_parse_int( const char *ptr, const char *end, int *value )
+{
+	int sign = 1,
+		i	 = 0;
+
+	const char *start;
+
+	ptr = OBJ_skip_space( ptr, end );
+
+	if( ptr != end && ( *ptr == '-' || *ptr == '+' ) )
+	{
+		if( *ptr == '-' ) sign = -1;
+		++ptr;
+	}
+
+	start = ptr;
+
+	while( ptr != end && *ptr >= '0' && *ptr <= '9' )
+	{
+		i = ( i * 10 ) + ( *ptr - '0' );
+		++ptr;
+	}
+
+	if( ptr == start ) return NULL;
+
+	*value = i * sign;
+
+	return ptr;
+}
+
+
+/*!
+	Function internally used by the OBJ and MTL parsers to read a floating point value in decimal
+	or scientific notation. The digits are accumulated as an integer and scaled once by a power
+	of 10, which is both faster and as precise as the libc conversion for the values exported by
+	modeling tools.
+
+	\param[in] ptr The current read position.
+	\param[in] end The end of the current line.
+	\param[out] value Return the floating point value.
+
+	\return Return the position following the value, or NULL if no value can be read.
+*/
+const char *OBJ_parse_float( const char *ptr, const char *end, float *value )
+{
+	static const double power[ 23 ] = { 1e0 , 1e1 , 1e2 , 1e3 , 1e4 , 1e5 , 1e6 , 1e7 ,
+										1e8 , 1e9 , 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+										1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	unsigned long long mantissa = 0;
+
+	unsigned char negative = 0,
+				  digits   = 0;
+
+	int exponent = 0,
+		e		 = 0;
+
+	double d;
+
+	ptr = OBJ_skip_space( ptr, end );
+
+	if( ptr != end && ( *ptr == '-' || *ptr == '+' ) )
+	{
+		negative = ( *ptr == '-' );
+		++ptr;
+	}
+
+	while( ptr != end && *ptr >= '0' && *ptr <= '9' )
+	{
+		if( mantissa < 1000000000000000000ULL ) mantissa = ( mantissa * 10 ) + ( *ptr - '0' );
+		else ++exponent;
+
+		++digits;
+		++ptr;
+	}
+
+	if( ptr != end && *ptr == '.' )
+	{
+		++ptr;
+
+		while( ptr != end && *ptr >= '0' && *ptr <= '9' )
+		{
+			if( mantissa < 1000000000000000000ULL )
+			{
+				mantissa = ( mantissa * 10 ) + ( *ptr - '0' );
+				--exponent;
+			}
+
+			++digits;
+			++ptr;
+		}
+	}
+
+	if( !digits ) return NULL;
+
+	if( ptr != end && ( *ptr == 'e' || *ptr == 'E' ) )
+	{
+		const char *exp = ptr + 1;
+
+		int sign = 1;
+
+		if( exp != end && ( *exp == '-' || *exp == '+' ) )
+		{
+			if( *exp == '-' ) sign = -1;
+			++exp;
+		}
+
+		if( exp != end && *exp >= '0' && *exp <= '9' )
+		{
+			while( exp != end && *exp >= '0' && *exp <= '9' )
+			{
+				if( e < 10000 ) e = ( e * 10 ) + ( *exp - '0' );
+				++exp;
+			}
+
+			exponent += e * sign;
+			ptr = exp;
+		}
+	}
+
+	d = ( double )mantissa;
+
+	if( exponent < 0 )
+	{
+		if( exponent >= -22 ) d /= power[ -exponent ];
+		else d *= pow( 10.0, exponent );
+	}
+	else if( exponent > 0 )
+	{
+		if( exponent <= 22 ) d *= power[ exponent ];
+		else d *= pow( 10.0, exponent );
+	}
+
+	*value = ( float )( negative ? -d : d );
+
+	return ptr;
+}
+
+
+/*!
+	Function internally used by the OBJ and MTL parsers to read a series of floating point values.
+
+	\param[in] ptr The current read position.
+	\param[in] end The end of the current line.
+	\param[out] value The array that receive the values.
+	\param[in] n The maximum number of values to read.
+
+	\return Return the number of values that have been read.
+*/
+unsigned int OBJ_parse_floats( const char *ptr, const char *end, float *value, unsigned int n )
+{
+	unsigned int i = 0;
+
+	while( i != n && ( ptr = OBJ_parse_float( ptr, end, &value[ i ] ) ) ) ++i;
+
+	return i;
+}
+
+
+/*!
+	Function internally used by the OBJ and MTL parsers to copy a blank separated word.
+
+	\param[in] ptr The current read position.
+	\param[in] end The end of the current line.
+	\param[out] str The destination string.
+	\param[in] size The size of the destination string in bytes.
+
+	\return Return the position following the word, or NULL if the line does not contain any word.
+*/
+const char *OBJ_parse_string( const char *ptr, const char *end, char *str, unsigned int size )
+{
+	unsigned int i = 0;
+
+	ptr = OBJ_skip_space( ptr, end );
+
+	if( ptr == end ) return NULL;
+
+	while( ptr != end && *ptr != ' ' && *ptr != '\t' && *ptr != '\r' )
+	{
+		if( i < size - 1 ) str[ i++ ] = *ptr;
+		++ptr;
+	}
+
+	str[ i ] = 0;
+
+	return ptr;
+}
+
+
+/*!
+	Function internally used by the OBJ and MTL parsers to locate the next line of a buffer.
+
+	\param[in] ptr The beginning of the line.
+	\param[in] end The end of the buffer.
+
+	\return Return the end of the line (the position of the line feed or the end of the buffer).
+*/
+const char *OBJ_get_line_end( const char *ptr, const char *end )
+{
+	const char *eol = ( const char * ) memchr( ptr, '\n', end - ptr );
+
+	return eol ? eol : end;
+}
+
+
+/*!
+	Function internally used by the OBJ parser to read a face vertex in any of the v, v//n,
+	v/t or v/t/n syntax. Negative (relative) indices are resolved against the number of
+	vertex and UV loaded so far.
+
+	\param[in] obj A valid OBJ structure pointer.
+	\param[in] ptr The current read position.
+	\param[in] end The end of the current line.
+	\param[out] vertex_index Return the zero based vertex index.
+	\param[out] uv_index Return the zero based UV index, or -1 if the vertex does not have a UV.
+
+	\return Return the position following the face vertex, or NULL if no face vertex can be read.
+*/
+const char *OBJ_parse_face_vertex( OBJ		  *obj,
+								   const char *ptr,
+								   const char *end,
+								   int		  *vertex_index,
+								   int		  *uv_index )
+{
+	int index;
+
+	if( !( ptr = OBJ_parse_int( ptr, end, &index ) ) ) return NULL;
+
+	*vertex_index = index < 0 ? obj->n_indexed_vertex + index : index - 1;
+	*uv_index	  = -1;
+
+	if( ptr != end && *ptr == '/' )
+	{
+		++ptr;
+
+		if( ptr != end && *ptr != '/' )
+		{
+			if( !( ptr = OBJ_parse_int( ptr, end, &index ) ) ) return NULL;
+
+			*uv_index = index < 0 ? obj->n_indexed_uv + index : index - 1;
+		}
+
+		// Drop the normal index.
+		if( ptr != end && *ptr == '/' )
+		{
+			++ptr;
+
+			if( ptr != end && ( *ptr == '-' || ( *ptr >= '0' && *ptr <= '9' ) ) )
+			{ ptr = OBJ_parse_int( ptr, end, &index ); }
+		}
+	}
+
+	return ptr;
+}
+
+
+/*!
+	Helper function to load an MTL file.
+
+	\param[in,out] obj A valid OBJ structure pointer.
+	\param[in] filename The .MTL filename to load.
+	\param[in] relative_path Determine if the filename is relative to the application or an absolute path.
+	
+	\return Return 1 if the file was loaded successfully, else return 0.
 */
 unsigned char OBJ_load_mtl( OBJ *obj, char *filename, unsigned char relative_path )
 {
 	MEMORY *m = mopen( filename, relative_path );
 
-	OBJMATERIAL *objmaterial = NULL;
+	OBJMATERIAL *objmaterial = NULL;
+
+	if( !m ) return 0; 
+
+	get_file_path( m->filename, obj->texture_path );
+
+	get_file_path( m->filename, obj->program_path );
+
+	const char *line = ( const char * )m->buffer,
+			   *end  = line + m->size,
+			   *eol,
+			   *arg;
+
+	char str[ MAX_PATH ] = {""},
+		 *map;
+		 
+	vec3 v;
+
+	while( line < end )
+	{
+		eol = OBJ_get_line_end( line, end );
+
+		map = NULL;
+
+		if( line == eol || line[ 0 ] == '#' ) goto next_mat_line;
+		
+		else if( ( arg = OBJ_parse_keyword( line, eol, "newmtl" ) ) &&
+				 OBJ_parse_string( arg, eol, str, MAX_PATH ) )
+		{
+			++obj->n_objmaterial;
+			
+			obj->objmaterial = ( OBJMATERIAL * ) realloc( obj->objmaterial, 
+														  obj->n_objmaterial *
+														  sizeof( OBJMATERIAL ) );
+			
+			objmaterial = &obj->objmaterial[ obj->n_objmaterial - 1 ];
+			
+			memset( objmaterial, 0, sizeof( OBJMATERIAL ) );
+					
+			strcpy( objmaterial->name, str );
+		}
+
+		else if( ( arg = OBJ_parse_keyword( line, eol, "Ka" ) ) &&
+				 OBJ_parse_floats( arg, eol, ( float * )&v, 3 ) == 3 )
+		{ memcpy( &objmaterial->ambient, &v, sizeof( vec3 ) ); }
+
+		else if( ( arg = OBJ_parse_keyword( line, eol, "Kd" ) ) &&
+				 OBJ_parse_floats( arg, eol, ( float * )&v, 3 ) == 3 )
+		{ memcpy( &objmaterial->diffuse, &v, sizeof( vec3 ) ); }
+
+		else if( ( arg = OBJ_parse_keyword( line, eol, "Ks" ) ) &&
+				 OBJ_parse_floats( arg, eol, ( float * )&v, 3 ) == 3 )
+		{ memcpy( &objmaterial->specular, &v, sizeof( vec3 ) ); }
+
+		else if( ( arg = OBJ_parse_keyword( line, eol, "Tf" ) ) &&
+				 OBJ_parse_floats( arg, eol, ( float * )&v, 3 ) == 3 )
+		{ memcpy( &objmaterial->transmission_filter, &v, sizeof( vec3 ) ); }
+
+		else if( ( arg = OBJ_parse_keyword( line, eol, "illum" ) ) &&
+				 OBJ_parse_float( arg, eol, &v.x ) )
+		{ objmaterial->illumination_model = ( int )v.x; }
+
+		else if( ( arg = OBJ_parse_keyword( line, eol, "d" ) ) &&
+				 OBJ_parse_float( arg, eol, &v.x ) )
+		{
+			objmaterial->ambient.w  = v.x;
+			objmaterial->diffuse.w  = v.x;
+			objmaterial->specular.w = v.x;
+			objmaterial->dissolve   = v.x;
+		}
+
+		else if( ( arg = OBJ_parse_keyword( line, eol, "Ns" ) ) &&
+				 OBJ_parse_float( arg, eol, &v.x ) )
+		{ objmaterial->specular_exponent = v.x; }
+
+		else if( ( arg = OBJ_parse_keyword( line, eol, "Ni" ) ) &&
+				 OBJ_parse_float( arg, eol, &v.x ) )
+		{ objmaterial->optical_density = v.x; }
+
+		else if( ( arg = OBJ_parse_keyword( line, eol, "map_Ka" ) ) &&
+				 OBJ_parse_string( arg, eol, str, MAX_PATH ) )
+		{ map = objmaterial->map_ambient; }
+
+		else if( ( arg = OBJ_parse_keyword( line, eol, "map_Kd" ) ) &&
+				 OBJ_parse_string( arg, eol, str, MAX_PATH ) )
+		{ map = objmaterial->map_diffuse; }
+
+		else if( ( arg = OBJ_parse_keyword( line, eol, "map_Ks" ) ) &&
+				 OBJ_parse_string( arg, eol, str, MAX_PATH ) )
+		{ map = objmaterial->map_specular; }
+
+		else if( ( arg = OBJ_parse_keyword( line, eol, "map_Tr" ) ) &&
+				 OBJ_parse_string( arg, eol, str, MAX_PATH ) )
+		{ map = objmaterial->map_translucency; }
+
+		else if( ( ( arg = OBJ_parse_keyword( line, eol, "map_disp" ) ) ||
+				   ( arg = OBJ_parse_keyword( line, eol, "map_Disp" ) ) ||
+				   ( arg = OBJ_parse_keyword( line, eol, "disp"		) ) ) &&
+				 OBJ_parse_string( arg, eol, str, MAX_PATH ) )
+		{ map = objmaterial->map_disp; }
+
+		else if( ( ( arg = OBJ_parse_keyword( line, eol, "map_bump" ) ) ||
+				   ( arg = OBJ_parse_keyword( line, eol, "map_Bump" ) ) ||
+				   ( arg = OBJ_parse_keyword( line, eol, "bump"		) ) ) &&
+				 OBJ_parse_string( arg, eol, str, MAX_PATH ) )
+		{ map = objmaterial->map_bump; }
+
+		if( map )
+		{
+			get_file_name( str, map );
+			
+			OBJ_add_map( obj, map );
+		}
+
+		next_mat_line:
+		
+			line = eol + 1;
+	}
+
+	mclose( m );
+
+	return 1;
+}
+
+
+//! Internal structure used to share the normals and tangents generation between threads.
+typedef struct
+{
+	//! The OBJ to process.
+	OBJ				*obj;
+	
+	//! The total number of triangles of the OBJ.
+	unsigned int	n_triangle;
+	
+	//! The normal array of each worker (the worker 0 is using the OBJ indexed_normal array).
+	vec3			**normal;
+
+	//! The face normal array of each worker (the worker 0 is using the OBJ indexed_fnormal array).
+	vec3			**fnormal;
+	
+	//! The tangent array of each worker (the worker 0 is using the OBJ indexed_tangent array).
+	vec3			**tangent;
+	
+	//! Flag array for each worker to determine which face normals have been written.
+	unsigned char	**written;
+
+} OBJNORMALTASK;
+
+
+/*!
+	Function internally used to accumulate the normals and tangent of a triangle.
+	
+	\param[in] obj A valid OBJ structure pointer.
+	\param[in] objtrianglelist The OBJTRIANGLELIST the triangle belongs to.
+	\param[in] objtriangleindex The triangle.
+	\param[in,out] normal The normal array to accumulate the smooth normals to.
+	\param[in,out] fnormal The face normal array.
+	\param[in,out] tangent The tangent array to accumulate the tangents to.
+	\param[in,out] written Flag array used to mark the face normals written (can be NULL).
+*/
+void OBJ_accumulate_triangle( OBJ			   *obj,
+							  OBJTRIANGLELIST  *objtrianglelist,
+							  OBJTRIANGLEINDEX *objtriangleindex,
+							  vec3			   *normal,
+							  vec3			   *fnormal,
+							  vec3			   *tangent,
+							  unsigned char	   *written )
+{
+	unsigned int i;
+	
+	vec3 v1,
+		 v2,
+		 n;
+
+	vec3_diff( &v1,
+			   &obj->indexed_vertex[ objtriangleindex->vertex_index[ 0 ] ],
+			   &obj->indexed_vertex[ objtriangleindex->vertex_index[ 1 ] ] );
+
+	vec3_diff( &v2,
+			   &obj->indexed_vertex[ objtriangleindex->vertex_index[ 0 ] ],
+			   &obj->indexed_vertex[ objtriangleindex->vertex_index[ 2 ] ] );
+
+	vec3_cross( &n, &v1, &v2 );
+		
+	vec3_normalize( &n, &n );
+	
+	
+	i = 0;
+	while( i != 3 )
+	{
+		// Face normals
+		memcpy( &fnormal[ objtriangleindex->vertex_index[ i ] ],
+				&n,
+				sizeof( vec3 ) );
+		
+		if( written ) written[ objtriangleindex->vertex_index[ i ] ] = 1;
+		
+		// Smooth normals
+		vec3_add( &normal[ objtriangleindex->vertex_index[ i ] ], 
+				  &normal[ objtriangleindex->vertex_index[ i ] ],
+				  &n );
+		++i;
+	}
+
+	
+	if( objtrianglelist->useuvs )
+	{
+		vec3 t;
+		
+		vec2 uv1, uv2;
+	
+		float c;
+		
+		vec2_diff( &uv1,
+				   &obj->indexed_uv[ objtriangleindex->uv_index[ 2 ] ],
+				   &obj->indexed_uv[ objtriangleindex->uv_index[ 0 ] ] );
+
+		vec2_diff( &uv2,
+				   &obj->indexed_uv[ objtriangleindex->uv_index[ 1 ] ],
+				   &obj->indexed_uv[ objtriangleindex->uv_index[ 0 ] ] );
+		
+
+		c = 1.0f / ( uv1.x * uv2.y - uv2.x * uv1.y );
+		
+		t.x = ( v1.x * uv2.y + v2.x * uv1.y ) * c;
+		t.y = ( v1.y * uv2.y + v2.y * uv1.y ) * c;
+		t.z = ( v1.z * uv2.y + v2.z * uv1.y ) * c;
+
+		i = 0;
+		while( i != 3 )
+		{
+			vec3_add( &tangent[ objtriangleindex->vertex_index[ i ] ], 
+					  &tangent[ objtriangleindex->vertex_index[ i ] ],
+					  &t );
+			++i;
+		}
+	}
+}
+
+
+/*!
+	Function internally used as THREAD_dispatch callback to accumulate the normals and
+	tangents of a range of triangles. The triangles are split in contiguous ranges (in
+	the order they appear in the OBJ) and every worker except the first one accumulate
+	inside its own partial arrays.
+	
+	\param[in,out] userdata The OBJNORMALTASK.
+	\param[in] index The worker index.
+	\param[in] n_thread The number of workers.
+*/
+void OBJ_accumulate_normals_tangents( void *userdata, unsigned int index, unsigned int n_thread )
+{
+	OBJNORMALTASK *objnormaltask = ( OBJNORMALTASK * )userdata;
+	
+	OBJ *obj = objnormaltask->obj;
+	
+	unsigned int i = 0,
+				 j,
+				 k,
+				 n	   = 0,
+				 first = ( unsigned int )( ( ( unsigned long long )objnormaltask->n_triangle *   index		 ) / n_thread ),
+				 last  = ( unsigned int )( ( ( unsigned long long )objnormaltask->n_triangle * ( index + 1 ) ) / n_thread );
+	
+	if( index )
+	{
+		objnormaltask->normal [ index ] = ( vec3 * ) calloc( obj->n_indexed_vertex, sizeof( vec3 ) );
+		objnormaltask->fnormal[ index ] = ( vec3 * ) calloc( obj->n_indexed_vertex, sizeof( vec3 ) );
+		objnormaltask->tangent[ index ] = ( vec3 * ) calloc( obj->n_indexed_vertex, sizeof( vec3 ) );
+		objnormaltask->written[ index ] = ( unsigned char * ) calloc( obj->n_indexed_vertex, 1 );
+	}
+	
+	while( i != obj->n_objmesh && n < last )
+	{
+		OBJMESH *objmesh = &obj->objmesh[ i ];
+		
+		j = 0;
+		while( j != objmesh->n_objtrianglelist && n < last )
+		{
+			OBJTRIANGLELIST *objtrianglelist = &objmesh->objtrianglelist[ j ];
+			
+			k = first > n ? first - n : 0;
+			
+			while( k < objtrianglelist->n_objtriangleindex && ( n + k ) < last )
+			{
+				OBJ_accumulate_triangle( obj,
+										 objtrianglelist,
+										 &objtrianglelist->objtriangleindex[ k ],
+										 objnormaltask->normal [ index ],
+										 objnormaltask->fnormal[ index ],
+										 objnormaltask->tangent[ index ],
+										 objnormaltask->written[ index ] );
+				++k;
+			}
+			
+			n += objtrianglelist->n_objtriangleindex;
+			++j;
+		}
+		
+		++i;
+	}
+}
+
+
+/*!
+	Function internally used as THREAD_dispatch callback to merge the partial arrays of
+	the workers for a range of vertices, and normalize the resulting normals and tangents.
+	
+	\param[in,out] userdata The OBJNORMALTASK.
+	\param[in] index The worker index.
+	\param[in] n_thread The number of workers.
+*/
+void OBJ_reduce_normals_tangents( void *userdata, unsigned int index, unsigned int n_thread )
+{
+	OBJNORMALTASK *objnormaltask = ( OBJNORMALTASK * )userdata;
+	
+	OBJ *obj = objnormaltask->obj;
+	
+	unsigned int i,
+				 j,
+				 first = ( unsigned int )( ( ( unsigned long long )obj->n_indexed_vertex *   index		 ) / n_thread ),
+				 last  = ( unsigned int )( ( ( unsigned long long )obj->n_indexed_vertex * ( index + 1 ) ) / n_thread );
+	
+	// The face normal of a vertex is the one of the last triangle using it.
+	j = 1;
+	while( j != n_thread )
+	{
+		i = first;
+		while( i != last )
+		{
+			vec3_add( &obj->indexed_normal[ i ], &obj->indexed_normal[ i ], &objnormaltask->normal[ j ][ i ] );
+			
+			vec3_add( &obj->indexed_tangent[ i ], &obj->indexed_tangent[ i ], &objnormaltask->tangent[ j ][ i ] );
+			
+			if( objnormaltask->written[ j ][ i ] )
+			{
+				memcpy( &obj->indexed_fnormal[ i ],
+						&objnormaltask->fnormal[ j ][ i ],
+						sizeof( vec3 ) );
+			}
+			
+			++i;
+		}
+		
+		++j;
+	}
+	
+	// Average smooth normals.
+	vec3_normalize_array( &obj->indexed_normal[ first ], &obj->indexed_normal[ first ], last - first );
+	
+	vec3_normalize_array( &obj->indexed_tangent[ first ], &obj->indexed_tangent[ first ], last - first );
+}
+
+
+/*!
+	Build the smooth normals, face normals and tangents of an OBJ. This function is called
+	internally by OBJ_load and OBJ_load2 and expect the normal, face normal and tangent arrays
+	to be cleared. When more than one thread is used, the triangles are divided in ranges and
+	each thread accumulates in its own partial arrays that are merged at the end, the results
+	are equal to the single threaded path within float precision.
+	
+	\param[in,out] obj A valid OBJ structure pointer.
+	\param[in] n_thread The number of threads to use (0 to use one thread per processor).
+*/
+void OBJ_build_normals_tangents( OBJ *obj, unsigned int n_thread )
+{
+	unsigned int i = 0,
+				 j;
+	
+	OBJNORMALTASK objnormaltask;
+	
+	memset( &objnormaltask, 0, sizeof( OBJNORMALTASK ) );
+	
+	objnormaltask.obj = obj;
+	
+	while( i != obj->n_objmesh )
+	{
+		j = 0;
+		while( j != obj->objmesh[ i ].n_objtrianglelist )
+		{
+			objnormaltask.n_triangle += obj->objmesh[ i ].objtrianglelist[ j ].n_objtriangleindex;
+			++j;
+		}
+		
+		++i;
+	}
+	
+	if( !n_thread ) n_thread = THREAD_get_cpu_count();
+	
+	// Not worth splitting small meshes.
+	if( n_thread > ( objnormaltask.n_triangle >> 12 ) ) n_thread = ( objnormaltask.n_triangle >> 12 );
+	
+	if( !n_thread ) n_thread = 1;
+	
+	objnormaltask.normal  = ( vec3 ** ) calloc( n_thread, sizeof( vec3 * ) );
+	objnormaltask.fnormal = ( vec3 ** ) calloc( n_thread, sizeof( vec3 * ) );
+	objnormaltask.tangent = ( vec3 ** ) calloc( n_thread, sizeof( vec3 * ) );
+	objnormaltask.written = ( unsigned char ** ) calloc( n_thread, sizeof( unsigned char * ) );
+	
+	objnormaltask.normal [ 0 ] = obj->indexed_normal;
+	objnormaltask.fnormal[ 0 ] = obj->indexed_fnormal;
+	objnormaltask.tangent[ 0 ] = obj->indexed_tangent;
+	
+	THREAD_dispatch( OBJ_accumulate_normals_tangents, &objnormaltask, n_thread );
+	
+	THREAD_dispatch( OBJ_reduce_normals_tangents, &objnormaltask, n_thread );
+	
+	i = 1;
+	while( i < n_thread )
+	{
+		free( objnormaltask.normal [ i ] );
+		free( objnormaltask.fnormal[ i ] );
+		free( objnormaltask.tangent[ i ] );
+		free( objnormaltask.written[ i ] );
+		++i;
+	}
+	
+	free( objnormaltask.normal  );
+	free( objnormaltask.fnormal );
+	free( objnormaltask.tangent );
+	free( objnormaltask.written );
+}
+
 
-	if( !m ) return 0; 
+/*!
+	Helper function to load an OBJ file.
 
-	get_file_path( m->filename, obj->texture_path );
+	\param[in] filename The .OBJ filename to load.
+	\param[in] relative_path Determine if the filename is relative to the application or an absolute path.
+	
+	\return Return a new OBJ structure pointer.
+*/
+OBJ *OBJ_load( char *filename, unsigned char relative_path )
+{ return OBJ_load2( filename, relative_path, 1 ); }
 
-	get_file_path( m->filename, obj->program_path );
 
-	char *line = strtok( ( char * )m->buffer, "\n" ),
-		 str[ MAX_PATH ] = {""};
-		 
-	vec3 v;
+/*!
+	Same as OBJ_load, but the normals and tangents are generated using multiple threads
+	(see OBJ_build_normals_tangents).
+
+	\param[in] filename The .OBJ filename to load.
+	\param[in] relative_path Determine if the filename is relative to the application or an absolute path.
+	\param[in] n_thread The number of threads to use (0 to use one thread per processor).
+	
+	\return Return a new OBJ structure pointer.
+*/
+OBJ *OBJ_load2( char *filename, unsigned char relative_path, unsigned int n_thread )
+{
+	OBJ *obj = NULL;
+	
+	MEMORY *o = mopen( filename, relative_path );
+	
+	if( !o ) return obj;
 
-	while( line )
+	else
 	{
-		if( !line[ 0 ] || line[ 0 ] == '#' ) goto next_mat_line;
+		char name  [ MAX_CHAR ] = {""},	
+			 group [ MAX_CHAR ] = {""},
+			 usemtl[ MAX_CHAR ] = {""},
+			 str   [ MAX_PATH ] = {""},
+			 last  = 0;
 		
-		else if( sscanf( line, "newmtl %s", str ) == 1 )
+		const char *line = ( const char * )o->buffer,
+				   *end  = line + o->size,
+				   *eol,
+				   *arg;
+		
+		unsigned char use_smooth_normals;
+		
+		OBJMESH *objmesh = NULL;
+		
+		OBJTRIANGLELIST *objtrianglelist = NULL;
+		
+		OBJVERTEXHASH objvertexhash;
+		
+		vec3 v;
+
+		memset( &objvertexhash, 0, sizeof( OBJVERTEXHASH ) );
+
+		obj = ( OBJ * ) calloc( 1, sizeof( OBJ ) );
+
+		while( line < end )
 		{
-			++obj->n_objmaterial;
+			eol = OBJ_get_line_end( line, end );
 			
-			obj->objmaterial = ( OBJMATERIAL * ) realloc( obj->objmaterial, 
-														  obj->n_objmaterial *
-														  sizeof( OBJMATERIAL ) );
+			if( line == eol ) goto skip_obj_line;
 			
-			objmaterial = &obj->objmaterial[ obj->n_objmaterial - 1 ];
+			else if( line[ 0 ] == '#' ) goto next_obj_line;
 			
-			memset( objmaterial, 0, sizeof( OBJMATERIAL ) );
-					
-			strcpy( objmaterial->name, str );
-		}
+			else if( ( arg = OBJ_parse_keyword( line, eol, "f" ) ) )
+			{
+				int vertex_index[ 3 ],
+					uv_index	[ 3 ];
+				
+				// Read the first two vertices of the face, then fan triangulate
+				// the polygon with each of the following vertices.
+				if( !( arg = OBJ_parse_face_vertex( obj, arg, eol, &vertex_index[ 0 ], &uv_index[ 0 ] ) ) ||
+					!( arg = OBJ_parse_face_vertex( obj, arg, eol, &vertex_index[ 1 ], &uv_index[ 1 ] ) ) )
+				{ goto next_obj_line; }
+				
+				while( ( arg = OBJ_parse_face_vertex( obj, arg, eol, &vertex_index[ 2 ], &uv_index[ 2 ] ) ) )
+				{
+					if( last != 'f' )
+					{
+						if( objmesh ) OBJMESH_shrink_vertex_data( objmesh );
+						
+						OBJVERTEXHASH_init( &objvertexhash, 64 );
+						
+						++obj->n_objmesh;
+									
+						obj->objmesh = ( OBJMESH * ) realloc( obj->objmesh,
+															  obj->n_objmesh *
+															  sizeof( OBJMESH ) );
 
-		else if( sscanf( line, "Ka %f %f %f", &v.x, &v.y, &v.z ) == 3 )
-		{ memcpy( &objmaterial->ambient, &v, sizeof( vec3 ) ); }
+						objmesh = &obj->objmesh[ obj->n_objmesh - 1 ];
+		
+						memset( objmesh, 0, sizeof( OBJMESH ) );
 
-		else if( sscanf( line, "Kd %f %f %f", &v.x, &v.y, &v.z ) == 3 )
-		{ memcpy( &objmaterial->diffuse, &v, sizeof( vec3 ) ); }
+						objmesh->scale.x  =
+						objmesh->scale.y  =
+						objmesh->scale.z  =
+						objmesh->distance = 1.0f;
+						objmesh->visible  = 1;
 
-		else if( sscanf( line, "Ks %f %f %f", &v.x, &v.y, &v.z ) == 3 )
-		{ memcpy( &objmaterial->specular, &v, sizeof( vec3 ) ); }
+						if( name[ 0 ] ) strcpy( objmesh->name, name );
+						
+						else if( usemtl[ 0 ] ) strcpy( objmesh->name, usemtl );
+						
+						if( group[ 0 ] ) strcpy( objmesh->group, group );
+						
+						objmesh->use_smooth_normals = use_smooth_normals;
+						
+						++objmesh->n_objtrianglelist;
 
-		else if( sscanf( line, "Tf %f %f %f", &v.x, &v.y, &v.z ) == 3 )
-		{ memcpy( &objmaterial->transmission_filter, &v, sizeof( vec3 ) ); }
+						objmesh->objtrianglelist = ( OBJTRIANGLELIST * ) realloc( objmesh->objtrianglelist, 
+																				  objmesh->n_objtrianglelist *
+																				  sizeof( OBJTRIANGLELIST ) );
 
-		else if( sscanf( line, "illum %f", &v.x ) == 1 )
-		{ objmaterial->illumination_model = ( int )v.x; }
+						objtrianglelist = &objmesh->objtrianglelist[ objmesh->n_objtrianglelist - 1 ];
+						
+						memset( objtrianglelist,
+								0,
+								sizeof( OBJTRIANGLELIST ) );
+						
+						objtrianglelist->mode = GL_TRIANGLES;
+						
+						objtrianglelist->indice_type = GL_UNSIGNED_SHORT;
+						
+						if( uv_index[ 0 ] != -1 ) objtrianglelist->useuvs = 1;
+						
+						
+						if( usemtl[ 0 ] ) objtrianglelist->objmaterial = OBJ_get_material( obj, usemtl, 1 );
 
-		else if( sscanf( line, "d %f", &v.x ) == 1 )
-		{
-			objmaterial->ambient.w  = v.x;
-			objmaterial->diffuse.w  = v.x;
-			objmaterial->specular.w = v.x;
-			objmaterial->dissolve   = v.x;
-		}
+						name  [ 0 ] = 0;
+						usemtl[ 0 ] = 0;
+						
+						last = 'f';
+					}
+					
+					OBJMESH_add_triangle( objmesh,
+										  objtrianglelist,
+										  &objvertexhash,
+										  vertex_index,
+										  uv_index );
+
+					vertex_index[ 1 ] = vertex_index[ 2 ];
+					uv_index	[ 1 ] = uv_index	[ 2 ];
+				}
+			}			
+			
+			else if( ( arg = OBJ_parse_keyword( line, eol, "v" ) ) &&
+					 OBJ_parse_floats( arg, eol, ( float * )&v, 3 ) == 3 )
+			{
+				// Vertex
+				obj->indexed_vertex = ( vec3 * ) OBJ_grow_array( obj->indexed_vertex,
+																 obj->n_indexed_vertex,
+																 sizeof( vec3 ) );
 
-		else if( sscanf( line, "Ns %f", &v.x ) == 1 )
-		{ objmaterial->specular_exponent = v.x; }
+				memcpy( &obj->indexed_vertex[ obj->n_indexed_vertex ],
+						&v,
+						sizeof( vec3 ) );
 
-		else if( sscanf( line, "Ni %f", &v.x ) == 1 )
-		{ objmaterial->optical_density = v.x; }
+				
+				// Normal
+				obj->indexed_normal = ( vec3 * ) OBJ_grow_array( obj->indexed_normal,
+																 obj->n_indexed_vertex,
+																 sizeof( vec3 ) );
 
-		else if( sscanf( line, "map_Ka %s", str ) == 1 )
-		{
-			get_file_name( str, objmaterial->map_ambient );
-			
-			get_file_extension( objmaterial->map_ambient, str, 1 );
+				obj->indexed_fnormal = ( vec3 * ) OBJ_grow_array( obj->indexed_fnormal,
+																  obj->n_indexed_vertex,
+																  sizeof( vec3 ) );
+														  
+				memset( &obj->indexed_normal[ obj->n_indexed_vertex ],
+						0,
+						sizeof( vec3 ) );
 			
-			if( !strcmp( str, "GFX" ) ) OBJ_add_program( obj, objmaterial->map_ambient );
 			
-			else OBJ_add_texture( obj, objmaterial->map_ambient );
-		}
-
-		else if( sscanf( line, "map_Kd %s", str ) == 1 )
-		{
-			get_file_name( str, objmaterial->map_diffuse );
+				memset( &obj->indexed_fnormal[ obj->n_indexed_vertex ],
+						0,
+						sizeof( vec3 ) );			
 			
-			get_file_extension( objmaterial->map_diffuse, str, 1 );
 			
-			if( !strcmp( str, "GFX" ) ) OBJ_add_program( obj, objmaterial->map_diffuse );
+				// Tangent
+				obj->indexed_tangent = ( vec3 * ) OBJ_grow_array( obj->indexed_tangent,
+																  obj->n_indexed_vertex,
+																  sizeof( vec3 ) );
+
+				memset( &obj->indexed_tangent[ obj->n_indexed_vertex ],
+						0,
+						sizeof( vec3 ) );
+
+				++obj->n_indexed_vertex;
+			}
+
+			// Drop the normals.
+			else if( line[ 0 ] == 'v' && line[ 1 ] == 'n' ) goto next_obj_line;
 			
-			else OBJ_add_texture( obj, objmaterial->map_diffuse );
+			else if( ( arg = OBJ_parse_keyword( line, eol, "vt" ) ) &&
+					 OBJ_parse_floats( arg, eol, ( float * )&v, 2 ) == 2 )
+			{
+				obj->indexed_uv = ( vec2 * ) OBJ_grow_array( obj->indexed_uv,
+															 obj->n_indexed_uv,
+															 sizeof( vec2 ) );
+				v.y = 1.0f - v.y;
+				
+				memcpy( &obj->indexed_uv[ obj->n_indexed_uv ],
+						&v,
+						sizeof( vec2 ) );
 
-		}
+				++obj->n_indexed_uv;
+			}			
 
-		else if( sscanf( line, "map_Ks %s", str ) == 1 )
-		{
-			get_file_name( str, objmaterial->map_specular );
+			else if( ( arg = OBJ_parse_keyword( line, eol, "usemtl" ) ) &&
+					 OBJ_parse_string( arg, eol, str, MAX_PATH ) ) strcpy( usemtl, str );
 			
-			get_file_extension( objmaterial->map_specular, str, 1 );
+			else if( ( arg = OBJ_parse_keyword( line, eol, "o" ) ) &&
+					 OBJ_parse_string( arg, eol, str, MAX_PATH ) ) strcpy( name, str );
+
+			else if( ( arg = OBJ_parse_keyword( line, eol, "g" ) ) &&
+					 OBJ_parse_string( arg, eol, str, MAX_PATH ) ) strcpy( group, str );
 			
-			if( !strcmp( str, "GFX" ) ) OBJ_add_program( obj, objmaterial->map_specular );
+			else if( ( arg = OBJ_parse_keyword( line, eol, "s" ) ) &&
+					 OBJ_parse_string( arg, eol, str, MAX_PATH ) )
+			{
+				use_smooth_normals = 1;
+				
+				if( strstr( str, "off" ) || strstr( str, "0" ) )
+				{ use_smooth_normals = 0; }
+			}
 			
-			else OBJ_add_texture( obj, objmaterial->map_specular );
-		}
+			else if( ( arg = OBJ_parse_keyword( line, eol, "mtllib" ) ) &&
+					 OBJ_parse_string( arg, eol, str, MAX_PATH ) ) OBJ_load_mtl( obj, str, relative_path );
 
-		else if( sscanf( line, "map_Tr %s", str ) == 1 )
-		{
-			get_file_name( str, objmaterial->map_translucency );
+			next_obj_line:
 			
-			get_file_extension( objmaterial->map_translucency, str, 1 );
+				last = line[ 0 ];
 			
-			if( !strcmp( str, "GFX" ) ) OBJ_add_program( obj, objmaterial->map_translucency );
+			skip_obj_line:
 			
-			else OBJ_add_texture( obj, objmaterial->map_translucency );
+				line = eol + 1;
+		}
+		
+		mclose( o );
+		
+		
+		// Release the extra memory reserved while growing the arrays.
+		if( objmesh ) OBJMESH_shrink_vertex_data( objmesh );
+		
+		OBJVERTEXHASH_free( &objvertexhash );
+		
+		if( obj->n_indexed_vertex )
+		{
+			obj->indexed_vertex  = ( vec3 * ) realloc( obj->indexed_vertex , obj->n_indexed_vertex * sizeof( vec3 ) );
+			obj->indexed_normal  = ( vec3 * ) realloc( obj->indexed_normal , obj->n_indexed_vertex * sizeof( vec3 ) );
+			obj->indexed_fnormal = ( vec3 * ) realloc( obj->indexed_fnormal, obj->n_indexed_vertex * sizeof( vec3 ) );
+			obj->indexed_tangent = ( vec3 * ) realloc( obj->indexed_tangent, obj->n_indexed_vertex * sizeof( vec3 ) );
 		}
+		
+		if( obj->n_indexed_uv ) obj->indexed_uv = ( vec2 * ) realloc( obj->indexed_uv, obj->n_indexed_uv * sizeof( vec2 ) );
+	}
+
+	
+	OBJ_build_normals_tangents( obj, n_thread );
+
+	return obj;
+}
+
+
+/*!
+	Function internally used by OBJ_save_bin and MD5_save_bin to append a chunk of data to a
+	growing buffer.
+	
+	\param[in,out] buffer The buffer to append the data to.
+	\param[in,out] size The current size of the buffer in bytes.
+	\param[in] data The data to append (if NULL the chunk is filled with zeros).
+	\param[in] length The size of the data in bytes.
+	\param[in] alignment The alignment in bytes of the chunk from the beginning of the buffer.
+	
+	\return Return the location of the chunk from the beginning of the buffer.
+*/
+unsigned int OBJ_append_bin( unsigned char **buffer,
+							 unsigned int  *size,
+							 const void	   *data,
+							 unsigned int  length,
+							 unsigned int  alignment )
+{
+	unsigned int offset = ( *size + alignment - 1 ) & ~( alignment - 1 );
+	
+	*buffer = ( unsigned char * ) realloc( *buffer, offset + length );
+	
+	memset( *buffer + *size, 0, offset - *size );
+	
+	if( data ) memcpy( *buffer + offset, data, length );
+	
+	else memset( *buffer + offset, 0, length );
+	
+	*size = offset + length;
+	
+	return offset;
+}
 
-		else if( sscanf( line, "map_disp %s", str ) == 1 ||
-				 sscanf( line, "map_Disp %s", str ) == 1 ||
-				 sscanf( line, "disp %s"    , str ) == 1 )
+
+/*!
+	Compile an OBJ to a .gfxmesh binary file. The file contains the materials, the final
+	interleaved vertex array of each OBJMESH (as built by OBJ_build_vbo_mesh), the index
+	array of each OBJTRIANGLELIST and the OBJMESH bounds, so it can be loaded back using
+	OBJ_load_bin without any parsing or processing.
+	
+	The OBJ vertex data have to be available (the function have to be called before
+	OBJ_free_mesh_vertex_data and OBJ_free_vertex_data). If you want to optimize the
+	OBJMESH do it before saving.
+	
+	\param[in,out] obj A valid OBJ structure pointer.
+	\param[in] filename The .gfxmesh filename to create.
+	
+	\return Return 1 if the file was created successfully, else return 0.
+*/
+unsigned char OBJ_save_bin( OBJ *obj, char *filename )
+{
+	unsigned int i,
+				 j,
+				 size	  = 0,
+				 mesh	  = 0;
+	
+	unsigned char *buffer = NULL;
+	
+	OBJBINHEADER objbinheader;
+	
+	FILE *f;
+	
+	
+	OBJ_append_bin( &buffer, &size, NULL, sizeof( OBJBINHEADER ), 4 );
+	
+	i = 0;
+	while( i != obj->n_objmaterial )
+	{
+		OBJMATERIAL *objmaterial = &obj->objmaterial[ i ];
+		
+		OBJBINMATERIAL objbinmaterial;
+		
+		memset( &objbinmaterial, 0, sizeof( OBJBINMATERIAL ) );
+		
+		strcpy( objbinmaterial.name, objmaterial->name );
+		
+		memcpy( &objbinmaterial.ambient			   , &objmaterial->ambient			  , sizeof( vec4 ) );
+		memcpy( &objbinmaterial.diffuse			   , &objmaterial->diffuse			  , sizeof( vec4 ) );
+		memcpy( &objbinmaterial.specular		   , &objmaterial->specular			  , sizeof( vec4 ) );
+		memcpy( &objbinmaterial.transmission_filter, &objmaterial->transmission_filter, sizeof( vec3 ) );
+		
+		objbinmaterial.illumination_model = objmaterial->illumination_model;
+		objbinmaterial.dissolve			  = objmaterial->dissolve;
+		objbinmaterial.specular_exponent  = objmaterial->specular_exponent;
+		objbinmaterial.optical_density	  = objmaterial->optical_density;
+		
+		strcpy( objbinmaterial.map_ambient	   , objmaterial->map_ambient	   );
+		strcpy( objbinmaterial.map_diffuse	   , objmaterial->map_diffuse	   );
+		strcpy( objbinmaterial.map_specular	   , objmaterial->map_specular	   );
+		strcpy( objbinmaterial.map_translucency, objmaterial->map_translucency );
+		strcpy( objbinmaterial.map_disp		   , objmaterial->map_disp		   );
+		strcpy( objbinmaterial.map_bump		   , objmaterial->map_bump		   );
+		
+		OBJ_append_bin( &buffer, &size, &objbinmaterial, sizeof( OBJBINMATERIAL ), 4 );
+		
+		++i;
+	}
+	
+	
+	if( obj->n_objmesh ) mesh = OBJ_append_bin( &buffer, &size, NULL, obj->n_objmesh * sizeof( OBJBINMESH ), 4 );
+	
+	i = 0;
+	while( i != obj->n_objmesh )
+	{
+		OBJMESH *objmesh = &obj->objmesh[ i ];
+		
+		OBJBINMESH objbinmesh;
+		
+		memset( &objbinmesh, 0, sizeof( OBJBINMESH ) );
+		
+		if( objmesh->n_objvertexdata )
 		{
-			get_file_name( str, objmaterial->map_disp );
+			unsigned char *vertex_array;
 			
-			get_file_extension( objmaterial->map_disp, str, 1 );
+			OBJ_update_bound_mesh( obj, i );
 			
-			if( !strcmp( str, "GFX" ) ) OBJ_add_program( obj, objmaterial->map_disp );
+			vertex_array = OBJ_build_vertex_array_mesh( obj, i );
 			
-			else OBJ_add_texture( obj, objmaterial->map_disp );
-
+			objbinmesh.vertex_array = OBJ_append_bin( &buffer, &size, vertex_array, objmesh->size, OBJ_BIN_ALIGNMENT );
+			
+			free( vertex_array );
 		}
-
-		else if( sscanf( line, "map_bump %s", str ) == 1 ||
-				 sscanf( line, "map_Bump %s", str ) == 1 ||
-				 sscanf( line, "bump %s"	, str ) == 1 )
+		
+		strcpy( objbinmesh.name , objmesh->name  );
+		strcpy( objbinmesh.group, objmesh->group );
+		
+		memcpy( &objbinmesh.location , &objmesh->location , sizeof( vec3 ) );
+		memcpy( &objbinmesh.min		 , &objmesh->min	  , sizeof( vec3 ) );
+		memcpy( &objbinmesh.max		 , &objmesh->max	  , sizeof( vec3 ) );
+		memcpy( &objbinmesh.dimension, &objmesh->dimension, sizeof( vec3 ) );
+		memcpy( objbinmesh.offset	 , objmesh->offset	  , sizeof( objmesh->offset ) );
+		
+		objbinmesh.radius			  = objmesh->radius;
+		objbinmesh.n_objvertexdata	  = objmesh->n_objvertexdata;
+		objbinmesh.stride			  = objmesh->stride;
+		objbinmesh.size				  = objmesh->n_objvertexdata ? objmesh->size : 0;
+		objbinmesh.n_objtrianglelist  = objmesh->n_objtrianglelist;
+		objbinmesh.use_smooth_normals = objmesh->use_smooth_normals;
+		objbinmesh.vertex_format	  = objmesh->vertex_format;
+		
+		memcpy( &objbinmesh.vertex_scale, &objmesh->vertex_scale, sizeof( vec3 ) );
+		
+		if( objmesh->n_objtrianglelist )
+		{
+			objbinmesh.objtrianglelist = OBJ_append_bin( &buffer,
+														 &size,
+														 NULL,
+														 objmesh->n_objtrianglelist * sizeof( OBJBINTRIANGLELIST ),
+														 4 );
+		}
+		
+		j = 0;
+		while( j != objmesh->n_objtrianglelist )
 		{
-			get_file_name( str, objmaterial->map_bump );
+			OBJTRIANGLELIST *objtrianglelist = &objmesh->objtrianglelist[ j ];
 			
-			get_file_extension( objmaterial->map_bump, str, 1 );
+			OBJBINTRIANGLELIST objbintrianglelist;
 			
-			if( !strcmp( str, "GFX" ) ) OBJ_add_program( obj, objmaterial->map_bump );
+			objbintrianglelist.material_index = objtrianglelist->objmaterial ?
+												( int )( objtrianglelist->objmaterial - obj->objmaterial ) :
+												-1;
+			objbintrianglelist.mode			  = objtrianglelist->mode;
+			objbintrianglelist.useuvs		  = objtrianglelist->useuvs;
+			objbintrianglelist.indice_type	  = objtrianglelist->indice_type;
+			objbintrianglelist.n_indice_array = objtrianglelist->n_indice_array;
+			objbintrianglelist.indice_array   = OBJ_append_bin( &buffer,
+															    &size,
+															    objtrianglelist->indice_array,
+															    objtrianglelist->n_indice_array * OBJTRIANGLELIST_get_indice_size( objtrianglelist ),
+															    OBJ_BIN_ALIGNMENT );
 			
-			else OBJ_add_texture( obj, objmaterial->map_bump );
+			memcpy( buffer + objbinmesh.objtrianglelist + ( j * sizeof( OBJBINTRIANGLELIST ) ),
+					&objbintrianglelist,
+					sizeof( OBJBINTRIANGLELIST ) );
+			++j;
 		}
-
-		next_mat_line:
 		
-			line = strtok( NULL, "\n" );
+		memcpy( buffer + mesh + ( i * sizeof( OBJBINMESH ) ),
+				&objbinmesh,
+				sizeof( OBJBINMESH ) );
+		++i;
+	}
+	
+	
+	memset( &objbinheader, 0, sizeof( OBJBINHEADER ) );
+	
+	strcpy( objbinheader.magic, OBJ_BIN_MAGIC );
+	
+	objbinheader.version	   = OBJ_BIN_VERSION;
+	objbinheader.n_objmaterial = obj->n_objmaterial;
+	objbinheader.n_objmesh	   = obj->n_objmesh;
+	objbinheader.size		   = size;
+	
+	memcpy( buffer, &objbinheader, sizeof( OBJBINHEADER ) );
+	
+	
+	f = fopen( filename, "wb" );
+	
+	if( f )
+	{
+		i = fwrite( buffer, size, 1, f );
+		
+		fclose( f );
 	}
+	
+	free( buffer );
+	
+	return f && i == 1;
+}
+
+
+/*!
+	Function internally used by OBJ_load_bin to check that an array stored in a memory
+	mapped file is entirely inside the file, without overflowing while computing its size.
+	
+	\param[in] m The memory mapped file.
+	\param[in] offset The location in bytes of the array from the beginning of the file.
+	\param[in] count The number of elements of the array.
+	\param[in] stride The size of an element in bytes.
+	
+	\return Return 1 if the array is valid, else return 0.
+*/
+unsigned char OBJ_check_bin( MEMORY *m, unsigned int offset, unsigned int count, unsigned int stride )
+{
+	if( !count ) return 1;
+	
+	return offset <= m->size && count <= ( m->size - offset ) / stride;
+}
 
-	mclose( m );
 
-	return 1;
+/*!
+	Function internally used by OBJ_load_bin to check that a fixed size name stored in a
+	.gfxmesh file is terminated.
+	
+	\param[in] name The name, MAX_CHAR characters.
+	
+	\return Return 1 if the name is valid, else return 0.
+*/
+unsigned char OBJ_check_bin_name( char *name )
+{
+	return memchr( name, 0, MAX_CHAR ) != NULL;
 }
 
 
 /*!
-	Helper function to load an OBJ file.
-
-	\param[in] filename The .OBJ filename to load.
-	\param[in] relative_path Determine if the filename is relative to the application or an absolute path.
+	Function internally used by OBJ_load_bin to validate the content of a .gfxmesh file
+	before creating the OBJ: every array must be inside the file, every name terminated,
+	every material index and vertex index in range, and the indices must be aligned 16 or 32 bits.
 	
-	\return Return a new OBJ structure pointer.
+	\param[in] m The memory mapped file, with a valid OBJBINHEADER.
+	
+	\return Return 1 if the file is valid, else return 0.
 */
-OBJ *OBJ_load( char *filename, unsigned char relative_path )
+unsigned char OBJ_check_bin_file( MEMORY *m )
 {
-	OBJ *obj = NULL;
+	unsigned int i = 0,
+				 j,
+				 k;
 	
-	MEMORY *o = mopen( filename, relative_path );
+	OBJBINHEADER *objbinheader = ( OBJBINHEADER * )m->buffer;
 	
-	if( !o ) return obj;
-
-	else
+	OBJBINMATERIAL *objbinmaterial = ( OBJBINMATERIAL * )&m->buffer[ sizeof( OBJBINHEADER ) ];
+	
+	OBJBINMESH *objbinmesh;
+	
+	if( !OBJ_check_bin( m, sizeof( OBJBINHEADER ), objbinheader->n_objmaterial, sizeof( OBJBINMATERIAL ) ) ||
+		!OBJ_check_bin( m,
+						sizeof( OBJBINHEADER ) + objbinheader->n_objmaterial * sizeof( OBJBINMATERIAL ),
+						objbinheader->n_objmesh,
+						sizeof( OBJBINMESH ) ) ) return 0;
+	
+	while( i != objbinheader->n_objmaterial )
 	{
-		char name  [ MAX_CHAR ] = {""},	
-			 group [ MAX_CHAR ] = {""},
-			 usemtl[ MAX_CHAR ] = {""},
-			 str   [ MAX_PATH ] = {""},
-			 last  = 0,
-			 *line = strtok( ( char * )o->buffer, "\n" );
+		if( !OBJ_check_bin_name( objbinmaterial[ i ].name			  ) ||
+			!OBJ_check_bin_name( objbinmaterial[ i ].map_ambient	  ) ||
+			!OBJ_check_bin_name( objbinmaterial[ i ].map_diffuse	  ) ||
+			!OBJ_check_bin_name( objbinmaterial[ i ].map_specular	  ) ||
+			!OBJ_check_bin_name( objbinmaterial[ i ].map_translucency ) ||
+			!OBJ_check_bin_name( objbinmaterial[ i ].map_disp		  ) ||
+			!OBJ_check_bin_name( objbinmaterial[ i ].map_bump		  ) ) return 0;
 		
-		unsigned char use_smooth_normals;
+		++i;
+	}
+	
+	objbinmesh = ( OBJBINMESH * )&objbinmaterial[ objbinheader->n_objmaterial ];
+	
+	i = 0;
+	while( i != objbinheader->n_objmesh )
+	{
+		OBJBINTRIANGLELIST *objbintrianglelist;
 		
-		OBJMESH *objmesh = NULL;
+		unsigned int n_vertex = objbinmesh[ i ].stride ? objbinmesh[ i ].size / objbinmesh[ i ].stride : 0;
 		
-		OBJTRIANGLELIST *objtrianglelist = NULL;
+		if( !OBJ_check_bin_name( objbinmesh[ i ].name  ) ||
+			!OBJ_check_bin_name( objbinmesh[ i ].group ) ||
+			!OBJ_check_bin( m, objbinmesh[ i ].vertex_array, objbinmesh[ i ].size, 1 ) ||
+			!OBJ_check_bin( m, objbinmesh[ i ].objtrianglelist, objbinmesh[ i ].n_objtrianglelist, sizeof( OBJBINTRIANGLELIST ) ) ) return 0;
 		
-		vec3 v;
-
-		obj = ( OBJ * ) calloc( 1, sizeof( OBJ ) );
-
-		while( line )
-		{	
-			if( !line[ 0 ] || line[ 0 ] == '#' ) goto next_obj_line;
+		objbintrianglelist = ( OBJBINTRIANGLELIST * )&m->buffer[ objbinmesh[ i ].objtrianglelist ];
+		
+		j = 0;
+		while( j != objbinmesh[ i ].n_objtrianglelist )
+		{
+			OBJBINTRIANGLELIST *t = &objbintrianglelist[ j ];
 			
-			else if( line[ 0 ] == 'f' && line[ 1 ] == ' ' )
+			if( t->material_index < -1 || t->material_index >= ( int )objbinheader->n_objmaterial ) return 0;
+			
+			if( t->indice_type == GL_UNSIGNED_SHORT )
 			{
-				unsigned char useuvs;
-						
-				int vertex_index[ 3 ] = { 0, 0, 0 },
-					normal_index[ 3 ] = { 0, 0, 0 },
-					uv_index	[ 3 ] = { 0, 0, 0 },
-					triangle_index;
-					
-				if( sscanf( line, "f %d %d %d", &vertex_index[ 0 ],
-												&vertex_index[ 1 ],
-												&vertex_index[ 2 ] ) == 3 )
-												{ useuvs = 0; }
-				
-				else if( sscanf( line, "f %d//%d %d//%d %d//%d", &vertex_index[ 0 ],
-																 &normal_index[ 0 ],
-																 &vertex_index[ 1 ],
-																 &normal_index[ 1 ],
-																 &vertex_index[ 2 ],
-																 &normal_index[ 2 ] ) == 6 )
-																 { useuvs = 0; }
-				
-				else if( sscanf( line, "f %d/%d %d/%d %d/%d", &vertex_index[ 0 ],
-															  &uv_index    [ 0 ],
-															  &vertex_index[ 1 ],
-															  &uv_index    [ 1 ],
-															  &vertex_index[ 2 ],
-															  &uv_index    [ 2 ] ) == 6 )
-															  { useuvs = 1; }
-				
-				else
-				{
-					sscanf( line, "f %d/%d/%d %d/%d/%d %d/%d/%d", &vertex_index[ 0 ],
-																  &uv_index    [ 0 ],
-																  &normal_index[ 0 ],
-																  &vertex_index[ 1 ],
-																  &uv_index    [ 1 ],
-																  &normal_index[ 1 ],
-																  &vertex_index[ 2 ],
-																  &uv_index    [ 2 ],
-																  &normal_index[ 2 ] );
-					useuvs = 1;
-				}
+				unsigned short *indice = ( unsigned short * )&m->buffer[ t->indice_array ];
 				
+				if( t->indice_array % sizeof( unsigned short ) || !OBJ_check_bin( m, t->indice_array, t->n_indice_array, sizeof( unsigned short ) ) ) return 0;
 				
-				if( last != 'f' )
+				k = 0;
+				while( k != t->n_indice_array )
 				{
-					++obj->n_objmesh;
-								
-					obj->objmesh = ( OBJMESH * ) realloc( obj->objmesh,
-														  obj->n_objmesh *
-														  sizeof( OBJMESH ) );
-
-					objmesh = &obj->objmesh[ obj->n_objmesh - 1 ];
-	
-					memset( objmesh, 0, sizeof( OBJMESH ) );
-
-					objmesh->scale.x  =
-					objmesh->scale.y  =
-					objmesh->scale.z  =
-					objmesh->distance = 1.0f;
-					objmesh->visible  = 1;
-
-					if( name[ 0 ] ) strcpy( objmesh->name, name );
-					
-					else if( usemtl[ 0 ] ) strcpy( objmesh->name, usemtl );
-					
-					if( group[ 0 ] ) strcpy( objmesh->group, group );
-					
-					objmesh->use_smooth_normals = use_smooth_normals;
-					
-					++objmesh->n_objtrianglelist;
-
-					objmesh->objtrianglelist = ( OBJTRIANGLELIST * ) realloc( objmesh->objtrianglelist, 
-																			  objmesh->n_objtrianglelist *
-																			  sizeof( OBJTRIANGLELIST ) );
-
-					objtrianglelist = &objmesh->objtrianglelist[ objmesh->n_objtrianglelist - 1 ];
-					
-					memset( objtrianglelist,
-							0,
-							sizeof( OBJTRIANGLELIST ) );
-					
-					objtrianglelist->mode = GL_TRIANGLES;
-					
-					if( useuvs ) objtrianglelist->useuvs = useuvs;
-					
-					
-					if( usemtl[ 0 ] ) objtrianglelist->objmaterial = OBJ_get_material( obj, usemtl, 1 );
-					
-					name  [ 0 ] = 0;
-					usemtl[ 0 ] = 0;
+					if( indice[ k ] >= n_vertex ) return 0;
+					++k;
 				}
-				
-				--vertex_index[ 0 ];
-				--vertex_index[ 1 ];
-				--vertex_index[ 2 ];
-
-				--uv_index[ 0 ];
-				--uv_index[ 1 ];
-				--uv_index[ 2 ];
-				
-				
-				OBJMESH_add_vertex_data( objmesh,
-										 objtrianglelist,
-										 vertex_index[ 0 ], 
-										 uv_index    [ 0 ] );
-
-				OBJMESH_add_vertex_data( objmesh,
-										 objtrianglelist,
-										 vertex_index[ 1 ], 
-										 uv_index    [ 1 ] );
-
-				OBJMESH_add_vertex_data( objmesh,
-										 objtrianglelist,
-										 vertex_index[ 2 ], 
-										 uv_index    [ 2 ] );
-										 
-				
-				triangle_index = objtrianglelist->n_objtriangleindex;
-				
-				++objtrianglelist->n_objtriangleindex;
-				
-				objtrianglelist->objtriangleindex = ( OBJTRIANGLEINDEX * ) realloc( objtrianglelist->objtriangleindex, 
-																					objtrianglelist->n_objtriangleindex * sizeof( OBJTRIANGLEINDEX ) );
-				
-				objtrianglelist->objtriangleindex[ triangle_index ].vertex_index[ 0 ] = vertex_index[ 0 ];
-				objtrianglelist->objtriangleindex[ triangle_index ].vertex_index[ 1 ] = vertex_index[ 1 ];
-				objtrianglelist->objtriangleindex[ triangle_index ].vertex_index[ 2 ] = vertex_index[ 2 ];
-
-				objtrianglelist->objtriangleindex[ triangle_index ].uv_index[ 0 ] = uv_index[ 0 ];
-				objtrianglelist->objtriangleindex[ triangle_index ].uv_index[ 1 ] = uv_index[ 1 ];
-				objtrianglelist->objtriangleindex[ triangle_index ].uv_index[ 2 ] = uv_index[ 2 ];
-			}			
-			
-			else if( sscanf( line, "v %f %f %f", &v.x, &v.y, &v.z ) == 3 )
-			{
-				// Vertex
-				++obj->n_indexed_vertex;
-				
-				obj->indexed_vertex = ( vec3 * ) realloc( obj->indexed_vertex,
-														  obj->n_indexed_vertex * 
-														  sizeof( vec3 ) );
-
-				memcpy( &obj->indexed_vertex[ obj->n_indexed_vertex - 1 ],
-						&v,
-						sizeof( vec3 ) );
-
-				
-				// Normal
-				obj->indexed_normal = ( vec3 * ) realloc( obj->indexed_normal,
-														  obj->n_indexed_vertex * 
-														  sizeof( vec3 ) );
-
-				obj->indexed_fnormal = ( vec3 * ) realloc( obj->indexed_fnormal,
-														   obj->n_indexed_vertex * 
-														   sizeof( vec3 ) );
-														  
-				memset( &obj->indexed_normal[ obj->n_indexed_vertex - 1 ],
-						0,
-						sizeof( vec3 ) );
-			
-			
-				memset( &obj->indexed_fnormal[ obj->n_indexed_vertex - 1 ],
-						0,
-						sizeof( vec3 ) );			
-			
-			
-				// Tangent
-				obj->indexed_tangent = ( vec3 * ) realloc( obj->indexed_tangent,
-														   obj->n_indexed_vertex * 
-														   sizeof( vec3 ) );
-
-				memset( &obj->indexed_tangent[ obj->n_indexed_vertex - 1 ],
-						0,
-						sizeof( vec3 ) );
 			}
-
-			// Drop the normals.
-			else if( sscanf( line, "vn %f %f %f", &v.x, &v.y, &v.z ) == 3 ) goto next_obj_line;
 			
-			else if( sscanf( line, "vt %f %f", &v.x, &v.y ) == 2 )
+			else if( t->indice_type == GL_UNSIGNED_INT )
 			{
-				++obj->n_indexed_uv;
-				
-				obj->indexed_uv = ( vec2 * ) realloc( obj->indexed_uv,
-													  obj->n_indexed_uv * 
-													  sizeof( vec2 ) );
-				v.y = 1.0f - v.y;
+				unsigned int *indice = ( unsigned int * )&m->buffer[ t->indice_array ];
 				
-				memcpy( &obj->indexed_uv[ obj->n_indexed_uv - 1 ],
-						&v,
-						sizeof( vec2 ) );
-			}			
-
-			else if( line[ 0 ] == 'v' && line[ 1 ] == 'n' ) goto next_obj_line;
-			
-			else if( sscanf( line, "usemtl %s", str ) == 1 ) strcpy( usemtl, str );
-			
-			else if( sscanf( line, "o %s", str ) == 1 ) strcpy( name, str );
-
-			else if( sscanf( line, "g %s", str ) == 1 ) strcpy( group, str );
-			
-			else if( sscanf( line, "s %s", str ) == 1 )
-			{
-				use_smooth_normals = 1;
+				if( t->indice_array % sizeof( unsigned int ) || !OBJ_check_bin( m, t->indice_array, t->n_indice_array, sizeof( unsigned int ) ) ) return 0;
 				
-				if( strstr( str, "off" ) || strstr( str, "0" ) )
-				{ use_smooth_normals = 0; }
+				k = 0;
+				while( k != t->n_indice_array )
+				{
+					if( indice[ k ] >= n_vertex ) return 0;
+					++k;
+				}
 			}
 			
-			else if( sscanf( line, "mtllib %s", str ) == 1 )
-			{
-				o->position = ( unsigned char * )line - o->buffer + strlen( line ) + 1;
-				
-				OBJ_load_mtl( obj, str, relative_path );
-				
-				line = strtok( ( char * )&o->buffer[ o->position ], "\n" );
-				continue;
-			}
-
-			next_obj_line:
+			else return 0;
 			
-				last = line[ 0 ];
-				line = strtok( NULL, "\n" );
+			++j;
 		}
 		
-		mclose( o );
+		++i;
 	}
-
 	
-	// Build Normals and Tangent
-	{
-		unsigned int i, j, k,index;
-		
-		i = 0;
-		while( i != obj->n_objmesh )
-		{
-			OBJMESH *objmesh = &obj->objmesh[ i ];
-		
-			// Accumulate Normals and Tangent
-			j = 0;
-			while( j != objmesh->n_objtrianglelist )
-			{
-				OBJTRIANGLELIST *objtrianglelist = &objmesh->objtrianglelist[ j ];
-
-				k = 0;
-				while( k != objtrianglelist->n_objtriangleindex )
-				{
-					vec3 v1,
-						 v2,
-						 normal;
-
-
-					vec3_diff( &v1,
-							   &obj->indexed_vertex[ objtrianglelist->objtriangleindex[ k ].vertex_index[ 0 ] ],
-							   &obj->indexed_vertex[ objtrianglelist->objtriangleindex[ k ].vertex_index[ 1 ] ] );
-
-					vec3_diff( &v2,
-							   &obj->indexed_vertex[ objtrianglelist->objtriangleindex[ k ].vertex_index[ 0 ] ],
-							   &obj->indexed_vertex[ objtrianglelist->objtriangleindex[ k ].vertex_index[ 2 ] ] );
-
-
-					vec3_cross( &normal, &v1, &v2 );
-						
-					vec3_normalize( &normal, &normal );
-					
-					
-					// Face normals
-					memcpy( &obj->indexed_fnormal[ objtrianglelist->objtriangleindex[ k ].vertex_index[ 0 ] ],
-							&normal,
-							sizeof( vec3 ) );
-
-					memcpy( &obj->indexed_fnormal[ objtrianglelist->objtriangleindex[ k ].vertex_index[ 1 ] ],
-							&normal,
-							sizeof( vec3 ) );
-
-					memcpy( &obj->indexed_fnormal[ objtrianglelist->objtriangleindex[ k ].vertex_index[ 2 ] ],
-							&normal,
-							sizeof( vec3 ) );
-					
-					
-					// Smooth normals
-					vec3_add( &obj->indexed_normal[ objtrianglelist->objtriangleindex[ k ].vertex_index[ 0 ] ], 
-							  &obj->indexed_normal[ objtrianglelist->objtriangleindex[ k ].vertex_index[ 0 ] ],
-							  &normal );
-
-					vec3_add( &obj->indexed_normal[ objtrianglelist->objtriangleindex[ k ].vertex_index[ 1 ] ], 
-							  &obj->indexed_normal[ objtrianglelist->objtriangleindex[ k ].vertex_index[ 1 ] ],
-							  &normal );
-
-					vec3_add( &obj->indexed_normal[ objtrianglelist->objtriangleindex[ k ].vertex_index[ 2 ] ], 
-							  &obj->indexed_normal[ objtrianglelist->objtriangleindex[ k ].vertex_index[ 2 ] ],
-							  &normal );
-
-				
-					if( objtrianglelist->useuvs )
-					{
-						vec3 tangent;
-						
-						vec2 uv1, uv2;
-					
-						float c;
-						
-						vec2_diff( &uv1,
-								   &obj->indexed_uv[ objtrianglelist->objtriangleindex[ k ].uv_index[ 2 ] ],
-								   &obj->indexed_uv[ objtrianglelist->objtriangleindex[ k ].uv_index[ 0 ] ] );
-
-						vec2_diff( &uv2,
-								   &obj->indexed_uv[ objtrianglelist->objtriangleindex[ k ].uv_index[ 1 ] ],
-								   &obj->indexed_uv[ objtrianglelist->objtriangleindex[ k ].uv_index[ 0 ] ] );
-						
-
-						c = 1.0f / ( uv1.x * uv2.y - uv2.x * uv1.y );
-						
-						tangent.x = ( v1.x * uv2.y + v2.x * uv1.y ) * c;
-						tangent.y = ( v1.y * uv2.y + v2.y * uv1.y ) * c;
-						tangent.z = ( v1.z * uv2.y + v2.z * uv1.y ) * c;
+	return 1;
+}
 
 
-						vec3_add( &obj->indexed_tangent[ objtrianglelist->objtriangleindex[ k ].vertex_index[ 0 ] ], 
-								  &obj->indexed_tangent[ objtrianglelist->objtriangleindex[ k ].vertex_index[ 0 ] ],
-								  &tangent );
+/*!
+	Load a .gfxmesh file created with OBJ_save_bin. The file is memory mapped (see mmopen)
+	and the OBJMESH vertex and index arrays are pointing directly inside it, so the
+	only work left is to call OBJ_build_mesh (or OBJ_build_mesh2) to send them to GLES.
+	The textures and shader programs are resolved relative to the location of the
+	.gfxmesh file.
+	
+	\param[in] filename The .gfxmesh filename to load.
+	\param[in] relative_path Determine if the filename is relative to the application or an absolute path.
+	
+	\return Return a new OBJ structure pointer, or NULL if the file cannot be loaded or is not valid.
+*/
+OBJ *OBJ_load_bin( char *filename, unsigned char relative_path )
+{
+	unsigned int i,
+				 j;
+	
+	OBJ *obj = NULL;
+	
+	OBJBINHEADER *objbinheader;
+	
+	OBJBINMATERIAL *objbinmaterial;
+	
+	OBJBINMESH *objbinmesh;
+	
+	MEMORY *m = mmopen( filename, relative_path );
+	
+	if( !m ) return obj;
+	
+	objbinheader = ( OBJBINHEADER * )m->buffer;
+	
+	if( m->size < sizeof( OBJBINHEADER )					 ||
+		strncmp( objbinheader->magic, OBJ_BIN_MAGIC, 8 ) ||
+		objbinheader->version != OBJ_BIN_VERSION			 ||
+		objbinheader->size	  != m->size				 ||
+		!OBJ_check_bin_file( m ) )
+	{
+		mclose( m );
+		return obj;
+	}
+	
+	obj = ( OBJ * ) calloc( 1, sizeof( OBJ ) );
 
-						vec3_add( &obj->indexed_tangent[ objtrianglelist->objtriangleindex[ k ].vertex_index[ 1 ] ], 
-								  &obj->indexed_tangent[ objtrianglelist->objtriangleindex[ k ].vertex_index[ 1 ] ],
-								  &tangent );
+	obj->memory = m;
+	
+	get_file_path( m->filename, obj->texture_path );
 
-						vec3_add( &obj->indexed_tangent[ objtrianglelist->objtriangleindex[ k ].vertex_index[ 2 ] ], 
-								  &obj->indexed_tangent[ objtrianglelist->objtriangleindex[ k ].vertex_index[ 2 ] ],
-								  &tangent );			
-					}
-				
-					++k;
-				}
-			
-				++j;
-			}
+	get_file_path( m->filename, obj->program_path );
+	
+	
+	objbinmaterial = ( OBJBINMATERIAL * )&m->buffer[ sizeof( OBJBINHEADER ) ];
+	
+	obj->n_objmaterial = objbinheader->n_objmaterial;
+	
+	if( obj->n_objmaterial ) obj->objmaterial = ( OBJMATERIAL * ) calloc( obj->n_objmaterial, sizeof( OBJMATERIAL ) );
+	
+	i = 0;
+	while( i != obj->n_objmaterial )
+	{
+		OBJMATERIAL *objmaterial = &obj->objmaterial[ i ];
 		
-			++i;
-		}
+		strcpy( objmaterial->name, objbinmaterial[ i ].name );
 		
-
-		// Normalize Normals & Tangent
-		i = 0;
-		while( i != obj->n_objmesh )
+		memcpy( &objmaterial->ambient			 , &objbinmaterial[ i ].ambient			   , sizeof( vec4 ) );
+		memcpy( &objmaterial->diffuse			 , &objbinmaterial[ i ].diffuse			   , sizeof( vec4 ) );
+		memcpy( &objmaterial->specular			 , &objbinmaterial[ i ].specular		   , sizeof( vec4 ) );
+		memcpy( &objmaterial->transmission_filter, &objbinmaterial[ i ].transmission_filter, sizeof( vec3 ) );
+		
+		objmaterial->illumination_model = objbinmaterial[ i ].illumination_model;
+		objmaterial->dissolve			= objbinmaterial[ i ].dissolve;
+		objmaterial->specular_exponent  = objbinmaterial[ i ].specular_exponent;
+		objmaterial->optical_density	= objbinmaterial[ i ].optical_density;
+		
+		strcpy( objmaterial->map_ambient	 , objbinmaterial[ i ].map_ambient		);
+		strcpy( objmaterial->map_diffuse	 , objbinmaterial[ i ].map_diffuse		);
+		strcpy( objmaterial->map_specular	 , objbinmaterial[ i ].map_specular		);
+		strcpy( objmaterial->map_translucency, objbinmaterial[ i ].map_translucency );
+		strcpy( objmaterial->map_disp		 , objbinmaterial[ i ].map_disp			);
+		strcpy( objmaterial->map_bump		 , objbinmaterial[ i ].map_bump			);
+		
+		if( objmaterial->map_ambient	 [ 0 ] ) OBJ_add_map( obj, objmaterial->map_ambient		 );
+		if( objmaterial->map_diffuse	 [ 0 ] ) OBJ_add_map( obj, objmaterial->map_diffuse		 );
+		if( objmaterial->map_specular	 [ 0 ] ) OBJ_add_map( obj, objmaterial->map_specular	 );
+		if( objmaterial->map_translucency[ 0 ] ) OBJ_add_map( obj, objmaterial->map_translucency );
+		if( objmaterial->map_disp		 [ 0 ] ) OBJ_add_map( obj, objmaterial->map_disp		 );
+		if( objmaterial->map_bump		 [ 0 ] ) OBJ_add_map( obj, objmaterial->map_bump		 );
+		
+		++i;
+	}
+	
+	
+	objbinmesh = ( OBJBINMESH * )&objbinmaterial[ obj->n_objmaterial ];
+	
+	obj->n_objmesh = objbinheader->n_objmesh;
+	
+	if( obj->n_objmesh ) obj->objmesh = ( OBJMESH * ) calloc( obj->n_objmesh, sizeof( OBJMESH ) );
+	
+	i = 0;
+	while( i != obj->n_objmesh )
+	{
+		OBJMESH *objmesh = &obj->objmesh[ i ];
+		
+		OBJBINTRIANGLELIST *objbintrianglelist = ( OBJBINTRIANGLELIST * )&m->buffer[ objbinmesh[ i ].objtrianglelist ];
+		
+		strcpy( objmesh->name , objbinmesh[ i ].name  );
+		strcpy( objmesh->group, objbinmesh[ i ].group );
+		
+		objmesh->scale.x  =
+		objmesh->scale.y  =
+		objmesh->scale.z  =
+		objmesh->distance = 1.0f;
+		objmesh->visible  = 1;
+		
+		memcpy( &objmesh->location , &objbinmesh[ i ].location , sizeof( vec3 ) );
+		memcpy( &objmesh->min	   , &objbinmesh[ i ].min	   , sizeof( vec3 ) );
+		memcpy( &objmesh->max	   , &objbinmesh[ i ].max	   , sizeof( vec3 ) );
+		memcpy( &objmesh->dimension, &objbinmesh[ i ].dimension, sizeof( vec3 ) );
+		memcpy( objmesh->offset	   , objbinmesh[ i ].offset	   , sizeof( objmesh->offset ) );
+		memcpy( &objmesh->vertex_scale, &objbinmesh[ i ].vertex_scale, sizeof( vec3 ) );
+		
+		objmesh->radius				= objbinmesh[ i ].radius;
+		objmesh->stride				= objbinmesh[ i ].stride;
+		objmesh->size				= objbinmesh[ i ].size;
+		objmesh->use_smooth_normals = objbinmesh[ i ].use_smooth_normals;
+		objmesh->vertex_format		= objbinmesh[ i ].vertex_format;
+		objmesh->vertex_array		= &m->buffer[ objbinmesh[ i ].vertex_array ];
+		
+		objmesh->n_objtrianglelist = objbinmesh[ i ].n_objtrianglelist;
+		
+		if( objmesh->n_objtrianglelist ) objmesh->objtrianglelist = ( OBJTRIANGLELIST * ) calloc( objmesh->n_objtrianglelist, sizeof( OBJTRIANGLELIST ) );
+		
+		j = 0;
+		while( j != objmesh->n_objtrianglelist )
 		{
-			j = 0;
-			while( j != obj->objmesh[ i ].n_objvertexdata )
-			{
-				index = obj->objmesh[ i ].objvertexdata[ j ].vertex_index;
-				
-				// Average smooth normals.
-				vec3_normalize( &obj->indexed_normal[ index ],
-								&obj->indexed_normal[ index ] );
-				
-				if( obj->objmesh[ i ].objvertexdata[ j ].uv_index != -1 )
-				{
-					vec3_normalize( &obj->indexed_tangent[ index ],
-									&obj->indexed_tangent[ index ] );
-				}
+			OBJTRIANGLELIST *objtrianglelist = &objmesh->objtrianglelist[ j ];
 			
-				++j;
-			}
+			objtrianglelist->mode			= objbintrianglelist[ j ].mode;
+			objtrianglelist->useuvs			= objbintrianglelist[ j ].useuvs;
+			objtrianglelist->indice_type	= objbintrianglelist[ j ].indice_type;
+			objtrianglelist->n_indice_array = objbintrianglelist[ j ].n_indice_array;
+			objtrianglelist->indice_array	= ( unsigned short * )&m->buffer[ objbintrianglelist[ j ].indice_array ];
 			
-			++i;
-		}	
+			if( objbintrianglelist[ j ].material_index != -1 )
+			{ objtrianglelist->objmaterial = &obj->objmaterial[ objbintrianglelist[ j ].material_index ]; }
+			
+			++j;
+		}
+		
+		++i;
 	}
-
+	
 	return obj;
 }
 
@@ -1768,9 +3797,13 @@ OBJ *OBJ_free( OBJ *obj )
 		++i;
 	}
 	
+	GFX_reset_state();
+	
 	free( obj->objmesh );
 	obj->objmesh = NULL;
 	
+	if( obj->memory ) obj->memory = mclose( obj->memory );
+	
 	
 	free( obj->objmaterial );
 	obj->objmaterial = NULL;
@@ -36,6 +36,32 @@ as being the original software.
 typedef void( MATERIALDRAWCALLBACK( void * ) );
 
 
+//! Flags to use with OBJ_set_vertex_format_mesh to control the layout of the OBJMESH vertex buffer.
+enum
+{
+	//! The default layout: float position, smooth normal, face normal, UV and tangent (56 bytes per vertex).
+	OBJ_VERTEX_FORMAT_FLOAT			 = 0,
+	
+	//! Only store the normal set selected by use_smooth_normals, NORMAL and FNORMAL are reading the same data.
+	OBJ_VERTEX_FORMAT_SINGLE_NORMAL	 = ( 1 << 0 ),
+	
+	//! Store the positions as half floats (GL_OES_vertex_half_float, else OBJ_build_vbo_mesh falls back to floats).
+	OBJ_VERTEX_FORMAT_HALF_POSITION	 = ( 1 << 1 ),
+	
+	//! Store the positions as normalized shorts relative to the OBJMESH bounding box, the shader have to apply the VERTEX_SCALE uniform set by OBJ_draw_mesh.
+	OBJ_VERTEX_FORMAT_SHORT_POSITION = ( 1 << 2 ),
+	
+	//! Store the normals and tangents as normalized bytes.
+	OBJ_VERTEX_FORMAT_BYTE_NORMAL	 = ( 1 << 3 ),
+	
+	//! Store the normals and tangents as octahedral encoded normalized shorts, the shader have to decode them.
+	OBJ_VERTEX_FORMAT_OCT_NORMAL	 = ( 1 << 4 ),
+	
+	//! Store the UVs as half floats (GL_OES_vertex_half_float, else OBJ_build_vbo_mesh falls back to floats).
+	OBJ_VERTEX_FORMAT_HALF_UV		 = ( 1 << 5 )
+};
+
+
 //! Wavefront OBJMATERIAL structure definition.
 typedef struct
 {
@@ -133,11 +159,20 @@ typedef struct
 	//! Flag to determine if the OBJTRIANGLELIST is using UVs.
 	unsigned char	 useuvs;
 	
+	//! The data type of the indices, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT if the triangle list is using more than 65536 vertices.
+	unsigned int	 indice_type;
+	
 	//! The number of indice required to draw the triangle list.
-	unsigned short	 n_indice_array;
+	unsigned int	 n_indice_array;
 	
-	//! Array of indices.
-	unsigned short   *indice_array;
+	union
+	{
+		//! Array of indices (when indice_type is GL_UNSIGNED_SHORT).
+		unsigned short	 *indice_array;
+		
+		//! Array of 32 bits indices (when indice_type is GL_UNSIGNED_INT).
+		unsigned int	 *indice_array32;
+	};
 	
 	//! Pointer to an OBJMATERIAL to use when drawing the OBJTRIANGLELIST. 
 	OBJMATERIAL		 *objmaterial;
@@ -176,7 +211,7 @@ typedef struct
 	char			group[ MAX_CHAR ]; // g
 
 	//! The number of OBJVERTEXDATA for this mesh.
-	unsigned short	n_objvertexdata;
+	unsigned int	n_objvertexdata;
 	
 	//! Array of OBJVERTEXDATA to be able to construct the mesh.
 	OBJVERTEXDATA	*objvertexdata;
@@ -234,6 +269,15 @@ typedef struct
 	
 	//! Determine if the OBJMESH is using vertex or face normals.
 	unsigned char	use_smooth_normals;
+	
+	//! The interleaved vertex data ready to be sent to GLES (only available for OBJMESH loaded from a .gfxmesh file).
+	unsigned char	*vertex_array;
+	
+	//! The OBJ_VERTEX_FORMAT flags used to build the vertex buffer.
+	unsigned int	vertex_format;
+	
+	//! The dequantization scale of the positions when using OBJ_VERTEX_FORMAT_SHORT_POSITION.
+	vec3			vertex_scale;
 
 } OBJMESH;
 
@@ -290,10 +334,152 @@ typedef struct
 	
 	//! Array of indexed UVs.
 	vec2			*indexed_uv;		// vt
+	
+	//! The memory mapped .gfxmesh file the vertex and index arrays are pointing to (NULL for .obj).
+	MEMORY			*memory;
 
 } OBJ;
 
 
+//! The .gfxmesh file signature.
+#define OBJ_BIN_MAGIC		"GFXMESH"
+
+//! The .gfxmesh file format version.
+#define OBJ_BIN_VERSION		3
+
+//! The alignment in bytes of the vertex and index arrays inside a .gfxmesh file.
+#define OBJ_BIN_ALIGNMENT	16
+
+//! The default post-transform vertex cache size used by OBJ_optimize_mesh2 and MD5_optimize2.
+#define OBJ_VERTEX_CACHE_SIZE	16
+
+
+//! The .gfxmesh file header.
+typedef struct
+{
+	//! The file signature (OBJ_BIN_MAGIC).
+	char			magic[ 8 ];
+	
+	//! The file format version (OBJ_BIN_VERSION).
+	unsigned int	version;
+	
+	//! The number of OBJBINMATERIAL following the header.
+	unsigned int	n_objmaterial;
+	
+	//! The number of OBJBINMESH following the materials.
+	unsigned int	n_objmesh;
+	
+	//! The total size of the file in bytes.
+	unsigned int	size;
+
+} OBJBINHEADER;
+
+
+//! The .gfxmesh representation of an OBJMATERIAL.
+typedef struct
+{
+	char			name[ MAX_CHAR ];
+	
+	vec4			ambient;
+	
+	vec4			diffuse;
+
+	vec4			specular;
+	
+	vec3			transmission_filter;
+
+	int				illumination_model;
+	
+	float			dissolve;
+	
+	float			specular_exponent;
+
+	float			optical_density;
+	
+	char			map_ambient[ MAX_CHAR ];
+	
+	char			map_diffuse[ MAX_CHAR ];
+	
+	char			map_specular[ MAX_CHAR ];
+
+	char			map_translucency[ MAX_CHAR ];
+
+	char			map_disp[ MAX_CHAR ];
+
+	char			map_bump[ MAX_CHAR ];
+
+} OBJBINMATERIAL;
+
+
+//! The .gfxmesh representation of an OBJTRIANGLELIST.
+typedef struct
+{
+	//! The OBJBINMATERIAL index (-1 if the triangle list does not have a material).
+	int				material_index;
+	
+	//! The drawing mode.
+	int				mode;
+	
+	//! Flag to determine if the triangle list is using UVs.
+	unsigned int	useuvs;
+	
+	//! The data type of the indices (GL_UNSIGNED_SHORT or GL_UNSIGNED_INT).
+	unsigned int	indice_type;
+	
+	//! The number of indices.
+	unsigned int	n_indice_array;
+	
+	//! The location in bytes of the index array from the beginning of the file.
+	unsigned int	indice_array;
+
+} OBJBINTRIANGLELIST;
+
+
+//! The .gfxmesh representation of an OBJMESH.
+typedef struct
+{
+	char			name[ MAX_CHAR ];
+	
+	char			group[ MAX_CHAR ];
+	
+	vec3			location;
+	
+	vec3			min;
+	
+	vec3			max;
+	
+	vec3			dimension;
+	
+	float			radius;
+	
+	//! The number of vertex in the vertex array.
+	unsigned int	n_objvertexdata;
+	
+	unsigned int	stride;
+	
+	unsigned int	size;
+	
+	unsigned int	offset[ 5 ];
+	
+	//! The location in bytes of the interleaved vertex array from the beginning of the file.
+	unsigned int	vertex_array;
+	
+	//! The number of OBJBINTRIANGLELIST.
+	unsigned int	n_objtrianglelist;
+	
+	//! The location in bytes of the OBJBINTRIANGLELIST array from the beginning of the file.
+	unsigned int	objtrianglelist;
+	
+	unsigned int	use_smooth_normals;
+	
+	//! The OBJ_VERTEX_FORMAT flags of the vertex array.
+	unsigned int	vertex_format;
+	
+	vec3			vertex_scale;
+
+} OBJBINMESH;
+
+
 void OBJ_build_texture( OBJ *obj, unsigned int texture_index, char *texture_path, unsigned int flags, unsigned char filter, float anisotropic_filter );
 
 void OBJ_build_program( OBJ	*obj, unsigned int program_index, PROGRAMBINDATTRIBCALLBACK *programbindattribcallback, PROGRAMDRAWCALLBACK *programdrawcallback, unsigned char debug_shader, char *program_path );
@@ -304,16 +490,28 @@ void OBJ_set_draw_callback_material( OBJ *obj, unsigned int material_index, MATE
 
 void OBJ_update_bound_mesh( OBJ *obj, unsigned int mesh_index );
 
-void OBJ_build_vbo_mesh( OBJ *obj, unsigned int mesh_index );
+void OBJ_set_vertex_format_mesh( OBJ *obj, unsigned int mesh_index, unsigned int vertex_format );
+
+unsigned char *OBJ_build_vertex_array_mesh( OBJ *obj, unsigned int mesh_index );
+
+unsigned char OBJ_build_vbo_mesh( OBJ *obj, unsigned int mesh_index );
 
 void OBJ_set_attributes_mesh( OBJ *obj, unsigned int mesh_index );
 
-void OBJ_build_mesh( OBJ *obj, unsigned int mesh_index );
+unsigned char OBJ_build_mesh( OBJ *obj, unsigned int mesh_index );
 
-void OBJ_build_mesh2( OBJ *obj, unsigned int mesh_index );
+unsigned char OBJ_build_mesh2( OBJ *obj, unsigned int mesh_index );
 
 void OBJ_optimize_mesh( OBJ *obj, unsigned int mesh_index, unsigned int vertex_cache_size );
 
+void OBJ_get_vertex_cache_ratio( unsigned int *indice, unsigned int n_indice, unsigned int n_vertex, unsigned int vertex_cache_size, float *acmr, float *atvr );
+
+void OBJ_optimize_vertex_cache( unsigned int *indice, unsigned int n_indice, unsigned int n_vertex, unsigned int vertex_cache_size );
+
+unsigned int OBJ_optimize_vertex_fetch( int *remap, unsigned int n_remap, unsigned int *indice, unsigned int n_indice );
+
+void OBJ_optimize_mesh2( OBJ *obj, unsigned int mesh_index, unsigned int vertex_cache_size );
+
 OBJMESH *OBJ_get_mesh( OBJ *obj, const char *name, unsigned char exact_name );
 
 int OBJ_get_mesh_index( OBJ *obj, const char *name, unsigned char exact_name );
@@ -332,12 +530,24 @@ unsigned int OBJ_draw_mesh2( OBJ *obj, OBJMESH *objmesh );
 
 unsigned int OBJ_draw_mesh3( OBJ *obj, OBJMESH *objmesh );
 
+unsigned int OBJ_draw_triangle_list( OBJ *obj, unsigned int mesh_index, unsigned int triangle_list_index );
+
 void OBJ_free_mesh_vertex_data( OBJ *obj, unsigned int mesh_index );
 
 unsigned char OBJ_load_mtl( OBJ *obj, char *filename, unsigned char relative_path );
 
+void OBJ_build_normals_tangents( OBJ *obj, unsigned int n_thread );
+
 OBJ *OBJ_load( char *filename, unsigned char relative_path );
 
+OBJ *OBJ_load2( char *filename, unsigned char relative_path, unsigned int n_thread );
+
+unsigned int OBJ_append_bin( unsigned char **buffer, unsigned int *size, const void *data, unsigned int length, unsigned int alignment );
+
+unsigned char OBJ_save_bin( OBJ *obj, char *filename );
+
+OBJ *OBJ_load_bin( char *filename, unsigned char relative_path );
+
 void OBJ_free_vertex_data( OBJ *obj );
 
 OBJ *OBJ_free( OBJ *obj );
@@ -36,6 +36,141 @@ as being the original software.
 */
 
 
+//! Global table of the interned uniform and vertex attribute names. Declared as extern in program.h
+PROGRAMNAME programname;
+
+
+/*!
+	Function internally used to compute the hash of a uniform or vertex attribute name (FNV-1a).
+	
+	\param[in] name The name to hash.
+	
+	\return Return the hash value.
+*/
+unsigned int PROGRAM_hash_name( char *name )
+{
+	unsigned int hash = 2166136261u;
+	
+	while( *name )
+	{
+		hash = ( hash ^ ( unsigned char )*name ) * 16777619u;
+		
+		++name;
+	}
+	
+	return hash;
+}
+
+
+/*!
+	Function internally used to find the slot of a name in the interned name hash table.
+	
+	\param[in] name The name to look for.
+	
+	\return Return the slot that contains the name id, or the empty slot where it should be inserted.
+*/
+unsigned int PROGRAM_get_name_slot( char *name )
+{
+	unsigned int mask = programname.hash_size - 1,
+				 slot = PROGRAM_hash_name( name ) & mask;
+
+	while( programname.hash[ slot ] &&
+		   strcmp( programname.name[ programname.hash[ slot ] - 1 ], name ) )
+	{ slot = ( slot + 1 ) & mask; }
+
+	return slot;
+}
+
+
+/*!
+	Retrieve the id of a uniform or vertex attribute name, without interning it.
+	
+	\param[in] name The name to look for.
+	
+	\return Return the name id, or -1 if the name have never been interned.
+*/
+int PROGRAM_find_name_id( char *name )
+{
+	if( !programname.hash_size ) return -1;
+	
+	return ( int )programname.hash[ PROGRAM_get_name_slot( name ) ] - 1;
+}
+
+
+/*!
+	Intern a uniform or vertex attribute name and return its id. The id is stable for the
+	lifetime of the application and is shared by all the PROGRAM, so it can be resolved once
+	(before or after linking) and used with PROGRAM_get_uniform_location2 and
+	PROGRAM_get_vertex_attrib_location2 to access the locations in constant time.
+	
+	\param[in] name The name of the uniform or vertex attribute.
+	
+	\return Return the name id.
+*/
+unsigned int PROGRAM_get_name_id( char *name )
+{
+	unsigned int slot;
+	
+	if( ( programname.n_name << 1 ) >= programname.hash_size )
+	{
+		unsigned int i = 0;
+		
+		programname.hash_size = programname.hash_size ? programname.hash_size << 1 : 64;
+		
+		programname.hash = ( unsigned int * ) realloc( programname.hash,
+													   programname.hash_size * sizeof( unsigned int ) );
+
+		memset( programname.hash, 0, programname.hash_size * sizeof( unsigned int ) );
+
+		while( i != programname.n_name )
+		{
+			programname.hash[ PROGRAM_get_name_slot( programname.name[ i ] ) ] = i + 1;
+			
+			++i;
+		}
+	}
+	
+	slot = PROGRAM_get_name_slot( name );
+	
+	if( !programname.hash[ slot ] )
+	{
+		programname.name = ( char ** ) realloc( programname.name,
+												( programname.n_name + 1 ) * sizeof( char * ) );
+
+		programname.name[ programname.n_name ] = strdup( name );
+		
+		++programname.n_name;
+
+		programname.hash[ slot ] = programname.n_name;
+	}
+	
+	return programname.hash[ slot ] - 1;
+}
+
+
+/*!
+	Free the interned name table. Only call this function when all the PROGRAM have been freed,
+	since the ids previously returned by PROGRAM_get_name_id are no longer valid.
+*/
+void PROGRAM_free_name( void )
+{
+	unsigned int i = 0;
+	
+	while( i != programname.n_name )
+	{
+		free( programname.name[ i ] );
+		
+		++i;
+	}
+	
+	if( programname.name ) free( programname.name );
+	
+	if( programname.hash ) free( programname.hash );
+	
+	memset( &programname, 0, sizeof( PROGRAMNAME ) );
+}
+
+
 /*!
 	Initialize a new PROGRAM structure.
 	
@@ -62,10 +197,23 @@ PROGRAM *PROGRAM_init( char *name )
 */
 PROGRAM *PROGRAM_free( PROGRAM *program )
 {
+	unsigned int i = 0;
+	
+	while( i != program->uniform_count )
+	{
+		if( program->uniform_array[ i ].value ) free( program->uniform_array[ i ].value );
+		
+		++i;
+	}
+
 	if( program->uniform_array ) free( program->uniform_array );
 	
 	if( program->vertex_attrib_array ) free( program->vertex_attrib_array );
 	
+	if( program->uniform_map ) free( program->uniform_map );
+	
+	if( program->vertex_attrib_map ) free( program->vertex_attrib_map );
+	
 	if( program->pid ) PROGRAM_delete_id( program );
 
 	free( program );
@@ -134,12 +282,14 @@ PROGRAM *PROGRAM_create( char						  *name,
 	\param[in,out] program A valid PROGRAM structure pointer.
 	\param[in] name The name of the uniform.
 	\param[in] type The variable type for this uniform.
+	\param[in] size The number of elements of the uniform (greater than 1 for arrays).
 	
 	\return Return the newly created UNIFORM index inside the PROGRAM uniform database.
 */
-unsigned char PROGRAM_add_uniform( PROGRAM *program, char *name, unsigned int type )
+unsigned int PROGRAM_add_uniform( PROGRAM *program, char *name, unsigned int type, int size )
 {
-	unsigned char uniform_index = program->uniform_count;
+	unsigned int uniform_index = program->uniform_count,
+				 length;
 	
 	++program->uniform_count;
 
@@ -150,10 +300,25 @@ unsigned char PROGRAM_add_uniform( PROGRAM *program, char *name, unsigned int ty
 	
 	strcpy( program->uniform_array[ uniform_index ].name, name );
 	
+	name = program->uniform_array[ uniform_index ].name;
+	
+	// Arrays are reported as "NAME[0]", drop the suffix to retrieve them using their declared name.
+	length = strlen( name );
+	
+	if( length > 3 && !strcmp( &name[ length - 3 ], "[0]" ) ) name[ length - 3 ] = 0;
+	
 	program->uniform_array[ uniform_index ].type = type;
 	
+	program->uniform_array[ uniform_index ].size = size;
+	
 	program->uniform_array[ uniform_index ].location = glGetUniformLocation( program->pid, name );
 	
+	program->uniform_array[ uniform_index ].id = PROGRAM_get_name_id( name );
+	
+	program->uniform_array[ uniform_index ].value_size = PROGRAM_get_uniform_type_size( type ) * size;
+	
+	program->uniform_array[ uniform_index ].value = ( unsigned char * ) malloc( program->uniform_array[ uniform_index ].value_size );
+	
 	return uniform_index;
 }
 
@@ -167,9 +332,9 @@ unsigned char PROGRAM_add_uniform( PROGRAM *program, char *name, unsigned int ty
 	
 	\return Return the newly created VERTEX_ATTRIB index inside the PROGRAM vertex attribute database.
 */
-unsigned char PROGRAM_add_vertex_attrib( PROGRAM *program, char *name, unsigned int type )
+unsigned int PROGRAM_add_vertex_attrib( PROGRAM *program, char *name, unsigned int type )
 {
-	unsigned char vertex_attrib_index = program->vertex_attrib_count;
+	unsigned int vertex_attrib_index = program->vertex_attrib_count;
 	
 	++program->vertex_attrib_count;
 
@@ -184,6 +349,8 @@ unsigned char PROGRAM_add_vertex_attrib( PROGRAM *program, char *name, unsigned
 	
 	program->vertex_attrib_array[ vertex_attrib_index ].location = glGetAttribLocation( program->pid, name );
 	
+	program->vertex_attrib_array[ vertex_attrib_index ].id = PROGRAM_get_name_id( name );
+	
 	return vertex_attrib_index;
 }
 
@@ -308,11 +475,40 @@ unsigned char PROGRAM_link( PROGRAM *program, unsigned char debug )
 							&type,
 							name );
 	
-		PROGRAM_add_uniform( program, name, type );
+		PROGRAM_add_uniform( program, name, type, size );
 	
 		++i;
 	}
 	
+	
+	// Map every interned name id to the uniform and vertex attribute indices.
+	program->n_map = programname.n_name;
+	
+	program->uniform_map = ( int * ) realloc( program->uniform_map,
+											  program->n_map * sizeof( int ) );
+
+	program->vertex_attrib_map = ( int * ) realloc( program->vertex_attrib_map,
+													program->n_map * sizeof( int ) );
+
+	memset( program->uniform_map	  , -1, program->n_map * sizeof( int ) );
+	memset( program->vertex_attrib_map, -1, program->n_map * sizeof( int ) );
+	
+	i = 0;
+	while( i != program->uniform_count )
+	{
+		program->uniform_map[ program->uniform_array[ i ].id ] = i;
+		
+		++i;
+	}
+
+	i = 0;
+	while( i != program->vertex_attrib_count )
+	{
+		program->vertex_attrib_map[ program->vertex_attrib_array[ i ].id ] = i;
+		
+		++i;
+	}
+	
 	return 1;
 
 	
@@ -352,21 +548,29 @@ void PROGRAM_set_bind_attrib_location_callback( PROGRAM *program, PROGRAMBINDATT
 	\param[in] program A valid PROGRAM structure pointer.
 	\param[in] name The name of the vertex attribute.
 	
-	\return Return the vertex attribute location.
+	\return Return the vertex attribute location, or -1 if the vertex attribute is not used by the PROGRAM.
 */
-char PROGRAM_get_vertex_attrib_location( PROGRAM *program, char *name )
+int PROGRAM_get_vertex_attrib_location( PROGRAM *program, char *name )
 {
-	unsigned char i = 0;
+	int id = PROGRAM_find_name_id( name );
 	
-	while( i != program->vertex_attrib_count )
-	{
-		if( !strcmp( program->vertex_attrib_array[ i ].name, name ) )
-		{ return program->vertex_attrib_array[ i ].location; }
-		
-		++i;
-	}
+	return id == -1 ? -1 : PROGRAM_get_vertex_attrib_location2( program, id );
+}
+
 
-	return -1;
+/*!
+	Retrieve a vertex attribute location using an interned name id, without any string compare.
+
+	\param[in] program A valid PROGRAM structure pointer.
+	\param[in] id The vertex attribute name id returned by PROGRAM_get_name_id.
+	
+	\return Return the vertex attribute location, or -1 if the vertex attribute is not used by the PROGRAM.
+*/
+int PROGRAM_get_vertex_attrib_location2( PROGRAM *program, unsigned int id )
+{
+	if( id >= program->n_map || program->vertex_attrib_map[ id ] == -1 ) return -1;
+	
+	return program->vertex_attrib_array[ program->vertex_attrib_map[ id ] ].location;
 }
 
 
@@ -376,24 +580,232 @@ char PROGRAM_get_vertex_attrib_location( PROGRAM *program, char *name )
 	\param[in] program A valid PROGRAM structure pointer.
 	\param[in] name The name of the uniform.
 	
-	\return Return the uniform location.
+	\return Return the uniform location, or -1 if the uniform is not used by the PROGRAM.
 */
-char PROGRAM_get_uniform_location( PROGRAM *program, char *name )
+int PROGRAM_get_uniform_location( PROGRAM *program, char *name )
 {
-	unsigned char i = 0;
+	int id = PROGRAM_find_name_id( name );
 	
-	while( i != program->uniform_count )
+	return id == -1 ? -1 : PROGRAM_get_uniform_location2( program, id );
+}
+
+
+/*!
+	Retrieve a uniform location using an interned name id, without any string compare.
+
+	\param[in] program A valid PROGRAM structure pointer.
+	\param[in] id The uniform name id returned by PROGRAM_get_name_id.
+	
+	\return Return the uniform location, or -1 if the uniform is not used by the PROGRAM.
+*/
+int PROGRAM_get_uniform_location2( PROGRAM *program, unsigned int id )
+{
+	if( id >= program->n_map || program->uniform_map[ id ] == -1 ) return -1;
+	
+	return program->uniform_array[ program->uniform_map[ id ] ].location;
+}
+
+
+/*!
+	Retrieve the size in bytes of a GLSL uniform type.
+	
+	\param[in] type The GL type of the uniform (as returned by glGetActiveUniform).
+	
+	\return Return the size in bytes of the type, samplers and booleans are stored as int.
+*/
+unsigned int PROGRAM_get_uniform_type_size( unsigned int type )
+{
+	switch( type )
 	{
-		if( !strcmp( program->uniform_array[ i ].name, name ) )
-		{ return program->uniform_array[ i ].location; }
-		
-		++i;
+		case GL_FLOAT	   : return sizeof( float );
+		case GL_FLOAT_VEC2 : return sizeof( float ) * 2;
+		case GL_FLOAT_VEC3 : return sizeof( float ) * 3;
+		case GL_FLOAT_VEC4 : return sizeof( float ) * 4;
+		case GL_FLOAT_MAT2 : return sizeof( float ) * 4;
+		case GL_FLOAT_MAT3 : return sizeof( float ) * 9;
+		case GL_FLOAT_MAT4 : return sizeof( float ) * 16;
+		case GL_INT_VEC2   :
+		case GL_BOOL_VEC2  : return sizeof( int ) * 2;
+		case GL_INT_VEC3   :
+		case GL_BOOL_VEC3  : return sizeof( int ) * 3;
+		case GL_INT_VEC4   :
+		case GL_BOOL_VEC4  : return sizeof( int ) * 4;
 	}
+	
+	// GL_INT, GL_BOOL, GL_SAMPLER_2D and GL_SAMPLER_CUBE.
+	return sizeof( int );
+}
 
-	return -1;
+
+/*!
+	Retrieve a UNIFORM using an interned name id.
+
+	\param[in] program A valid PROGRAM structure pointer.
+	\param[in] id The uniform name id returned by PROGRAM_get_name_id.
+	
+	\return Return the UNIFORM pointer, or NULL if the uniform is not used by the PROGRAM.
+*/
+UNIFORM *PROGRAM_get_uniform( PROGRAM *program, unsigned int id )
+{
+	if( id >= program->n_map || program->uniform_map[ id ] == -1 ) return NULL;
+	
+	return &program->uniform_array[ program->uniform_map[ id ] ];
 }
 
 
+/*!
+	Set the value of a uniform. The value is compared with the last value uploaded for this
+	uniform and is only sent to the driver if it changed. The PROGRAM have to be the one in
+	use (ideally call this function from the PROGRAMDRAWCALLBACK or the MATERIALDRAWCALLBACK).
+	Values set directly with glUniform are not seen by the shadow copy, so a uniform should
+	always be set the same way.
+	The number of uploads issued and skipped can be retrieved using GFX_get_uniform_counter.
+
+	\param[in,out] program A valid PROGRAM structure pointer.
+	\param[in] id The uniform name id returned by PROGRAM_get_name_id.
+	\param[in] value The value(s) to set, using the memory layout of the uniform type (int for samplers and booleans).
+	\param[in] count The number of elements to set (1 unless the uniform is an array).
+	
+	\return Return 1 if the value have been uploaded, 0 if it was unchanged or if the uniform is not used by the PROGRAM.
+*/
+unsigned char PROGRAM_set_uniform( PROGRAM *program, unsigned int id, void *value, int count )
+{
+	UNIFORM *uniform = PROGRAM_get_uniform( program, id );
+	
+	unsigned int size;
+
+	if( !uniform ) return 0;
+	
+	if( count > uniform->size ) count = uniform->size;
+	
+	size = PROGRAM_get_uniform_type_size( uniform->type ) * count;
+	
+	if( uniform->uploaded && !memcmp( uniform->value, value, size ) )
+	{
+		++gfx.state.n_uniform_elided;
+		return 0;
+	}
+	
+	switch( uniform->type )
+	{
+		case GL_FLOAT	   : { glUniform1fv( uniform->location, count, ( float * )value ); break; }
+		case GL_FLOAT_VEC2 : { glUniform2fv( uniform->location, count, ( float * )value ); break; }
+		case GL_FLOAT_VEC3 : { glUniform3fv( uniform->location, count, ( float * )value ); break; }
+		case GL_FLOAT_VEC4 : { glUniform4fv( uniform->location, count, ( float * )value ); break; }
+		case GL_FLOAT_MAT2 : { glUniformMatrix2fv( uniform->location, count, GL_FALSE, ( float * )value ); break; }
+		case GL_FLOAT_MAT3 : { glUniformMatrix3fv( uniform->location, count, GL_FALSE, ( float * )value ); break; }
+		case GL_FLOAT_MAT4 : { glUniformMatrix4fv( uniform->location, count, GL_FALSE, ( float * )value ); break; }
+		case GL_INT_VEC2   :
+		case GL_BOOL_VEC2  : { glUniform2iv( uniform->location, count, ( int * )value ); break; }
+		case GL_INT_VEC3   :
+		case GL_BOOL_VEC3  : { glUniform3iv( uniform->location, count, ( int * )value ); break; }
+		case GL_INT_VEC4   :
+		case GL_BOOL_VEC4  : { glUniform4iv( uniform->location, count, ( int * )value ); break; }
+		default			   : { glUniform1iv( uniform->location, count, ( int * )value ); break; }
+	}
+	
+	memcpy( uniform->value, value, size );
+	
+	// Only a full upload make the whole shadow copy valid.
+	if( count == uniform->size ) uniform->uploaded = 1;
+	
+	++gfx.state.n_uniform_issued;
+	
+	return 1;
+}
+
+
+/*!
+	Set the value of an int, bool or sampler uniform. \sa PROGRAM_set_uniform
+	
+	\param[in,out] program A valid PROGRAM structure pointer.
+	\param[in] id The uniform name id returned by PROGRAM_get_name_id.
+	\param[in] value The value to set.
+	
+	\return Return 1 if the value have been uploaded, else 0.
+*/
+unsigned char PROGRAM_set_uniform_1i( PROGRAM *program, unsigned int id, int value )
+{ return PROGRAM_set_uniform( program, id, &value, 1 ); }
+
+
+/*!
+	Set the value of a float uniform. \sa PROGRAM_set_uniform
+	
+	\param[in,out] program A valid PROGRAM structure pointer.
+	\param[in] id The uniform name id returned by PROGRAM_get_name_id.
+	\param[in] value The value to set.
+	
+	\return Return 1 if the value have been uploaded, else 0.
+*/
+unsigned char PROGRAM_set_uniform_1f( PROGRAM *program, unsigned int id, float value )
+{ return PROGRAM_set_uniform( program, id, &value, 1 ); }
+
+
+/*!
+	Set the value of a vec2 uniform. \sa PROGRAM_set_uniform
+	
+	\param[in,out] program A valid PROGRAM structure pointer.
+	\param[in] id The uniform name id returned by PROGRAM_get_name_id.
+	\param[in] value The value to set.
+	
+	\return Return 1 if the value have been uploaded, else 0.
+*/
+unsigned char PROGRAM_set_uniform_vec2( PROGRAM *program, unsigned int id, vec2 *value )
+{ return PROGRAM_set_uniform( program, id, value, 1 ); }
+
+
+/*!
+	Set the value of a vec3 uniform. \sa PROGRAM_set_uniform
+	
+	\param[in,out] program A valid PROGRAM structure pointer.
+	\param[in] id The uniform name id returned by PROGRAM_get_name_id.
+	\param[in] value The value to set.
+	
+	\return Return 1 if the value have been uploaded, else 0.
+*/
+unsigned char PROGRAM_set_uniform_vec3( PROGRAM *program, unsigned int id, vec3 *value )
+{ return PROGRAM_set_uniform( program, id, value, 1 ); }
+
+
+/*!
+	Set the value of a vec4 uniform. \sa PROGRAM_set_uniform
+	
+	\param[in,out] program A valid PROGRAM structure pointer.
+	\param[in] id The uniform name id returned by PROGRAM_get_name_id.
+	\param[in] value The value to set.
+	
+	\return Return 1 if the value have been uploaded, else 0.
+*/
+unsigned char PROGRAM_set_uniform_vec4( PROGRAM *program, unsigned int id, vec4 *value )
+{ return PROGRAM_set_uniform( program, id, value, 1 ); }
+
+
+/*!
+	Set the value of a mat3 uniform. \sa PROGRAM_set_uniform
+	
+	\param[in,out] program A valid PROGRAM structure pointer.
+	\param[in] id The uniform name id returned by PROGRAM_get_name_id.
+	\param[in] value The value to set.
+	
+	\return Return 1 if the value have been uploaded, else 0.
+*/
+unsigned char PROGRAM_set_uniform_mat3( PROGRAM *program, unsigned int id, mat3 *value )
+{ return PROGRAM_set_uniform( program, id, value, 1 ); }
+
+
+/*!
+	Set the value of a mat4 uniform. \sa PROGRAM_set_uniform
+	
+	\param[in,out] program A valid PROGRAM structure pointer.
+	\param[in] id The uniform name id returned by PROGRAM_get_name_id.
+	\param[in] value The value to set.
+	
+	\return Return 1 if the value have been uploaded, else 0.
+*/
+unsigned char PROGRAM_set_uniform_mat4( PROGRAM *program, unsigned int id, mat4 *value )
+{ return PROGRAM_set_uniform( program, id, value, 1 ); }
+
+
 /*!
 	Delete the GLSL program id attached to the PROGRAM structure.
 	
@@ -403,9 +815,20 @@ void PROGRAM_delete_id( PROGRAM *program )
 {
 	if( program->pid )
 	{
+		unsigned int i = 0;
+		
+		while( i != program->uniform_count )
+		{
+			program->uniform_array[ i ].uploaded = 0;
+			
+			++i;
+		}
+
 		glDeleteProgram( program->pid );
 
 		program->pid = 0;
+		
+		GFX_reset_state();
 	}
 }
 
@@ -419,7 +842,7 @@ void PROGRAM_delete_id( PROGRAM *program )
 */
 void PROGRAM_draw( PROGRAM *program )
 {
-	glUseProgram( program->pid );
+	GFX_use_program( program->pid );
 	
 	if( program->programdrawcallback ) program->programdrawcallback( program );	
 }
@@ -40,11 +40,26 @@ typedef struct
 	//! The variable type for this uniform.
 	unsigned int	type;
 	
+	//! The number of elements of the uniform (greater than 1 for arrays).
+	int				size;
+	
 	//! The location id maintained by GLSL for this uniform.
 	int				location;
 	
+	//! The interned name id of the uniform. \sa PROGRAM_get_name_id
+	unsigned int	id;
+	
 	//! Determine if the uniform is constant or shoud be updated every frame.
 	unsigned char	constant;
+	
+	//! Determine if the value array contains the last value uploaded by PROGRAM_set_uniform.
+	unsigned char	uploaded;
+	
+	//! The size in bytes of the value array (the size of the GL type multiplied by the number of elements).
+	unsigned int	value_size;
+	
+	//! Shadow copy of the last uploaded value, used by PROGRAM_set_uniform to skip redundant uploads.
+	unsigned char	*value;
 
 } UNIFORM;
 
@@ -61,6 +76,9 @@ typedef struct
 	//! The location of the id maintained GLSL for this vertex attribute. 
 	int				location;
 	
+	//! The interned name id of the vertex attribute. \sa PROGRAM_get_name_id
+	unsigned int	id;
+	
 } VERTEX_ATTRIB;
 
 
@@ -71,6 +89,24 @@ typedef void( PROGRAMDRAWCALLBACK( void * ) );
 typedef void( PROGRAMBINDATTRIBCALLBACK( void * ) );
 
 
+//! Table of the uniform and vertex attribute names interned by all the PROGRAM, giving each name a stable id.
+typedef struct
+{
+	//! The number of interned names.
+	unsigned int	n_name;
+	
+	//! Array of interned names, indexed by id.
+	char			**name;
+	
+	//! The size of the hash array (a power of 2).
+	unsigned int	hash_size;
+	
+	//! Open addressing hash table containing the name ids + 1 (0 for an empty slot).
+	unsigned int	*hash;
+
+} PROGRAMNAME;
+
+
 //! Structure to easily handle GLSL programs.
 typedef struct
 {
@@ -87,17 +123,26 @@ typedef struct
 	unsigned int				 pid;
 	
 	//! The number of uniforms.
-	unsigned char				 uniform_count;
+	unsigned int				 uniform_count;
 	
 	//! Array of UNIFORM variables.
 	UNIFORM						 *uniform_array;	
 	
 	//! The number of vertex attributes.
-	unsigned char				 vertex_attrib_count;
+	unsigned int				 vertex_attrib_count;
 	
 	//! Array of vertex attributes.
 	VERTEX_ATTRIB				 *vertex_attrib_array;
 	
+	//! The size of the uniform_map and vertex_attrib_map arrays (the number of interned names when the program was linked).
+	unsigned int				 n_map;
+	
+	//! Array indexed by interned name id containing the UNIFORM index in the uniform_array, or -1.
+	int							 *uniform_map;
+	
+	//! Array indexed by interned name id containing the VERTEX_ATTRIB index in the vertex_attrib_array, or -1.
+	int							 *vertex_attrib_map;
+	
 	//! The program draw callback.
 	PROGRAMDRAWCALLBACK			 *programdrawcallback;
 	
@@ -107,6 +152,14 @@ typedef struct
 } PROGRAM;
 
 
+extern PROGRAMNAME programname;
+
+unsigned int PROGRAM_get_name_id( char *name );
+
+int PROGRAM_find_name_id( char *name );
+
+void PROGRAM_free_name( void );
+
 PROGRAM *PROGRAM_init( char *name );
 
 PROGRAM *PROGRAM_free( PROGRAM *program );
@@ -119,9 +172,33 @@ void PROGRAM_set_draw_callback( PROGRAM *program, PROGRAMDRAWCALLBACK *programdr
 
 void PROGRAM_set_bind_attrib_location_callback( PROGRAM *program, PROGRAMBINDATTRIBCALLBACK *programbindattribcallback );
 
-char PROGRAM_get_vertex_attrib_location( PROGRAM *program, char *name );
+int PROGRAM_get_vertex_attrib_location( PROGRAM *program, char *name );
+
+int PROGRAM_get_vertex_attrib_location2( PROGRAM *program, unsigned int id );
+
+int PROGRAM_get_uniform_location( PROGRAM *program, char *name );
+
+int PROGRAM_get_uniform_location2( PROGRAM *program, unsigned int id );
+
+unsigned int PROGRAM_get_uniform_type_size( unsigned int type );
+
+UNIFORM *PROGRAM_get_uniform( PROGRAM *program, unsigned int id );
+
+unsigned char PROGRAM_set_uniform( PROGRAM *program, unsigned int id, void *value, int count );
+
+unsigned char PROGRAM_set_uniform_1i( PROGRAM *program, unsigned int id, int value );
+
+unsigned char PROGRAM_set_uniform_1f( PROGRAM *program, unsigned int id, float value );
+
+unsigned char PROGRAM_set_uniform_vec2( PROGRAM *program, unsigned int id, vec2 *value );
+
+unsigned char PROGRAM_set_uniform_vec3( PROGRAM *program, unsigned int id, vec3 *value );
+
+unsigned char PROGRAM_set_uniform_vec4( PROGRAM *program, unsigned int id, vec4 *value );
+
+unsigned char PROGRAM_set_uniform_mat3( PROGRAM *program, unsigned int id, mat3 *value );
 
-char PROGRAM_get_uniform_location( PROGRAM *program, char *name );
+unsigned char PROGRAM_set_uniform_mat4( PROGRAM *program, unsigned int id, mat4 *value );
 
 void PROGRAM_delete_id( PROGRAM *program );
 
@@ -434,7 +434,7 @@ void TEXTURE_generate_id( TEXTURE *texture, unsigned int flags, unsigned char fi
 
 	glGenTextures( 1, &texture->tid );
 
-	glBindTexture( texture->target, texture->tid );
+	GFX_bind_texture( texture->target, texture->tid );
 	
 	
 	if( !texture->compression )
@@ -612,6 +612,8 @@ void TEXTURE_delete_id( TEXTURE *texture )
 	{
 		glDeleteTextures( 1, &texture->tid );
 		texture->tid = 0;
+		
+		GFX_reset_state();
 	}
 }
 
@@ -638,8 +640,22 @@ void TEXTURE_free_texel_array( TEXTURE *texture )
 */
 void TEXTURE_draw( TEXTURE *texture )
 {
-	glBindTexture( texture->target, 
-				   texture->tid );
+	GFX_bind_texture( texture->target, 
+					  texture->tid );
+}
+
+
+/*!
+	Bind the OpenGLES texture id to a specific texture unit for drawing.
+	
+	\param[in] texture A valid TEXTURE structure pointer.
+	\param[in] unit The texture unit index (0 for GL_TEXTURE0).
+*/
+void TEXTURE_draw2( TEXTURE *texture, unsigned int unit )
+{
+	GFX_bind_texture_unit( unit,
+						   texture->target,
+						   texture->tid );
 }
 
 
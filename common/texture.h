@@ -175,6 +175,8 @@ void TEXTURE_free_texel_array( TEXTURE *texture );
 
 void TEXTURE_draw( TEXTURE *texture );
 
+void TEXTURE_draw2( TEXTURE *texture, unsigned int unit );
+
 void TEXTURE_scale( TEXTURE *texture, unsigned int width, unsigned int height );
 
 #endif
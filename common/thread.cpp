@@ -167,3 +167,185 @@ void THREAD_stop( THREAD *thread )
 
 	usleep( thread->timeout * 1000 );
 }
+
+
+/*!
+	Return the number of processors currently available on the system.
+	
+	\return Return the number of processors (at least 1).
+*/
+unsigned int THREAD_get_cpu_count( void )
+{
+	long n = sysconf( _SC_NPROCESSORS_ONLN );
+	
+	return n > 0 ? ( unsigned int )n : 1;
+}
+
+
+//! Internal structure holding the persistent workers of THREAD_dispatch and the task they are running.
+typedef struct
+{
+	//! The worker pthreads, created on the first call to THREAD_dispatch.
+	pthread_t			*thread;
+	
+	//! The number of worker pthreads (the calling thread is not included).
+	unsigned int		n_worker;
+	
+	//! Determine if the workers have already been created.
+	unsigned char		started;
+	
+	//! Determine if a task is running, a nested or concurrent THREAD_dispatch is then executed on its calling thread.
+	unsigned char		busy;
+
+	//! The mutex protecting the task parameters.
+	pthread_mutex_t		mutex;
+	
+	//! Signaled when a new task is available.
+	pthread_cond_t		task_cond;
+	
+	//! Signaled when all the worker indices of the task have been executed.
+	pthread_cond_t		done_cond;
+	
+	//! Incremented for every new task, so a worker can tell if it already joined the current one.
+	unsigned int		serial;
+	
+	THREADTASKCALLBACK	*threadtaskcallback;
+	
+	void				*userdata;
+	
+	unsigned int		n_thread;
+	
+	//! The next worker index of the task to execute.
+	unsigned int		next;
+	
+	//! The number of worker indices of the task that are done.
+	unsigned int		n_done;
+
+} THREADPOOL;
+
+
+//! The global THREAD_dispatch workers, shared by the whole application.
+THREADPOOL threadpool = { NULL, 0, 0, 0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER };
+
+
+/*!
+	Function internally used to execute the remaining worker indices of the current task. The
+	mutex of the THREADPOOL must be locked, and it is released while the callback is running.
+*/
+void THREAD_run_task( void )
+{
+	while( threadpool.next < threadpool.n_thread )
+	{
+		unsigned int index = threadpool.next++;
+		
+		pthread_mutex_unlock( &threadpool.mutex );
+		
+		threadpool.threadtaskcallback( threadpool.userdata,
+									   index,
+									   threadpool.n_thread );
+		
+		pthread_mutex_lock( &threadpool.mutex );
+		
+		if( ++threadpool.n_done == threadpool.n_thread ) pthread_cond_signal( &threadpool.done_cond );
+	}
+}
+
+
+/*!
+	The internal worker function of the THREADPOOL, waiting for tasks until the application exit.
+	
+	\param[in] ptr Unused.
+*/
+void *THREAD_run_worker( void *ptr )
+{
+	unsigned int serial;
+	
+	( void )ptr;
+	
+	pthread_mutex_lock( &threadpool.mutex );
+	
+	serial = threadpool.serial;
+	
+	while( 1 )
+	{
+		while( serial == threadpool.serial ) pthread_cond_wait( &threadpool.task_cond, &threadpool.mutex );
+		
+		serial = threadpool.serial;
+		
+		THREAD_run_task();
+	}
+	
+	return NULL;
+}
+
+
+/*!
+	Execute a task in parallel and wait for its completion (fork/join). The callback is
+	called once for each worker index, it is up to the callback to split its workload using
+	this index. The indices are shared between the calling thread and a pool of persistent
+	workers (one per additional processor) created on the first call, so no thread is created
+	or joined per task, which makes this function suitable for short CPU intensive jobs such
+	as skinning. A THREAD_dispatch called while another one is running, for example from the
+	task callback, is executed on its calling thread with a single worker. Just like for the
+	THREAD, the task callback cannot make any OpenGLES calls.
+	
+	\param[in] threadtaskcallback The task callback.
+	\param[in] userdata User data pointer passed to the task callback.
+	\param[in] n_thread The number of worker indices to use (0 to use one per processor).
+*/
+void THREAD_dispatch( THREADTASKCALLBACK *threadtaskcallback, void *userdata, unsigned int n_thread )
+{
+	if( !n_thread ) n_thread = THREAD_get_cpu_count();
+	
+	if( n_thread == 1 )
+	{
+		threadtaskcallback( userdata, 0, 1 );
+		return;
+	}
+	
+	pthread_mutex_lock( &threadpool.mutex );
+	
+	if( threadpool.busy )
+	{
+		pthread_mutex_unlock( &threadpool.mutex );
+		
+		threadtaskcallback( userdata, 0, 1 );
+		return;
+	}
+	
+	if( !threadpool.started )
+	{
+		unsigned int n = THREAD_get_cpu_count() - 1;
+		
+		threadpool.started = 1;
+		
+		threadpool.thread = ( pthread_t * ) calloc( n ? n : 1, sizeof( pthread_t ) );
+		
+		// The workers that cannot be created are simply left to the calling thread.
+		while( threadpool.n_worker != n &&
+			   !pthread_create( &threadpool.thread[ threadpool.n_worker ], NULL, THREAD_run_worker, NULL ) )
+		{
+			pthread_detach( threadpool.thread[ threadpool.n_worker ] );
+			++threadpool.n_worker;
+		}
+	}
+	
+	threadpool.busy				  = 1;
+	threadpool.threadtaskcallback = threadtaskcallback;
+	threadpool.userdata			  = userdata;
+	threadpool.n_thread			  = n_thread;
+	threadpool.next				  = 0;
+	threadpool.n_done			  = 0;
+	
+	++threadpool.serial;
+	
+	pthread_cond_broadcast( &threadpool.task_cond );
+	
+	THREAD_run_task();
+	
+	while( threadpool.n_done != n_thread ) pthread_cond_wait( &threadpool.done_cond, &threadpool.mutex );
+	
+	threadpool.busy = 0;
+	
+	pthread_mutex_unlock( &threadpool.mutex );
+}
@@ -55,6 +55,10 @@ enum
 typedef void( THREADCALLBACK( void * ) );
 
 
+//! The THREAD_dispatch task callback prototype. The callback is executed once for each worker, with the index of the worker and the total number of workers.
+typedef void( THREADTASKCALLBACK( void *userdata, unsigned int index, unsigned int n_thread ) );
+
+
 //! Main structure to initialize in order to use THREAD functionalities.
 typedef struct
 {
@@ -94,4 +98,8 @@ void THREAD_pause( THREAD *thread );
 
 void THREAD_stop( THREAD *thread );
 
+unsigned int THREAD_get_cpu_count( void );
+
+void THREAD_dispatch( THREADTASKCALLBACK *threadtaskcallback, void *userdata, unsigned int n_thread );
+
 #endif
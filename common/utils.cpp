@@ -688,6 +688,451 @@ unsigned char box_intersect_frustum( vec4 *frustum,
 }
 
 
+/*!
+	Cull an array of spheres (when radius is not NULL) or boxes (when radius is NULL) stored as
+	separate component arrays. \sa sphere_in_frustum_array box_in_frustum_array
+	
+	\param[in] frustum The six clipping planes data.
+	\param[in] n The number of objects.
+	\param[in] x The X locations of the objects.
+	\param[in] y The Y locations of the objects.
+	\param[in] z The Z locations of the objects.
+	\param[in] radius The sphere radius, or NULL for boxes.
+	\param[in] ex The box extents on the X axis (ignored for spheres).
+	\param[in] ey The box extents on the Y axis (ignored for spheres).
+	\param[in] ez The box extents on the Z axis (ignored for spheres).
+	\param[in,out] visibility The visibility bitmask.
+	\param[in,out] inside The inside bitmask, can be NULL.
+	\param[in,out] distance The distance array, can be NULL.
+	\param[in,out] plane The rejecting plane cache, can be NULL.
+	
+	\return Return the number of visible objects.
+*/
+unsigned int frustum_cull_array( vec4 *frustum, unsigned int n, float *x, float *y, float *z, float *radius,
+								 float *ex, float *ey, float *ez, unsigned int *visibility, unsigned int *inside,
+								 float *distance, unsigned char *plane )
+{
+	unsigned int i = 0,
+				 j,
+				 k,
+				 v = 0;
+
+	// Absolute plane normals, the projected radius of a box on a plane is
+	// abs( normal ) dot extents.
+	vec3 a[ 6 ];
+	
+	j = 0;
+	while( j != 6 )
+	{
+		a[ j ].x = fabsf( frustum[ j ].x );
+		a[ j ].y = fabsf( frustum[ j ].y );
+		a[ j ].z = fabsf( frustum[ j ].z );
+		
+		++j;
+	}
+
+	#if defined( __SSE__ )
+	
+		__m128 zero = _mm_setzero_ps(),
+			   fx[ 6 ],
+			   fy[ 6 ],
+			   fz[ 6 ],
+			   fw[ 6 ],
+			   ax[ 6 ],
+			   ay[ 6 ],
+			   az[ 6 ];
+		
+		j = 0;
+		while( j != 6 )
+		{
+			fx[ j ] = _mm_set1_ps( frustum[ j ].x );
+			fy[ j ] = _mm_set1_ps( frustum[ j ].y );
+			fz[ j ] = _mm_set1_ps( frustum[ j ].z );
+			fw[ j ] = _mm_set1_ps( frustum[ j ].w );
+			
+			ax[ j ] = _mm_set1_ps( a[ j ].x );
+			ay[ j ] = _mm_set1_ps( a[ j ].y );
+			az[ j ] = _mm_set1_ps( a[ j ].z );
+			
+			++j;
+		}
+	
+		while( ( i + 4 ) <= n )
+		{
+			__m128 px = _mm_loadu_ps( &x[ i ] ),
+				   py = _mm_loadu_ps( &y[ i ] ),
+				   pz = _mm_loadu_ps( &z[ i ] ),
+				   rx = _mm_loadu_ps( radius ? &radius[ i ] : &ex[ i ] ),
+				   ry = radius ? rx : _mm_loadu_ps( &ey[ i ] ),
+				   rz = radius ? rx : _mm_loadu_ps( &ez[ i ] ),
+				   c  = zero,
+				   in = _mm_cmpeq_ps( zero, zero ),
+				   d,
+				   r,
+				   m;
+			
+			// Test the plane that rejected each object last time first, most of the
+			// time the whole group is then rejected with a single plane test.
+			if( plane )
+			{
+				vec4 *p0 = &frustum[ plane[ i	  ] ],
+					 *p1 = &frustum[ plane[ i + 1 ] ],
+					 *p2 = &frustum[ plane[ i + 2 ] ],
+					 *p3 = &frustum[ plane[ i + 3 ] ];
+				
+				d = _mm_add_ps( _mm_add_ps( _mm_mul_ps( px, _mm_setr_ps( p0->x, p1->x, p2->x, p3->x ) ),
+											_mm_mul_ps( py, _mm_setr_ps( p0->y, p1->y, p2->y, p3->y ) ) ),
+								_mm_add_ps( _mm_mul_ps( pz, _mm_setr_ps( p0->z, p1->z, p2->z, p3->z ) ),
+														_mm_setr_ps( p0->w, p1->w, p2->w, p3->w ) ) );
+				if( radius )
+				{ c = _mm_cmplt_ps( d, _mm_sub_ps( zero, rx ) ); }
+				else
+				{
+					vec3 *a0 = &a[ plane[ i	 ] ],
+						 *a1 = &a[ plane[ i + 1 ] ],
+						 *a2 = &a[ plane[ i + 2 ] ],
+						 *a3 = &a[ plane[ i + 3 ] ];
+					
+					r = _mm_add_ps( _mm_add_ps( _mm_mul_ps( rx, _mm_setr_ps( a0->x, a1->x, a2->x, a3->x ) ),
+												_mm_mul_ps( ry, _mm_setr_ps( a0->y, a1->y, a2->y, a3->y ) ) ),
+												_mm_mul_ps( rz, _mm_setr_ps( a0->z, a1->z, a2->z, a3->z ) ) );
+					
+					c = _mm_cmple_ps( _mm_add_ps( d, r ), zero );
+				}
+			}
+			
+			j = 0;
+			while( j != 6 && _mm_movemask_ps( c ) != 0xF )
+			{
+				d = _mm_add_ps( _mm_add_ps( _mm_mul_ps( px, fx[ j ] ),
+											_mm_mul_ps( py, fy[ j ] ) ),
+								_mm_add_ps( _mm_mul_ps( pz, fz[ j ] ), fw[ j ] ) );
+				if( radius )
+				{
+					r = rx;
+					m = _mm_cmplt_ps( d, _mm_sub_ps( zero, r ) );
+				}
+				else
+				{
+					r = _mm_add_ps( _mm_add_ps( _mm_mul_ps( rx, ax[ j ] ),
+												_mm_mul_ps( ry, ay[ j ] ) ),
+												_mm_mul_ps( rz, az[ j ] ) );
+					
+					m = _mm_cmple_ps( _mm_add_ps( d, r ), zero );
+				}
+				
+				if( plane && ( k = _mm_movemask_ps( _mm_andnot_ps( c, m ) ) ) )
+				{
+					if( k & 1 ) plane[ i	 ] = j;
+					if( k & 2 ) plane[ i + 1 ] = j;
+					if( k & 4 ) plane[ i + 2 ] = j;
+					if( k & 8 ) plane[ i + 3 ] = j;
+				}
+				
+				c  = _mm_or_ps ( c, m );
+				in = _mm_and_ps( in, _mm_cmpgt_ps( d, r ) );
+				
+				++j;
+			}
+			
+			k = ~_mm_movemask_ps( c ) & 0xF;
+			
+			if( !( i & 31 ) )
+			{
+				visibility[ i >> 5 ] = 0;
+				
+				if( inside ) inside[ i >> 5 ] = 0;
+			}
+			
+			visibility[ i >> 5 ] |= k << ( i & 31 );
+			
+			// When an object is visible the six planes were tested, d and r are then
+			// the values of the last (near) plane.
+			if( k )
+			{
+				v += ( k & 1 ) + ( ( k >> 1 ) & 1 ) + ( ( k >> 2 ) & 1 ) + ( k >> 3 );
+				
+				if( inside ) inside[ i >> 5 ] |= ( k & _mm_movemask_ps( in ) ) << ( i & 31 );
+				
+				if( distance ) _mm_storeu_ps( &distance[ i ], _mm_andnot_ps( c, _mm_add_ps( d, r ) ) );
+			}
+			else if( distance ) _mm_storeu_ps( &distance[ i ], zero );
+			
+			i += 4;
+		}
+
+	#elif defined( __ARM_NEON__ ) || defined( __ARM_NEON )
+	
+		float32x4_t zero = vdupq_n_f32( 0.0f );
+		
+		uint32x4_t bit = { 1, 2, 4, 8 };
+	
+		while( ( i + 4 ) <= n )
+		{
+			float32x4_t px = vld1q_f32( &x[ i ] ),
+						py = vld1q_f32( &y[ i ] ),
+						pz = vld1q_f32( &z[ i ] ),
+						rx = vld1q_f32( radius ? &radius[ i ] : &ex[ i ] ),
+						ry = radius ? rx : vld1q_f32( &ey[ i ] ),
+						rz = radius ? rx : vld1q_f32( &ez[ i ] ),
+						d  = zero,
+						r  = zero;
+			
+			uint32x4_t c  = vdupq_n_u32( 0 ),
+					   in = vdupq_n_u32( 0xFFFFFFFF ),
+					   m;
+			
+			uint32x2_t h;
+			
+			// Test the plane that rejected each object last time first, most of the
+			// time the whole group is then rejected with a single plane test.
+			if( plane )
+			{
+				vec4 *p0 = &frustum[ plane[ i	  ] ],
+					 *p1 = &frustum[ plane[ i + 1 ] ],
+					 *p2 = &frustum[ plane[ i + 2 ] ],
+					 *p3 = &frustum[ plane[ i + 3 ] ];
+				
+				float32x4x4_t p;
+				
+				p.val[ 0 ] = vld1q_f32( &p0->x );
+				p.val[ 1 ] = vld1q_f32( &p1->x );
+				p.val[ 2 ] = vld1q_f32( &p2->x );
+				p.val[ 3 ] = vld1q_f32( &p3->x );
+				
+				// Transpose the four planes to xxxx yyyy zzzz wwww.
+				{
+					float32x4x2_t t0 = vtrnq_f32( p.val[ 0 ], p.val[ 1 ] ),
+								  t1 = vtrnq_f32( p.val[ 2 ], p.val[ 3 ] );
+					
+					p.val[ 0 ] = vcombine_f32( vget_low_f32 ( t0.val[ 0 ] ), vget_low_f32 ( t1.val[ 0 ] ) );
+					p.val[ 1 ] = vcombine_f32( vget_low_f32 ( t0.val[ 1 ] ), vget_low_f32 ( t1.val[ 1 ] ) );
+					p.val[ 2 ] = vcombine_f32( vget_high_f32( t0.val[ 0 ] ), vget_high_f32( t1.val[ 0 ] ) );
+					p.val[ 3 ] = vcombine_f32( vget_high_f32( t0.val[ 1 ] ), vget_high_f32( t1.val[ 1 ] ) );
+				}
+				
+				d = vmlaq_f32( vmlaq_f32( vmlaq_f32( p.val[ 3 ], px, p.val[ 0 ] ), py, p.val[ 1 ] ), pz, p.val[ 2 ] );
+				
+				if( radius )
+				{ c = vcltq_f32( d, vnegq_f32( rx ) ); }
+				else
+				{
+					r = vmlaq_f32( vmlaq_f32( vmulq_f32( rx, vabsq_f32( p.val[ 0 ] ) ),
+														 ry, vabsq_f32( p.val[ 1 ] ) ),
+														 rz, vabsq_f32( p.val[ 2 ] ) );
+					
+					c = vcleq_f32( vaddq_f32( d, r ), zero );
+				}
+			}
+			
+			j = 0;
+			while( j != 6 )
+			{
+				h = vand_u32( vget_low_u32( c ), vget_high_u32( c ) );
+				
+				if( vget_lane_u32( vand_u32( h, vrev64_u32( h ) ), 0 ) ) break;
+				
+				d = vmlaq_n_f32( vmlaq_n_f32( vmlaq_n_f32( vdupq_n_f32( frustum[ j ].w ),
+														   px, frustum[ j ].x ),
+														   py, frustum[ j ].y ),
+														   pz, frustum[ j ].z );
+				if( radius )
+				{
+					r = rx;
+					m = vcltq_f32( d, vnegq_f32( r ) );
+				}
+				else
+				{
+					r = vmlaq_n_f32( vmlaq_n_f32( vmulq_n_f32( rx, a[ j ].x ),
+														   ry, a[ j ].y ),
+														   rz, a[ j ].z );
+					
+					m = vcleq_f32( vaddq_f32( d, r ), zero );
+				}
+				
+				if( plane )
+				{
+					uint32x4_t t = vandq_u32( vbicq_u32( m, c ), bit );
+					
+					h = vorr_u32( vget_low_u32( t ), vget_high_u32( t ) );
+					
+					k = vget_lane_u32( h, 0 ) | vget_lane_u32( h, 1 );
+					
+					if( k & 1 ) plane[ i	 ] = j;
+					if( k & 2 ) plane[ i + 1 ] = j;
+					if( k & 4 ) plane[ i + 2 ] = j;
+					if( k & 8 ) plane[ i + 3 ] = j;
+				}
+				
+				c  = vorrq_u32( c, m );
+				in = vandq_u32( in, vcgtq_f32( d, r ) );
+				
+				++j;
+			}
+			
+			// Pack the lanes to a 4 bits mask.
+			m = vandq_u32( vmvnq_u32( c ), bit );
+			h = vorr_u32( vget_low_u32( m ), vget_high_u32( m ) );
+			k = vget_lane_u32( h, 0 ) | vget_lane_u32( h, 1 );
+			
+			if( !( i & 31 ) )
+			{
+				visibility[ i >> 5 ] = 0;
+				
+				if( inside ) inside[ i >> 5 ] = 0;
+			}
+			
+			visibility[ i >> 5 ] |= k << ( i & 31 );
+			
+			// When an object is visible the six planes were tested, d and r are then
+			// the values of the last (near) plane.
+			if( k )
+			{
+				v += ( k & 1 ) + ( ( k >> 1 ) & 1 ) + ( ( k >> 2 ) & 1 ) + ( k >> 3 );
+				
+				if( inside )
+				{
+					m = vandq_u32( in, bit );
+					h = vorr_u32( vget_low_u32( m ), vget_high_u32( m ) );
+					
+					inside[ i >> 5 ] |= ( k & ( vget_lane_u32( h, 0 ) | vget_lane_u32( h, 1 ) ) ) << ( i & 31 );
+				}
+				
+				if( distance )
+				{ vst1q_f32( &distance[ i ], vreinterpretq_f32_u32( vbicq_u32( vreinterpretq_u32_f32( vaddq_f32( d, r ) ), c ) ) ); }
+			}
+			else if( distance ) vst1q_f32( &distance[ i ], zero );
+			
+			i += 4;
+		}
+	
+	#endif
+	
+	while( i != n )
+	{
+		float d = 0.0f,
+			  r = 0.0f;
+		
+		unsigned char culled = 0,
+					  in	 = 1;
+		
+		// Step 0 is the cached rejecting plane, steps 1 to 6 are the six planes.
+		k = plane ? 0 : 1;
+		
+		while( k != 7 )
+		{
+			j = k ? k - 1 : plane[ i ];
+			
+			d = frustum[ j ].x * x[ i ] +
+				frustum[ j ].y * y[ i ] +
+				frustum[ j ].z * z[ i ] +
+				frustum[ j ].w;
+			
+			r = radius ? radius[ i ] : a[ j ].x * ex[ i ] +
+									   a[ j ].y * ey[ i ] +
+									   a[ j ].z * ez[ i ];
+			
+			if( radius ? d < -r : d + r <= 0.0f )
+			{
+				if( plane ) plane[ i ] = j;
+				
+				culled = 1;
+				break;
+			}
+			
+			if( d <= r ) in = 0;
+			
+			++k;
+		}
+		
+		if( !( i & 31 ) )
+		{
+			visibility[ i >> 5 ] = 0;
+			
+			if( inside ) inside[ i >> 5 ] = 0;
+		}
+		
+		if( !culled )
+		{
+			visibility[ i >> 5 ] |= 1u << ( i & 31 );
+			
+			if( inside && in ) inside[ i >> 5 ] |= 1u << ( i & 31 );
+			
+			++v;
+		}
+		
+		if( distance ) distance[ i ] = culled ? 0.0f : d + r;
+		
+		++i;
+	}
+	
+	return v;
+}
+
+
+/*!
+	Cull an array of spheres stored as separate arrays (structure of arrays) against the
+	frustum planes. This is the batch version of sphere_distance_in_frustum and
+	sphere_intersect_frustum, on SSE and NEON capable CPUs the spheres are tested four
+	at a time.
+	
+	\param[in] frustum The six clipping planes data to use to test the spheres.
+	\param[in] n The number of spheres.
+	\param[in] x The X locations of the spheres in world coordinates.
+	\param[in] y The Y locations of the spheres in world coordinates.
+	\param[in] z The Z locations of the spheres in world coordinates.
+	\param[in] radius The radius of the spheres.
+	\param[in,out] visibility The bitmask receiving the visibility of the spheres (bit i % 32
+	of visibility[ i / 32 ]), must be able to hold ( n + 31 ) / 32 unsigned int.
+	\param[in,out] inside Optional bitmask receiving if the spheres are entirely inside
+	the frustum (like sphere_intersect_frustum returning 2), can be NULL.
+	\param[in,out] distance Optional array receiving the distance of the spheres in the
+	frustum, or 0 when culled (like sphere_distance_in_frustum), can be NULL.
+	\param[in,out] plane Optional per sphere cache of the last plane that rejected it, tested
+	first on the next call to exploit frame to frame coherency. Must be initialized to 0 and
+	kept between calls, can be NULL.
+	
+	\return Return the number of visible spheres.
+*/
+unsigned int sphere_in_frustum_array( vec4 *frustum, unsigned int n, float *x, float *y, float *z, float *radius,
+									  unsigned int *visibility, unsigned int *inside, float *distance, unsigned char *plane )
+{
+	return frustum_cull_array( frustum, n, x, y, z, radius, NULL, NULL, NULL, visibility, inside, distance, plane );
+}
+
+
+/*!
+	Cull an array of boxes stored as separate arrays (structure of arrays) against the
+	frustum planes. This is the batch version of box_in_frustum and box_intersect_frustum,
+	on SSE and NEON capable CPUs the boxes are tested four at a time.
+	
+	\param[in] frustum The six clipping planes data to use to test the boxes.
+	\param[in] n The number of boxes.
+	\param[in] x The X locations of the center of the boxes in world coordinates.
+	\param[in] y The Y locations of the center of the boxes in world coordinates.
+	\param[in] z The Z locations of the center of the boxes in world coordinates.
+	\param[in] ex The extents (half dimension) of the boxes on the X axis.
+	\param[in] ey The extents (half dimension) of the boxes on the Y axis.
+	\param[in] ez The extents (half dimension) of the boxes on the Z axis.
+	\param[in,out] visibility The bitmask receiving the visibility of the boxes (bit i % 32
+	of visibility[ i / 32 ]), must be able to hold ( n + 31 ) / 32 unsigned int.
+	\param[in,out] inside Optional bitmask receiving if the boxes are entirely inside the
+	frustum (like box_intersect_frustum returning 2), can be NULL.
+	\param[in,out] distance Optional array receiving the distance of the boxes in the frustum,
+	or 0 when culled, can be NULL.
+	\param[in,out] plane Optional per box cache of the last plane that rejected it, tested
+	first on the next call to exploit frame to frame coherency. Must be initialized to 0 and
+	kept between calls, can be NULL.
+	
+	\return Return the number of visible boxes.
+*/
+unsigned int box_in_frustum_array( vec4 *frustum, unsigned int n, float *x, float *y, float *z, float *ex, float *ey, float *ez,
+								   unsigned int *visibility, unsigned int *inside, float *distance, unsigned char *plane )
+{
+	return frustum_cull_array( frustum, n, x, y, z, NULL, ex, ey, ez, visibility, inside, distance, plane );
+}
+
+
 /*!
 	\return Return the next valid power of 2 for the current size.
 */
@@ -778,3 +1223,79 @@ void create_direction_vector( vec3 *dst, vec3 *up_axis, float rotx, float roty,
 
 	vec3_multiply_mat4( dst, up_axis, &m );
 }
+
+
+/*!
+	Convert a 32 bits float to a 16 bits half float (IEEE 754 binary16) that can be used with
+	GL_HALF_FLOAT_OES.
+	
+	\param[in] f The float value to convert.
+	
+	\return Return the half float bits, rounded to the nearest value.
+*/
+unsigned short float_to_half( float f )
+{
+	union
+	{
+		float		 f;
+		unsigned int u;
+		
+	} v;
+	
+	unsigned int sign,
+				 mantissa;
+	
+	int exponent;
+	
+	v.f = f;
+	
+	sign	 = ( v.u >> 16 ) & 0x8000;
+	exponent = ( int )( ( v.u >> 23 ) & 0xFF );
+	mantissa = v.u & 0x7FFFFF;
+	
+	// Infinity and NaN
+	if( exponent == 0xFF ) return sign | 0x7C00 | ( mantissa ? 0x200 : 0 );
+	
+	exponent = exponent - 127 + 15;
+	
+	if( exponent >= 31 ) return sign | 0x7C00;
+	
+	// Denormalized half
+	else if( exponent <= 0 )
+	{
+		unsigned int shift = 14 - exponent;
+		
+		if( exponent < -10 ) return sign;
+		
+		mantissa |= 0x800000;
+
+		return sign | ( ( mantissa + ( 1 << ( shift - 1 ) ) ) >> shift );
+	}
+	
+	// The rounding carry can overflow in the exponent, which is the expected result.
+	return sign | ( ( ( exponent << 10 ) | ( mantissa >> 13 ) ) + ( ( mantissa >> 12 ) & 1 ) );
+}
+
+
+/*!
+	Convert a float in the [ -1, 1 ] range to a signed normalized integer using the GLES 2.0
+	conversion rule f = ( 2c + 1 ) / ( 2^b - 1 ).
+	
+	\param[in] f The float value to convert.
+	\param[in] bits The number of bits of the signed integer (8 for GL_BYTE, 16 for GL_SHORT).
+	
+	\return Return the signed normalized integer.
+*/
+int float_to_snorm( float f, unsigned int bits )
+{
+	float range = ( float )( ( 1 << bits ) - 1 );
+	
+	int c = ( int )floorf( ( f * range - 1.0f ) * 0.5f + 0.5f ),
+		max = ( 1 << ( bits - 1 ) ) - 1;
+	
+	if( c > max ) return max;
+	
+	else if( c < -max - 1 ) return -max - 1;
+	
+	return c;
+}
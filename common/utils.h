@@ -59,10 +59,20 @@ unsigned char sphere_intersect_frustum( vec4 *frustum, vec3 *location, float rad
 
 unsigned char box_intersect_frustum( vec4 *frustum, vec3 *location, vec3 *dimension );
 
+unsigned int frustum_cull_array( vec4 *frustum, unsigned int n, float *x, float *y, float *z, float *radius, float *ex, float *ey, float *ez, unsigned int *visibility, unsigned int *inside, float *distance, unsigned char *plane );
+
+unsigned int sphere_in_frustum_array( vec4 *frustum, unsigned int n, float *x, float *y, float *z, float *radius, unsigned int *visibility, unsigned int *inside, float *distance, unsigned char *plane );
+
+unsigned int box_in_frustum_array( vec4 *frustum, unsigned int n, float *x, float *y, float *z, float *ex, float *ey, float *ez, unsigned int *visibility, unsigned int *inside, float *distance, unsigned char *plane );
+
 unsigned int get_next_pow2( unsigned int size );
 
 unsigned int get_nearest_pow2( unsigned int size );
 
 void create_direction_vector( vec3 *dst, vec3 *up_axis, float rotx, float roty, float rotz );
 
+unsigned short float_to_half( float f );
+
+int float_to_snorm( float f, unsigned int bits );
+
 #endif
@@ -174,6 +174,116 @@ float vec3_normalize( vec3 *dst, vec3 *v )
 }
 
 
+/*!
+	Normalize an array of vector 3D. On SSE and NEON capable CPUs the vectors are
+	processed four at a time. Just like vec3_normalize, vectors with a null length are
+	left untouched (copied as is to the destination).
+	
+	\param[in,out] dst The array used to store the normalized vectors (can be the same as v).
+	\param[in] v The array of vectors 3D to normalize.
+	\param[in] n The number of vectors in the array.
+*/
+void vec3_normalize_array( vec3 *dst, vec3 *v, unsigned int n )
+{
+	unsigned int i = 0;
+
+	#if defined( __SSE__ )
+	
+		__m128 zero = _mm_setzero_ps(),
+			   one  = _mm_set1_ps( 1.0f );
+	
+		while( ( i + 4 ) <= n )
+		{
+			float *src = ( float * )&v  [ i ],
+				  *out = ( float * )&dst[ i ];
+			
+			__m128 a = _mm_loadu_ps( src	 ),
+				   b = _mm_loadu_ps( src + 4 ),
+				   c = _mm_loadu_ps( src + 8 ),
+				   x, y, z, l, m, mask, t, u;
+			
+			// Transpose x0y0z0x1 y1z1x2y2 z2x3y3z3 to xxxx yyyy zzzz.
+			x = _mm_shuffle_ps( a, _mm_shuffle_ps( b, c, _MM_SHUFFLE( 1, 1, 2, 2 ) ), _MM_SHUFFLE( 2, 0, 3, 0 ) );
+			y = _mm_shuffle_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 0, 0, 1, 1 ) ),
+								_mm_shuffle_ps( b, c, _MM_SHUFFLE( 2, 2, 3, 3 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+			z = _mm_shuffle_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 1, 1, 2, 2 ) ),
+								_mm_shuffle_ps( c, c, _MM_SHUFFLE( 3, 3, 0, 0 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+			
+			l = _mm_sqrt_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, x ),
+													 _mm_mul_ps( y, y ) ),
+													 _mm_mul_ps( z, z ) ) );
+			
+			mask = _mm_cmpneq_ps( l, zero );
+			
+			m = _mm_div_ps( one, l );
+			
+			x = _mm_or_ps( _mm_and_ps( mask, _mm_mul_ps( x, m ) ), _mm_andnot_ps( mask, x ) );
+			y = _mm_or_ps( _mm_and_ps( mask, _mm_mul_ps( y, m ) ), _mm_andnot_ps( mask, y ) );
+			z = _mm_or_ps( _mm_and_ps( mask, _mm_mul_ps( z, m ) ), _mm_andnot_ps( mask, z ) );
+			
+			// Transpose back to x0y0z0x1 y1z1x2y2 z2x3y3z3.
+			t = _mm_shuffle_ps( x, y, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+			u = _mm_shuffle_ps( z, x, _MM_SHUFFLE( 1, 1, 0, 0 ) );
+			_mm_storeu_ps( out, _mm_shuffle_ps( t, u, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+			
+			t = _mm_shuffle_ps( y, z, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+			u = _mm_shuffle_ps( x, y, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+			_mm_storeu_ps( out + 4, _mm_shuffle_ps( t, u, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+			
+			t = _mm_shuffle_ps( z, x, _MM_SHUFFLE( 3, 3, 2, 2 ) );
+			u = _mm_shuffle_ps( y, z, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+			_mm_storeu_ps( out + 8, _mm_shuffle_ps( t, u, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+			
+			i += 4;
+		}
+
+	#elif defined( __ARM_NEON__ ) || defined( __ARM_NEON )
+
+		while( ( i + 4 ) <= n )
+		{
+			float32x4x3_t p = vld3q_f32( ( float * )&v[ i ] );
+			
+			float32x4_t d = vmlaq_f32( vmlaq_f32( vmulq_f32( p.val[ 0 ], p.val[ 0 ] ),
+												  p.val[ 1 ], p.val[ 1 ] ),
+												  p.val[ 2 ], p.val[ 2 ] ),
+						m;
+			
+			uint32x4_t mask = vceqq_f32( d, vdupq_n_f32( 0.0f ) );
+			
+			#if defined( __aarch64__ )
+			
+				m = vdivq_f32( vdupq_n_f32( 1.0f ), vsqrtq_f32( d ) );
+			
+			#else
+			
+				// Reciprocal square root estimate refined by two Newton-Raphson steps.
+				m = vrsqrteq_f32( d );
+				m = vmulq_f32( m, vrsqrtsq_f32( vmulq_f32( d, m ), m ) );
+				m = vmulq_f32( m, vrsqrtsq_f32( vmulq_f32( d, m ), m ) );
+			
+			#endif
+			
+			p.val[ 0 ] = vbslq_f32( mask, p.val[ 0 ], vmulq_f32( p.val[ 0 ], m ) );
+			p.val[ 1 ] = vbslq_f32( mask, p.val[ 1 ], vmulq_f32( p.val[ 1 ], m ) );
+			p.val[ 2 ] = vbslq_f32( mask, p.val[ 2 ], vmulq_f32( p.val[ 2 ], m ) );
+			
+			vst3q_f32( ( float * )&dst[ i ], p );
+			
+			i += 4;
+		}
+
+	#endif
+	
+	while( i != n )
+	{
+		if( !vec3_normalize( &dst[ i ], &v[ i ] ) && dst != v )
+		{ memcpy( &dst[ i ], &v[ i ], sizeof( vec3 ) ); }
+		
+		++i;
+	}
+}
+
+
 /*!
 	Calculate the cross product between two vector 3D.
 	
@@ -295,17 +405,42 @@ void vec3_lerp2( vec3 *dst, vec3 *v0, vec3 *v1, float t )
 */
 void vec3_rotate_vec4( vec3 *dst, vec3 *v0, vec4 *v1 )
 {
-	vec4 i, t, f;
+	// Expanded form of q * v * conjugate( q ) / | q | where q = ( u, s ):
+	// ( ( s * s - u.u ) * v + 2 * ( u.v ) * u + 2 * s * ( u x v ) ) / | q |
+	float uu = ( v1->x * v1->x ) + ( v1->y * v1->y ) + ( v1->z * v1->z ),
+		  uv = ( v1->x * v0->x ) + ( v1->y * v0->y ) + ( v1->z * v0->z ),
+		  l  = sqrtf( uu + ( v1->w * v1->w ) ),
+		  m  = l ? 1.0f / l : 0.0f,
+		  k0 = ( ( v1->w * v1->w ) - uu ) * m,
+		  k1 = 2.0f * uv * m,
+		  k2 = 2.0f * v1->w * m;
 
-	vec4_conjugate( &i, v1 );
-	
-	vec4_normalize( &i, &i );
-	
-	vec4_multiply_vec3( &t, v1, v0 );
-	
-	vec4_multiply_vec4( &f, &t, &i );
-	
-	memcpy( dst, &f, sizeof( vec3 ) );
+	#if defined( __SSE__ )
+
+		__m128 u = _mm_loadu_ps( &v1->x ),
+			   v = _mm_setr_ps( v0->x, v0->y, v0->z, 0.0f ),
+			   c = _mm_sub_ps( _mm_mul_ps( _mm_shuffle_ps( u, u, _MM_SHUFFLE( 3, 0, 2, 1 ) ), _mm_shuffle_ps( v, v, _MM_SHUFFLE( 3, 1, 0, 2 ) ) ),
+							   _mm_mul_ps( _mm_shuffle_ps( u, u, _MM_SHUFFLE( 3, 1, 0, 2 ) ), _mm_shuffle_ps( v, v, _MM_SHUFFLE( 3, 0, 2, 1 ) ) ) ),
+			   r = _mm_add_ps( _mm_add_ps( _mm_mul_ps( v, _mm_set1_ps( k0 ) ),
+										   _mm_mul_ps( u, _mm_set1_ps( k1 ) ) ),
+										   _mm_mul_ps( c, _mm_set1_ps( k2 ) ) );
+
+		_mm_storel_pi( ( __m64 * )&dst->x, r );
+		_mm_store_ss( &dst->z, _mm_movehl_ps( r, r ) );
+
+	#else
+
+		vec3 c, r;
+
+		vec3_cross( &c, ( vec3 * )v1, v0 );
+
+		r.x = ( v0->x * k0 ) + ( v1->x * k1 ) + ( c.x * k2 );
+		r.y = ( v0->y * k0 ) + ( v1->y * k1 ) + ( c.y * k2 );
+		r.z = ( v0->z * k0 ) + ( v1->z * k1 ) + ( c.z * k2 );
+
+		memcpy( dst, &r, sizeof( vec3 ) );
+
+	#endif
 }
 
 /*!
@@ -660,8 +795,22 @@ void vec4_slerp( vec4 *dst, vec4 *v0, vec4 *v1, float t )
 		k1 = sinf( t * o ) * o1;
 	}
 	
-	dst->x = ( k0 * v0->x ) + ( k1 * tmp.x );
-	dst->y = ( k0 * v0->y ) + ( k1 * tmp.y );
-	dst->z = ( k0 * v0->z ) + ( k1 * tmp.z );		
-	dst->w = ( k0 * v0->w ) + ( k1 * tmp.w );
+	#if defined( __SSE__ )
+	
+		_mm_storeu_ps( &dst->x, _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( &v0->x ), _mm_set1_ps( k0 ) ),
+											_mm_mul_ps( _mm_loadu_ps( &tmp.x ), _mm_set1_ps( k1 ) ) ) );
+	
+	#elif defined( __ARM_NEON__ ) || defined( __ARM_NEON )
+	
+		vst1q_f32( &dst->x, vmlaq_n_f32( vmulq_n_f32( vld1q_f32( &v0->x ), k0 ),
+													  vld1q_f32( &tmp.x ), k1 ) );
+	
+	#else
+	
+		dst->x = ( k0 * v0->x ) + ( k1 * tmp.x );
+		dst->y = ( k0 * v0->y ) + ( k1 * tmp.y );
+		dst->z = ( k0 * v0->z ) + ( k1 * tmp.z );		
+		dst->w = ( k0 * v0->w ) + ( k1 * tmp.w );
+	
+	#endif
 }
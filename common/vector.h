@@ -49,6 +49,8 @@ float vec3_length( vec3 *v );
 
 float vec3_normalize( vec3 *dst, vec3 *v );
 
+void vec3_normalize_array( vec3 *dst, vec3 *v, unsigned int n );
+
 void vec3_cross( vec3 *dst, vec3 *v0, vec3 *v1 );
 
 float vec3_dist( vec3 *v0, vec3 *v1 );
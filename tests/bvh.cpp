@@ -0,0 +1,476 @@
+/*
+
+GFX Lightweight OpenGLES 2.0 Game and Graphics Engine
+
+Copyright (C) 2011 Romain Marucchi-Foino http://gfx.sio2interactive.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of
+this software. Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that
+you wrote the original software. If you use this software in a product, an acknowledgment
+in the product would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be misrepresented
+as being the original software.
+
+3. This notice may not be removed or altered from any source distribution.
+
+*/
+
+#include "test.h"
+
+/*!
+	\file bvh.cpp
+
+	\brief Check the BVH queries against a linear loop over the objects, before and after
+	moving objects, and print their speed.
+*/
+
+
+// Internal functions of gfx.cpp, used as the reference per object tests.
+unsigned char BVH_box_in_frustum( vec4 *frustum, vec3 *min, vec3 *max, unsigned int *mask );
+
+float BVH_ray_box( vec3 *min, vec3 *max, vec3 *origin, vec3 *inv_direction, float distance );
+
+
+//! The size of the world along each axis.
+#define WORLD_SIZE 200.0f
+
+
+/*!
+	Function internally used to place an OBJMESH randomly in the world.
+
+	\param[in,out] objmesh The OBJMESH.
+*/
+void random_mesh( OBJMESH *objmesh )
+{
+	objmesh->location.x = TEST_random( -WORLD_SIZE, WORLD_SIZE );
+	objmesh->location.y = TEST_random( -WORLD_SIZE, WORLD_SIZE );
+	objmesh->location.z = TEST_random( -10.0f, 10.0f );
+
+	objmesh->rotation.x = TEST_random( -180.0f, 180.0f );
+	objmesh->rotation.y = TEST_random( -180.0f, 180.0f );
+	objmesh->rotation.z = TEST_random( -180.0f, 180.0f );
+
+	objmesh->scale.x =
+	objmesh->scale.y =
+	objmesh->scale.z = TEST_random( 0.5f, 2.0f );
+
+	objmesh->dimension.x = TEST_random( 0.5f, 4.0f );
+	objmesh->dimension.y = TEST_random( 0.5f, 4.0f );
+	objmesh->dimension.z = TEST_random( 0.5f, 4.0f );
+}
+
+
+/*!
+	Function internally used to sort object indices.
+
+	\param[in] a The first index.
+	\param[in] b The second index.
+
+	\return Return the qsort order of the indices.
+*/
+int compare_index( const void *a, const void *b )
+{
+	unsigned int i0 = *( unsigned int * )a,
+				 i1 = *( unsigned int * )b;
+
+	return ( i0 > i1 ) - ( i0 < i1 );
+}
+
+
+/*!
+	Function internally used to compare the result of the last BVH query with the objects
+	selected by a linear loop.
+
+	\param[in,out] bvh The BVH.
+	\param[in] selected The flag of each object selected by the linear loop.
+
+	\return Return 1 if the BVH returned each selected object once and nothing else.
+*/
+unsigned char check_result( BVH *bvh, unsigned char *selected )
+{
+	unsigned int i = 0,
+				 n = 0;
+
+	qsort( bvh->result, bvh->n_result, sizeof( unsigned int ), compare_index );
+
+	while( i != bvh->n_result )
+	{
+		if( !selected[ bvh->result[ i ] ] || ( i && bvh->result[ i ] == bvh->result[ i - 1 ] ) ) return 0;
+		++i;
+	}
+
+	i = 0;
+	while( i != bvh->n_bvhobject )
+	{
+		n += selected[ i ];
+		++i;
+	}
+
+	return n == bvh->n_result;
+}
+
+
+/*!
+	Function internally used to check that every node bounding box encloses its children,
+	or its objects for the leaf nodes.
+
+	\param[in] bvh The BVH.
+
+	\return Return 1 if the bounds are valid.
+*/
+unsigned char check_nodes( BVH *bvh )
+{
+	unsigned int i = 0;
+
+	while( i != bvh->n_bvhnode )
+	{
+		BVHNODE *bvhnode = &bvh->bvhnode[ i ];
+
+		unsigned int j = bvhnode->first;
+
+		while( j != bvhnode->first + bvhnode->count )
+		{
+			BVHOBJECT *bvhobject = &bvh->bvhobject[ bvh->index[ j ] ];
+
+			if( bvhobject->min.x < bvhnode->min.x || bvhobject->max.x > bvhnode->max.x ||
+				bvhobject->min.y < bvhnode->min.y || bvhobject->max.y > bvhnode->max.y ||
+				bvhobject->min.z < bvhnode->min.z || bvhobject->max.z > bvhnode->max.z ) return 0;
+
+			if( !bvhnode->right && bvhobject->node != i ) return 0;
+
+			++j;
+		}
+
+		if( !bvhnode->right && bvhnode->count > BVH_LEAF_SIZE ) return 0;
+
+		++i;
+	}
+
+	return 1;
+}
+
+
+/*!
+	Function internally used to run random queries against a BVH and a linear loop.
+
+	\param[in,out] bvh The BVH.
+	\param[in] n_query The number of queries of each type.
+
+	\return Return the number of queries with a different result.
+*/
+unsigned int check_queries( BVH *bvh, unsigned int n_query )
+{
+	unsigned int i,
+				 j,
+				 n_error = 0;
+
+	unsigned char *selected = ( unsigned char * ) malloc( bvh->n_bvhobject );
+
+	i = 0;
+	while( i != n_query )
+	{
+		vec3 eye	= { TEST_random( -WORLD_SIZE, WORLD_SIZE ), TEST_random( -WORLD_SIZE, WORLD_SIZE ), 20.0f },
+			 center = { TEST_random( -WORLD_SIZE, WORLD_SIZE ), TEST_random( -WORLD_SIZE, WORLD_SIZE ), 0.0f },
+			 up		= { 0.0f, 0.0f, 1.0f },
+			 min,
+			 max,
+			 direction,
+			 inv_direction;
+
+		vec4 frustum[ 6 ];
+
+		float radius = TEST_random( 1.0f, 50.0f ),
+			  best = 3.402823466e+38f,
+			  distance;
+
+		int hit;
+
+		// Frustum.
+		GFX_set_matrix_mode( PROJECTION_MATRIX );
+		GFX_load_identity();
+		GFX_set_perspective( TEST_random( 30.0f, 90.0f ), 1.5f, 1.0f, TEST_random( 50.0f, 300.0f ), 0.0f );
+
+		GFX_set_matrix_mode( MODELVIEW_MATRIX );
+		GFX_load_identity();
+		GFX_look_at( &eye, &center, &up );
+
+		build_frustum( frustum, GFX_get_modelview_matrix(), GFX_get_projection_matrix() );
+
+		j = 0;
+		while( j != bvh->n_bvhobject )
+		{
+			unsigned int mask = 0x3F;
+
+			selected[ j ] = BVH_box_in_frustum( frustum, &bvh->bvhobject[ j ].min, &bvh->bvhobject[ j ].max, &mask );
+			++j;
+		}
+
+		BVH_query_frustum( bvh, frustum );
+
+		n_error += !check_result( bvh, selected );
+
+
+		// Sphere.
+		j = 0;
+		while( j != bvh->n_bvhobject )
+		{
+			BVHOBJECT *bvhobject = &bvh->bvhobject[ j ];
+
+			float d = 0.0f,
+				  t;
+
+			t = fmaxf( fmaxf( bvhobject->min.x - center.x, center.x - bvhobject->max.x ), 0.0f ); d += t * t;
+			t = fmaxf( fmaxf( bvhobject->min.y - center.y, center.y - bvhobject->max.y ), 0.0f ); d += t * t;
+			t = fmaxf( fmaxf( bvhobject->min.z - center.z, center.z - bvhobject->max.z ), 0.0f ); d += t * t;
+
+			selected[ j ] = d <= radius * radius;
+			++j;
+		}
+
+		BVH_query_sphere( bvh, &center, radius );
+
+		n_error += !check_result( bvh, selected );
+
+
+		// Box.
+		min.x = center.x - radius;
+		min.y = center.y - radius * 0.5f;
+		min.z = -5.0f;
+
+		max.x = center.x + radius * 0.5f;
+		max.y = center.y + radius;
+		max.z = 5.0f;
+
+		j = 0;
+		while( j != bvh->n_bvhobject )
+		{
+			BVHOBJECT *bvhobject = &bvh->bvhobject[ j ];
+
+			selected[ j ] = bvhobject->min.x <= max.x && bvhobject->max.x >= min.x &&
+							bvhobject->min.y <= max.y && bvhobject->max.y >= min.y &&
+							bvhobject->min.z <= max.z && bvhobject->max.z >= min.z;
+			++j;
+		}
+
+		BVH_query_box( bvh, &min, &max );
+
+		n_error += !check_result( bvh, selected );
+
+
+		// Ray, only the distance is compared since two boxes can be hit at the same distance.
+		vec3_diff( &direction, &center, &eye );
+
+		inv_direction.x = 1.0f / direction.x;
+		inv_direction.y = 1.0f / direction.y;
+		inv_direction.z = 1.0f / direction.z;
+
+		j = 0;
+		while( j != bvh->n_bvhobject )
+		{
+			float t = BVH_ray_box( &bvh->bvhobject[ j ].min, &bvh->bvhobject[ j ].max, &eye, &inv_direction, best );
+
+			if( t >= 0.0f && t < best ) best = t;
+
+			++j;
+		}
+
+		hit = BVH_query_ray( bvh, &eye, &direction, &distance );
+
+		if( best == 3.402823466e+38f ) n_error += hit != -1;
+
+		else n_error += hit == -1 || distance != best;
+
+		++i;
+	}
+
+	free( selected );
+
+	return n_error;
+}
+
+
+int main( void )
+{
+	unsigned int i,
+				 j,
+				 n_objmesh = 20000;
+
+	double bvh_time = 0.0,
+		   linear_time = 0.0;
+
+	unsigned char valid = 1;
+
+	OBJMESH *objmesh = ( OBJMESH * ) calloc( n_objmesh, sizeof( OBJMESH ) );
+
+	BVH *bvh = BVH_init();
+
+	vec4 frustum[ 6 ];
+
+	vec3 eye	= { 0.0f, 0.0f, 20.0f },
+		 center = { 50.0f, 50.0f, 0.0f },
+		 up		= { 0.0f, 0.0f, 1.0f };
+
+	GFX_start();
+
+	i = 0;
+	while( i != n_objmesh )
+	{
+		random_mesh( &objmesh[ i ] );
+
+		TEST_CHECK( BVH_add_mesh( bvh, &objmesh[ i ] ) == i );
+		++i;
+	}
+
+	BVH_build( bvh );
+
+
+	// The object boxes must enclose the transformed OBJMESH boxes.
+	i = 0;
+	while( i != n_objmesh )
+	{
+		mat4 m;
+
+		mat4_transform( &m, &objmesh[ i ].location, &objmesh[ i ].rotation, &objmesh[ i ].scale );
+
+		j = 0;
+		while( j != 8 )
+		{
+			vec3 v = { objmesh[ i ].dimension.x * ( ( j & 1 ) ? 0.5f : -0.5f ),
+					   objmesh[ i ].dimension.y * ( ( j & 2 ) ? 0.5f : -0.5f ),
+					   objmesh[ i ].dimension.z * ( ( j & 4 ) ? 0.5f : -0.5f ) };
+
+			BVHOBJECT *bvhobject = &bvh->bvhobject[ i ];
+
+			vec3_multiply_mat4( &v, &v, &m );
+
+			v.x += m.m[ 3 ].x;
+			v.y += m.m[ 3 ].y;
+			v.z += m.m[ 3 ].z;
+
+			if( v.x < bvhobject->min.x - 0.001f || v.x > bvhobject->max.x + 0.001f ||
+				v.y < bvhobject->min.y - 0.001f || v.y > bvhobject->max.y + 0.001f ||
+				v.z < bvhobject->min.z - 0.001f || v.z > bvhobject->max.z + 0.001f ) valid = 0;
+
+			++j;
+		}
+
+		++i;
+	}
+
+	TEST_CHECK( valid );
+	TEST_CHECK( check_nodes( bvh ) );
+	TEST_CHECK( check_queries( bvh, 200 ) == 0 );
+
+
+	// Move a few objects at a time.
+	i = 0;
+	while( i != 20 )
+	{
+		j = 0;
+		while( j != n_objmesh / 100 )
+		{
+			unsigned int k = ( unsigned int )TEST_random( 0.0f, n_objmesh - 0.5f );
+
+			objmesh[ k ].location.x += TEST_random( -20.0f, 20.0f );
+			objmesh[ k ].location.y += TEST_random( -20.0f, 20.0f );
+			objmesh[ k ].rotation.z += 30.0f;
+
+			BVH_update( bvh, k );
+			++j;
+		}
+
+		++i;
+	}
+
+	TEST_CHECK( check_nodes( bvh ) );
+	TEST_CHECK( check_queries( bvh, 100 ) == 0 );
+
+
+	// Move everything.
+	i = 0;
+	while( i != n_objmesh )
+	{
+		random_mesh( &objmesh[ i ] );
+		++i;
+	}
+
+	BVH_refit( bvh );
+
+	TEST_CHECK( check_nodes( bvh ) );
+	TEST_CHECK( check_queries( bvh, 100 ) == 0 );
+
+	BVH_build( bvh );
+
+	TEST_CHECK( check_nodes( bvh ) );
+	TEST_CHECK( check_queries( bvh, 100 ) == 0 );
+
+
+	// Frustum culling frames, moving 1% of the objects every frame.
+	GFX_set_matrix_mode( PROJECTION_MATRIX );
+	GFX_load_identity();
+	GFX_set_perspective( 60.0f, 1.5f, 1.0f, 100.0f, 0.0f );
+
+	GFX_set_matrix_mode( MODELVIEW_MATRIX );
+	GFX_load_identity();
+	GFX_look_at( &eye, &center, &up );
+
+	build_frustum( frustum, GFX_get_modelview_matrix(), GFX_get_projection_matrix() );
+
+	i = 0;
+	while( i != 50 )
+	{
+		unsigned int n_visible = 0;
+
+		double t = TEST_time();
+
+		j = 0;
+		while( j != n_objmesh / 100 )
+		{
+			unsigned int k = ( i * 131 + j * 97 ) % n_objmesh;
+
+			objmesh[ k ].location.x += ( i & 1 ) ? 1.0f : -1.0f;
+
+			BVH_update( bvh, k );
+			++j;
+		}
+
+		BVH_query_frustum( bvh, frustum );
+
+		bvh_time += TEST_time() - t;
+
+		t = TEST_time();
+
+		j = 0;
+		while( j != n_objmesh )
+		{
+			unsigned int mask = 0x3F;
+
+			n_visible += BVH_box_in_frustum( frustum, &bvh->bvhobject[ j ].min, &bvh->bvhobject[ j ].max, &mask );
+			++j;
+		}
+
+		linear_time += TEST_time() - t;
+
+		TEST_CHECK( n_visible == bvh->n_result );
+
+		++i;
+	}
+
+	printf( "%u objects, %u visible: BVH %.3f ms, linear %.3f ms per frame\n",
+			n_objmesh,
+			bvh->n_result,
+			bvh_time * 1000.0 / 50,
+			linear_time * 1000.0 / 50 );
+
+	BVH_free( bvh );
+
+	free( objmesh );
+
+	return TEST_end();
+}
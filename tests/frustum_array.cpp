@@ -0,0 +1,328 @@
+/*
+
+GFX Lightweight OpenGLES 2.0 Game and Graphics Engine
+
+Copyright (C) 2011 Romain Marucchi-Foino http://gfx.sio2interactive.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of
+this software. Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that
+you wrote the original software. If you use this software in a product, an acknowledgment
+in the product would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be misrepresented
+as being the original software.
+
+3. This notice may not be removed or altered from any source distribution.
+
+*/
+
+#include "test.h"
+
+/*!
+	\file frustum_array.cpp
+
+	\brief Check the visibility, inside and distance results of sphere_in_frustum_array and
+	box_in_frustum_array against sphere_intersect_frustum and box_intersect_frustum for random
+	spheres and boxes, with and without the rejecting plane cache, and print the time to cull
+	N_OBJECT objects. The Makefile builds this test twice, the second time with the SIMD paths
+	of utils.cpp disabled.
+*/
+
+
+//! The largest number of objects.
+#define N_OBJECT 10000
+
+
+//! The X locations of the objects.
+float x[ N_OBJECT ];
+
+//! The Y locations of the objects.
+float y[ N_OBJECT ];
+
+//! The Z locations of the objects.
+float z[ N_OBJECT ];
+
+//! The radius of the spheres.
+float radius[ N_OBJECT ];
+
+//! The extents of the boxes on the X axis.
+float ex[ N_OBJECT ];
+
+//! The extents of the boxes on the Y axis.
+float ey[ N_OBJECT ];
+
+//! The extents of the boxes on the Z axis.
+float ez[ N_OBJECT ];
+
+//! The distances returned by the array functions.
+float distance[ N_OBJECT ];
+
+//! The visibility bitmask.
+unsigned int visibility[ ( N_OBJECT + 31 ) / 32 ];
+
+//! The inside bitmask.
+unsigned int inside[ ( N_OBJECT + 31 ) / 32 ];
+
+//! The rejecting plane cache.
+unsigned char plane[ N_OBJECT ];
+
+
+/*!
+	Function internally used to build the frustum of a camera looking at the origin from a
+	random direction.
+
+	\param[in,out] frustum The six clipping planes.
+*/
+void random_frustum( vec4 frustum[ 6 ] )
+{
+	vec3 eye	= { TEST_random( -20.0f, 20.0f ), TEST_random( -20.0f, 20.0f ), TEST_random( 1.0f, 10.0f ) },
+		 center = { TEST_random( -2.0f, 2.0f ), TEST_random( -2.0f, 2.0f ), 0.0f },
+		 up		= { 0.0f, 0.0f, 1.0f };
+
+	GFX_set_matrix_mode( PROJECTION_MATRIX );
+	GFX_load_identity();
+	GFX_set_perspective( TEST_random( 30.0f, 90.0f ), 1.5f, 0.5f, TEST_random( 20.0f, 60.0f ), 0.0f );
+
+	GFX_set_matrix_mode( MODELVIEW_MATRIX );
+	GFX_load_identity();
+	GFX_look_at( &eye, &center, &up );
+
+	build_frustum( frustum, GFX_get_modelview_matrix(), GFX_get_projection_matrix() );
+}
+
+
+/*!
+	Function internally used to get if an object is so close to be tangent to a plane that the
+	float rounding of the corner and projected radius tests may disagree.
+
+	\param[in] frustum The six clipping planes.
+	\param[in] i The index of the object.
+	\param[in] box Determine if the object is a box or a sphere.
+
+	\return Return 1 if the object is on the edge of a plane, else return 0.
+*/
+unsigned char on_edge( vec4 *frustum, unsigned int i, unsigned char box )
+{
+	unsigned int j = 0;
+
+	while( j != 6 )
+	{
+		float d = frustum[ j ].x * x[ i ] + frustum[ j ].y * y[ i ] + frustum[ j ].z * z[ i ] + frustum[ j ].w,
+			  r = box ? fabsf( frustum[ j ].x ) * ex[ i ] + fabsf( frustum[ j ].y ) * ey[ i ] + fabsf( frustum[ j ].z ) * ez[ i ] : radius[ i ],
+			  e = 0.0001f * ( 1.0f + fabsf( d ) + r );
+
+		if( fabsf( d + r ) < e || fabsf( d - r ) < e ) return 1;
+
+		++j;
+	}
+
+	return 0;
+}
+
+
+/*!
+	Function internally used to cull the first n objects as spheres or boxes and compare every
+	result with the single object functions.
+
+	\param[in] frustum The six clipping planes.
+	\param[in] n The number of objects.
+	\param[in] box Determine if the objects are boxes or spheres.
+	\param[in] use_plane Determine if the rejecting plane cache is used.
+
+	\return Return the number of objects whose results differ.
+*/
+unsigned int check_array( vec4 *frustum, unsigned int n, unsigned char box, unsigned char use_plane )
+{
+	unsigned int i = 0,
+				 n_visible = 0,
+				 n_error = 0,
+				 v = box ? box_in_frustum_array( frustum, n, x, y, z, ex, ey, ez, visibility, inside, distance, use_plane ? plane : NULL ) :
+						   sphere_in_frustum_array( frustum, n, x, y, z, radius, visibility, inside, distance, use_plane ? plane : NULL );
+
+	while( i != n )
+	{
+		vec3 location  = { x[ i ], y[ i ], z[ i ] },
+			 dimension = { ex[ i ], ey[ i ], ez[ i ] };
+
+		unsigned char ref = box ? box_intersect_frustum( frustum, &location, &dimension ) :
+								  sphere_intersect_frustum( frustum, &location, radius[ i ] ),
+					  visible = ( visibility[ i >> 5 ] >> ( i & 31 ) ) & 1,
+					  in	  = ( inside[ i >> 5 ] >> ( i & 31 ) ) & 1;
+
+		float d;
+
+		n_visible += visible;
+
+		if( box ) d = ref ? frustum[ 5 ].x * x[ i ] + frustum[ 5 ].y * y[ i ] + frustum[ 5 ].z * z[ i ] + frustum[ 5 ].w +
+							fabsf( frustum[ 5 ].x ) * ex[ i ] + fabsf( frustum[ 5 ].y ) * ey[ i ] + fabsf( frustum[ 5 ].z ) * ez[ i ] : 0.0f;
+
+		else d = sphere_distance_in_frustum( frustum, &location, radius[ i ] );
+
+		if( !on_edge( frustum, i, box ) &&
+			( visible != ( ref != 0 ) ||
+			  in	  != ( ref == 2 ) ||
+			  fabsf( distance[ i ] - d ) > 0.0001f * ( 1.0f + fabsf( d ) ) ) ) ++n_error;
+
+		if( !visible && distance[ i ] != 0.0f ) ++n_error;
+
+		++i;
+	}
+
+	// The bits past the last object are cleared.
+	if( ( n & 31 ) && ( visibility[ n >> 5 ] >> ( n & 31 ) || inside[ n >> 5 ] >> ( n & 31 ) ) ) ++n_error;
+
+	if( v != n_visible ) ++n_error;
+
+	return n_error;
+}
+
+
+/*!
+	Function internally used to cull every object one at a time, the way the array functions
+	replace.
+
+	\param[in] frustum The six clipping planes.
+	\param[in] box Determine if the objects are boxes or spheres.
+
+	\return Return the number of visible objects.
+*/
+unsigned int cull_loop( vec4 *frustum, unsigned char box )
+{
+	unsigned int i = 0,
+				 v = 0;
+
+	while( i != N_OBJECT )
+	{
+		vec3 location  = { x[ i ], y[ i ], z[ i ] },
+			 dimension = { ex[ i ], ey[ i ], ez[ i ] };
+
+		if( box ? box_intersect_frustum( frustum, &location, &dimension ) :
+				  sphere_intersect_frustum( frustum, &location, radius[ i ] ) ) ++v;
+
+		++i;
+	}
+
+	return v;
+}
+
+
+int main( void )
+{
+	unsigned int n[ 6 ] = { 1, 3, 5, 37, 1001, N_OBJECT - 3 },
+				 i,
+				 j,
+				 k,
+				 n_error = 0,
+				 n_visible = 0;
+
+	double t,
+		   array_time,
+		   plane_time;
+
+	vec4 frustum[ 6 ];
+
+	GFX_start();
+
+	TEST_seed( 15 );
+
+	i = 0;
+	while( i != N_OBJECT )
+	{
+		x[ i ] = TEST_random( -40.0f, 40.0f );
+		y[ i ] = TEST_random( -40.0f, 40.0f );
+		z[ i ] = TEST_random( -20.0f, 20.0f );
+
+		radius[ i ] = TEST_random( 0.1f, 4.0f );
+
+		ex[ i ] = TEST_random( 0.1f, 4.0f );
+		ey[ i ] = TEST_random( 0.1f, 4.0f );
+		ez[ i ] = TEST_random( 0.1f, 4.0f );
+		++i;
+	}
+
+
+	// Every count of objects, as spheres then boxes, without then with the rejecting plane
+	// cache kept over several frames.
+	i = 0;
+	while( i != 6 )
+	{
+		j = 0;
+		while( j != 2 )
+		{
+			random_frustum( frustum );
+
+			n_error += check_array( frustum, n[ i ], j, 0 );
+
+			memset( plane, 0, sizeof( plane ) );
+
+			k = 0;
+			while( k != 20 )
+			{
+				random_frustum( frustum );
+
+				n_error += check_array( frustum, n[ i ], j, 1 );
+				++k;
+			}
+
+			++j;
+		}
+
+		++i;
+	}
+
+	TEST_CHECK( n_error == 0 );
+
+
+	// The time to cull every object from a still camera, the plane cache being warm after the
+	// first call.
+	random_frustum( frustum );
+
+	j = 0;
+	while( j != 2 )
+	{
+		memset( plane, 0, sizeof( plane ) );
+
+		k = 0;
+		while( k != 3 )
+		{
+			t = TEST_time();
+
+			i = 0;
+			while( i != 100 )
+			{
+				if( k == 2 ) n_visible = cull_loop( frustum, j );
+
+				else if( j ) n_visible = box_in_frustum_array( frustum, N_OBJECT, x, y, z, ex, ey, ez, visibility, inside, distance, k ? plane : NULL );
+
+				else n_visible = sphere_in_frustum_array( frustum, N_OBJECT, x, y, z, radius, visibility, inside, distance, k ? plane : NULL );
+
+				++i;
+			}
+
+			t = ( TEST_time() - t ) / 100;
+
+			if( k == 0 ) array_time = t;
+
+			else if( k == 1 ) plane_time = t;
+
+			++k;
+		}
+
+		printf( "%u %s, %u visible: array %.3f ms, with plane cache %.3f ms, %s %.3f ms\n",
+				N_OBJECT,
+				j ? "boxes  " : "spheres",
+				n_visible,
+				array_time * 1000.0,
+				plane_time * 1000.0,
+				j ? "box_intersect_frustum loop   " : "sphere_intersect_frustum loop",
+				t * 1000.0 );
+		++j;
+	}
+
+	return TEST_end();
+}
@@ -0,0 +1,444 @@
+/*
+
+GFX Lightweight OpenGLES 2.0 Game and Graphics Engine
+
+Copyright (C) 2011 Romain Marucchi-Foino http://gfx.sio2interactive.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of
+this software. Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that
+you wrote the original software. If you use this software in a product, an acknowledgment
+in the product would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be misrepresented
+as being the original software.
+
+3. This notice may not be removed or altered from any source distribution.
+
+*/
+
+#include "test.h"
+
+/*!
+	\file gfx_matrix.cpp
+
+	\brief Check the cached modelview projection and normal matrices of GFX against the
+	uncached computation over random matrix stack operations, GFX_push_transform against the
+	calls it replaces, the overflow and underflow of the matrix stacks, and print the time of
+	a draw loop requesting them.
+*/
+
+
+/*!
+	Function internally used to return the largest difference between two matrices, relative
+	to the largest element of the reference.
+
+	\param[in] m The matrix to check.
+	\param[in] ref The reference matrix.
+	\param[in] n The number of float of the matrices.
+
+	\return Return the relative error.
+*/
+float get_error( float *m, float *ref, unsigned int n )
+{
+	unsigned int i = 0;
+
+	float e = 0.0f,
+		  scale = 0.0f;
+
+	while( i != n )
+	{
+		e	  = fmaxf( e, fabsf( m[ i ] - ref[ i ] ) );
+		scale = fmaxf( scale, fabsf( ref[ i ] ) );
+		++i;
+	}
+
+	return scale ? e / scale : e;
+}
+
+
+/*!
+	Function internally used to compute the normal matrix the way it was done before the
+	cache, with a full inverse.
+
+	\param[in,out] dst The normal matrix.
+	\param[in] m The modelview matrix.
+*/
+void get_normal_matrix( mat3 *dst, mat4 *m )
+{
+	mat4 mat;
+
+	mat4_copy_mat4( &mat, m );
+
+	mat4_invert_full( &mat );
+
+	mat4_transpose( &mat );
+
+	mat3_copy_mat4( dst, &mat );
+}
+
+
+int main( void )
+{
+	unsigned int i,
+				 j,
+				 k,
+				 n_draw = 2000;
+
+	unsigned char same = 1;
+
+	float mvp_error = 0.0f,
+		  normal_error = 0.0f,
+		  transform_error;
+
+	double t,
+		   cached_time,
+		   uncached_time;
+
+	mat4 mvp,
+		 m;
+
+	mat3 normal;
+
+	vec3 eye	= { 0.0f, -10.0f, 3.0f },
+		 center = { 0.0f,   0.0f, 0.0f },
+		 up		= { 0.0f,   0.0f, 1.0f };
+
+	GFX_start();
+
+	GFX_set_matrix_mode( PROJECTION_MATRIX );
+	GFX_load_identity();
+	GFX_set_perspective( 60.0f, 1.5f, 0.1f, 100.0f, 0.0f );
+
+	GFX_set_matrix_mode( MODELVIEW_MATRIX );
+	GFX_load_identity();
+
+
+	// Random stack operations, every one of them followed by a check of both matrices.
+	i = 0;
+	while( i != 200000 )
+	{
+		unsigned int op = ( unsigned int )TEST_random( 0.0f, 10.999f );
+
+		switch( op )
+		{
+			case 0:
+			{
+				if( gfx.modelview_matrix_index < MAX_MODELVIEW_MATRIX - 1 ) GFX_push_matrix();
+				break;
+			}
+
+			case 1:
+			{
+				if( gfx.modelview_matrix_index ) GFX_pop_matrix();
+				break;
+			}
+
+			case 2:
+			{
+				GFX_translate( TEST_random( -5.0f, 5.0f ), TEST_random( -5.0f, 5.0f ), TEST_random( -5.0f, 5.0f ) );
+				break;
+			}
+
+			case 3:
+			{
+				GFX_rotate( TEST_random( -180.0f, 180.0f ), TEST_random( -1.0f, 1.0f ), TEST_random( -1.0f, 1.0f ), TEST_random( 0.1f, 1.0f ) );
+				break;
+			}
+
+			case 4:
+			{
+				GFX_scale( TEST_random( 0.5f, 2.0f ), TEST_random( 0.5f, 2.0f ), TEST_random( 0.5f, 2.0f ) );
+				break;
+			}
+
+			case 5:
+			{
+				// Keep the matrices in a range where the uncached inverse is accurate.
+				if( gfx.modelview_matrix_index ) GFX_pop_matrix();
+
+				GFX_load_identity();
+				break;
+			}
+
+			case 6:
+			{
+				GFX_look_at( &eye, &center, &up );
+				break;
+			}
+
+			case 7:
+			{
+				// Write through the pointer, then flag the level.
+				mat4 *m = GFX_get_modelview_matrix();
+
+				m->m[ 3 ].x += TEST_random( -1.0f, 1.0f );
+
+				GFX_dirty_matrix( 1 );
+				break;
+			}
+
+			case 8:
+			{
+				mat4 m;
+
+				mat4_identity( &m );
+
+				m.m[ 0 ].y = TEST_random( -0.5f, 0.5f );
+				m.m[ 3 ].z = TEST_random( -2.0f, 2.0f );
+
+				GFX_multiply_matrix( &m );
+				break;
+			}
+
+			case 9:
+			{
+				GFX_set_matrix_mode( PROJECTION_MATRIX );
+
+				GFX_load_identity();
+
+				GFX_set_perspective( TEST_random( 30.0f, 90.0f ), 1.5f, 0.1f, 100.0f, 0.0f );
+
+				GFX_set_matrix_mode( MODELVIEW_MATRIX );
+				break;
+			}
+
+			default:
+			{
+				// Query without modification, the cache must stay valid.
+				break;
+			}
+		}
+
+		if( fabsf( GFX_get_modelview_matrix()->m[ 0 ].x ) > 1000.0f ) GFX_load_identity();
+
+		mat4_multiply_mat4( &mvp, GFX_get_projection_matrix(), GFX_get_modelview_matrix() );
+
+		get_normal_matrix( &normal, GFX_get_modelview_matrix() );
+
+		mvp_error = fmaxf( mvp_error, get_error( ( float * )GFX_get_modelview_projection_matrix(), ( float * )&mvp, 16 ) );
+
+		normal_error = fmaxf( normal_error, get_error( ( float * )GFX_get_normal_matrix(), ( float * )&normal, 9 ) );
+
+		++i;
+	}
+
+	printf( "random stack operations: MVP error %g, normal matrix relative error %g\n", mvp_error, normal_error );
+
+	TEST_CHECK( mvp_error == 0.0f );
+	TEST_CHECK( normal_error < 0.00001f );
+
+	while( gfx.modelview_matrix_index ) GFX_pop_matrix();
+
+	GFX_load_identity();
+
+	GFX_look_at( &eye, &center, &up );
+
+
+	// GFX_push_transform is a push, a translation, the Z, Y and X rotations then a scale.
+	transform_error = 0.0f;
+
+	i = 0;
+	while( i != 1000 )
+	{
+		vec3 location = { TEST_random( -5.0f, 5.0f ), TEST_random( -5.0f, 5.0f ), TEST_random( -5.0f, 5.0f ) },
+			 rotation = { TEST_random( -180.0f, 180.0f ), TEST_random( -180.0f, 180.0f ), TEST_random( -180.0f, 180.0f ) },
+			 scale	  = { 1.0f, 1.0f, 1.0f };
+
+		if( i & 1 )
+		{
+			scale.x = TEST_random( 0.5f, 2.0f );
+			scale.y = TEST_random( 0.5f, 2.0f );
+			scale.z = TEST_random( 0.5f, 2.0f );
+		}
+
+		GFX_push_matrix();
+
+		GFX_translate( location.x, location.y, location.z );
+		GFX_rotate( rotation.z, 0.0f, 0.0f, 1.0f );
+		GFX_rotate( rotation.y, 0.0f, 1.0f, 0.0f );
+		GFX_rotate( rotation.x, 1.0f, 0.0f, 0.0f );
+		GFX_scale( scale.x, scale.y, scale.z );
+
+		mat4_copy_mat4( &m, GFX_get_modelview_matrix() );
+
+		GFX_pop_matrix();
+
+		GFX_push_transform( &location, &rotation, &scale );
+
+		transform_error = fmaxf( transform_error, get_error( ( float * )GFX_get_modelview_matrix(), ( float * )&m, 16 ) );
+
+		if( gfx.modelview_orthonormal[ gfx.modelview_matrix_index ] != !( i & 1 ) ) same = 0;
+
+		GFX_pop_matrix();
+
+		++i;
+	}
+
+	printf( "GFX_push_transform relative error %g\n", transform_error );
+
+	TEST_CHECK( transform_error < 0.000001f );
+	TEST_CHECK( same );
+	TEST_CHECK( gfx.modelview_matrix_index == 0 );
+
+
+	// The transformations applied after an ignored push are discarded by its pop, and do not
+	// leak into the top most level of the stack.
+	while( gfx.modelview_matrix_index != MAX_MODELVIEW_MATRIX - 1 ) GFX_push_matrix();
+
+	GFX_translate( 1.0f, 2.0f, 3.0f );
+
+	mat4_copy_mat4( &m, GFX_get_modelview_matrix() );
+
+	GFX_get_modelview_projection_matrix();
+	GFX_get_normal_matrix();
+
+	i = 0;
+	while( i != 3 )
+	{
+		vec3 location = { 1.0f, 0.0f, 0.0f },
+			 rotation = { 0.0f, 0.0f, 45.0f },
+			 scale	  = { 2.0f, 2.0f, 2.0f };
+
+		GFX_push_matrix();
+
+		GFX_translate( 5.0f, 0.0f, 0.0f );
+		GFX_rotate( 30.0f, 0.0f, 0.0f, 1.0f );
+		GFX_push_transform( &location, &rotation, &scale );
+		++i;
+	}
+
+	TEST_CHECK( gfx.modelview_matrix_index == MAX_MODELVIEW_MATRIX - 1 );
+	TEST_CHECK( gfx.matrix_overflow[ MODELVIEW_MATRIX ] == 6 );
+
+	i = 0;
+	while( i != 6 )
+	{
+		GFX_pop_matrix();
+		++i;
+	}
+
+	TEST_CHECK( gfx.matrix_overflow[ MODELVIEW_MATRIX ] == 0 );
+	TEST_CHECK( !memcmp( GFX_get_modelview_matrix(), &m, sizeof( mat4 ) ) );
+	TEST_CHECK( gfx.modelview_orthonormal[ gfx.modelview_matrix_index ] );
+
+	mat4_multiply_mat4( &mvp, GFX_get_projection_matrix(), GFX_get_modelview_matrix() );
+
+	TEST_CHECK( !memcmp( GFX_get_modelview_projection_matrix(), &mvp, sizeof( mat4 ) ) );
+
+	GFX_pop_matrix();
+
+	TEST_CHECK( gfx.modelview_matrix_index == MAX_MODELVIEW_MATRIX - 2 );
+
+	while( gfx.modelview_matrix_index ) GFX_pop_matrix();
+
+
+	// The same on the projection stack, the modelview projection matrix follows.
+	GFX_set_matrix_mode( PROJECTION_MATRIX );
+
+	while( gfx.projection_matrix_index != MAX_PROJECTION_MATRIX - 1 ) GFX_push_matrix();
+
+	mat4_copy_mat4( &m, GFX_get_projection_matrix() );
+
+	GFX_push_matrix();
+
+	GFX_load_identity();
+
+	GFX_get_modelview_projection_matrix();
+
+	GFX_pop_matrix();
+
+	TEST_CHECK( !memcmp( GFX_get_projection_matrix(), &m, sizeof( mat4 ) ) );
+
+	mat4_multiply_mat4( &mvp, GFX_get_projection_matrix(), GFX_get_modelview_matrix() );
+
+	TEST_CHECK( !memcmp( GFX_get_modelview_projection_matrix(), &mvp, sizeof( mat4 ) ) );
+
+	while( gfx.projection_matrix_index ) GFX_pop_matrix();
+
+
+	// Popping an empty stack is ignored, and does not swallow the next push.
+	GFX_pop_matrix();
+
+	TEST_CHECK( gfx.projection_matrix_index == 0 );
+	TEST_CHECK( !memcmp( GFX_get_projection_matrix(), &m, sizeof( mat4 ) ) );
+
+	GFX_set_matrix_mode( MODELVIEW_MATRIX );
+
+	mat4_copy_mat4( &m, GFX_get_modelview_matrix() );
+
+	GFX_pop_matrix();
+
+	TEST_CHECK( gfx.modelview_matrix_index == 0 );
+	TEST_CHECK( gfx.matrix_overflow[ MODELVIEW_MATRIX ] == 0 );
+	TEST_CHECK( !memcmp( GFX_get_modelview_matrix(), &m, sizeof( mat4 ) ) );
+
+	GFX_push_matrix();
+
+	GFX_translate( 1.0f, 0.0f, 0.0f );
+
+	TEST_CHECK( gfx.modelview_matrix_index == 1 );
+
+	GFX_pop_matrix();
+
+	TEST_CHECK( !memcmp( GFX_get_modelview_matrix(), &m, sizeof( mat4 ) ) );
+
+
+	// Draw loop: per object a transform, then 3 triangle lists asking for the matrices.
+	k = 0;
+	while( k != 2 )
+	{
+		t = TEST_time();
+
+		i = 0;
+		while( i != n_draw )
+		{
+			GFX_push_matrix();
+
+			GFX_translate( ( float )( i % 40 ), ( float )( i / 40 ), 0.0f );
+
+			GFX_rotate( ( float )i, 0.0f, 0.0f, 1.0f );
+
+			j = 0;
+			while( j != 3 )
+			{
+				if( k )
+				{
+					mat4_multiply_mat4( &mvp, GFX_get_projection_matrix(), GFX_get_modelview_matrix() );
+
+					get_normal_matrix( &normal, GFX_get_modelview_matrix() );
+				}
+				else
+				{
+					GFX_get_modelview_projection_matrix();
+
+					GFX_get_normal_matrix();
+				}
+
+				GFX_get_modelview_matrix();
+
+				++j;
+			}
+
+			GFX_pop_matrix();
+
+			++i;
+		}
+
+		t = TEST_time() - t;
+
+		if( k ) uncached_time = t;
+
+		else cached_time = t;
+
+		++k;
+	}
+
+	printf( "%u draws of 3 triangle lists: cached %.0f us, uncached %.0f us\n", n_draw, cached_time * 1000000.0, uncached_time * 1000000.0 );
+
+	return TEST_end();
+}
@@ -0,0 +1,336 @@
+/*
+
+GFX Lightweight OpenGLES 2.0 Game and Graphics Engine
+
+Copyright (C) 2011 Romain Marucchi-Foino http://gfx.sio2interactive.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of
+this software. Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that
+you wrote the original software. If you use this software in a product, an acknowledgment
+in the product would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be misrepresented
+as being the original software.
+
+3. This notice may not be removed or altered from any source distribution.
+
+*/
+
+#include "test.h"
+
+/*!
+	\file gles.cpp
+
+	\brief Headless implementation of the OpenGLES 2.0 functions used by the engine.
+
+	\details The shaders always compile and the programs always link, every program reports
+	the uniforms of testgles.testuniform, and the ids are taken from a single counter.
+	Everything else does nothing except counting the calls checked by the tests.
+*/
+
+
+TESTGLES testgles = { NULL, 0, 128, 0, 0, -1, 0, 0, 0, 0 };
+
+
+/*!
+	Function internally used by the stubs to return n new ids.
+
+	\param[in] n The number of ids.
+	\param[in,out] id The array of ids.
+*/
+void TEST_gen_id( GLsizei n, GLuint *id )
+{
+	GLsizei i = 0;
+
+	while( i != n )
+	{
+		++testgles.id;
+		id[ i ] = testgles.id;
+		++i;
+	}
+}
+
+
+void glBufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage)
+{ testgles.n_buffer_byte += ( unsigned int )size; }
+
+void glBufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data)
+{ testgles.n_buffer_byte += ( unsigned int )size; }
+
+GLuint glCreateProgram (void)
+{ return ++testgles.id; }
+
+GLuint glCreateShader (GLenum type)
+{ return ++testgles.id; }
+
+void glDrawElements (GLenum mode, GLsizei count, GLenum type, const GLvoid* indices)
+{ ++testgles.n_draw; }
+
+void glGenBuffers (GLsizei n, GLuint* buffers)
+{ TEST_gen_id( n, buffers ); }
+
+void glGenTextures (GLsizei n, GLuint* textures)
+{ TEST_gen_id( n, textures ); }
+
+void glGenVertexArraysOES (GLsizei n, GLuint *arrays)
+{ TEST_gen_id( n, arrays ); }
+
+void glGetActiveAttrib (GLuint program, GLuint index, GLsizei bufsize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+	if( length ) *length = 0;
+	if( bufsize ) name[ 0 ] = 0;
+}
+
+void glGetActiveUniform (GLuint program, GLuint index, GLsizei bufsize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+	TESTUNIFORM *testuniform = &testgles.testuniform[ index ];
+
+	snprintf( name, bufsize, "%s", testuniform->name );
+
+	if( length ) *length = ( GLsizei )strlen( name );
+
+	*size = testuniform->size;
+	*type = testuniform->type;
+}
+
+int glGetAttribLocation (GLuint program, const GLchar* name)
+{ return -1; }
+
+GLenum glGetError (void)
+{ return GL_NO_ERROR; }
+
+void glGetFloatv (GLenum pname, GLfloat* params)
+{ *params = 0.0f; }
+
+void glGetIntegerv (GLenum pname, GLint* params)
+{ *params = pname == GL_MAX_VERTEX_UNIFORM_VECTORS ? testgles.max_vertex_uniform_vectors : 0; }
+
+void glGetProgramInfoLog (GLuint program, GLsizei bufsize, GLsizei* length, GLchar* infolog)
+{
+	if( length ) *length = 0;
+	if( bufsize ) infolog[ 0 ] = 0;
+}
+
+void glGetProgramiv (GLuint program, GLenum pname, GLint* params)
+{
+	switch( pname )
+	{
+		case GL_LINK_STATUS:
+		case GL_VALIDATE_STATUS:
+		{
+			*params = 1;
+			break;
+		}
+
+		case GL_ACTIVE_UNIFORMS:
+		{
+			*params = testgles.n_testuniform;
+			break;
+		}
+
+		default:
+		{
+			*params = 0;
+			break;
+		}
+	}
+}
+
+void glGetShaderInfoLog (GLuint shader, GLsizei bufsize, GLsizei* length, GLchar* infolog)
+{
+	if( length ) *length = 0;
+	if( bufsize ) infolog[ 0 ] = 0;
+}
+
+void glGetShaderiv (GLuint shader, GLenum pname, GLint* params)
+{ *params = pname == GL_COMPILE_STATUS; }
+
+const GLubyte* glGetString (GLenum name)
+{ return ( const GLubyte * )""; }
+
+int glGetUniformLocation (GLuint program, const GLchar* name)
+{
+	unsigned int i = 0,
+				 length = strlen( name );
+
+	++testgles.n_uniform_location;
+
+	while( i != testgles.n_testuniform )
+	{
+		const char *testname = testgles.testuniform[ i ].name;
+
+		// Like the drivers, accept "NAME" for an array reported as "NAME[0]".
+		if( !strcmp( testname, name ) ||
+			( !strncmp( testname, name, length ) && !strcmp( &testname[ length ], "[0]" ) ) ) return i;
+
+		++i;
+	}
+
+	return -1;
+}
+
+void glUniform4fv (GLint location, GLsizei count, const GLfloat* v)
+{
+	++testgles.n_uniform;
+
+	testgles.uniform4fv_location = location;
+	testgles.uniform4fv_count	 = count;
+}
+
+void glActiveTexture (GLenum texture)
+{}
+
+void glAttachShader (GLuint program, GLuint shader)
+{}
+
+void glBindBuffer (GLenum target, GLuint buffer)
+{}
+
+void glBindTexture (GLenum target, GLuint texture)
+{}
+
+void glBindVertexArrayOES (GLuint array)
+{}
+
+void glBlendFunc (GLenum sfactor, GLenum dfactor)
+{}
+
+void glClear (GLbitfield mask)
+{}
+
+void glClearColor (GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha)
+{}
+
+void glClearDepthf (GLclampf depth)
+{}
+
+void glClearStencil (GLint s)
+{}
+
+void glCompileShader (GLuint shader)
+{}
+
+void glCompressedTexImage2D (GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const GLvoid* data)
+{}
+
+void glCullFace (GLenum mode)
+{}
+
+void glDeleteBuffers (GLsizei n, const GLuint* buffers)
+{}
+
+void glDeleteProgram (GLuint program)
+{}
+
+void glDeleteShader (GLuint shader)
+{}
+
+void glDeleteTextures (GLsizei n, const GLuint* textures)
+{}
+
+void glDeleteVertexArraysOES (GLsizei n, const GLuint *arrays)
+{}
+
+void glDepthFunc (GLenum func)
+{}
+
+void glDepthMask (GLboolean flag)
+{}
+
+void glDepthRangef (GLclampf zNear, GLclampf zFar)
+{}
+
+void glDisable (GLenum cap)
+{}
+
+void glDrawArrays (GLenum mode, GLint first, GLsizei count)
+{}
+
+void glEnable (GLenum cap)
+{}
+
+void glEnableVertexAttribArray (GLuint index)
+{}
+
+void glFrontFace (GLenum mode)
+{}
+
+void glGenerateMipmap (GLenum target)
+{}
+
+void glHint (GLenum target, GLenum mode)
+{}
+
+void glLinkProgram (GLuint program)
+{}
+
+void glPixelStorei (GLenum pname, GLint param)
+{}
+
+void glShaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length)
+{}
+
+void glStencilMask (GLuint mask)
+{}
+
+void glTexImage2D (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* pixels)
+{}
+
+void glTexParameterf (GLenum target, GLenum pname, GLfloat param)
+{}
+
+void glTexParameteri (GLenum target, GLenum pname, GLint param)
+{}
+
+void glUniform1fv (GLint location, GLsizei count, const GLfloat* v)
+{ ++testgles.n_uniform; }
+
+void glUniform1i (GLint location, GLint x)
+{ ++testgles.n_uniform; }
+
+void glUniform1iv (GLint location, GLsizei count, const GLint* v)
+{ ++testgles.n_uniform; }
+
+void glUniform2fv (GLint location, GLsizei count, const GLfloat* v)
+{ ++testgles.n_uniform; }
+
+void glUniform2iv (GLint location, GLsizei count, const GLint* v)
+{ ++testgles.n_uniform; }
+
+void glUniform3fv (GLint location, GLsizei count, const GLfloat* v)
+{ ++testgles.n_uniform; }
+
+void glUniform3iv (GLint location, GLsizei count, const GLint* v)
+{ ++testgles.n_uniform; }
+
+void glUniform4iv (GLint location, GLsizei count, const GLint* v)
+{ ++testgles.n_uniform; }
+
+void glUniformMatrix2fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{ ++testgles.n_uniform; }
+
+void glUniformMatrix3fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{ ++testgles.n_uniform; }
+
+void glUniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{ ++testgles.n_uniform; }
+
+void glUseProgram (GLuint program)
+{}
+
+void glValidateProgram (GLuint program)
+{}
+
+void glVertexAttribPointer (GLuint indx, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* ptr)
+{}
+
+
+// The world importer references the constraint serialization, which is not part of the
+// Bullet sources compiled for the tests.
+const char *btTypedConstraint::serialize( void *dataBuffer, btSerializer *serializer ) const
+{ return NULL; }
@@ -0,0 +1,10 @@
+#include <stdint.h>
+#include <stddef.h>
+#define GL_APICALL
+#define GL_APIENTRY
+typedef int8_t khronos_int8_t;
+typedef uint8_t khronos_uint8_t;
+typedef int32_t khronos_int32_t;
+typedef float khronos_float_t;
+typedef intptr_t khronos_intptr_t;
+typedef ptrdiff_t khronos_ssize_t;
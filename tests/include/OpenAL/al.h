@@ -0,0 +1 @@
+#include "openal/al.h"
@@ -0,0 +1 @@
+#include "openal/alc.h"
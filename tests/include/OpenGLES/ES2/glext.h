@@ -0,0 +1,2 @@
+#define GL_GLEXT_PROTOTYPES 1
+#include "GLES2/gl2ext.h"
@@ -0,0 +1,290 @@
+/*
+
+GFX Lightweight OpenGLES 2.0 Game and Graphics Engine
+
+Copyright (C) 2011 Romain Marucchi-Foino http://gfx.sio2interactive.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of
+this software. Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that
+you wrote the original software. If you use this software in a product, an acknowledgment
+in the product would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be misrepresented
+as being the original software.
+
+3. This notice may not be removed or altered from any source distribution.
+
+*/
+
+#include "test.h"
+
+/*!
+	\file md5_batch.cpp
+
+	\brief Check that MD5_update_batch updates MD5 instances, with one or two actions, exactly
+	like updating them one after the other on 1 to 4 threads, and print the time per frame of
+	both.
+*/
+
+
+//! The number of MD5 instances.
+#define N_INSTANCE 32
+
+
+/*!
+	Function internally used to create the MD5 instances and their MD5UPDATE. The odd instances
+	blend a second action, and each instance starts at a different frame.
+
+	\param[in] md5 The MD5 to instance.
+	\param[in,out] md5update The array of N_INSTANCE MD5UPDATE to fill.
+*/
+void create_instances( MD5 *md5, MD5UPDATE *md5update )
+{
+	unsigned int i = 0;
+
+	char name[ MAX_CHAR ];
+
+	while( i != N_INSTANCE )
+	{
+		MD5 *instance;
+
+		sprintf( name, "instance%u", i );
+
+		instance = MD5_create_instance( md5, name );
+
+		memset( &md5update[ i ], 0, sizeof( MD5UPDATE ) );
+
+		md5update[ i ].md5		 = instance;
+		md5update[ i ].time_step = 1.0f / 60.0f;
+		md5update[ i ].action0	 = &instance->md5action[ 0 ];
+
+		MD5_action_play( md5update[ i ].action0, MD5_METHOD_SLERP, 1 );
+
+		md5update[ i ].action0->curr_frame = i % md5update[ i ].action0->n_frame;
+		md5update[ i ].action0->next_frame = ( md5update[ i ].action0->curr_frame + 1 ) % md5update[ i ].action0->n_frame;
+
+		if( i & 1 )
+		{
+			md5update[ i ].action1					  = &instance->md5action[ 1 ];
+			md5update[ i ].joint_interpolation_method = MD5_METHOD_SLERP;
+			md5update[ i ].action_weight			  = 0.5f;
+
+			md5update[ i ].pose = ( MD5POSE * ) calloc( 1, sizeof( MD5POSE ) );
+
+			MD5_init_pose( instance, md5update[ i ].pose );
+
+			MD5_action_play( md5update[ i ].action1, MD5_METHOD_LERP, 1 );
+		}
+
+		++i;
+	}
+}
+
+
+/*!
+	Function internally used to update the MD5 instances one after the other, the way
+	MD5_update_batch does it for each MD5UPDATE.
+
+	\param[in,out] md5update The array of N_INSTANCE MD5UPDATE.
+*/
+void update_serial( MD5UPDATE *md5update )
+{
+	unsigned int i = 0;
+
+	while( i != N_INSTANCE )
+	{
+		MD5UPDATE *u = &md5update[ i ];
+
+		u->update = MD5_draw_action( u->md5, u->time_step );
+
+		if( u->update )
+		{
+			MD5POSE *pose = &u->action0->pose;
+
+			if( u->action1 )
+			{
+				MD5_add_pose( u->md5, u->pose, u->action0, u->action1, u->joint_interpolation_method, u->action_weight );
+
+				pose = u->pose;
+			}
+
+			MD5_skin_pose( u->md5, pose, 1 );
+
+			MD5_update_bound_pose( u->md5, pose );
+		}
+
+		++i;
+	}
+}
+
+
+/*!
+	Function internally used to free the MD5 instances.
+
+	\param[in,out] md5update The array of N_INSTANCE MD5UPDATE.
+*/
+void free_instances( MD5UPDATE *md5update )
+{
+	unsigned int i = 0;
+
+	while( i != N_INSTANCE )
+	{
+		if( md5update[ i ].pose )
+		{
+			MD5_free_pose( md5update[ i ].pose );
+
+			free( md5update[ i ].pose );
+		}
+
+		MD5_free( md5update[ i ].md5 );
+		++i;
+	}
+}
+
+
+int main( void )
+{
+	char mesh_filepath[ MAX_PATH ],
+		 action_filepath[ MAX_PATH ];
+
+	unsigned int i,
+				 j,
+				 n_step = 60,
+				 n_update = 0,
+				 n_byte,
+				 n_thread;
+
+	unsigned char same = 1,
+				  same_bound = 1;
+
+	double t,
+		   serial_time,
+		   batch_time;
+
+	MD5 *md5;
+
+	MD5UPDATE batch[ N_INSTANCE ],
+			  serial[ N_INSTANCE ];
+
+	TEST_get_path( mesh_filepath  , "batch.md5mesh" );
+	TEST_get_path( action_filepath, "batch.md5anim" );
+
+	TEST_write_md5( mesh_filepath, action_filepath, 64, 4096, 4, 30 );
+
+	md5 = MD5_load_mesh( mesh_filepath, 0 );
+
+	TEST_CHECK( md5 != NULL );
+	TEST_CHECK( MD5_load_action( md5, ( char * )"walk", action_filepath, 0 ) == 0 );
+	TEST_CHECK( MD5_load_action( md5, ( char * )"wave", action_filepath, 0 ) == 1 );
+
+	// Sample the second action with a different timing.
+	md5->md5action[ 1 ].fps *= 0.7f;
+
+	MD5_build2( md5 );
+
+	create_instances( md5, batch  );
+	create_instances( md5, serial );
+
+
+	// The batch on 1 to 4 threads gives the same result as the serial update.
+	i = 0;
+	while( i != n_step )
+	{
+		n_thread = 1 + i % 4;
+
+		// Vary the time step, including steps that skip frames.
+		j = 0;
+		while( j != N_INSTANCE )
+		{
+			batch[ j ].time_step = serial[ j ].time_step = ( i % 7 == 6 ) ? 0.2f : 0.01f * ( 1 + ( i + j ) % 3 );
+			++j;
+		}
+
+		MD5_update_batch( batch, N_INSTANCE, n_thread );
+
+		update_serial( serial );
+
+		n_byte = testgles.n_buffer_byte;
+
+		MD5_upload_batch( batch, N_INSTANCE );
+
+		j = 0;
+		while( j != N_INSTANCE )
+		{
+			MD5MESH *a = &batch [ j ].md5->md5mesh[ 0 ],
+					*b = &serial[ j ].md5->md5mesh[ 0 ];
+
+			if( batch[ j ].update != serial[ j ].update ||
+				memcmp( a->vertex_data, b->vertex_data, a->size ) ) same = 0;
+
+			if( memcmp( &batch[ j ].md5->min, &serial[ j ].md5->min, sizeof( vec3 ) ) ||
+				memcmp( &batch[ j ].md5->max, &serial[ j ].md5->max, sizeof( vec3 ) ) ) same_bound = 0;
+
+			// Only the updated instances are uploaded.
+			if( batch[ j ].update ) n_byte += a->size;
+
+			n_update += batch[ j ].update;
+			++j;
+		}
+
+		TEST_CHECK( testgles.n_buffer_byte == n_byte );
+
+		++i;
+	}
+
+	TEST_CHECK( same );
+	TEST_CHECK( same_bound );
+	TEST_CHECK( n_update != 0 );
+
+	// The instances do not share their vertex data.
+	TEST_CHECK( memcmp( batch[ 0 ].md5->md5mesh[ 0 ].vertex_data, batch[ 1 ].md5->md5mesh[ 0 ].vertex_data, md5->md5mesh[ 0 ].size ) );
+
+
+	// Time per frame.
+	t = TEST_time();
+
+	i = 0;
+	while( i != n_step )
+	{
+		update_serial( serial );
+		++i;
+	}
+
+	serial_time = ( TEST_time() - t ) / n_step;
+
+	printf( "%u instances, serial  %.2f ms\n", N_INSTANCE, serial_time * 1000.0 );
+
+	n_thread = 1;
+	while( n_thread != 8 )
+	{
+		t = TEST_time();
+
+		i = 0;
+		while( i != n_step )
+		{
+			MD5_update_batch( batch, N_INSTANCE, n_thread );
+			++i;
+		}
+
+		batch_time = ( TEST_time() - t ) / n_step;
+
+		printf( "%u instances, batch %u thread(s) %.2f ms\n", N_INSTANCE, n_thread, batch_time * 1000.0 );
+
+		n_thread *= 2;
+	}
+
+	free_instances( serial );
+	free_instances( batch );
+
+	MD5_free( md5 );
+
+	unlink( action_filepath );
+	unlink( mesh_filepath );
+
+	return TEST_end();
+}
@@ -0,0 +1,386 @@
+/*
+
+GFX Lightweight OpenGLES 2.0 Game and Graphics Engine
+
+Copyright (C) 2011 Romain Marucchi-Foino http://gfx.sio2interactive.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of
+this software. Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that
+you wrote the original software. If you use this software in a product, an acknowledgment
+in the product would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be misrepresented
+as being the original software.
+
+3. This notice may not be removed or altered from any source distribution.
+
+*/
+
+#include "test.h"
+
+/*!
+	\file md5_bin.cpp
+
+	\brief Check that the .gfxmd5 and .gfxmd5anim files reload an MD5 and its actions (quantized
+	or not) that skin exactly like the .md5mesh and .md5anim files, that invalid files (out of
+	bounds arrays or indices) are rejected, and print the loading time of both formats.
+*/
+
+
+/*!
+	Function internally used to skin two MD5 to every frame of their first action and compare
+	their vertex data.
+
+	\param[in] md5_a The first MD5.
+	\param[in] md5_b The second MD5.
+
+	\return Return 1 if the vertex data is identical for every frame, else return 0.
+*/
+unsigned char compare_skin( MD5 *md5_a, MD5 *md5_b )
+{
+	unsigned int i = 0;
+
+	unsigned char same = 1;
+
+	MD5POSE pose_a,
+			pose_b;
+
+	MD5_init_pose( md5_a, &pose_a );
+	MD5_init_pose( md5_b, &pose_b );
+
+	while( i != md5_a->md5action[ 0 ].n_frame )
+	{
+		MD5_copy_pose( md5_a, &pose_a, &md5_a->md5action[ 0 ].frame[ i ] );
+		MD5_copy_pose( md5_b, &pose_b, &md5_b->md5action[ 0 ].frame[ i ] );
+
+		MD5_skin_pose( md5_a, &pose_a, 1 );
+		MD5_skin_pose( md5_b, &pose_b, 1 );
+
+		if( memcmp( md5_a->md5mesh[ 0 ].vertex_data, md5_b->md5mesh[ 0 ].vertex_data, md5_a->md5mesh[ 0 ].size ) ) same = 0;
+
+		++i;
+	}
+
+	MD5_free_pose( &pose_b );
+	MD5_free_pose( &pose_a );
+
+	return same;
+}
+
+
+int main( void )
+{
+	char mesh_filepath[ MAX_PATH ],
+		 action_filepath[ MAX_PATH ],
+		 bin_filepath[ MAX_PATH ],
+		 action_bin_filepath[ MAX_PATH ],
+		 bad_filepath[ MAX_PATH ];
+
+	unsigned int i,
+				 n_run = 5,
+				 mesh_size,
+				 action_size;
+
+	double t,
+		   text_time,
+		   bin_time;
+
+	unsigned char *mesh_file,
+				  *action_file,
+				  *buffer;
+
+	MD5BINHEADER *md5binheader;
+
+	MD5BINMESH *md5binmesh;
+
+	MD5JOINT *md5joint;
+
+	MD5VERTEX *md5vertex;
+
+	MD5WEIGHT *md5weight;
+
+	MD5TRIANGLE *md5triangle;
+
+	unsigned short *indice;
+
+	MD5 *md5,
+		*md5_bin;
+
+	TEST_get_path( mesh_filepath	  , "bin.md5mesh"   );
+	TEST_get_path( action_filepath	  , "bin.md5anim"   );
+	TEST_get_path( bin_filepath		  , "bin.gfxmd5"	 );
+	TEST_get_path( action_bin_filepath, "bin.gfxmd5anim" );
+	TEST_get_path( bad_filepath		  , "bad.gfxmd5"	 );
+
+	TEST_write_md5( mesh_filepath, action_filepath, 64, 6400, 4, 240 );
+
+
+	// Compile the text files.
+	md5 = MD5_load_mesh( mesh_filepath, 0 );
+
+	TEST_CHECK( md5 != NULL );
+	TEST_CHECK( MD5_load_action( md5, ( char * )"walk", action_filepath, 0 ) == 0 );
+
+	TEST_CHECK( MD5_save_bin( md5, bin_filepath ) );
+	TEST_CHECK( MD5_save_action_bin( md5, &md5->md5action[ 0 ], action_bin_filepath ) );
+
+	MD5_free( md5 );
+
+
+	// The binary files skin exactly like the text files.
+	md5 = MD5_load_mesh( mesh_filepath, 0 );
+
+	MD5_load_action( md5, ( char * )"walk", action_filepath, 0 );
+
+	md5_bin = MD5_load_bin( bin_filepath, 0 );
+
+	TEST_CHECK( md5_bin != NULL );
+	TEST_CHECK( MD5_load_action_bin( md5_bin, ( char * )"walk", action_bin_filepath, 0 ) == 0 );
+
+	TEST_CHECK( md5_bin->n_joint == md5->n_joint );
+	TEST_CHECK( md5_bin->n_mesh == md5->n_mesh );
+	TEST_CHECK( md5_bin->md5mesh[ 0 ].n_vertex == md5->md5mesh[ 0 ].n_vertex );
+	TEST_CHECK( md5_bin->md5mesh[ 0 ].n_weight == md5->md5mesh[ 0 ].n_weight );
+	TEST_CHECK( md5_bin->md5action[ 0 ].n_frame == md5->md5action[ 0 ].n_frame );
+	TEST_CHECK( md5_bin->md5action[ 0 ].fps == md5->md5action[ 0 ].fps );
+	TEST_CHECK( !memcmp( md5_bin->md5joint, md5->md5joint, md5->n_joint * sizeof( MD5JOINT ) ) );
+	TEST_CHECK( !memcmp( md5_bin->md5action[ 0 ].frame[ 0 ].location, md5->md5action[ 0 ].frame[ 0 ].location, md5->n_joint * md5->md5action[ 0 ].n_frame * sizeof( vec3 ) ) );
+	TEST_CHECK( !memcmp( md5_bin->md5action[ 0 ].frame[ 0 ].rotation, md5->md5action[ 0 ].frame[ 0 ].rotation, md5->n_joint * md5->md5action[ 0 ].n_frame * sizeof( vec4 ) ) );
+
+	MD5_build2( md5 );
+	MD5_build2( md5_bin );
+
+	TEST_CHECK( md5_bin->md5mesh[ 0 ].size == md5->md5mesh[ 0 ].size );
+	TEST_CHECK( compare_skin( md5, md5_bin ) );
+
+	MD5_free( md5_bin );
+
+
+	// A quantized action reloads identically.
+	MD5_quantize_action( md5, &md5->md5action[ 0 ] );
+
+	TEST_CHECK( MD5_save_action_bin( md5, &md5->md5action[ 0 ], action_bin_filepath ) );
+
+	md5_bin = MD5_load_bin( bin_filepath, 0 );
+
+	TEST_CHECK( MD5_load_action_bin( md5_bin, ( char * )"walk", action_bin_filepath, 0 ) == 0 );
+	TEST_CHECK( md5_bin->md5action[ 0 ].frame[ 0 ].qrotation != NULL );
+	TEST_CHECK( !memcmp( md5_bin->md5action[ 0 ].frame[ 0 ].qrotation, md5->md5action[ 0 ].frame[ 0 ].qrotation, md5->n_joint * md5->md5action[ 0 ].n_frame * 4 * sizeof( short ) ) );
+
+	MD5_build2( md5_bin );
+
+	TEST_CHECK( compare_skin( md5, md5_bin ) );
+
+	MD5_free( md5_bin );
+
+	MD5_free( md5 );
+
+
+	// Loading time.
+	t = TEST_time();
+
+	i = 0;
+	while( i != n_run )
+	{
+		md5 = MD5_load_mesh( mesh_filepath, 0 );
+
+		MD5_load_action( md5, ( char * )"walk", action_filepath, 0 );
+
+		MD5_free( md5 );
+		++i;
+	}
+
+	text_time = ( TEST_time() - t ) / n_run;
+
+	t = TEST_time();
+
+	i = 0;
+	while( i != n_run )
+	{
+		md5 = MD5_load_bin( bin_filepath, 0 );
+
+		MD5_load_action_bin( md5, ( char * )"walk", action_bin_filepath, 0 );
+
+		MD5_free( md5 );
+		++i;
+	}
+
+	bin_time = ( TEST_time() - t ) / n_run;
+
+	printf( ".md5mesh + .md5anim     %.2f ms\n", text_time * 1000.0 );
+	printf( ".gfxmd5 + .gfxmd5anim   %.2f ms\n", bin_time  * 1000.0 );
+
+
+	// Invalid .gfxmd5 files are rejected.
+	mesh_file = TEST_read_file( bin_filepath, &mesh_size );
+
+	buffer = ( unsigned char * ) malloc( mesh_size );
+
+	md5binheader = ( MD5BINHEADER * )buffer;
+
+	md5binmesh = ( MD5BINMESH * )&buffer[ ( ( MD5BINHEADER * )mesh_file )->md5mesh ];
+
+	TEST_write_file( bad_filepath, mesh_file, mesh_size - 1 );
+	TEST_CHECK( MD5_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, mesh_file, mesh_size );
+	md5binheader->magic[ 0 ] = 'X';
+	TEST_write_file( bad_filepath, buffer, mesh_size );
+	TEST_CHECK( MD5_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, mesh_file, mesh_size );
+	md5binheader->md5joint = mesh_size - sizeof( MD5JOINT ) + 1;
+	TEST_write_file( bad_filepath, buffer, mesh_size );
+	TEST_CHECK( MD5_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, mesh_file, mesh_size );
+	md5binheader->n_joint = 0xFFFFFFFF;
+	TEST_write_file( bad_filepath, buffer, mesh_size );
+	TEST_CHECK( MD5_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, mesh_file, mesh_size );
+	md5binheader->md5mesh = 0xFFFFFFF0;
+	TEST_write_file( bad_filepath, buffer, mesh_size );
+	TEST_CHECK( MD5_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, mesh_file, mesh_size );
+	md5binmesh->n_weight = 0x40000000;
+	TEST_write_file( bad_filepath, buffer, mesh_size );
+	TEST_CHECK( MD5_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, mesh_file, mesh_size );
+	md5binmesh->indice = mesh_size;
+	TEST_write_file( bad_filepath, buffer, mesh_size );
+	TEST_CHECK( MD5_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, mesh_file, mesh_size );
+	memset( md5binmesh->shader, 'a', sizeof( md5binmesh->shader ) );
+	TEST_write_file( bad_filepath, buffer, mesh_size );
+	TEST_CHECK( MD5_load_bin( bad_filepath, 0 ) == NULL );
+
+
+	// Arrays in bounds holding indices out of range are rejected as well.
+	md5joint = ( MD5JOINT * )&buffer[ ( ( MD5BINHEADER * )mesh_file )->md5joint ];
+
+	md5vertex = ( MD5VERTEX * )&buffer[ md5binmesh->md5vertex ];
+
+	md5weight = ( MD5WEIGHT * )&buffer[ md5binmesh->md5weight ];
+
+	md5triangle = ( MD5TRIANGLE * )&buffer[ md5binmesh->md5triangle ];
+
+	indice = ( unsigned short * )&buffer[ md5binmesh->indice ];
+
+	memcpy( buffer, mesh_file, mesh_size );
+	md5joint[ 1 ].parent = md5binheader->n_joint;
+	TEST_write_file( bad_filepath, buffer, mesh_size );
+	TEST_CHECK( MD5_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, mesh_file, mesh_size );
+	md5joint[ 0 ].parent = 1;
+	TEST_write_file( bad_filepath, buffer, mesh_size );
+	TEST_CHECK( MD5_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, mesh_file, mesh_size );
+	md5joint[ 1 ].parent = -2;
+	TEST_write_file( bad_filepath, buffer, mesh_size );
+	TEST_CHECK( MD5_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, mesh_file, mesh_size );
+	md5vertex[ md5binmesh->n_vertex - 1 ].start = md5binmesh->n_weight;
+	TEST_write_file( bad_filepath, buffer, mesh_size );
+	TEST_CHECK( MD5_load_bin( bad_filepath, 0 ) == NULL );
+
+	// A start plus count wrapping around to a small number.
+	memcpy( buffer, mesh_file, mesh_size );
+	md5vertex[ 0 ].start = 1;
+	md5vertex[ 0 ].count = 0xFFFFFFFF;
+	TEST_write_file( bad_filepath, buffer, mesh_size );
+	TEST_CHECK( MD5_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, mesh_file, mesh_size );
+	md5weight[ 0 ].joint = md5binheader->n_joint;
+	TEST_write_file( bad_filepath, buffer, mesh_size );
+	TEST_CHECK( MD5_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, mesh_file, mesh_size );
+	md5weight[ 0 ].joint = -1;
+	TEST_write_file( bad_filepath, buffer, mesh_size );
+	TEST_CHECK( MD5_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, mesh_file, mesh_size );
+	md5triangle[ 0 ].indice[ 2 ] = md5binmesh->n_vertex;
+	TEST_write_file( bad_filepath, buffer, mesh_size );
+	TEST_CHECK( MD5_load_bin( bad_filepath, 0 ) == NULL );
+
+	TEST_CHECK( md5binmesh->n_indice != 0 );
+
+	memcpy( buffer, mesh_file, mesh_size );
+	indice[ md5binmesh->n_indice - 1 ] = md5binmesh->n_vertex;
+	TEST_write_file( bad_filepath, buffer, mesh_size );
+	TEST_CHECK( MD5_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, mesh_file, mesh_size );
+	md5binmesh->md5vertex += 2;
+	TEST_write_file( bad_filepath, buffer, mesh_size );
+	TEST_CHECK( MD5_load_bin( bad_filepath, 0 ) == NULL );
+
+	free( buffer );
+
+
+	// Invalid .gfxmd5anim files are rejected, without adding an action.
+	md5 = MD5_load_bin( bin_filepath, 0 );
+
+	action_file = TEST_read_file( action_bin_filepath, &action_size );
+
+	buffer = ( unsigned char * ) malloc( action_size );
+
+	md5binheader = ( MD5BINHEADER * )buffer;
+
+	TEST_write_file( bad_filepath, action_file, action_size - 1 );
+	TEST_CHECK( MD5_load_action_bin( md5, ( char * )"bad", bad_filepath, 0 ) == -1 );
+
+	memcpy( buffer, action_file, action_size );
+	++md5binheader->n_joint;
+	TEST_write_file( bad_filepath, buffer, action_size );
+	TEST_CHECK( MD5_load_action_bin( md5, ( char * )"bad", bad_filepath, 0 ) == -1 );
+
+	// 64 joints times 0x4000001 frames wraps around to 64 joint poses.
+	memcpy( buffer, action_file, action_size );
+	md5binheader->n_frame = 0x4000001;
+	TEST_write_file( bad_filepath, buffer, action_size );
+	TEST_CHECK( MD5_load_action_bin( md5, ( char * )"bad", bad_filepath, 0 ) == -1 );
+
+	memcpy( buffer, action_file, action_size );
+	++md5binheader->n_frame;
+	TEST_write_file( bad_filepath, buffer, action_size );
+	TEST_CHECK( MD5_load_action_bin( md5, ( char * )"bad", bad_filepath, 0 ) == -1 );
+
+	memcpy( buffer, action_file, action_size );
+	md5binheader->rotation = action_size - 8;
+	TEST_write_file( bad_filepath, buffer, action_size );
+	TEST_CHECK( MD5_load_action_bin( md5, ( char * )"bad", bad_filepath, 0 ) == -1 );
+
+	TEST_CHECK( md5->n_action == 0 );
+
+	TEST_write_file( bad_filepath, action_file, action_size );
+	TEST_CHECK( MD5_load_action_bin( md5, ( char * )"walk", bad_filepath, 0 ) == 0 );
+
+	MD5_free( md5 );
+
+	free( buffer );
+	free( action_file );
+	free( mesh_file );
+
+	unlink( bad_filepath );
+	unlink( action_bin_filepath );
+	unlink( bin_filepath );
+	unlink( action_filepath );
+	unlink( mesh_filepath );
+
+	return TEST_end();
+}
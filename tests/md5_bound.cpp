@@ -0,0 +1,379 @@
+/*
+
+GFX Lightweight OpenGLES 2.0 Game and Graphics Engine
+
+Copyright (C) 2011 Romain Marucchi-Foino http://gfx.sio2interactive.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of
+this software. Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that
+you wrote the original software. If you use this software in a product, an acknowledgment
+in the product would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be misrepresented
+as being the original software.
+
+3. This notice may not be removed or altered from any source distribution.
+
+*/
+
+#include "test.h"
+
+/*!
+	\file md5_bound.cpp
+
+	\brief Check that the bounds of MD5_update_bound_pose enclose the skinned vertices for the
+	frames of an action, blended, compressed and random poses, with the reduced weights of an
+	MD5LOD, on the GPU palettes and with biases that do not sum to 1, and print how much larger
+	than the box of the vertices they are.
+*/
+
+
+//! The PALETTE uniform reported by the OpenGLES stubs.
+TESTUNIFORM palette_uniform = { "PALETTE[0]", GL_FLOAT_VEC4, 96 };
+
+
+//! The largest volume of the bounds relative to the box of the skinned vertices.
+float max_ratio = 0.0f;
+
+
+/*!
+	Function internally used to check that skinned positions are inside the bounds of an MD5,
+	and to update max_ratio.
+
+	\param[in] md5 The MD5, with its bounds updated to the pose of the positions.
+	\param[in] position The array of skinned positions.
+	\param[in] n_position The number of positions.
+
+	\return Return 1 if all the positions are inside the bounds, else return 0.
+*/
+unsigned char check_bound( MD5 *md5, vec3 *position, unsigned int n_position )
+{
+	unsigned int i = 0;
+
+	unsigned char inside = 1;
+
+	vec3 min = {  99999.999f,  99999.999f,  99999.999f },
+		 max = { -99999.999f, -99999.999f, -99999.999f };
+
+	while( i != n_position )
+	{
+		vec3 *p = &position[ i ];
+
+		float e = 0.0001f * ( 1.0f + vec3_length( p ) );
+
+		if( p->x < md5->min.x - e || p->x > md5->max.x + e ||
+			p->y < md5->min.y - e || p->y > md5->max.y + e ||
+			p->z < md5->min.z - e || p->z > md5->max.z + e ) inside = 0;
+
+		min.x = fminf( min.x, p->x );
+		min.y = fminf( min.y, p->y );
+		min.z = fminf( min.z, p->z );
+
+		max.x = fmaxf( max.x, p->x );
+		max.y = fmaxf( max.y, p->y );
+		max.z = fmaxf( max.z, p->z );
+
+		++i;
+	}
+
+	max_ratio = fmaxf( max_ratio, ( ( md5->max.x - md5->min.x ) * ( md5->max.y - md5->min.y ) * ( md5->max.z - md5->min.z ) ) /
+								  ( ( max.x - min.x ) * ( max.y - min.y ) * ( max.z - min.z ) ) );
+
+	return inside;
+}
+
+
+/*!
+	Function internally used to skin an MD5 skinned on the CPU to a pose, update its bounds and
+	check them.
+
+	\param[in,out] md5 The MD5.
+	\param[in] pose The pose.
+
+	\return Return 1 if all the vertices are inside the bounds, else return 0.
+*/
+unsigned char check_pose( MD5 *md5, MD5POSE *pose )
+{
+	MD5_skin_pose( md5, pose, 1 );
+
+	MD5_update_bound_pose( md5, pose );
+
+	return check_bound( md5, ( vec3 * )md5->md5mesh[ 0 ].vertex_data, md5->md5mesh[ 0 ].n_vertex );
+}
+
+
+/*!
+	Function internally used to skin the positions of an MD5 skinned on the GPU the way its
+	vertex shader does, update its bounds and check them.
+
+	\param[in,out] md5 The MD5, built using MD5_build3.
+	\param[in] pose The pose.
+	\param[in,out] position An array large enough to receive the skinned positions.
+
+	\return Return 1 if all the vertices are inside the bounds, else return 0.
+*/
+unsigned char check_palette_pose( MD5 *md5, MD5POSE *pose, vec3 *position )
+{
+	MD5MESH *md5mesh = &md5->md5mesh[ 0 ];
+
+	unsigned int i = 0,
+				 j,
+				 k,
+				 n = 0;
+
+	MD5_skin_pose( md5, pose, 1 );
+
+	MD5_update_bound_pose( md5, pose );
+
+	while( i != md5mesh->n_md5palette )
+	{
+		MD5PALETTE *md5palette = &md5mesh->md5palette[ i ];
+
+		j = md5palette->first;
+		while( j != md5palette->first + md5palette->n_indice )
+		{
+			unsigned short index = md5mesh->indice[ j ];
+
+			unsigned char *joint = &md5mesh->vertex_data[ md5mesh->offset[ 4 ] + index * 4 ];
+
+			float *weight = ( float * )&md5mesh->vertex_data[ md5mesh->offset[ 5 ] + index * sizeof( vec4 ) ];
+
+			vec3 *v = &( ( vec3 * )md5mesh->vertex_data )[ index ],
+				 *p = &position[ n++ ];
+
+			p->x = p->y = p->z = 0.0f;
+
+			k = 0;
+			while( k != 4 )
+			{
+				vec4 *m = &md5palette->matrix[ joint[ k ] * 3 ];
+
+				p->x += weight[ k ] * ( m[ 0 ].x * v->x + m[ 0 ].y * v->y + m[ 0 ].z * v->z + m[ 0 ].w );
+				p->y += weight[ k ] * ( m[ 1 ].x * v->x + m[ 1 ].y * v->y + m[ 1 ].z * v->z + m[ 1 ].w );
+				p->z += weight[ k ] * ( m[ 2 ].x * v->x + m[ 2 ].y * v->y + m[ 2 ].z * v->z + m[ 2 ].w );
+				++k;
+			}
+
+			++j;
+		}
+
+		++i;
+	}
+
+	return check_bound( md5, position, n );
+}
+
+
+/*!
+	Function internally used to check the bounds of an MD5 for every frame of its first action,
+	in between the frames, blended with another frame, for every frame of its second action once
+	compressed and for random poses.
+
+	\param[in,out] md5 The MD5.
+	\param[in,out] position An array large enough to receive the skinned positions, or NULL if
+	the MD5 is skinned on the CPU.
+
+	\return Return 1 if all the vertices are inside the bounds, else return 0.
+*/
+unsigned char check_poses( MD5 *md5, vec3 *position )
+{
+	MD5ACTION *md5action  = &md5->md5action[ 0 ],
+			  *compressed = &md5->md5action[ 1 ];
+
+	unsigned int i = 0,
+				 j;
+
+	unsigned char inside = 1;
+
+	MD5POSE pose;
+
+	MD5_init_pose( md5, &pose );
+
+	TEST_seed( 11 );
+
+	while( i != md5action->n_frame * 3 + 20 )
+	{
+		unsigned int f = i % md5action->n_frame;
+
+		if( i < md5action->n_frame ) MD5_copy_pose( md5, &pose, &md5action->frame[ f ] );
+
+		else if( i < md5action->n_frame * 2 )
+		{
+			MD5_blend_pose( md5, &pose, &md5action->frame[ f ], &md5action->frame[ ( f + 7 ) % md5action->n_frame ], MD5_METHOD_SLERP, 0.3f );
+		}
+
+		else if( i < md5action->n_frame * 3 )
+		{
+			compressed->curr_frame = f;
+			compressed->next_frame = ( f + 1 ) % compressed->n_frame;
+
+			MD5_sample_action( md5, compressed, &pose, 0.5f );
+		}
+
+		else
+		{
+			j = 0;
+			while( j != md5->n_joint )
+			{
+				pose.location[ j ].x = md5->bind_pose.location[ j ].x + TEST_random( -1.0f, 1.0f );
+				pose.location[ j ].y = md5->bind_pose.location[ j ].y + TEST_random( -1.0f, 1.0f );
+				pose.location[ j ].z = md5->bind_pose.location[ j ].z + TEST_random( -1.0f, 1.0f );
+
+				pose.rotation[ j ].x = TEST_random( -0.9f, 0.9f );
+				pose.rotation[ j ].y = TEST_random( -0.9f, 0.9f );
+				pose.rotation[ j ].z = TEST_random( -0.9f, 0.9f );
+				pose.rotation[ j ].w = TEST_random( -0.9f, 0.9f );
+
+				vec4_normalize( &pose.rotation[ j ], &pose.rotation[ j ] );
+				++j;
+			}
+		}
+
+		if( !( position ? check_palette_pose( md5, &pose, position ) : check_pose( md5, &pose ) ) ) inside = 0;
+
+		++i;
+	}
+
+	MD5_free_pose( &pose );
+
+	return inside;
+}
+
+
+/*!
+	Function internally used to load the test MD5 and its actions, the second one compressed.
+
+	\param[in] mesh_filepath The .md5mesh file.
+	\param[in] action_filepath The .md5anim file.
+	\param[in] scale_bias Determine if the biases of some vertices are scaled so they do not sum to 1.
+
+	\return Return the MD5 structure pointer.
+*/
+MD5 *load_md5( char *mesh_filepath, char *action_filepath, unsigned char scale_bias )
+{
+	MD5 *md5 = MD5_load_mesh( mesh_filepath, 0 );
+
+	TEST_CHECK( md5 != NULL );
+	TEST_CHECK( MD5_load_action( md5, ( char * )"walk", action_filepath, 0 ) == 0 );
+	TEST_CHECK( MD5_load_action( md5, ( char * )"compressed", action_filepath, 0 ) == 1 );
+
+	MD5_compress_action( md5, &md5->md5action[ 1 ], 0.01f, 0.002f );
+
+	if( scale_bias )
+	{
+		MD5MESH *md5mesh = &md5->md5mesh[ 0 ];
+
+		unsigned int i = 0,
+					 j;
+
+		while( i != md5mesh->n_vertex )
+		{
+			float s = ( i % 5 ) ? ( i % 7 ? 1.0f : 1.2f ) : 0.8f;
+
+			j = 0;
+			while( j != md5mesh->md5vertex[ i ].count )
+			{
+				md5mesh->md5weight[ md5mesh->md5vertex[ i ].start + j ].bias *= s;
+				++j;
+			}
+
+			++i;
+		}
+	}
+
+	return md5;
+}
+
+
+int main( void )
+{
+	char mesh_filepath[ MAX_PATH ],
+		 action_filepath[ MAX_PATH ];
+
+	MD5LOD md5lod[ 3 ] = { {  0.0f, 1, 0, 1, 0 },
+						   { 10.0f, 1, 0, 1, 2 },
+						   { 50.0f, 1, 0, 1, 1 } };
+
+	unsigned int i;
+
+	vec3 *position;
+
+	MD5 *md5;
+
+	TEST_get_path( mesh_filepath  , "bound.md5mesh" );
+	TEST_get_path( action_filepath, "bound.md5anim" );
+
+	TEST_write_md5( mesh_filepath, action_filepath, 64, 3000, 4, 30 );
+
+
+	// Skinned on the CPU, with all the weights then the reduced weights of the MD5LOD.
+	i = 0;
+	while( i != 2 )
+	{
+		md5 = load_md5( mesh_filepath, action_filepath, i );
+
+		MD5_build2( md5 );
+
+		if( i ) TEST_CHECK( md5->bias_range.x < 0.81f && md5->bias_range.y > 1.19f );
+
+		else TEST_CHECK( fabsf( md5->bias_range.x - 1.0f ) < 0.0001f && fabsf( md5->bias_range.y - 1.0f ) < 0.0001f );
+
+		TEST_CHECK( check_poses( md5, NULL ) );
+
+		MD5_set_lod( md5, md5lod, 3 );
+
+		md5->lod = 1;
+
+		TEST_CHECK( check_poses( md5, NULL ) );
+
+		md5->lod = 2;
+
+		TEST_CHECK( check_poses( md5, NULL ) );
+
+		MD5_free( md5 );
+		++i;
+	}
+
+
+	// Skinned on the GPU, by a program exposing the PALETTE uniform.
+	testgles.testuniform   = &palette_uniform;
+	testgles.n_testuniform = 1;
+
+	GFX_use_program( 1 );
+
+	i = 0;
+	while( i != 2 )
+	{
+		md5 = load_md5( mesh_filepath, action_filepath, i );
+
+		MD5_build3( md5, 16 );
+
+		TEST_CHECK( md5->md5mesh[ 0 ].n_md5palette > 1 );
+
+		position = ( vec3 * ) malloc( md5->md5mesh[ 0 ].n_indice * sizeof( vec3 ) );
+
+		TEST_CHECK( check_poses( md5, position ) );
+
+		free( position );
+
+		MD5_free( md5 );
+		++i;
+	}
+
+	GFX_use_program( 0 );
+
+	testgles.testuniform   = NULL;
+	testgles.n_testuniform = 0;
+
+	printf( "bounds up to %.1fx the volume of the box of the vertices\n", max_ratio );
+
+	unlink( action_filepath );
+	unlink( mesh_filepath );
+
+	return TEST_end();
+}
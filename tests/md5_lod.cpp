@@ -0,0 +1,393 @@
+/*
+
+GFX Lightweight OpenGLES 2.0 Game and Graphics Engine
+
+Copyright (C) 2011 Romain Marucchi-Foino http://gfx.sio2interactive.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of
+this software. Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that
+you wrote the original software. If you use this software in a product, an acknowledgment
+in the product would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be misrepresented
+as being the original software.
+
+3. This notice may not be removed or altered from any source distribution.
+
+*/
+
+#include "test.h"
+
+/*!
+	\file md5_lod.cpp
+
+	\brief Check the animation levels of detail of MD5_set_lod (the level selection, the update
+	rate, the frame snapping, the tangents and the number of weights), and print the time per
+	frame of a crowd with and without levels of detail.
+*/
+
+
+//! The number of MD5 instances of the crowd.
+#define N_INSTANCE 100
+
+
+/*!
+	Function internally used to skin the position of a vertex using only its max_weight weights
+	with the highest bias, renormalized, without relying on the order of the weights.
+
+	\param[in] md5mesh The MD5MESH.
+	\param[in] pose The object space pose.
+	\param[in] vertex_index The index of the vertex.
+	\param[in] max_weight The number of weights to use.
+	\param[out] position The skinned position.
+*/
+void skin_position( MD5MESH *md5mesh, MD5POSE *pose, unsigned int vertex_index, unsigned int max_weight, vec3 *position )
+{
+	MD5VERTEX *md5vertex = &md5mesh->md5vertex[ vertex_index ];
+
+	unsigned int i,
+				 j = 0;
+
+	unsigned char used[ 4 ] = { 0, 0, 0, 0 };
+
+	float bias = 0.0f;
+
+	position->x = position->y = position->z = 0.0f;
+
+	while( j != max_weight && j != md5vertex->count )
+	{
+		MD5WEIGHT *md5weight;
+
+		vec3 p;
+
+		vec4 q;
+
+		int best = -1;
+
+		i = 0;
+		while( i != md5vertex->count )
+		{
+			if( !used[ i ] && ( best == -1 || md5mesh->md5weight[ md5vertex->start + i ].bias > md5mesh->md5weight[ md5vertex->start + best ].bias ) ) best = i;
+			++i;
+		}
+
+		used[ best ] = 1;
+
+		md5weight = &md5mesh->md5weight[ md5vertex->start + best ];
+
+		MD5_get_pose_rotation( pose, md5weight->joint, &q );
+
+		vec3_rotate_vec4( &p, &md5weight->location, &q );
+
+		vec3_add( &p, &p, &pose->location[ md5weight->joint ] );
+
+		position->x += p.x * md5weight->bias;
+		position->y += p.y * md5weight->bias;
+		position->z += p.z * md5weight->bias;
+
+		bias += md5weight->bias;
+		++j;
+	}
+
+	position->x /= bias;
+	position->y /= bias;
+	position->z /= bias;
+}
+
+
+/*!
+	Function internally used to return the largest distance between the skinned positions of an
+	MD5 and their reference.
+
+	\param[in] md5 The skinned MD5.
+	\param[in] md5mesh The MD5MESH holding the weights in their original order.
+	\param[in] pose The pose the MD5 was skinned to.
+	\param[in] max_weight The number of weights of the reference.
+
+	\return Return the distance.
+*/
+float get_position_error( MD5 *md5, MD5MESH *md5mesh, MD5POSE *pose, unsigned int max_weight )
+{
+	vec3 *vertex_array = ( vec3 * )md5->md5mesh[ 0 ].vertex_data;
+
+	unsigned int i = 0;
+
+	float e = 0.0f;
+
+	while( i != md5mesh->n_vertex )
+	{
+		vec3 p;
+
+		skin_position( md5mesh, pose, i, max_weight, &p );
+
+		e = fmaxf( e, vec3_dist( &p, &vertex_array[ i ] ) / ( 1.0f + vec3_length( &p ) ) );
+		++i;
+	}
+
+	return e;
+}
+
+
+int main( void )
+{
+	char mesh_filepath[ MAX_PATH ],
+		 action_filepath[ MAX_PATH ],
+		 name[ MAX_CHAR ];
+
+	MD5LOD md5lod[ 3 ] = { {  0.0f, 1, 0, 1, 0 },
+						   { 10.0f, 2, 0, 1, 2 },
+						   { 50.0f, 4, 1, 0, 1 } };
+
+	unsigned int i,
+				 j,
+				 n_step = 240,
+				 n_update;
+
+	unsigned char same = 1,
+				  snapped = 1;
+
+	float error = 0.0f,
+		  error2 = 0.0f,
+		  error1 = 0.0f;
+
+	double t;
+
+	MD5 *md5,
+		*md5_lod,
+		*instance[ N_INSTANCE ];
+
+	MD5MESH *md5mesh;
+
+	MD5ACTION *md5action,
+			  *md5action_lod;
+
+	unsigned char *vertex_data,
+				  *tangent;
+
+	TEST_get_path( mesh_filepath  , "lod.md5mesh" );
+	TEST_get_path( action_filepath, "lod.md5anim" );
+
+	TEST_write_md5( mesh_filepath, action_filepath, 64, 6400, 4, 30 );
+
+	md5		= MD5_load_mesh( mesh_filepath, 0 );
+	md5_lod = MD5_load_mesh( mesh_filepath, 0 );
+
+	TEST_CHECK( md5 != NULL && md5_lod != NULL );
+	TEST_CHECK( MD5_load_action( md5	, ( char * )"walk", action_filepath, 0 ) == 0 );
+	TEST_CHECK( MD5_load_action( md5_lod, ( char * )"walk", action_filepath, 0 ) == 0 );
+
+	MD5_build2( md5 );
+	MD5_build2( md5_lod );
+
+	MD5_set_lod( md5_lod, md5lod, 3 );
+
+	md5mesh = &md5->md5mesh[ 0 ];
+
+	md5action	  = &md5->md5action[ 0 ];
+	md5action_lod = &md5_lod->md5action[ 0 ];
+
+
+	// The level 0 skins exactly like the same MD5 without levels of detail, and within the float
+	// rounding of the original order of the weights. The other levels use their highest biases.
+	vertex_data = ( unsigned char * ) malloc( md5mesh->size );
+
+	i = 0;
+	while( i != md5action->n_frame )
+	{
+		MD5POSE *pose = &md5action->frame[ i ];
+
+		md5_lod->md5lod = NULL;
+
+		MD5_skin_pose( md5_lod, pose, 1 );
+
+		memcpy( vertex_data, md5_lod->md5mesh[ 0 ].vertex_data, md5mesh->size );
+
+		md5_lod->md5lod = md5lod;
+		md5_lod->lod	= 0;
+
+		MD5_skin_pose( md5_lod, pose, 1 );
+
+		if( memcmp( vertex_data, md5_lod->md5mesh[ 0 ].vertex_data, md5mesh->size ) ) same = 0;
+
+		error = fmaxf( error, get_position_error( md5_lod, md5mesh, pose, 4 ) );
+
+		md5_lod->lod = 1;
+
+		MD5_skin_pose( md5_lod, pose, 1 );
+
+		error2 = fmaxf( error2, get_position_error( md5_lod, md5mesh, pose, 2 ) );
+
+		md5_lod->lod = 2;
+
+		MD5_skin_pose( md5_lod, pose, 1 );
+
+		error1 = fmaxf( error1, get_position_error( md5_lod, md5mesh, pose, 1 ) );
+
+		++i;
+	}
+
+	free( vertex_data );
+
+	printf( "relative error with 4, 2 and 1 weight(s): %g %g %g\n", error, error2, error1 );
+
+	TEST_CHECK( same );
+	TEST_CHECK( error  < 0.000002f );
+	TEST_CHECK( error2 < 0.000002f );
+	TEST_CHECK( error1 < 0.000002f );
+
+
+	// Without tangents, the tangents of the previous pose are kept.
+	md5_lod->lod = 2;
+
+	tangent = &md5_lod->md5mesh[ 0 ].vertex_data[ md5_lod->md5mesh[ 0 ].offset[ 3 ] ];
+
+	memset( tangent, 0x7F, md5mesh->n_vertex * sizeof( vec3 ) );
+
+	MD5_skin_pose( md5_lod, &md5action->frame[ 1 ], 1 );
+
+	TEST_CHECK( tangent[ 0 ] == 0x7F && !memcmp( tangent, tangent + 1, md5mesh->n_vertex * sizeof( vec3 ) - 1 ) );
+
+	md5_lod->lod = 1;
+
+	MD5_skin_pose( md5_lod, &md5action->frame[ 1 ], 1 );
+
+	TEST_CHECK( memcmp( tangent, tangent + 1, md5mesh->n_vertex * sizeof( vec3 ) - 1 ) );
+
+
+	// The level follows the distance, and the skipped time steps are accumulated.
+	MD5_action_play( md5action	  , MD5_METHOD_SLERP, 1 );
+	MD5_action_play( md5action_lod, MD5_METHOD_SLERP, 1 );
+
+	md5->distance	  = 20.0f;
+	md5_lod->distance = 20.0f;
+
+	i = 0;
+	while( i != 40 )
+	{
+		unsigned char update = MD5_draw_action( md5_lod, 0.01f );
+
+		TEST_CHECK( md5_lod->lod == 1 );
+		TEST_CHECK( update == ( i & 1 ) );
+
+		if( update )
+		{
+			MD5_draw_action( md5, 0.02f );
+
+			TEST_CHECK( md5action_lod->curr_frame == md5action->curr_frame );
+			TEST_CHECK( fabsf( md5action_lod->frame_time - md5action->frame_time ) < 0.00001f );
+		}
+
+		++i;
+	}
+
+
+	// Snapped to the frames, the pose is only updated when reaching the next frame.
+	md5_lod->distance = 60.0f;
+
+	n_update = 0;
+
+	i = 0;
+	while( i != 400 )
+	{
+		if( MD5_draw_action( md5_lod, 0.01f ) )
+		{
+			MD5POSE *frame = &md5action_lod->frame[ md5action_lod->curr_frame ];
+
+			j = 0;
+			while( j != md5_lod->n_joint )
+			{
+				if( vec3_dist( &md5action_lod->pose.location[ j ], &frame->location[ j ] ) > 0.00001f ) snapped = 0;
+				++j;
+			}
+
+			++n_update;
+		}
+
+		TEST_CHECK( md5_lod->lod == 2 );
+
+		++i;
+	}
+
+	TEST_CHECK( snapped );
+
+	// At most one update every 4 calls, and one per frame of the action reached in the 4 seconds.
+	printf( "snapped to the frames: %u updates for 400 calls\n", n_update );
+
+	TEST_CHECK( n_update > 0 && n_update <= 100 );
+	TEST_CHECK( n_update <= ( unsigned int )( 4.0f / md5action_lod->fps ) + 1 );
+
+
+	// A crowd at increasing distances, with and without levels of detail.
+	MD5_set_lod( md5_lod, NULL, 0 );
+
+	i = 0;
+	while( i != N_INSTANCE )
+	{
+		sprintf( name, "instance%u", i );
+
+		instance[ i ] = MD5_create_instance( md5_lod, name );
+
+		instance[ i ]->distance = ( float )( i + 1 );
+
+		MD5_action_play( &instance[ i ]->md5action[ 0 ], MD5_METHOD_SLERP, 1 );
+		++i;
+	}
+
+	j = 0;
+	while( j != 2 )
+	{
+		t = TEST_time();
+
+		n_update = 0;
+
+		i = 0;
+		while( i != n_step * N_INSTANCE )
+		{
+			MD5 *m = instance[ i % N_INSTANCE ];
+
+			if( MD5_draw_action( m, 1.0f / 60.0f ) )
+			{
+				MD5_skin_pose( m, &m->md5action[ 0 ].pose, 1 );
+				++n_update;
+			}
+
+			++i;
+		}
+
+		t = ( TEST_time() - t ) / n_step;
+
+		printf( "%s %.2f ms per frame, %u skinning(s)\n", j ? "with LOD   " : "full detail", t * 1000.0, n_update );
+
+		if( !j )
+		{
+			i = 0;
+			while( i != N_INSTANCE )
+			{
+				MD5_set_lod( instance[ i ], md5lod, 3 );
+				++i;
+			}
+		}
+
+		++j;
+	}
+
+	i = 0;
+	while( i != N_INSTANCE )
+	{
+		MD5_free( instance[ i ] );
+		++i;
+	}
+
+	MD5_free( md5_lod );
+	MD5_free( md5 );
+
+	unlink( action_filepath );
+	unlink( mesh_filepath );
+
+	return TEST_end();
+}
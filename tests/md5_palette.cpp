@@ -0,0 +1,384 @@
+/*
+
+GFX Lightweight OpenGLES 2.0 Game and Graphics Engine
+
+Copyright (C) 2011 Romain Marucchi-Foino http://gfx.sio2interactive.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of
+this software. Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that
+you wrote the original software. If you use this software in a product, an acknowledgment
+in the product would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be misrepresented
+as being the original software.
+
+3. This notice may not be removed or altered from any source distribution.
+
+*/
+
+#include "test.h"
+
+/*!
+	\file md5_palette.cpp
+
+	\brief Check the GPU palette skinning of MD5_build3 by running the math of the vertex
+	shader on the CPU and comparing it with the CPU skinning of MD5_build2, and check how the
+	palettes are split, drawn and sized, and that a program without the PALETTE uniform falls
+	back to the CPU skinning.
+*/
+
+
+//! The PALETTE uniform reported by the OpenGLES stubs.
+TESTUNIFORM palette_uniform = { "PALETTE[0]", GL_FLOAT_VEC4, 96 };
+
+
+/*!
+	Function internally used to run the skinning of the vertex shader of MD5_build3 on a
+	vector, using w = 1 for a position and w = 0 for a direction.
+
+	\param[out] r The skinned vector.
+	\param[in] v The bind pose vector.
+	\param[in] w The w component of the vector.
+	\param[in] row The matrix rows of the palette.
+	\param[in] joint The 4 palette local joint indices of the vertex.
+	\param[in] weight The 4 weights of the vertex.
+*/
+void skin_palette( vec3 *r, vec3 *v, float w, vec4 *row, unsigned char *joint, vec4 *weight )
+{
+	float *wi = &weight->x;
+
+	unsigned int i = 0;
+
+	r->x = r->y = r->z = 0.0f;
+
+	while( i != 4 )
+	{
+		vec4 *m = &row[ joint[ i ] * 3 ];
+
+		r->x += wi[ i ] * ( m[ 0 ].x * v->x + m[ 0 ].y * v->y + m[ 0 ].z * v->z + m[ 0 ].w * w );
+		r->y += wi[ i ] * ( m[ 1 ].x * v->x + m[ 1 ].y * v->y + m[ 1 ].z * v->z + m[ 1 ].w * w );
+		r->z += wi[ i ] * ( m[ 2 ].x * v->x + m[ 2 ].y * v->y + m[ 2 ].z * v->z + m[ 2 ].w * w );
+
+		++i;
+	}
+}
+
+
+/*!
+	Function internally used to sort triangles made of 3 vertex indices.
+*/
+int compare_triangle( const void *a, const void *b )
+{
+	const int *ta = ( const int * )a,
+			  *tb = ( const int * )b;
+
+	if( ta[ 0 ] != tb[ 0 ] ) return ta[ 0 ] < tb[ 0 ] ? -1 : 1;
+	if( ta[ 1 ] != tb[ 1 ] ) return ta[ 1 ] < tb[ 1 ] ? -1 : 1;
+	if( ta[ 2 ] != tb[ 2 ] ) return ta[ 2 ] < tb[ 2 ] ? -1 : 1;
+
+	return 0;
+}
+
+
+/*!
+	Function internally used to load the test MD5 and its action.
+
+	\param[in] mesh_filepath The .md5mesh file.
+	\param[in] action_filepath The .md5anim file.
+
+	\return Return the MD5 structure pointer.
+*/
+MD5 *load_md5( char *mesh_filepath, char *action_filepath )
+{
+	MD5 *md5 = MD5_load_mesh( mesh_filepath, 0 );
+
+	TEST_CHECK( md5 != NULL );
+	TEST_CHECK( MD5_load_action( md5, ( char * )"walk", action_filepath, 0 ) == 0 );
+
+	return md5;
+}
+
+
+int main( void )
+{
+	char mesh_filepath[ MAX_PATH ],
+		 action_filepath[ MAX_PATH ];
+
+	unsigned int i,
+				 j,
+				 k,
+				 n_vertex,
+				 n_palette_vertex,
+				 n_draw,
+				 n_uniform_location,
+				 n_indice = 0,
+				 max_joint = 0;
+
+	unsigned char valid = 1;
+
+	float error = 0.0f;
+
+	int *source,
+		*triangle,
+		*palette_triangle;
+
+	MD5 *md5,
+		*md5_gpu;
+
+	MD5MESH *md5mesh,
+			*md5mesh_gpu;
+
+	MD5ACTION *md5action;
+
+	MD5POSE pose;
+
+	TEST_get_path( mesh_filepath  , "palette.md5mesh" );
+	TEST_get_path( action_filepath, "palette.md5anim" );
+
+	TEST_write_md5( mesh_filepath, action_filepath, 64, 3000, 4, 10 );
+
+	md5		= load_md5( mesh_filepath, action_filepath );
+	md5_gpu = load_md5( mesh_filepath, action_filepath );
+
+	MD5_build2( md5 );
+
+	// Without a PROGRAM, the palettes are uploaded to the program in use.
+	testgles.testuniform   = &palette_uniform;
+	testgles.n_testuniform = 1;
+
+	GFX_use_program( 1 );
+
+	MD5_build3( md5_gpu, 16 );
+
+	md5mesh		= &md5->md5mesh[ 0 ];
+	md5mesh_gpu = &md5_gpu->md5mesh[ 0 ];
+
+	md5action = &md5->md5action[ 0 ];
+
+	n_vertex = md5mesh->n_vertex;
+
+	n_palette_vertex = md5mesh_gpu->offset[ 1 ] / sizeof( vec3 );
+
+	printf( "%u palette(s), %u vertices, %u after duplication\n", md5mesh_gpu->n_md5palette, n_vertex, n_palette_vertex );
+
+	TEST_CHECK( md5mesh_gpu->n_md5palette > 1 );
+	TEST_CHECK( n_palette_vertex >= n_vertex );
+	TEST_CHECK( md5mesh_gpu->n_indice == md5mesh->n_triangle * 3 );
+
+
+	// The original vertices keep their index, find the source of the duplicated ones.
+	source = ( int * ) malloc( n_palette_vertex * sizeof( int ) );
+
+	i = 0;
+	while( i != n_palette_vertex )
+	{
+		vec3 *p = &( ( vec3 * )md5mesh_gpu->vertex_data )[ i ];
+
+		vec2 *uv = &( ( vec2 * )&md5mesh_gpu->vertex_data[ md5mesh_gpu->offset[ 2 ] ] )[ i ];
+
+		source[ i ] = i < n_vertex ? ( int )i : -1;
+
+		j = 0;
+		while( source[ i ] == -1 && j != n_vertex )
+		{
+			if( !memcmp( p , &( ( vec3 * )md5mesh_gpu->vertex_data )[ j ], sizeof( vec3 ) ) &&
+				!memcmp( uv, &( ( vec2 * )&md5mesh_gpu->vertex_data[ md5mesh_gpu->offset[ 2 ] ] )[ j ], sizeof( vec2 ) ) ) source[ i ] = j;
+
+			++j;
+		}
+
+		TEST_CHECK( source[ i ] != -1 );
+
+		++i;
+	}
+
+
+	// Every triangle is drawn once, by a palette holding all the joints of its vertices.
+	triangle		 = ( int * ) malloc( md5mesh->n_triangle * 3 * sizeof( int ) );
+	palette_triangle = ( int * ) malloc( md5mesh->n_triangle * 3 * sizeof( int ) );
+
+	i = 0;
+	while( i != md5mesh->n_triangle * 3 )
+	{
+		triangle		[ i ] = md5mesh->md5triangle[ i / 3 ].indice[ i % 3 ];
+		palette_triangle[ i ] = source[ md5mesh_gpu->indice[ i ] ];
+		++i;
+	}
+
+	qsort( triangle		   , md5mesh->n_triangle, 3 * sizeof( int ), compare_triangle );
+	qsort( palette_triangle, md5mesh->n_triangle, 3 * sizeof( int ), compare_triangle );
+
+	TEST_CHECK( !memcmp( triangle, palette_triangle, md5mesh->n_triangle * 3 * sizeof( int ) ) );
+
+	i = 0;
+	while( i != md5mesh_gpu->n_md5palette )
+	{
+		MD5PALETTE *md5palette = &md5mesh_gpu->md5palette[ i ];
+
+		TEST_CHECK( md5palette->n_joint <= 16 );
+		TEST_CHECK( md5palette->first == n_indice );
+
+		j = md5palette->first;
+		while( j != md5palette->first + md5palette->n_indice )
+		{
+			unsigned short index = md5mesh_gpu->indice[ j ];
+
+			unsigned char *joint = &md5mesh_gpu->vertex_data[ md5mesh_gpu->offset[ 4 ] + index * 4 ];
+
+			float *weight = ( float * )&md5mesh_gpu->vertex_data[ md5mesh_gpu->offset[ 5 ] + index * sizeof( vec4 ) ];
+
+			k = 0;
+			while( k != 4 )
+			{
+				if( weight[ k ] && joint[ k ] >= md5palette->n_joint ) valid = 0;
+				++k;
+			}
+
+			++j;
+		}
+
+		n_indice += md5palette->n_indice;
+		++i;
+	}
+
+	TEST_CHECK( n_indice == md5mesh_gpu->n_indice );
+	TEST_CHECK( valid );
+
+
+	// Run the vertex shader for every frame and compare with the CPU skinning.
+	MD5_init_pose( md5, &pose );
+
+	i = 0;
+	while( i != md5action->n_frame )
+	{
+		MD5_copy_pose( md5, &pose, &md5action->frame[ i ] );
+
+		MD5_skin_pose( md5	  , &pose, 1 );
+		MD5_skin_pose( md5_gpu, &pose, 1 );
+
+		j = 0;
+		while( j != md5mesh_gpu->n_md5palette )
+		{
+			MD5PALETTE *md5palette = &md5mesh_gpu->md5palette[ j ];
+
+			k = md5palette->first;
+			while( k != md5palette->first + md5palette->n_indice )
+			{
+				unsigned short index = md5mesh_gpu->indice[ k ];
+
+				unsigned char *joint = &md5mesh_gpu->vertex_data[ md5mesh_gpu->offset[ 4 ] + index * 4 ];
+
+				vec4 *weight = ( vec4 * )&md5mesh_gpu->vertex_data[ md5mesh_gpu->offset[ 5 ] + index * sizeof( vec4 ) ];
+
+				vec3 p, n, t,
+					 *cpu_p = &( ( vec3 * )md5mesh->vertex_data )[ source[ index ] ],
+					 *cpu_n = &( ( vec3 * )&md5mesh->vertex_data[ md5mesh->offset[ 1 ] ] )[ source[ index ] ],
+					 *cpu_t = &( ( vec3 * )&md5mesh->vertex_data[ md5mesh->offset[ 3 ] ] )[ source[ index ] ];
+
+				skin_palette( &p, &( ( vec3 * )md5mesh_gpu->vertex_data )[ index ], 1.0f, md5palette->matrix, joint, weight );
+
+				skin_palette( &n, &( ( vec3 * )&md5mesh_gpu->vertex_data[ md5mesh_gpu->offset[ 1 ] ] )[ index ], 0.0f, md5palette->matrix, joint, weight );
+
+				skin_palette( &t, &( ( vec3 * )&md5mesh_gpu->vertex_data[ md5mesh_gpu->offset[ 3 ] ] )[ index ], 0.0f, md5palette->matrix, joint, weight );
+
+				error = fmaxf( error, vec3_dist( &p, cpu_p ) / ( 1.0f + vec3_length( cpu_p ) ) );
+				error = fmaxf( error, vec3_dist( &n, cpu_n ) / ( 1.0f + vec3_length( cpu_n ) ) );
+				error = fmaxf( error, vec3_dist( &t, cpu_t ) / ( 1.0f + vec3_length( cpu_t ) ) );
+
+				++k;
+			}
+
+			++j;
+		}
+
+		++i;
+	}
+
+	printf( "palette skinning: relative error %g\n", error );
+
+	TEST_CHECK( error < 0.00001f );
+
+
+	// Without a PROGRAM tracking the uniform, each palette is uploaded to the program in use,
+	// whose uniform location is only queried once.
+	n_draw = testgles.n_draw;
+
+	n_uniform_location = testgles.n_uniform_location;
+
+	TEST_CHECK( MD5_draw_mesh( md5mesh_gpu ) == md5mesh_gpu->n_indice );
+	TEST_CHECK( MD5_draw_mesh( md5mesh_gpu ) == md5mesh_gpu->n_indice );
+	TEST_CHECK( testgles.n_draw - n_draw == md5mesh_gpu->n_md5palette * 2 );
+	TEST_CHECK( testgles.uniform4fv_location == 0 );
+	TEST_CHECK( testgles.uniform4fv_count == ( int )md5mesh_gpu->md5palette[ md5mesh_gpu->n_md5palette - 1 ].n_joint * 3 );
+	TEST_CHECK( testgles.n_uniform_location == n_uniform_location );
+
+	MD5_free_pose( &pose );
+
+	free( palette_triangle );
+	free( triangle );
+	free( source );
+
+	MD5_free( md5_gpu );
+
+
+	// The palette size is limited by the uniform vectors of the driver.
+	md5_gpu = load_md5( mesh_filepath, action_filepath );
+
+	MD5_build3( md5_gpu, 255 );
+
+	i = 0;
+	while( i != md5_gpu->md5mesh[ 0 ].n_md5palette )
+	{
+		if( md5_gpu->md5mesh[ 0 ].md5palette[ i ].n_joint > max_joint ) max_joint = md5_gpu->md5mesh[ 0 ].md5palette[ i ].n_joint;
+		++i;
+	}
+
+	TEST_CHECK( md5_gpu->md5mesh[ 0 ].n_md5palette > 1 );
+	TEST_CHECK( max_joint <= ( 128 - 32 ) / 3 );
+
+	MD5_free( md5_gpu );
+
+	testgles.max_vertex_uniform_vectors = 1024;
+
+	md5_gpu = load_md5( mesh_filepath, action_filepath );
+
+	MD5_build3( md5_gpu, 255 );
+
+	TEST_CHECK( md5_gpu->md5mesh[ 0 ].n_md5palette == 1 );
+	TEST_CHECK( md5_gpu->md5mesh[ 0 ].md5palette[ 0 ].n_joint == 64 );
+
+	MD5_free( md5_gpu );
+
+	testgles.max_vertex_uniform_vectors = 128;
+
+
+	// A program without the PALETTE uniform cannot skin on the GPU, the MD5 falls back to the
+	// CPU skinning.
+	testgles.testuniform   = NULL;
+	testgles.n_testuniform = 0;
+
+	GFX_use_program( 2 );
+
+	md5_gpu = load_md5( mesh_filepath, action_filepath );
+
+	MD5_build3( md5_gpu, 16 );
+
+	TEST_CHECK( md5_gpu->md5mesh[ 0 ].n_md5palette == 0 );
+	TEST_CHECK( md5_gpu->md5mesh[ 0 ].vbo != 0 );
+
+	MD5_free( md5_gpu );
+
+	GFX_use_program( 0 );
+
+	MD5_free( md5 );
+
+	unlink( action_filepath );
+	unlink( mesh_filepath );
+
+	return TEST_end();
+}
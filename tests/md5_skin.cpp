@@ -0,0 +1,268 @@
+/*
+
+GFX Lightweight OpenGLES 2.0 Game and Graphics Engine
+
+Copyright (C) 2011 Romain Marucchi-Foino http://gfx.sio2interactive.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of
+this software. Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that
+you wrote the original software. If you use this software in a product, an acknowledgment
+in the product would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be misrepresented
+as being the original software.
+
+3. This notice may not be removed or altered from any source distribution.
+
+*/
+
+#include "test.h"
+
+/*!
+	\file md5_skin.cpp
+
+	\brief Check the CPU skinning of MD5_skin_pose against the quaternion skinning it
+	replaced, on 1 to 4 threads, and print the number of vertices skinned per second.
+*/
+
+
+/*!
+	Function internally used to return the largest difference between the vertex data of
+	the first MD5MESH of an MD5 and the reference skinning, relative to the magnitude of the
+	reference.
+
+	\param[in] md5 The MD5.
+	\param[in] pose The pose the MD5 was skinned to.
+
+	\return Return the relative error.
+*/
+float get_skin_error( MD5 *md5, MD5POSE *pose )
+{
+	MD5MESH *md5mesh = &md5->md5mesh[ 0 ];
+
+	vec3 *vertex_array  = ( vec3 * )md5mesh->vertex_data,
+		 *normal_array  = ( vec3 * )&md5mesh->vertex_data[ md5mesh->offset[ 1 ] ],
+		 *tangent_array = ( vec3 * )&md5mesh->vertex_data[ md5mesh->offset[ 3 ] ];
+
+	unsigned int i = 0;
+
+	float e = 0.0f;
+
+	while( i != md5mesh->n_vertex )
+	{
+		vec3 p, n, t;
+
+		TEST_skin_vertex( md5mesh, pose, i, &p, &n, &t );
+
+		e = fmaxf( e, vec3_dist( &p, &vertex_array [ i ] ) / ( 1.0f + vec3_length( &p ) ) );
+		e = fmaxf( e, vec3_dist( &n, &normal_array [ i ] ) / ( 1.0f + vec3_length( &n ) ) );
+		e = fmaxf( e, vec3_dist( &t, &tangent_array[ i ] ) / ( 1.0f + vec3_length( &t ) ) );
+
+		++i;
+	}
+
+	return e;
+}
+
+
+int main( void )
+{
+	char mesh_filepath[ MAX_PATH ],
+		 action_filepath[ MAX_PATH ];
+
+	unsigned int i,
+				 j,
+				 n_thread,
+				 n_run = 20;
+
+	unsigned char same = 1,
+				  valid = 1;
+
+	float error = 0.0f;
+
+	double t,
+		   ref_time;
+
+	MD5 *md5;
+
+	MD5MESH *md5mesh;
+
+	MD5ACTION *md5action;
+
+	MD5POSE pose;
+
+	unsigned char *vertex_data;
+
+	TEST_get_path( mesh_filepath  , "skin.md5mesh" );
+	TEST_get_path( action_filepath, "skin.md5anim" );
+
+	TEST_write_md5( mesh_filepath, action_filepath, 64, 40000, 4, 20 );
+
+	md5 = MD5_load_mesh( mesh_filepath, 0 );
+
+	TEST_CHECK( md5 != NULL );
+	TEST_CHECK( md5->n_joint == 64 );
+	TEST_CHECK( md5->n_mesh == 1 );
+	TEST_CHECK( MD5_load_action( md5, ( char * )"walk", action_filepath, 0 ) == 0 );
+
+	MD5_build2( md5 );
+
+	md5mesh = &md5->md5mesh[ 0 ];
+
+	md5action = &md5->md5action[ 0 ];
+
+	TEST_CHECK( md5mesh->n_vertex == 40000 );
+	TEST_CHECK( md5action->n_frame == 20 );
+
+
+	// In the bind pose, all the weights of a vertex must land on the same point.
+	i = 0;
+	while( i != md5mesh->n_vertex )
+	{
+		MD5VERTEX *md5vertex = &md5mesh->md5vertex[ i ];
+
+		vec3 p0;
+
+		j = 0;
+		while( j != md5vertex->count )
+		{
+			MD5WEIGHT *md5weight = &md5mesh->md5weight[ md5vertex->start + j ];
+
+			vec3 p;
+
+			vec3_rotate_vec4( &p, &md5weight->location, &md5->bind_pose.rotation[ md5weight->joint ] );
+
+			vec3_add( &p, &p, &md5->bind_pose.location[ md5weight->joint ] );
+
+			if( !j ) p0 = p;
+
+			else if( vec3_dist( &p, &p0 ) > 0.0001f ) valid = 0;
+
+			++j;
+		}
+
+		++i;
+	}
+
+	TEST_CHECK( valid );
+
+
+	// The frames of the action, then random poses.
+	MD5_init_pose( md5, &pose );
+
+	vertex_data = ( unsigned char * ) malloc( md5mesh->size );
+
+	i = 0;
+	while( i != md5action->n_frame + 20 )
+	{
+		if( i < md5action->n_frame ) MD5_copy_pose( md5, &pose, &md5action->frame[ i ] );
+
+		else
+		{
+			j = 0;
+			while( j != md5->n_joint )
+			{
+				pose.location[ j ].x = md5->bind_pose.location[ j ].x + TEST_random( -1.0f, 1.0f );
+				pose.location[ j ].y = md5->bind_pose.location[ j ].y + TEST_random( -1.0f, 1.0f );
+				pose.location[ j ].z = md5->bind_pose.location[ j ].z + TEST_random( -1.0f, 1.0f );
+
+				pose.rotation[ j ].x = TEST_random( -0.5f, 0.5f );
+				pose.rotation[ j ].y = TEST_random( -0.5f, 0.5f );
+				pose.rotation[ j ].z = TEST_random( -0.5f, 0.5f );
+
+				vec4_build_w( &pose.rotation[ j ] );
+				++j;
+			}
+		}
+
+		MD5_skin_pose( md5, &pose, 1 );
+
+		memcpy( vertex_data, md5mesh->vertex_data, md5mesh->size );
+
+		error = fmaxf( error, get_skin_error( md5, &pose ) );
+
+		// The result must not depend on the number of threads.
+		n_thread = 2;
+		while( n_thread != 5 )
+		{
+			memset( md5mesh->vertex_data, 0x7F, md5mesh->size );
+
+			MD5_skin_pose( md5, &pose, n_thread );
+
+			if( memcmp( vertex_data, md5mesh->vertex_data, md5mesh->size ) ) same = 0;
+
+			++n_thread;
+		}
+
+		++i;
+	}
+
+	printf( "MD5_skin_pose: relative error %g\n", error );
+
+	TEST_CHECK( error < 0.000002f );
+	TEST_CHECK( same );
+
+
+	// Throughput.
+	t = TEST_time();
+
+	i = 0;
+	while( i != n_run )
+	{
+		float sink = 0.0f;
+
+		j = 0;
+		while( j != md5mesh->n_vertex )
+		{
+			vec3 p, n, tangent;
+
+			TEST_skin_vertex( md5mesh, &pose, j, &p, &n, &tangent );
+
+			sink += p.x;
+			++j;
+		}
+
+		if( sink == 12345.0f ) printf( "\n" );
+
+		++i;
+	}
+
+	ref_time = TEST_time() - t;
+
+	printf( "quaternion skinning     %.1f M vertices/s\n", md5mesh->n_vertex * n_run / ref_time / 1000000.0 );
+
+	n_thread = 1;
+	while( n_thread != 8 )
+	{
+		t = TEST_time();
+
+		i = 0;
+		while( i != n_run )
+		{
+			MD5_skin_pose( md5, &pose, n_thread );
+			++i;
+		}
+
+		t = TEST_time() - t;
+
+		printf( "MD5_skin_pose %u thread(s) %.1f M vertices/s\n", n_thread, md5mesh->n_vertex * n_run / t / 1000000.0 );
+
+		n_thread *= 2;
+	}
+
+	free( vertex_data );
+
+	MD5_free_pose( &pose );
+
+	MD5_free( md5 );
+
+	unlink( action_filepath );
+	unlink( mesh_filepath );
+
+	return TEST_end();
+}
@@ -0,0 +1,210 @@
+/*
+
+GFX Lightweight OpenGLES 2.0 Game and Graphics Engine
+
+Copyright (C) 2011 Romain Marucchi-Foino http://gfx.sio2interactive.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of
+this software. Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that
+you wrote the original software. If you use this software in a product, an acknowledgment
+in the product would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be misrepresented
+as being the original software.
+
+3. This notice may not be removed or altered from any source distribution.
+
+*/
+
+#include "test.h"
+
+/*!
+	\file md5_track.cpp
+
+	\brief Check that the frames sampled from the tracks of MD5_compress_action stay within the
+	requested tolerances of the original frames, and print the size of the compressed actions.
+*/
+
+
+/*!
+	Function internally used to measure the angle between two rotations, using the chord between
+	the unit quaternions in double precision.
+
+	\param[in] q0 The first rotation.
+	\param[in] q1 The second rotation.
+
+	\return Return the angle in radians.
+*/
+double get_rotation_error( vec4 *q0, vec4 *q1 )
+{
+	double l0 = sqrt( ( double )q0->x * q0->x + ( double )q0->y * q0->y + ( double )q0->z * q0->z + ( double )q0->w * q0->w ),
+		   l1 = sqrt( ( double )q1->x * q1->x + ( double )q1->y * q1->y + ( double )q1->z * q1->z + ( double )q1->w * q1->w ),
+		   s  = vec4_dot_vec4( q0, q1 ) < 0.0f ? -1.0 : 1.0,
+		   x  = q0->x / l0 - s * q1->x / l1,
+		   y  = q0->y / l0 - s * q1->y / l1,
+		   z  = q0->z / l0 - s * q1->z / l1,
+		   w  = q0->w / l0 - s * q1->w / l1;
+
+	return 4.0 * asin( fmin( sqrt( x * x + y * y + z * z + w * w ) * 0.5, 1.0 ) );
+}
+
+
+/*!
+	Function internally used to return the memory used by the tracks of a compressed action.
+
+	\param[in] md5 The MD5.
+	\param[in] md5action The compressed MD5ACTION.
+
+	\return Return the size in bytes.
+*/
+unsigned int get_track_size( MD5 *md5, MD5ACTION *md5action )
+{
+	unsigned int i = 0,
+				 size = md5->n_joint * sizeof( MD5TRACK );
+
+	while( i != md5->n_joint )
+	{
+		MD5TRACK *md5track = &md5action->md5track[ i ];
+
+		if( md5track->n_location > 1 ) size += md5track->n_location * ( sizeof( unsigned short ) + 3 * sizeof( short ) );
+
+		size += md5track->n_rotation * ( sizeof( unsigned short ) + 4 * sizeof( short ) );
+
+		++i;
+	}
+
+	return size;
+}
+
+
+int main( void )
+{
+	char mesh_filepath[ MAX_PATH ],
+		 action_filepath[ MAX_PATH ];
+
+	float tolerance[ 3 ][ 2 ] = { { 0.01f	, 0.002f  },
+								  { 0.001f	, 0.0005f },
+								  { 0.0005f , 0.0002f } };
+
+	unsigned int i,
+				 j,
+				 k,
+				 raw_size;
+
+	MD5 *md5;
+
+	MD5ACTION *raw,
+			  *md5action;
+
+	MD5POSE pose,
+			raw_pose;
+
+	TEST_get_path( mesh_filepath  , "track.md5mesh" );
+	TEST_get_path( action_filepath, "track.md5anim" );
+
+	TEST_write_md5( mesh_filepath, action_filepath, 64, 500, 2, 240 );
+
+	md5 = MD5_load_mesh( mesh_filepath, 0 );
+
+	TEST_CHECK( md5 != NULL );
+	TEST_CHECK( MD5_load_action( md5, ( char * )"raw", action_filepath, 0 ) == 0 );
+
+	MD5_init_pose( md5, &pose );
+	MD5_init_pose( md5, &raw_pose );
+
+	i = 0;
+	while( i != 3 )
+	{
+		double location_error = 0.0,
+			   rotation_error = 0.0,
+			   blend_location_error = 0.0,
+			   blend_rotation_error = 0.0;
+
+		TEST_CHECK( MD5_load_action( md5, ( char * )"compressed", action_filepath, 0 ) == ( int )i + 1 );
+
+		raw		  = &md5->md5action[ 0 ];
+		md5action = &md5->md5action[ i + 1 ];
+
+		raw_size = raw->n_frame * md5->n_joint * ( sizeof( vec3 ) + sizeof( vec4 ) );
+
+		MD5_compress_action( md5, md5action, tolerance[ i ][ 0 ], tolerance[ i ][ 1 ] );
+
+		TEST_CHECK( md5action->md5track != NULL );
+		TEST_CHECK( md5action->frame == NULL );
+		TEST_CHECK( md5action->n_frame == raw->n_frame );
+
+		raw->method = md5action->method = MD5_METHOD_SLERP;
+
+		// Every frame, then in between the frames, including the loop back to the first frame.
+		j = 0;
+		while( j != raw->n_frame )
+		{
+			raw->curr_frame = md5action->curr_frame = j;
+			raw->next_frame = md5action->next_frame = ( j + 1 ) % raw->n_frame;
+
+			MD5_sample_action( md5, md5action, &pose, 0.0f );
+
+			k = 0;
+			while( k != md5->n_joint )
+			{
+				vec4 q;
+
+				MD5_get_pose_rotation( &raw->frame[ j ], k, &q );
+
+				location_error = fmax( location_error, vec3_dist( &pose.location[ k ], &raw->frame[ j ].location[ k ] ) );
+				rotation_error = fmax( rotation_error, get_rotation_error( &pose.rotation[ k ], &q ) );
+				++k;
+			}
+
+			MD5_sample_action( md5, raw		 , &raw_pose, 0.5f );
+			MD5_sample_action( md5, md5action, &pose	, 0.5f );
+
+			k = 0;
+			while( k != md5->n_joint )
+			{
+				blend_location_error = fmax( blend_location_error, vec3_dist( &pose.location[ k ], &raw_pose.location[ k ] ) );
+				blend_rotation_error = fmax( blend_rotation_error, get_rotation_error( &pose.rotation[ k ], &raw_pose.rotation[ k ] ) );
+				++k;
+			}
+
+			++j;
+		}
+
+		printf( "tolerance %g %g: %u bytes, %u compressed (%.1fx), frame error %g %g, blend error %g %g\n",
+				tolerance[ i ][ 0 ],
+				tolerance[ i ][ 1 ],
+				raw_size,
+				get_track_size( md5, md5action ),
+				( float )raw_size / get_track_size( md5, md5action ),
+				location_error,
+				rotation_error,
+				blend_location_error,
+				blend_rotation_error );
+
+		TEST_CHECK( location_error <= tolerance[ i ][ 0 ] * 1.01f );
+		TEST_CHECK( rotation_error <= tolerance[ i ][ 1 ] * 1.01f );
+		TEST_CHECK( get_track_size( md5, md5action ) < raw_size );
+
+		// In between the frames the joints are interpolated relative to their parent, which can
+		// slightly differ from blending the original frames.
+		TEST_CHECK( blend_location_error <= tolerance[ i ][ 0 ] * 2.0f );
+		TEST_CHECK( blend_rotation_error <= tolerance[ i ][ 1 ] * 2.0f );
+
+		++i;
+	}
+
+	MD5_free_pose( &raw_pose );
+	MD5_free_pose( &pose );
+
+	MD5_free( md5 );
+
+	unlink( action_filepath );
+	unlink( mesh_filepath );
+
+	return TEST_end();
+}
@@ -0,0 +1,250 @@
+/*
+
+GFX Lightweight OpenGLES 2.0 Game and Graphics Engine
+
+Copyright (C) 2011 Romain Marucchi-Foino http://gfx.sio2interactive.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of
+this software. Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that
+you wrote the original software. If you use this software in a product, an acknowledgment
+in the product would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be misrepresented
+as being the original software.
+
+3. This notice may not be removed or altered from any source distribution.
+
+*/
+
+#include "test.h"
+
+/*!
+	\file obj_bin.cpp
+
+	\brief Check that a .gfxmesh file reloads the same vertex and index arrays as the .obj
+	file it was saved from, that invalid files are rejected, and print their loading time.
+*/
+
+
+int main( void )
+{
+	char obj_filepath[ MAX_PATH ],
+		 bin_filepath[ MAX_PATH ],
+		 bad_filepath[ MAX_PATH ];
+
+	unsigned int i,
+				 j,
+				 n_run = 3,
+				 file_size;
+
+	double obj_time = 0.0,
+		   bin_time = 0.0;
+
+	OBJ *obj,
+		*bin;
+
+	unsigned char *file,
+				  *buffer;
+
+	OBJBINHEADER *objbinheader;
+
+	OBJBINMESH *objbinmesh;
+
+	OBJBINTRIANGLELIST *objbintrianglelist;
+
+	TEST_get_path( obj_filepath, "grid.obj" );
+	TEST_get_path( bin_filepath, "grid.gfxmesh" );
+	TEST_get_path( bad_filepath, "bad.gfxmesh" );
+
+	TEST_write_grid_obj( obj_filepath, 96, 4 );
+
+	obj = OBJ_load( obj_filepath, 0 );
+
+	TEST_CHECK( OBJ_save_bin( obj, bin_filepath ) );
+
+	bin = OBJ_load_bin( bin_filepath, 0 );
+
+	TEST_CHECK( bin != NULL );
+	TEST_CHECK( bin->n_objmesh == obj->n_objmesh );
+
+	i = 0;
+	while( i != obj->n_objmesh )
+	{
+		OBJMESH *objmesh = &obj->objmesh[ i ],
+				*binmesh = &bin->objmesh[ i ];
+
+		unsigned char *vertex_array = OBJ_build_vertex_array_mesh( obj, i );
+
+		TEST_CHECK( !strcmp( binmesh->name, objmesh->name ) );
+		TEST_CHECK( binmesh->stride == objmesh->stride );
+		TEST_CHECK( binmesh->size == objmesh->size );
+		TEST_CHECK( !memcmp( binmesh->offset, objmesh->offset, sizeof( objmesh->offset ) ) );
+		TEST_CHECK( !memcmp( &binmesh->min, &objmesh->min, sizeof( vec3 ) ) );
+		TEST_CHECK( !memcmp( &binmesh->max, &objmesh->max, sizeof( vec3 ) ) );
+		TEST_CHECK( !memcmp( &binmesh->location, &objmesh->location, sizeof( vec3 ) ) );
+		TEST_CHECK( binmesh->radius == objmesh->radius );
+		TEST_CHECK( !memcmp( binmesh->vertex_array, vertex_array, objmesh->size ) );
+		TEST_CHECK( binmesh->n_objtrianglelist == objmesh->n_objtrianglelist );
+
+		j = 0;
+		while( j != objmesh->n_objtrianglelist )
+		{
+			OBJTRIANGLELIST *objtrianglelist = &objmesh->objtrianglelist[ j ],
+							*bintrianglelist = &binmesh->objtrianglelist[ j ];
+
+			TEST_CHECK( bintrianglelist->mode == objtrianglelist->mode );
+			TEST_CHECK( bintrianglelist->indice_type == objtrianglelist->indice_type );
+			TEST_CHECK( bintrianglelist->n_indice_array == objtrianglelist->n_indice_array );
+			TEST_CHECK( !memcmp( bintrianglelist->indice_array,
+								 objtrianglelist->indice_array,
+								 objtrianglelist->n_indice_array * sizeof( unsigned short ) ) );
+			++j;
+		}
+
+		// The mapped vertex array must be uploaded as is.
+		testgles.n_buffer_byte = 0;
+
+		OBJ_build_mesh( bin, i );
+
+		TEST_CHECK( testgles.n_buffer_byte == binmesh->size + binmesh->objtrianglelist[ 0 ].n_indice_array * sizeof( unsigned short ) );
+
+		free( vertex_array );
+
+		++i;
+	}
+
+	OBJ_free( bin );
+	OBJ_free( obj );
+
+
+	// Invalid files must be rejected.
+	file = TEST_read_file( bin_filepath, &file_size );
+
+	buffer = ( unsigned char * ) malloc( file_size );
+
+	objbinheader = ( OBJBINHEADER * )buffer;
+
+	objbinmesh = ( OBJBINMESH * )&buffer[ sizeof( OBJBINHEADER ) ];
+
+	objbintrianglelist = ( OBJBINTRIANGLELIST * )&buffer[ ( ( OBJBINMESH * )&file[ sizeof( OBJBINHEADER ) ] )->objtrianglelist ];
+
+	TEST_write_file( bad_filepath, file, file_size / 2 );
+	TEST_CHECK( OBJ_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, file, file_size );
+	objbinheader->n_objmesh = 0x40000000;
+	TEST_write_file( bad_filepath, buffer, file_size );
+	TEST_CHECK( OBJ_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, file, file_size );
+	objbinheader->n_objmaterial = 0xFFFFFFFF;
+	TEST_write_file( bad_filepath, buffer, file_size );
+	TEST_CHECK( OBJ_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, file, file_size );
+	memset( objbinmesh->name, 'a', sizeof( objbinmesh->name ) );
+	TEST_write_file( bad_filepath, buffer, file_size );
+	TEST_CHECK( OBJ_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, file, file_size );
+	objbinmesh->vertex_array = file_size - objbinmesh->size + 1;
+	TEST_write_file( bad_filepath, buffer, file_size );
+	TEST_CHECK( OBJ_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, file, file_size );
+	objbinmesh->objtrianglelist = 0xFFFFFFF0;
+	TEST_write_file( bad_filepath, buffer, file_size );
+	TEST_CHECK( OBJ_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, file, file_size );
+	objbintrianglelist->material_index = 0;
+	TEST_write_file( bad_filepath, buffer, file_size );
+	TEST_CHECK( OBJ_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, file, file_size );
+	objbintrianglelist->indice_type = GL_UNSIGNED_BYTE;
+	TEST_write_file( bad_filepath, buffer, file_size );
+	TEST_CHECK( OBJ_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, file, file_size );
+	objbintrianglelist->n_indice_array = 0x80000000;
+	TEST_write_file( bad_filepath, buffer, file_size );
+	TEST_CHECK( OBJ_load_bin( bad_filepath, 0 ) == NULL );
+
+	memcpy( buffer, file, file_size );
+	( ( unsigned short * )&buffer[ objbintrianglelist->indice_array ] )[ 5 ] = objbinmesh->size / objbinmesh->stride;
+	TEST_write_file( bad_filepath, buffer, file_size );
+	TEST_CHECK( OBJ_load_bin( bad_filepath, 0 ) == NULL );
+
+	// The unmodified file still loads.
+	TEST_write_file( bad_filepath, file, file_size );
+
+	bin = OBJ_load_bin( bad_filepath, 0 );
+
+	TEST_CHECK( bin != NULL );
+
+	OBJ_free( bin );
+
+	free( buffer );
+	free( file );
+
+	unlink( bad_filepath );
+
+
+	// Loading time.
+	obj = OBJ_load( obj_filepath, 0 );
+
+	OBJ_save_bin( obj, bin_filepath );
+
+	OBJ_free( obj );
+
+	i = 0;
+	while( i != n_run )
+	{
+		double t = TEST_time();
+
+		obj = OBJ_load( obj_filepath, 0 );
+
+		j = 0;
+		while( j != obj->n_objmesh )
+		{
+			OBJ_build_mesh( obj, j );
+			++j;
+		}
+
+		obj_time += TEST_time() - t;
+
+		OBJ_free( obj );
+
+		t = TEST_time();
+
+		bin = OBJ_load_bin( bin_filepath, 0 );
+
+		j = 0;
+		while( j != bin->n_objmesh )
+		{
+			OBJ_build_mesh( bin, j );
+			++j;
+		}
+
+		bin_time += TEST_time() - t;
+
+		OBJ_free( bin );
+
+		++i;
+	}
+
+	printf( "load and build: .obj %.2f ms, .gfxmesh %.2f ms\n",
+			obj_time * 1000.0 / n_run,
+			bin_time * 1000.0 / n_run );
+
+	unlink( obj_filepath );
+	unlink( bin_filepath );
+
+	return TEST_end();
+}
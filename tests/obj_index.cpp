@@ -0,0 +1,148 @@
+/*
+
+GFX Lightweight OpenGLES 2.0 Game and Graphics Engine
+
+Copyright (C) 2011 Romain Marucchi-Foino http://gfx.sio2interactive.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of
+this software. Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that
+you wrote the original software. If you use this software in a product, an acknowledgment
+in the product would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be misrepresented
+as being the original software.
+
+3. This notice may not be removed or altered from any source distribution.
+
+*/
+
+#include "test.h"
+
+/*!
+	\file obj_index.cpp
+
+	\brief Check that the triangle lists of more than 65536 vertices are promoted to 32 bits
+	indices, that they survive a .gfxmesh round trip, and that they are only built and drawn
+	when the GLES driver supports GL_OES_element_index_uint.
+*/
+
+
+/*!
+	Function internally used to check that the indices of a triangle list point to the vertex
+	data of their face vertex.
+
+	\param[in] objmesh The OBJMESH.
+
+	\return Return 1 if all the indices are valid, else return 0.
+*/
+unsigned char check_indices( OBJMESH *objmesh )
+{
+	OBJTRIANGLELIST *objtrianglelist = &objmesh->objtrianglelist[ 0 ];
+
+	unsigned int i = 0;
+
+	while( i != objtrianglelist->n_indice_array )
+	{
+		unsigned int indice = objtrianglelist->indice_type == GL_UNSIGNED_INT ?
+							  objtrianglelist->indice_array32[ i ] :
+							  objtrianglelist->indice_array[ i ];
+
+		if( indice >= objmesh->n_objvertexdata ||
+			objmesh->objvertexdata[ indice ].vertex_index != objtrianglelist->objtriangleindex[ i / 3 ].vertex_index[ i % 3 ] ) return 0;
+
+		++i;
+	}
+
+	return 1;
+}
+
+
+int main( void )
+{
+	char obj_filepath[ MAX_PATH ],
+		 bin_filepath[ MAX_PATH ];
+
+	unsigned int n_quad = 256,
+				 n_draw;
+
+	OBJ *obj,
+		*bin;
+
+	OBJMESH *objmesh;
+
+	TEST_get_path( obj_filepath, "index.obj" );
+	TEST_get_path( bin_filepath, "index.gfxmesh" );
+
+
+	// A grid of 257 by 257 vertices needs 32 bits indices, a grid of 255 by 255 does not.
+	TEST_write_grid_obj( obj_filepath, n_quad - 2, 1 );
+
+	obj = OBJ_load( obj_filepath, 0 );
+
+	TEST_CHECK( obj->objmesh[ 0 ].objtrianglelist[ 0 ].indice_type == GL_UNSIGNED_SHORT );
+	TEST_CHECK( check_indices( &obj->objmesh[ 0 ] ) );
+
+	OBJ_free( obj );
+
+	TEST_write_grid_obj( obj_filepath, n_quad, 1 );
+
+	obj = OBJ_load( obj_filepath, 0 );
+
+	objmesh = &obj->objmesh[ 0 ];
+
+	TEST_CHECK( objmesh->n_objvertexdata == ( n_quad + 1 ) * ( n_quad + 1 ) );
+	TEST_CHECK( objmesh->objtrianglelist[ 0 ].indice_type == GL_UNSIGNED_INT );
+	TEST_CHECK( objmesh->objtrianglelist[ 0 ].n_indice_array == 6 * n_quad * n_quad );
+	TEST_CHECK( check_indices( objmesh ) );
+
+
+	// The 32 bits indices are saved and validated as such.
+	TEST_CHECK( OBJ_save_bin( obj, bin_filepath ) );
+
+	bin = OBJ_load_bin( bin_filepath, 0 );
+
+	TEST_CHECK( bin != NULL );
+	TEST_CHECK( bin->objmesh[ 0 ].objtrianglelist[ 0 ].indice_type == GL_UNSIGNED_INT );
+	TEST_CHECK( !memcmp( bin->objmesh[ 0 ].objtrianglelist[ 0 ].indice_array32,
+						 objmesh->objtrianglelist[ 0 ].indice_array32,
+						 objmesh->objtrianglelist[ 0 ].n_indice_array * sizeof( unsigned int ) ) );
+
+
+	// Without GL_OES_element_index_uint nothing is built or drawn.
+	gfx.index_uint = 0;
+
+	testgles.n_buffer_byte = 0;
+
+	TEST_CHECK( !OBJ_build_mesh( obj, 0 ) );
+	TEST_CHECK( !OBJ_build_mesh2( bin, 0 ) );
+	TEST_CHECK( objmesh->vbo == 0 && objmesh->vao == 0 );
+	TEST_CHECK( testgles.n_buffer_byte == 0 );
+
+	n_draw = testgles.n_draw;
+
+	TEST_CHECK( OBJ_draw_mesh( obj, 0 ) == 0 );
+	TEST_CHECK( OBJ_draw_triangle_list( bin, 0, 0 ) == 0 );
+	TEST_CHECK( testgles.n_draw == n_draw );
+
+
+	// With it the indices are uploaded as is.
+	gfx.index_uint = 1;
+
+	TEST_CHECK( OBJ_build_mesh( obj, 0 ) );
+	TEST_CHECK( testgles.n_buffer_byte == objmesh->size + objmesh->objtrianglelist[ 0 ].n_indice_array * sizeof( unsigned int ) );
+	TEST_CHECK( OBJ_draw_mesh( obj, 0 ) == objmesh->objtrianglelist[ 0 ].n_indice_array );
+	TEST_CHECK( testgles.n_draw == n_draw + 1 );
+
+	OBJ_free( bin );
+	OBJ_free( obj );
+
+	unlink( bin_filepath );
+	unlink( obj_filepath );
+
+	return TEST_end();
+}
@@ -0,0 +1,168 @@
+/*
+
+GFX Lightweight OpenGLES 2.0 Game and Graphics Engine
+
+Copyright (C) 2011 Romain Marucchi-Foino http://gfx.sio2interactive.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of
+this software. Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that
+you wrote the original software. If you use this software in a product, an acknowledgment
+in the product would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be misrepresented
+as being the original software.
+
+3. This notice may not be removed or altered from any source distribution.
+
+*/
+
+#include "test.h"
+
+/*!
+	\file obj_load.cpp
+
+	\brief Check the vertex deduplication of OBJ_load, and print how its loading time grows
+	with the number of faces.
+*/
+
+
+/*!
+	Function internally used to return the best loading time of an .obj file over a few runs.
+
+	\param[in] filepath The .obj file.
+
+	\return Return the time in seconds.
+*/
+double get_load_time( char *filepath )
+{
+	unsigned int i = 0;
+
+	double best = 0.0;
+
+	while( i != 3 )
+	{
+		double t = TEST_time();
+
+		OBJ *obj = OBJ_load( filepath, 0 );
+
+		t = TEST_time() - t;
+
+		OBJ_free( obj );
+
+		if( !i || t < best ) best = t;
+
+		++i;
+	}
+
+	return best;
+}
+
+
+int main( void )
+{
+	char filepath[ MAX_PATH ];
+
+	unsigned int i,
+				 j,
+				 n_quad = 32,
+				 n = ( n_quad + 1 ) * ( n_quad + 1 );
+
+	double t0, t1;
+
+	OBJ *obj;
+
+	TEST_get_path( filepath, "grid.obj" );
+
+
+	// Every grid vertex is referenced by up to 6 triangles, but must only be stored once.
+	TEST_write_grid_obj( filepath, n_quad, 3 );
+
+	obj = OBJ_load( filepath, 0 );
+
+	TEST_CHECK( obj != NULL );
+	TEST_CHECK( obj->n_objmesh == 3 );
+	TEST_CHECK( obj->n_indexed_vertex == 3 * n );
+	TEST_CHECK( obj->n_indexed_uv == 3 * n );
+
+	i = 0;
+	while( i != obj->n_objmesh )
+	{
+		OBJMESH *objmesh = &obj->objmesh[ i ];
+
+		OBJTRIANGLELIST *objtrianglelist = &objmesh->objtrianglelist[ 0 ];
+
+		unsigned char *used = ( unsigned char * ) calloc( obj->n_indexed_vertex, 1 ),
+					  unique = 1,
+					  valid  = 1;
+
+		TEST_CHECK( objmesh->n_objtrianglelist == 1 );
+		TEST_CHECK( objmesh->n_objvertexdata == n );
+		TEST_CHECK( objtrianglelist->n_objtriangleindex == 2 * n_quad * n_quad );
+		TEST_CHECK( objtrianglelist->n_indice_array == 6 * n_quad * n_quad );
+
+		j = 0;
+		while( j != objmesh->n_objvertexdata )
+		{
+			OBJVERTEXDATA *objvertexdata = &objmesh->objvertexdata[ j ];
+
+			if( objvertexdata->vertex_index != objvertexdata->uv_index ||
+				objvertexdata->vertex_index < ( int )( i * n ) ||
+				objvertexdata->vertex_index >= ( int )( ( i + 1 ) * n ) ) valid = 0;
+
+			else if( used[ objvertexdata->vertex_index ] ) unique = 0;
+
+			else used[ objvertexdata->vertex_index ] = 1;
+
+			++j;
+		}
+
+		TEST_CHECK( valid );
+		TEST_CHECK( unique );
+
+		// The indices must point to the vertex data of the same face vertex.
+		j = 0;
+		while( j != objtrianglelist->n_indice_array )
+		{
+			OBJTRIANGLEINDEX *objtriangleindex = &objtrianglelist->objtriangleindex[ j / 3 ];
+
+			unsigned short indice = objtrianglelist->indice_array[ j ];
+
+			if( indice >= objmesh->n_objvertexdata ||
+				objmesh->objvertexdata[ indice ].vertex_index != objtriangleindex->vertex_index[ j % 3 ] ) valid = 0;
+
+			++j;
+		}
+
+		TEST_CHECK( valid );
+
+		free( used );
+
+		++i;
+	}
+
+	OBJ_free( obj );
+
+
+	// Four times more faces should take about four times longer, not sixteen.
+	TEST_write_grid_obj( filepath, 128, 1 );
+
+	t0 = get_load_time( filepath );
+
+	TEST_write_grid_obj( filepath, 256, 1 );
+
+	t1 = get_load_time( filepath );
+
+	printf( "OBJ_load: %u triangles %.2f ms, %u triangles %.2f ms (%.1fx)\n",
+			2 * 128 * 128, t0 * 1000.0,
+			2 * 256 * 256, t1 * 1000.0,
+			t1 / t0 );
+
+	unlink( filepath );
+
+	return TEST_end();
+}
@@ -0,0 +1,153 @@
+/*
+
+GFX Lightweight OpenGLES 2.0 Game and Graphics Engine
+
+Copyright (C) 2011 Romain Marucchi-Foino http://gfx.sio2interactive.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of
+this software. Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that
+you wrote the original software. If you use this software in a product, an acknowledgment
+in the product would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be misrepresented
+as being the original software.
+
+3. This notice may not be removed or altered from any source distribution.
+
+*/
+
+#include "test.h"
+
+/*!
+	\file obj_normals.cpp
+
+	\brief Check that the normals and tangents built by OBJ_load2 on several threads match
+	the ones built serially, and that vec3_normalize_array matches vec3_normalize.
+*/
+
+
+/*!
+	Function internally used to return the largest component difference between two arrays
+	of vec3.
+
+	\param[in] v0 The first array.
+	\param[in] v1 The second array.
+	\param[in] n The number of vec3.
+
+	\return Return the largest difference.
+*/
+float get_max_error( vec3 *v0, vec3 *v1, unsigned int n )
+{
+	unsigned int i = 0;
+
+	float e = 0.0f;
+
+	while( i != n )
+	{
+		e = fmaxf( e, fabsf( v0[ i ].x - v1[ i ].x ) );
+		e = fmaxf( e, fabsf( v0[ i ].y - v1[ i ].y ) );
+		e = fmaxf( e, fabsf( v0[ i ].z - v1[ i ].z ) );
+		++i;
+	}
+
+	return e;
+}
+
+
+int main( void )
+{
+	char filepath[ MAX_PATH ];
+
+	unsigned int i,
+				 n_thread = 1,
+				 n_vector = 1027;
+
+	unsigned char same;
+
+	OBJ *serial;
+
+	vec3 *v		  = ( vec3 * ) malloc( n_vector * sizeof( vec3 ) ),
+		 *batch	  = ( vec3 * ) malloc( n_vector * sizeof( vec3 ) ),
+		 *single  = ( vec3 * ) malloc( n_vector * sizeof( vec3 ) );
+
+	TEST_get_path( filepath, "grid.obj" );
+
+	// Enough triangles for the normals and tangents to be split between 4 workers.
+	TEST_write_grid_obj( filepath, 160, 2 );
+
+	serial = OBJ_load( filepath, 0 );
+
+	same = 1;
+
+	i = 0;
+	while( i != serial->n_indexed_vertex )
+	{
+		if( fabsf( vec3_length( &serial->indexed_normal[ i ] ) - 1.0f ) > 0.00001f ||
+			fabsf( vec3_length( &serial->indexed_tangent[ i ] ) - 1.0f ) > 0.00001f ) same = 0;
+
+		++i;
+	}
+
+	TEST_CHECK( same );
+
+	while( n_thread != 16 )
+	{
+		double t = TEST_time();
+
+		OBJ *obj = OBJ_load2( filepath, 0, n_thread );
+
+		t = TEST_time() - t;
+
+		printf( "OBJ_load2: %u thread(s) %.2f ms, max error %g\n", n_thread, t * 1000.0,
+				get_max_error( obj->indexed_normal, serial->indexed_normal, serial->n_indexed_vertex ) );
+
+		TEST_CHECK( obj->n_indexed_vertex == serial->n_indexed_vertex );
+		TEST_CHECK( !memcmp( obj->indexed_fnormal, serial->indexed_fnormal, serial->n_indexed_vertex * sizeof( vec3 ) ) );
+
+		// The vertices shared by two triangle ranges sum their contributions in another order.
+		TEST_CHECK( get_max_error( obj->indexed_normal , serial->indexed_normal , serial->n_indexed_vertex ) < 0.000001f );
+		TEST_CHECK( get_max_error( obj->indexed_tangent, serial->indexed_tangent, serial->n_indexed_vertex ) < 0.000001f );
+
+		OBJ_free( obj );
+
+		n_thread *= 2;
+	}
+
+	OBJ_free( serial );
+
+
+	// The batch normalize handles a remainder and null vectors like vec3_normalize.
+	i = 0;
+	while( i != n_vector )
+	{
+		v[ i ].x = ( i % 97 ) ? TEST_random( -100.0f, 100.0f ) : 0.0f;
+		v[ i ].y = ( i % 97 ) ? TEST_random( -100.0f, 100.0f ) : 0.0f;
+		v[ i ].z = ( i % 97 ) ? TEST_random( -0.01f, 0.01f ) : 0.0f;
+
+		vec3_normalize( &single[ i ], &v[ i ] );
+
+		++i;
+	}
+
+	vec3_normalize_array( batch, v, n_vector );
+
+	TEST_CHECK( !memcmp( batch, single, n_vector * sizeof( vec3 ) ) );
+
+	// In place.
+	vec3_normalize_array( v, v, n_vector );
+
+	TEST_CHECK( !memcmp( v, single, n_vector * sizeof( vec3 ) ) );
+
+	free( single );
+	free( batch );
+	free( v );
+
+	unlink( filepath );
+
+	return TEST_end();
+}
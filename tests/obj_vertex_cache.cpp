@@ -0,0 +1,307 @@
+/*
+
+GFX Lightweight OpenGLES 2.0 Game and Graphics Engine
+
+Copyright (C) 2011 Romain Marucchi-Foino http://gfx.sio2interactive.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of
+this software. Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that
+you wrote the original software. If you use this software in a product, an acknowledgment
+in the product would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be misrepresented
+as being the original software.
+
+3. This notice may not be removed or altered from any source distribution.
+
+*/
+
+#include "test.h"
+
+/*!
+	\file obj_vertex_cache.cpp
+
+	\brief Check that OBJ_optimize_mesh2 and OBJ_optimize_vertex_cache lower the ACMR while
+	keeping every triangle, and print their speed next to the triangle strips of
+	OBJ_optimize_mesh.
+*/
+
+
+/*!
+	Function internally used to sort triangles stored as 3 int.
+
+	\param[in] a The first triangle.
+	\param[in] b The second triangle.
+
+	\return Return the qsort order of the triangles.
+*/
+int compare_triangle( const void *a, const void *b )
+{ return memcmp( a, b, 3 * sizeof( int ) ); }
+
+
+/*!
+	Function internally used to rotate the vertices of a triangle so the smallest comes first,
+	which keeps its winding.
+
+	\param[in,out] t The triangle.
+*/
+void rotate_triangle( int *t )
+{
+	while( t[ 0 ] > t[ 1 ] || t[ 0 ] > t[ 2 ] )
+	{
+		int tmp = t[ 0 ];
+
+		t[ 0 ] = t[ 1 ];
+		t[ 1 ] = t[ 2 ];
+		t[ 2 ] = tmp;
+	}
+}
+
+
+/*!
+	Function internally used to return the sorted triangles of an OBJMESH, with their
+	vertices expressed as indexed vertex indices so they do not depend on the vertex order.
+
+	\param[in] objmesh The OBJMESH, with a single GL_TRIANGLES triangle list.
+
+	\return Return the triangle array, the caller is responsible to free it.
+*/
+int *get_triangles( OBJMESH *objmesh )
+{
+	OBJTRIANGLELIST *objtrianglelist = &objmesh->objtrianglelist[ 0 ];
+
+	unsigned int i = 0;
+
+	int *t = ( int * ) malloc( objtrianglelist->n_indice_array * sizeof( int ) );
+
+	while( i != objtrianglelist->n_indice_array )
+	{
+		unsigned int indice = objtrianglelist->indice_type == GL_UNSIGNED_INT ?
+							  objtrianglelist->indice_array32[ i ] :
+							  objtrianglelist->indice_array  [ i ];
+
+		t[ i ] = objmesh->objvertexdata[ indice ].vertex_index;
+
+		if( i % 3 == 2 ) rotate_triangle( &t[ i - 2 ] );
+
+		++i;
+	}
+
+	qsort( t, objtrianglelist->n_indice_array / 3, 3 * sizeof( int ), compare_triangle );
+
+	return t;
+}
+
+
+/*!
+	Function internally used to return the ACMR of the triangle list of an OBJMESH.
+
+	\param[in] objmesh The OBJMESH.
+
+	\return Return the average cache miss ratio.
+*/
+float get_acmr( OBJMESH *objmesh )
+{
+	OBJTRIANGLELIST *objtrianglelist = &objmesh->objtrianglelist[ 0 ];
+
+	unsigned int i = 0,
+				 *indice = ( unsigned int * ) malloc( objtrianglelist->n_indice_array * sizeof( unsigned int ) );
+
+	float acmr,
+		  atvr;
+
+	while( i != objtrianglelist->n_indice_array )
+	{
+		indice[ i ] = objtrianglelist->indice_type == GL_UNSIGNED_INT ?
+					  objtrianglelist->indice_array32[ i ] :
+					  objtrianglelist->indice_array  [ i ];
+		++i;
+	}
+
+	OBJ_get_vertex_cache_ratio( indice, objtrianglelist->n_indice_array, objmesh->n_objvertexdata, OBJ_VERTEX_CACHE_SIZE, &acmr, &atvr );
+
+	free( indice );
+
+	return acmr;
+}
+
+
+int main( void )
+{
+	char filepath[ MAX_PATH ];
+
+	unsigned int i,
+				 n_quad = 64,
+				 n_indice = 6 * n_quad * n_quad,
+				 n_vertex = ( n_quad + 1 ) * ( n_quad + 1 ),
+				 *indice = ( unsigned int * ) malloc( n_indice * sizeof( unsigned int ) ),
+				 *shuffle = ( unsigned int * ) malloc( n_indice * sizeof( unsigned int ) );
+
+	int *t0,
+		*t1,
+		first_use = -1;
+
+	unsigned char ordered = 1;
+
+	float acmr[ 2 ],
+		  atvr[ 2 ];
+
+	double t,
+		   strip_time;
+
+	OBJ *obj;
+
+	OBJMESH *objmesh;
+
+
+	// A grid with its triangles in random order.
+	i = 0;
+	while( i != n_quad * n_quad )
+	{
+		unsigned int v = ( i / n_quad ) * ( n_quad + 1 ) + i % n_quad;
+
+		indice[ i * 6     ] = v;
+		indice[ i * 6 + 1 ] = v + n_quad + 1;
+		indice[ i * 6 + 2 ] = v + 1;
+		indice[ i * 6 + 3 ] = v + 1;
+		indice[ i * 6 + 4 ] = v + n_quad + 1;
+		indice[ i * 6 + 5 ] = v + n_quad + 2;
+		++i;
+	}
+
+	i = n_indice / 3;
+	while( i > 1 )
+	{
+		unsigned int j = ( unsigned int )TEST_random( 0.0f, ( float )i - 0.001f ),
+					 tmp[ 3 ];
+
+		--i;
+
+		memcpy( tmp, &indice[ i * 3 ], sizeof( tmp ) );
+		memcpy( &indice[ i * 3 ], &indice[ j * 3 ], sizeof( tmp ) );
+		memcpy( &indice[ j * 3 ], tmp, sizeof( tmp ) );
+	}
+
+	memcpy( shuffle, indice, n_indice * sizeof( unsigned int ) );
+
+	OBJ_get_vertex_cache_ratio( indice, n_indice, n_vertex, OBJ_VERTEX_CACHE_SIZE, &acmr[ 0 ], &atvr[ 0 ] );
+
+	OBJ_optimize_vertex_cache( indice, n_indice, n_vertex, OBJ_VERTEX_CACHE_SIZE );
+
+	OBJ_get_vertex_cache_ratio( indice, n_indice, n_vertex, OBJ_VERTEX_CACHE_SIZE, &acmr[ 1 ], &atvr[ 1 ] );
+
+	printf( "shuffled grid: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", acmr[ 0 ], acmr[ 1 ], atvr[ 0 ], atvr[ 1 ] );
+
+	TEST_CHECK( acmr[ 0 ] > 2.0f );
+	TEST_CHECK( acmr[ 1 ] < 0.8f );
+
+	i = 0;
+	while( i != n_indice )
+	{
+		if( i % 3 == 2 )
+		{
+			rotate_triangle( ( int * )&indice [ i - 2 ] );
+			rotate_triangle( ( int * )&shuffle[ i - 2 ] );
+		}
+
+		++i;
+	}
+
+	qsort( indice , n_indice / 3, 3 * sizeof( int ), compare_triangle );
+	qsort( shuffle, n_indice / 3, 3 * sizeof( int ), compare_triangle );
+
+	TEST_CHECK( !memcmp( indice, shuffle, n_indice * sizeof( unsigned int ) ) );
+
+	free( shuffle );
+	free( indice );
+
+
+	// The OBJMESH keeps its triangles, and its vertex data follows the order of first use.
+	TEST_get_path( filepath, "grid.obj" );
+
+	TEST_write_grid_obj( filepath, 128, 1 );
+
+	obj = OBJ_load( filepath, 0 );
+
+	objmesh = &obj->objmesh[ 0 ];
+
+	t0 = get_triangles( objmesh );
+
+	acmr[ 0 ] = get_acmr( objmesh );
+
+	t = TEST_time();
+
+	OBJ_optimize_mesh2( obj, 0, 0 );
+
+	t = TEST_time() - t;
+
+	acmr[ 1 ] = get_acmr( objmesh );
+
+	t1 = get_triangles( objmesh );
+
+	printf( "OBJ_optimize_mesh2: %u triangles %.2f ms, ACMR %.3f -> %.3f\n",
+			objmesh->objtrianglelist[ 0 ].n_indice_array / 3,
+			t * 1000.0,
+			acmr[ 0 ],
+			acmr[ 1 ] );
+
+	TEST_CHECK( acmr[ 1 ] < acmr[ 0 ] );
+	TEST_CHECK( !memcmp( t0, t1, objmesh->objtrianglelist[ 0 ].n_indice_array * sizeof( int ) ) );
+
+	i = 0;
+	while( i != objmesh->objtrianglelist[ 0 ].n_indice_array )
+	{
+		int indice = objmesh->objtrianglelist[ 0 ].indice_array[ i ];
+
+		if( indice > first_use + 1 ) ordered = 0;
+
+		else if( indice == first_use + 1 ) ++first_use;
+
+		++i;
+	}
+
+	TEST_CHECK( ordered );
+
+	free( t1 );
+	free( t0 );
+
+	OBJ_free( obj );
+
+
+	// Speed against the triangle strips, on a smaller mesh since they are quadratic.
+	TEST_write_grid_obj( filepath, 40, 1 );
+
+	obj = OBJ_load( filepath, 0 );
+
+	strip_time = TEST_time();
+
+	OBJ_optimize_mesh( obj, 0, 0 );
+
+	strip_time = TEST_time() - strip_time;
+
+	OBJ_free( obj );
+
+	obj = OBJ_load( filepath, 0 );
+
+	t = TEST_time();
+
+	OBJ_optimize_mesh2( obj, 0, 0 );
+
+	t = TEST_time() - t;
+
+	printf( "%u triangles: OBJ_optimize_mesh %.2f ms, OBJ_optimize_mesh2 %.2f ms\n",
+			2 * 40 * 40,
+			strip_time * 1000.0,
+			t * 1000.0 );
+
+	OBJ_free( obj );
+
+	unlink( filepath );
+
+	return TEST_end();
+}
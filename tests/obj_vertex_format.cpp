@@ -0,0 +1,329 @@
+/*
+
+GFX Lightweight OpenGLES 2.0 Game and Graphics Engine
+
+Copyright (C) 2011 Romain Marucchi-Foino http://gfx.sio2interactive.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of
+this software. Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that
+you wrote the original software. If you use this software in a product, an acknowledgment
+in the product would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be misrepresented
+as being the original software.
+
+3. This notice may not be removed or altered from any source distribution.
+
+*/
+
+#include "test.h"
+
+/*!
+	\file obj_vertex_format.cpp
+
+	\brief Check the strides and the decoding error of the OBJ_VERTEX_FORMAT layouts, the float
+	fallback of the half floats when GL_OES_vertex_half_float is missing, and that the location
+	of the VERTEX_SCALE uniform is only queried when the program in use changes.
+*/
+
+
+//! A vertex layout and its expected stride.
+typedef struct
+{
+	unsigned int	vertex_format;
+
+	unsigned int	stride;
+
+} TESTFORMAT;
+
+
+/*!
+	Function internally used to decode a half float.
+
+	\param[in] h The half float.
+
+	\return Return the float value.
+*/
+float half_to_float( unsigned short h )
+{
+	unsigned int e = ( h >> 10 ) & 31,
+				 m = h & 1023;
+
+	float f = e ? ldexpf( ( float )( m | 1024 ), e - 25 ) : ldexpf( ( float )m, -24 );
+
+	return ( h & 0x8000 ) ? -f : f;
+}
+
+
+/*!
+	Function internally used to decode a position of a vertex array.
+
+	\param[in] src The location of the position in the vertex array.
+	\param[in] objmesh The OBJMESH.
+	\param[out] v The position.
+*/
+void unpack_position( unsigned char *src, OBJMESH *objmesh, vec3 *v )
+{
+	if( objmesh->vertex_format & OBJ_VERTEX_FORMAT_SHORT_POSITION )
+	{
+		short *s = ( short * )src;
+
+		v->x = fmaxf( s[ 0 ] / 32767.0f, -1.0f ) * objmesh->vertex_scale.x;
+		v->y = fmaxf( s[ 1 ] / 32767.0f, -1.0f ) * objmesh->vertex_scale.y;
+		v->z = fmaxf( s[ 2 ] / 32767.0f, -1.0f ) * objmesh->vertex_scale.z;
+	}
+	else if( objmesh->vertex_format & OBJ_VERTEX_FORMAT_HALF_POSITION )
+	{
+		unsigned short *h = ( unsigned short * )src;
+
+		v->x = half_to_float( h[ 0 ] );
+		v->y = half_to_float( h[ 1 ] );
+		v->z = half_to_float( h[ 2 ] );
+	}
+	else memcpy( v, src, sizeof( vec3 ) );
+}
+
+
+/*!
+	Function internally used to decode a normal or a tangent of a vertex array, the way the
+	vertex shaders do.
+
+	\param[in] src The location of the normal in the vertex array.
+	\param[in] vertex_format The OBJ_VERTEX_FORMAT flags of the OBJMESH.
+	\param[out] v The normalized vector.
+*/
+void unpack_normal( unsigned char *src, unsigned int vertex_format, vec3 *v )
+{
+	if( vertex_format & OBJ_VERTEX_FORMAT_OCT_NORMAL )
+	{
+		short *s = ( short * )src;
+
+		float x;
+
+		v->x = fmaxf( s[ 0 ] / 32767.0f, -1.0f );
+		v->y = fmaxf( s[ 1 ] / 32767.0f, -1.0f );
+		v->z = 1.0f - fabsf( v->x ) - fabsf( v->y );
+
+		if( v->z < 0.0f )
+		{
+			x = v->x;
+
+			v->x = ( 1.0f - fabsf( v->y ) ) * ( x	 >= 0.0f ? 1.0f : -1.0f );
+			v->y = ( 1.0f - fabsf( x	) ) * ( v->y >= 0.0f ? 1.0f : -1.0f );
+		}
+	}
+	else if( vertex_format & OBJ_VERTEX_FORMAT_BYTE_NORMAL )
+	{
+		signed char *b = ( signed char * )src;
+
+		v->x = fmaxf( b[ 0 ] / 127.0f, -1.0f );
+		v->y = fmaxf( b[ 1 ] / 127.0f, -1.0f );
+		v->z = fmaxf( b[ 2 ] / 127.0f, -1.0f );
+	}
+	else memcpy( v, src, sizeof( vec3 ) );
+
+	vec3_normalize( v, v );
+}
+
+
+/*!
+	Function internally used to decode a UV of a vertex array.
+
+	\param[in] src The location of the UV in the vertex array.
+	\param[in] vertex_format The OBJ_VERTEX_FORMAT flags of the OBJMESH.
+	\param[out] v The UV.
+*/
+void unpack_uv( unsigned char *src, unsigned int vertex_format, vec2 *v )
+{
+	if( vertex_format & OBJ_VERTEX_FORMAT_HALF_UV )
+	{
+		unsigned short *h = ( unsigned short * )src;
+
+		v->x = half_to_float( h[ 0 ] );
+		v->y = half_to_float( h[ 1 ] );
+	}
+	else memcpy( v, src, sizeof( vec2 ) );
+}
+
+
+int main( void )
+{
+	char obj_filepath[ MAX_PATH ],
+		 bin_filepath[ MAX_PATH ];
+
+	TESTFORMAT testformat[ 5 ] = { { OBJ_VERTEX_FORMAT_FLOAT, 56 },
+								   { OBJ_VERTEX_FORMAT_SINGLE_NORMAL, 44 },
+								   { OBJ_VERTEX_FORMAT_SHORT_POSITION | OBJ_VERTEX_FORMAT_BYTE_NORMAL, 28 },
+								   { OBJ_VERTEX_FORMAT_HALF_POSITION | OBJ_VERTEX_FORMAT_HALF_UV | OBJ_VERTEX_FORMAT_OCT_NORMAL, 24 },
+								   { OBJ_VERTEX_FORMAT_SINGLE_NORMAL | OBJ_VERTEX_FORMAT_SHORT_POSITION | OBJ_VERTEX_FORMAT_OCT_NORMAL | OBJ_VERTEX_FORMAT_HALF_UV, 20 } };
+
+	float max_error[ 5 ][ 3 ] = { { 0.0f	, 0.0f	  , 0.0f	},
+								  { 0.0f	, 0.0f	  , 0.0f	},
+								  { 0.0005f , 0.015f  , 0.0f	},
+								  { 0.001f	, 0.0002f , 0.001f	},
+								  { 0.0005f , 0.0002f , 0.001f	} };
+
+	unsigned int i = 0,
+				 j,
+				 n_uniform_location;
+
+	OBJ *obj,
+		*bin;
+
+	OBJMESH *objmesh;
+
+	TEST_get_path( obj_filepath, "format.obj" );
+	TEST_get_path( bin_filepath, "format.gfxmesh" );
+
+	TEST_write_grid_obj( obj_filepath, 32, 1 );
+
+	obj = OBJ_load( obj_filepath, 0 );
+
+	objmesh = &obj->objmesh[ 0 ];
+
+	OBJ_update_bound_mesh( obj, 0 );
+
+
+	// Every layout decodes within the precision of its types.
+	gfx.half_float = 1;
+
+	while( i != 5 )
+	{
+		unsigned char *vertex_array;
+
+		float error[ 3 ] = { 0.0f, 0.0f, 0.0f };
+
+		OBJ_set_vertex_format_mesh( obj, 0, testformat[ i ].vertex_format );
+
+		vertex_array = OBJ_build_vertex_array_mesh( obj, 0 );
+
+		TEST_CHECK( objmesh->stride == testformat[ i ].stride );
+		TEST_CHECK( objmesh->size == objmesh->n_objvertexdata * objmesh->stride );
+
+		j = 0;
+		while( j != objmesh->n_objvertexdata )
+		{
+			unsigned char *vertex = &vertex_array[ j * objmesh->stride ];
+
+			int index = objmesh->objvertexdata[ j ].vertex_index;
+
+			vec3 p, n, t, v;
+
+			vec2 uv;
+
+			vec3_diff( &v, &obj->indexed_vertex[ index ], &objmesh->location );
+
+			unpack_position( vertex, objmesh, &p );
+
+			unpack_normal( vertex + objmesh->offset[ 1 ], objmesh->vertex_format, &n );
+
+			unpack_normal( vertex + objmesh->offset[ 4 ], objmesh->vertex_format, &t );
+
+			unpack_uv( vertex + objmesh->offset[ 3 ], objmesh->vertex_format, &uv );
+
+			error[ 0 ] = fmaxf( error[ 0 ], vec3_dist( &p, &v ) / ( 1.0f + vec3_length( &v ) ) );
+
+			// A single normal set is the one selected by use_smooth_normals.
+			error[ 1 ] = fmaxf( error[ 1 ], vec3_dist( &n, ( objmesh->vertex_format & OBJ_VERTEX_FORMAT_SINGLE_NORMAL ) && !objmesh->use_smooth_normals ?
+															 &obj->indexed_fnormal[ index ] :
+															 &obj->indexed_normal[ index ] ) );
+			error[ 1 ] = fmaxf( error[ 1 ], vec3_dist( &t, &obj->indexed_tangent[ index ] ) );
+			error[ 2 ] = fmaxf( error[ 2 ], fmaxf( fabsf( uv.x - obj->indexed_uv[ index ].x ), fabsf( uv.y - obj->indexed_uv[ index ].y ) ) );
+
+			if( !( objmesh->vertex_format & OBJ_VERTEX_FORMAT_SINGLE_NORMAL ) )
+			{
+				unpack_normal( vertex + objmesh->offset[ 2 ], objmesh->vertex_format, &n );
+
+				error[ 1 ] = fmaxf( error[ 1 ], vec3_dist( &n, &obj->indexed_fnormal[ index ] ) );
+			}
+
+			++j;
+		}
+
+		printf( "%u bytes per vertex: position error %g, normal error %g, uv error %g\n", objmesh->stride, error[ 0 ], error[ 1 ], error[ 2 ] );
+
+		TEST_CHECK( error[ 0 ] <= max_error[ i ][ 0 ] );
+		TEST_CHECK( error[ 1 ] <= max_error[ i ][ 1 ] + 0.000001f );
+		TEST_CHECK( error[ 2 ] <= max_error[ i ][ 2 ] );
+
+		free( vertex_array );
+
+		++i;
+	}
+
+
+	// A .gfxmesh using half floats is only built when the driver supports them.
+	OBJ_set_vertex_format_mesh( obj, 0, OBJ_VERTEX_FORMAT_HALF_POSITION | OBJ_VERTEX_FORMAT_HALF_UV );
+
+	TEST_CHECK( OBJ_save_bin( obj, bin_filepath ) );
+
+	bin = OBJ_load_bin( bin_filepath, 0 );
+
+	gfx.half_float = 0;
+
+	TEST_CHECK( !OBJ_build_mesh( bin, 0 ) );
+	TEST_CHECK( bin->objmesh[ 0 ].vbo == 0 );
+
+	gfx.half_float = 1;
+
+	TEST_CHECK( OBJ_build_mesh( bin, 0 ) );
+
+	OBJ_free( bin );
+
+
+	// Without half floats support an .obj mesh falls back to float positions and UVs.
+	gfx.half_float = 0;
+
+	testgles.n_buffer_byte = 0;
+
+	TEST_CHECK( OBJ_build_mesh( obj, 0 ) );
+	TEST_CHECK( objmesh->vertex_format == OBJ_VERTEX_FORMAT_FLOAT );
+	TEST_CHECK( objmesh->stride == 56 );
+	TEST_CHECK( testgles.n_buffer_byte == objmesh->size + objmesh->objtrianglelist[ 0 ].n_indice_array * sizeof( unsigned short ) );
+
+	OBJ_free( obj );
+
+
+	// The location of VERTEX_SCALE is queried once per program in use.
+	obj = OBJ_load( obj_filepath, 0 );
+
+	objmesh = &obj->objmesh[ 0 ];
+
+	OBJ_set_vertex_format_mesh( obj, 0, OBJ_VERTEX_FORMAT_SHORT_POSITION );
+
+	OBJ_build_mesh( obj, 0 );
+
+	GFX_use_program( 1000 );
+
+	n_uniform_location = testgles.n_uniform_location;
+
+	i = 0;
+	while( i != 10 )
+	{
+		OBJ_draw_mesh( obj, 0 );
+		++i;
+	}
+
+	TEST_CHECK( testgles.n_uniform_location == n_uniform_location + 1 );
+
+	GFX_use_program( 1001 );
+
+	OBJ_draw_mesh( obj, 0 );
+	OBJ_draw_mesh( obj, 0 );
+
+	TEST_CHECK( testgles.n_uniform_location == n_uniform_location + 2 );
+
+	GFX_use_program( 0 );
+
+	OBJ_free( obj );
+
+	unlink( bin_filepath );
+	unlink( obj_filepath );
+
+	return TEST_end();
+}
@@ -0,0 +1,142 @@
+/*
+
+GFX Lightweight OpenGLES 2.0 Game and Graphics Engine
+
+Copyright (C) 2011 Romain Marucchi-Foino http://gfx.sio2interactive.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of
+this software. Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that
+you wrote the original software. If you use this software in a product, an acknowledgment
+in the product would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be misrepresented
+as being the original software.
+
+3. This notice may not be removed or altered from any source distribution.
+
+*/
+
+#include "test.h"
+
+/*!
+	\file program_name.cpp
+
+	\brief Check that the interned name ids are stable, that they resolve the same locations as
+	the names, that PROGRAM_set_uniform skips the unchanged values, and that FONT_print only
+	uploads the uniforms that changed.
+*/
+
+
+int main( void )
+{
+	TESTUNIFORM testuniform[ 3 ] = { { "MODELVIEWPROJECTIONMATRIX", GL_FLOAT_MAT4, 1 },
+									 { "DIFFUSE"				  , GL_SAMPLER_2D, 1 },
+									 { "COLOR"					  , GL_FLOAT_VEC4, 1 } };
+
+	char name[ MAX_CHAR ];
+
+	unsigned int i,
+				 color_id,
+				 n_uniform;
+
+	unsigned char stable = 1;
+
+	vec4 color = { 1.0f, 0.5f, 0.25f, 1.0f };
+
+	PROGRAM *program;
+
+	FONT *font;
+
+
+	// The ids do not change when the table grows.
+	color_id = PROGRAM_get_name_id( ( char * )"COLOR" );
+
+	TEST_CHECK( PROGRAM_find_name_id( ( char * )"UNKNOWN" ) == -1 );
+
+	i = 0;
+	while( i != 500 )
+	{
+		sprintf( name, "NAME%u", i );
+
+		if( PROGRAM_get_name_id( name ) != PROGRAM_get_name_id( name ) ) stable = 0;
+
+		++i;
+	}
+
+	TEST_CHECK( stable );
+	TEST_CHECK( PROGRAM_get_name_id( ( char * )"COLOR" ) == color_id );
+	TEST_CHECK( PROGRAM_find_name_id( ( char * )"NAME250" ) == ( int )PROGRAM_get_name_id( ( char * )"NAME250" ) );
+
+
+	// A linked program resolves the same locations by id and by name.
+	testgles.testuniform   = testuniform;
+	testgles.n_testuniform = 3;
+
+	program = PROGRAM_init( ( char * )"program" );
+
+	program->vertex_shader	 = SHADER_init( ( char * )"program", GL_VERTEX_SHADER );
+	program->fragment_shader = SHADER_init( ( char * )"program", GL_FRAGMENT_SHADER );
+
+	SHADER_compile( program->vertex_shader	, "void main( void ) {}", 0 );
+	SHADER_compile( program->fragment_shader, "void main( void ) {}", 0 );
+
+	TEST_CHECK( PROGRAM_link( program, 0 ) );
+
+	i = 0;
+	while( i != 3 )
+	{
+		TEST_CHECK( PROGRAM_get_uniform_location2( program, PROGRAM_get_name_id( ( char * )testuniform[ i ].name ) ) ==
+					PROGRAM_get_uniform_location( program, ( char * )testuniform[ i ].name ) );
+		++i;
+	}
+
+	TEST_CHECK( PROGRAM_get_uniform_location2( program, PROGRAM_get_name_id( ( char * )"NAME0" ) ) == -1 );
+
+
+	// Only the changed values are uploaded.
+	PROGRAM_draw( program );
+
+	TEST_CHECK( PROGRAM_set_uniform_vec4( program, color_id, &color ) );
+	TEST_CHECK( !PROGRAM_set_uniform_vec4( program, color_id, &color ) );
+
+	color.w = 0.5f;
+
+	TEST_CHECK( PROGRAM_set_uniform_vec4( program, color_id, &color ) );
+
+	SHADER_free( program->vertex_shader );
+	SHADER_free( program->fragment_shader );
+
+	PROGRAM_free( program );
+
+
+	// FONT_print uploads its three uniforms once, then only the color when it changes.
+	font = FONT_init( ( char * )"font" );
+
+	n_uniform = testgles.n_uniform;
+
+	FONT_print( font, 0.0f, 0.0f, ( char * )"", &color );
+
+	TEST_CHECK( testgles.n_uniform == n_uniform + 3 );
+
+	FONT_print( font, 0.0f, 0.0f, ( char * )"", &color );
+
+	TEST_CHECK( testgles.n_uniform == n_uniform + 3 );
+
+	color.x = 0.0f;
+
+	FONT_print( font, 0.0f, 0.0f, ( char * )"", &color );
+
+	TEST_CHECK( testgles.n_uniform == n_uniform + 4 );
+
+	FONT_free( font );
+
+	testgles.testuniform   = NULL;
+	testgles.n_testuniform = 0;
+
+	return TEST_end();
+}
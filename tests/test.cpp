@@ -0,0 +1,585 @@
+/*
+
+GFX Lightweight OpenGLES 2.0 Game and Graphics Engine
+
+Copyright (C) 2011 Romain Marucchi-Foino http://gfx.sio2interactive.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of
+this software. Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that
+you wrote the original software. If you use this software in a product, an acknowledgment
+in the product would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be misrepresented
+as being the original software.
+
+3. This notice may not be removed or altered from any source distribution.
+
+*/
+
+#include "test.h"
+
+/*!
+	\file test.cpp
+
+	\brief Implementation of the helpers shared by the tests and benchmarks.
+*/
+
+
+//! The number of checks that failed since the beginning of the test.
+unsigned int test_n_failure = 0;
+
+//! The number of checks since the beginning of the test.
+unsigned int test_n_check = 0;
+
+//! The state of the pseudo random number generator.
+unsigned int test_seed = 1;
+
+
+/*!
+	Count a check, and print it with its location if it fails. Use the TEST_CHECK macro
+	instead of calling this function directly.
+
+	\param[in] result The result of the check.
+	\param[in] expression The checked expression.
+	\param[in] file The source file of the check.
+	\param[in] line The line of the check.
+*/
+void TEST_check( unsigned char result, const char *expression, const char *file, int line )
+{
+	++test_n_check;
+
+	if( !result )
+	{
+		++test_n_failure;
+
+		printf( "%s:%d: check failed: %s\n", file, line, expression );
+	}
+}
+
+
+/*!
+	Print the summary of the checks, to be returned by the main function of a test.
+
+	\return Return 0 if all the checks passed, else return 1.
+*/
+int TEST_end( void )
+{
+	printf( "%u checks, %u failed\n", test_n_check, test_n_failure );
+
+	return test_n_failure != 0;
+}
+
+
+/*!
+	Reset the pseudo random number generator, so a test always use the same data.
+
+	\param[in] seed The new seed.
+*/
+void TEST_seed( unsigned int seed )
+{ test_seed = seed; }
+
+
+/*!
+	Return a pseudo random number. The generator does not depend on the C library,
+	so the data is the same on every platform.
+
+	\param[in] min The minimum value.
+	\param[in] max The maximum value.
+
+	\return Return a number between min and max.
+*/
+float TEST_random( float min, float max )
+{
+	test_seed = test_seed * 1664525u + 1013904223u;
+
+	return min + ( max - min ) * ( float )( test_seed >> 8 ) / 16777216.0f;
+}
+
+
+/*!
+	Return the current time with a microsecond precision.
+
+	\return Return the time in seconds.
+*/
+double TEST_time( void )
+{
+	struct timeval tv;
+
+	gettimeofday( &tv, NULL );
+
+	return tv.tv_sec + tv.tv_usec * 0.000001;
+}
+
+
+/*!
+	Read a whole file.
+
+	\param[in] filepath The file to read.
+	\param[out] size The size of the file in bytes.
+
+	\return Return a buffer with the content of the file, to free with free.
+*/
+unsigned char *TEST_read_file( char *filepath, unsigned int *size )
+{
+	unsigned char *buffer;
+
+	FILE *f = fopen( filepath, "rb" );
+
+	fseek( f, 0, SEEK_END );
+	*size = ftell( f );
+	fseek( f, 0, SEEK_SET );
+
+	buffer = ( unsigned char * ) malloc( *size );
+
+	TEST_CHECK( fread( buffer, *size, 1, f ) == 1 );
+
+	fclose( f );
+
+	return buffer;
+}
+
+
+/*!
+	Write a buffer to a file.
+
+	\param[in] filepath The file to create.
+	\param[in] buffer The buffer to write.
+	\param[in] size The size of the buffer in bytes.
+*/
+void TEST_write_file( char *filepath, unsigned char *buffer, unsigned int size )
+{
+	FILE *f = fopen( filepath, "wb" );
+
+	fwrite( buffer, size, 1, f );
+
+	fclose( f );
+}
+
+
+/*!
+	Build the path of a file in the temporary directory (TMPDIR, or /tmp).
+
+	\param[in,out] filepath The path, at least MAX_PATH characters.
+	\param[in] filename The file name.
+*/
+void TEST_get_path( char *filepath, const char *filename )
+{
+	const char *tmp = getenv( "TMPDIR" );
+
+	snprintf( filepath, MAX_PATH, "%s/gfx_test_%d_%s", tmp ? tmp : "/tmp", ( int )getpid(), filename );
+}
+
+
+/*!
+	Write an .obj file containing square grids of n_quad by n_quad quads in the XZ plane,
+	with a bumpy height, one texture coordinate per grid vertex and one object per grid. Each
+	quad is written as two triangles. The grid vertices are shared between the quads, so each grid ends up with
+	( n_quad + 1 ) * ( n_quad + 1 ) unique vertices.
+
+	\param[in] filepath The .obj file to create.
+	\param[in] n_quad The number of quads on each side of a grid.
+	\param[in] n_mesh The number of grids.
+*/
+void TEST_write_grid_obj( char *filepath, unsigned int n_quad, unsigned int n_mesh )
+{
+	unsigned int i,
+				 j,
+				 k = 0,
+				 n = n_quad + 1,
+				 base;
+
+	FILE *f = fopen( filepath, "w" );
+
+	while( k != n_mesh )
+	{
+		fprintf( f, "o grid%u\n", k );
+
+		i = 0;
+		while( i != n )
+		{
+			j = 0;
+			while( j != n )
+			{
+				fprintf( f, "v %f %f %f\n", ( float )j, 0.25f * sinf( i * 0.7f ) * cosf( j * 0.3f ), ( float )i + k * n );
+				fprintf( f, "vt %f %f\n", ( float )j / n_quad, ( float )i / n_quad );
+				++j;
+			}
+
+			++i;
+		}
+
+		base = k * n * n + 1;
+
+		i = 0;
+		while( i != n_quad )
+		{
+			j = 0;
+			while( j != n_quad )
+			{
+				unsigned int v = base + i * n + j;
+
+				fprintf( f, "f %u/%u %u/%u %u/%u\n", v, v, v + n, v + n, v + n + 1, v + n + 1 );
+				fprintf( f, "f %u/%u %u/%u %u/%u\n", v, v, v + n + 1, v + n + 1, v + 1, v + 1 );
+				++j;
+			}
+
+			++i;
+		}
+
+		++k;
+	}
+
+	fclose( f );
+}
+
+
+/*!
+	Function internally used by TEST_write_md5 to build a rotation around a random axis.
+
+	\param[in,out] q The rotation quaternion.
+	\param[in] angle The maximum angle in radians.
+*/
+void TEST_random_rotation( vec4 *q, float angle )
+{
+	vec3 axis = { TEST_random( -1.0f, 1.0f ),
+				  TEST_random( -1.0f, 1.0f ),
+				  TEST_random( -1.0f, 1.0f ) };
+
+	float a = TEST_random( -angle, angle ) * 0.5f;
+
+	vec3_normalize( &axis, &axis );
+
+	q->x = axis.x * sinf( a );
+	q->y = axis.y * sinf( a );
+	q->z = axis.z * sinf( a );
+	q->w = cosf( a );
+}
+
+
+/*!
+	Function internally used by TEST_write_md5 to write a quaternion the way the .md5 files
+	store it, without its W component which is rebuilt negative by vec4_build_w.
+
+	\param[in] f The file to write to.
+	\param[in] q The rotation quaternion.
+*/
+void TEST_write_rotation( FILE *f, vec4 *q )
+{
+	float s = q->w > 0.0f ? -1.0f : 1.0f;
+
+	fprintf( f, "%.8f %.8f %.8f", q->x * s, q->y * s, q->z * s );
+}
+
+
+/*!
+	Write a synthetic character to an .md5mesh file and one of its actions to an .md5anim
+	file. The skeleton is a binary tree of joints, and the single mesh is a triangle strip
+	running over the vertices, each vertex being influenced by its joint and by up to
+	max_weight - 1 of the joint ancestors (the bind pose of the vertex being the same for all
+	its weights, as it is the case for the exporters). The action moves the root and swings
+	every joint around its own random axis.
+
+	\param[in] mesh_filepath The .md5mesh file to create.
+	\param[in] action_filepath The .md5anim file to create (NULL to skip it).
+	\param[in] n_joint The number of joints.
+	\param[in] n_vertex The number of vertices.
+	\param[in] max_weight The maximum number of weights per vertex (between 1 and 4).
+	\param[in] n_frame The number of frames of the action.
+*/
+void TEST_write_md5( char *mesh_filepath, char *action_filepath, unsigned int n_joint, unsigned int n_vertex, unsigned int max_weight, unsigned int n_frame )
+{
+	unsigned int i,
+				 j,
+				 k,
+				 n_weight = 0;
+
+	int *parent = ( int * ) malloc( n_joint * sizeof( int ) );
+
+	vec3 *local_location = ( vec3 * ) malloc( n_joint * sizeof( vec3 ) ),
+		 *location		 = ( vec3 * ) malloc( n_joint * sizeof( vec3 ) ),
+		 *swing_axis	 = ( vec3 * ) malloc( n_joint * sizeof( vec3 ) );
+
+	vec4 *local_rotation = ( vec4 * ) malloc( n_joint * sizeof( vec4 ) ),
+		 *rotation		 = ( vec4 * ) malloc( n_joint * sizeof( vec4 ) );
+
+	FILE *f;
+
+
+	// Bind pose, the parents are always before their children.
+	i = 0;
+	while( i != n_joint )
+	{
+		parent[ i ] = i ? ( int )( i - 1 ) / 2 : -1;
+
+		local_location[ i ].x = i ? TEST_random( -0.3f, 0.3f ) : 0.0f;
+		local_location[ i ].y = i ? TEST_random(  0.2f, 0.5f ) : 1.0f;
+		local_location[ i ].z = i ? TEST_random( -0.3f, 0.3f ) : 0.0f;
+
+		TEST_random_rotation( &local_rotation[ i ], 0.6f );
+
+		swing_axis[ i ].x = TEST_random( -1.0f, 1.0f );
+		swing_axis[ i ].y = TEST_random( -1.0f, 1.0f );
+		swing_axis[ i ].z = TEST_random( -1.0f, 1.0f );
+
+		vec3_normalize( &swing_axis[ i ], &swing_axis[ i ] );
+
+		if( parent[ i ] > -1 )
+		{
+			vec3_rotate_vec4( &location[ i ], &local_location[ i ], &rotation[ parent[ i ] ] );
+
+			vec3_add( &location[ i ], &location[ i ], &location[ parent[ i ] ] );
+
+			vec4_multiply_vec4( &rotation[ i ], &rotation[ parent[ i ] ], &local_rotation[ i ] );
+
+			vec4_normalize( &rotation[ i ], &rotation[ i ] );
+		}
+		else
+		{
+			location[ i ] = local_location[ i ];
+			rotation[ i ] = local_rotation[ i ];
+		}
+
+		// Store the rotation the way it is read back, with a negative W.
+		if( rotation[ i ].w > 0.0f )
+		{
+			rotation[ i ].x = -rotation[ i ].x;
+			rotation[ i ].y = -rotation[ i ].y;
+			rotation[ i ].z = -rotation[ i ].z;
+			rotation[ i ].w = -rotation[ i ].w;
+		}
+
+		++i;
+	}
+
+
+	f = fopen( mesh_filepath, "w" );
+
+	fprintf( f, "MD5Version 10\ncommandline \"\"\n\nnumJoints %u\nnumMeshes 1\n\njoints {\n", n_joint );
+
+	i = 0;
+	while( i != n_joint )
+	{
+		fprintf( f, "\t\"joint%u\" %d ( %.8f %.8f %.8f ) ( ", i, parent[ i ], location[ i ].x, location[ i ].y, location[ i ].z );
+
+		TEST_write_rotation( f, &rotation[ i ] );
+
+		fprintf( f, " )\n" );
+
+		// Use the rotation as it is rebuilt by the loader to express the weights.
+		vec4_build_w( &rotation[ i ] );
+
+		++i;
+	}
+
+	fprintf( f, "}\n\nmesh {\n\tshader \"test\"\n\n\tnumverts %u\n", n_vertex );
+
+	i = 0;
+	while( i != n_vertex )
+	{
+		unsigned int n = 1 + i % ( max_weight ? max_weight : 1 );
+
+		j = i % n_joint;
+
+		// Count the ancestors that can influence the vertex.
+		k = 1;
+		while( k != n && parent[ j ] > -1 )
+		{
+			j = parent[ j ];
+			++k;
+		}
+
+		fprintf( f, "\tvert %u ( %f %f ) %u %u\n", i, TEST_random( 0.0f, 1.0f ), TEST_random( 0.0f, 1.0f ), n_weight, k );
+
+		n_weight += k;
+		++i;
+	}
+
+	fprintf( f, "\n\tnumtris %u\n", n_vertex > 2 ? n_vertex - 2 : 0 );
+
+	i = 0;
+	while( i + 2 < n_vertex )
+	{
+		if( i & 1 ) fprintf( f, "\ttri %u %u %u %u\n", i, i + 1, i, i + 2 );
+
+		else fprintf( f, "\ttri %u %u %u %u\n", i, i, i + 1, i + 2 );
+
+		++i;
+	}
+
+	fprintf( f, "\n\tnumweights %u\n", n_weight );
+
+	TEST_seed( 7 );
+
+	n_weight = 0;
+
+	i = 0;
+	while( i != n_vertex )
+	{
+		unsigned int n = 1 + i % ( max_weight ? max_weight : 1 );
+
+		float bias[ 4 ],
+			  sum = 0.0f;
+
+		vec3 v;
+
+		j = i % n_joint;
+
+		v.x = location[ j ].x + TEST_random( -0.2f, 0.2f );
+		v.y = location[ j ].y + TEST_random( -0.2f, 0.2f );
+		v.z = location[ j ].z + TEST_random( -0.2f, 0.2f );
+
+		k = 0;
+		while( k != n )
+		{
+			bias[ k ] = TEST_random( 0.1f, 1.0f );
+			sum += bias[ k ];
+
+			++k;
+			if( parent[ j ] < 0 ) break;
+			j = parent[ j ];
+		}
+
+		n = k;
+		j = i % n_joint;
+
+		k = 0;
+		while( k != n )
+		{
+			vec4 inverse;
+
+			vec3 p;
+
+			vec3_diff( &p, &v, &location[ j ] );
+
+			vec4_conjugate( &inverse, &rotation[ j ] );
+
+			vec3_rotate_vec4( &p, &p, &inverse );
+
+			fprintf( f, "\tweight %u %u %.8f ( %.8f %.8f %.8f )\n", n_weight, j, bias[ k ] / sum, p.x, p.y, p.z );
+
+			++n_weight;
+			++k;
+			if( parent[ j ] > -1 ) j = parent[ j ];
+		}
+
+		++i;
+	}
+
+	fprintf( f, "}\n" );
+
+	fclose( f );
+
+
+	if( action_filepath )
+	{
+		f = fopen( action_filepath, "w" );
+
+		fprintf( f, "MD5Version 10\ncommandline \"\"\n\nnumFrames %u\nnumJoints %u\nframeRate 30\nnumAnimatedComponents %u\n\n",
+				 n_frame, n_joint, n_joint * 6 );
+
+		i = 0;
+		while( i != n_frame )
+		{
+			float t = 6.2831853f * i / n_frame;
+
+			fprintf( f, "frame %u {\n", i );
+
+			j = 0;
+			while( j != n_joint )
+			{
+				float a = 0.4f * sinf( t + j * 0.9f ) * 0.5f;
+
+				vec4 swing = { swing_axis[ j ].x * sinf( a ),
+							   swing_axis[ j ].y * sinf( a ),
+							   swing_axis[ j ].z * sinf( a ),
+							   cosf( a ) },
+					 q;
+
+				vec4_multiply_vec4( &q, &local_rotation[ j ], &swing );
+
+				vec4_normalize( &q, &q );
+
+				fprintf( f, "\t%.8f %.8f %.8f ",
+						 local_location[ j ].x,
+						 local_location[ j ].y + ( j ? 0.0f : 0.05f * sinf( 2.0f * t ) ),
+						 local_location[ j ].z + ( j ? 0.0f : 0.02f * i ) );
+
+				TEST_write_rotation( f, &q );
+
+				fprintf( f, "\n" );
+
+				++j;
+			}
+
+			fprintf( f, "}\n\n" );
+
+			++i;
+		}
+
+		fclose( f );
+	}
+
+	free( rotation );
+	free( local_rotation );
+	free( swing_axis );
+	free( location );
+	free( local_location );
+	free( parent );
+}
+
+
+/*!
+	Skin a vertex of an MD5MESH to a pose the way MD5_set_pose originally did, rotating each
+	weight by its joint quaternion. Used as the reference of the skinning tests.
+
+	\param[in] md5mesh The MD5MESH, with its weighted normals and tangents built.
+	\param[in] pose The pose.
+	\param[in] vertex_index The index of the vertex.
+	\param[in,out] position The skinned position.
+	\param[in,out] normal The skinned normal (not normalized).
+	\param[in,out] tangent The skinned tangent (not normalized).
+*/
+void TEST_skin_vertex( MD5MESH *md5mesh, MD5POSE *pose, unsigned int vertex_index, vec3 *position, vec3 *normal, vec3 *tangent )
+{
+	MD5VERTEX *md5vertex = &md5mesh->md5vertex[ vertex_index ];
+
+	unsigned int i = 0;
+
+	memset( position, 0, sizeof( vec3 ) );
+	memset( normal	, 0, sizeof( vec3 ) );
+	memset( tangent , 0, sizeof( vec3 ) );
+
+	while( i != md5vertex->count )
+	{
+		MD5WEIGHT *md5weight = &md5mesh->md5weight[ md5vertex->start + i ];
+
+		vec4 rotation;
+
+		vec3 l, n, t;
+
+		MD5_get_pose_rotation( pose, md5weight->joint, &rotation );
+
+		vec3_rotate_vec4( &l, &md5weight->location, &rotation );
+		vec3_rotate_vec4( &n, &md5weight->normal  , &rotation );
+		vec3_rotate_vec4( &t, &md5weight->tangent , &rotation );
+
+		position->x += ( pose->location[ md5weight->joint ].x + l.x ) * md5weight->bias;
+		position->y += ( pose->location[ md5weight->joint ].y + l.y ) * md5weight->bias;
+		position->z += ( pose->location[ md5weight->joint ].z + l.z ) * md5weight->bias;
+
+		normal->x += n.x * md5weight->bias;
+		normal->y += n.y * md5weight->bias;
+		normal->z += n.z * md5weight->bias;
+
+		tangent->x += t.x * md5weight->bias;
+		tangent->y += t.y * md5weight->bias;
+		tangent->z += t.z * md5weight->bias;
+
+		++i;
+	}
+}
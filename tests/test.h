@@ -0,0 +1,122 @@
+/*
+
+GFX Lightweight OpenGLES 2.0 Game and Graphics Engine
+
+Copyright (C) 2011 Romain Marucchi-Foino http://gfx.sio2interactive.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of
+this software. Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that
+you wrote the original software. If you use this software in a product, an acknowledgment
+in the product would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be misrepresented
+as being the original software.
+
+3. This notice may not be removed or altered from any source distribution.
+
+*/
+
+#ifndef TEST_H
+#define TEST_H
+
+#include "gfx.h"
+
+#include <unistd.h>
+
+/*!
+	\file test.h
+
+	\brief Helpers shared by the headless tests and benchmarks of the GFX engine.
+
+	\details Every test is a small program that exits with 0 on success. The OpenGLES calls
+	are implemented by gles.cpp, which only records what the tests need to check, so the
+	engine can be exercised without a device or a context. The synthetic OBJ and MD5 files
+	are generated in the temporary directory, so the tests do not depend on any data.
+*/
+
+
+//! Check a condition and report it with its location if it fails. \sa TEST_check
+#define TEST_CHECK( x ) TEST_check( ( x ), #x, __FILE__, __LINE__ )
+
+
+//! Uniform reported by the glGetActiveUniform stub for every linked program.
+typedef struct
+{
+	//! The name, as reported by the driver (arrays are reported as "NAME[0]").
+	const char		*name;
+
+	//! The GLSL type, for example GL_FLOAT_VEC4.
+	unsigned int	type;
+
+	//! The number of elements.
+	int				size;
+
+} TESTUNIFORM;
+
+
+//! State recorded by the OpenGLES stubs of gles.cpp.
+typedef struct
+{
+	//! The uniforms reported for every program.
+	TESTUNIFORM		*testuniform;
+
+	//! The number of TESTUNIFORM.
+	unsigned int	n_testuniform;
+
+	//! The value returned for GL_MAX_VERTEX_UNIFORM_VECTORS.
+	int				max_vertex_uniform_vectors;
+
+	//! The number of glUniform calls.
+	unsigned int	n_uniform;
+
+	//! The number of glGetUniformLocation calls.
+	unsigned int	n_uniform_location;
+
+	//! The location of the last glUniform4fv call.
+	int				uniform4fv_location;
+
+	//! The number of vec4 of the last glUniform4fv call.
+	int				uniform4fv_count;
+
+	//! The number of glDrawElements calls.
+	unsigned int	n_draw;
+
+	//! The number of bytes uploaded with glBufferData and glBufferSubData.
+	unsigned int	n_buffer_byte;
+
+	//! The last id returned by the glGen and glCreate functions.
+	unsigned int	id;
+
+} TESTGLES;
+
+extern TESTGLES testgles;
+
+
+void TEST_check( unsigned char result, const char *expression, const char *file, int line );
+
+int TEST_end( void );
+
+void TEST_seed( unsigned int seed );
+
+float TEST_random( float min, float max );
+
+double TEST_time( void );
+
+unsigned char *TEST_read_file( char *filepath, unsigned int *size );
+
+void TEST_write_file( char *filepath, unsigned char *buffer, unsigned int size );
+
+void TEST_get_path( char *filepath, const char *filename );
+
+void TEST_write_grid_obj( char *filepath, unsigned int n_quad, unsigned int n_mesh );
+
+void TEST_write_md5( char *mesh_filepath, char *action_filepath, unsigned int n_joint, unsigned int n_vertex, unsigned int max_weight, unsigned int n_frame );
+
+void TEST_skin_vertex( MD5MESH *md5mesh, MD5POSE *pose, unsigned int vertex_index, vec3 *position, vec3 *normal, vec3 *tangent );
+
+#endif
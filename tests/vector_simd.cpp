@@ -0,0 +1,456 @@
+/*
+
+GFX Lightweight OpenGLES 2.0 Game and Graphics Engine
+
+Copyright (C) 2011 Romain Marucchi-Foino http://gfx.sio2interactive.com
+
+This software is provided 'as-is', without any express or implied warranty.
+In no event will the authors be held liable for any damages arising from the use of
+this software. Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it freely,
+subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim that
+you wrote the original software. If you use this software in a product, an acknowledgment
+in the product would be appreciated but is not required.
+
+2. Altered source versions must be plainly marked as such, and must not be misrepresented
+as being the original software.
+
+3. This notice may not be removed or altered from any source distribution.
+
+*/
+
+#include "test.h"
+
+/*!
+	\file vector_simd.cpp
+
+	\brief Check the SSE, NEON or scalar paths of the vector and matrix functions against
+	double precision references, and print their cost. The Makefile builds this test
+	twice, the second time with the SIMD paths of vector.cpp and matrix.cpp disabled.
+*/
+
+
+//! The number of random inputs.
+#define N_INPUT 4096
+
+
+/*!
+	Function internally used to fill a 4x4 matrix with a random transform, perspective
+	when requested.
+
+	\param[in,out] m The matrix.
+	\param[in] perspective Determine if the last row is randomized as well.
+*/
+void random_mat4( mat4 *m, unsigned char perspective )
+{
+	unsigned int i = 0;
+
+	float *f = ( float * )m;
+
+	while( i != 16 )
+	{
+		f[ i ] = TEST_random( -1.0f, 1.0f );
+		++i;
+	}
+
+	// Keep the matrix well conditioned.
+	m->m[ 0 ].x += 3.0f;
+	m->m[ 1 ].y += 3.0f;
+	m->m[ 2 ].z += 3.0f;
+
+	if( perspective ) m->m[ 3 ].w += 3.0f;
+
+	else
+	{
+		m->m[ 0 ].w =
+		m->m[ 1 ].w =
+		m->m[ 2 ].w = 0.0f;
+		m->m[ 3 ].w = 1.0f;
+	}
+}
+
+
+/*!
+	Function internally used to compute the reference product of two 4x4 matrices.
+
+	\param[in,out] dst The result.
+	\param[in] m0 The first matrix.
+	\param[in] m1 The second matrix.
+*/
+void ref_mat4_multiply_mat4( double *dst, mat4 *m0, mat4 *m1 )
+{
+	unsigned int c = 0, r, k;
+
+	float *a = ( float * )m0,
+		  *b = ( float * )m1;
+
+	while( c != 4 )
+	{
+		r = 0;
+		while( r != 4 )
+		{
+			double s = 0.0;
+
+			k = 0;
+			while( k != 4 )
+			{
+				s += ( double )a[ k * 4 + r ] * b[ c * 4 + k ];
+				++k;
+			}
+
+			dst[ c * 4 + r ] = s;
+			++r;
+		}
+
+		++c;
+	}
+}
+
+
+/*!
+	Function internally used to compute the reference product of a vector by a 4x4 matrix.
+
+	\param[in,out] dst The result.
+	\param[in] v The vector, with n components.
+	\param[in] n The number of components of the vector used (3 or 4).
+	\param[in] m The matrix.
+	\param[in] w The W component of the vector when n is 3.
+*/
+void ref_vec_multiply_mat4( double *dst, float *v, unsigned int n, mat4 *m, float w )
+{
+	unsigned int r = 0;
+
+	float *f = ( float * )m;
+
+	while( r != 4 )
+	{
+		dst[ r ] = ( double )v[ 0 ] * f[ r ] +
+				   ( double )v[ 1 ] * f[ 4 + r ] +
+				   ( double )v[ 2 ] * f[ 8 + r ] +
+				   ( double )( n == 4 ? v[ 3 ] : w ) * f[ 12 + r ];
+		++r;
+	}
+}
+
+
+/*!
+	Function internally used to compute q * v * q' / |q|, the rotation of vec3_rotate_vec4.
+
+	\param[in,out] dst The result.
+	\param[in] v The vector.
+	\param[in] q The quaternion.
+*/
+void ref_vec3_rotate_vec4( double *dst, vec3 *v, vec4 *q )
+{
+	double l = sqrt( ( double )q->x * q->x + ( double )q->y * q->y + ( double )q->z * q->z + ( double )q->w * q->w ),
+		   // t = q * v
+		   tx =  q->w * ( double )v->x + q->y * ( double )v->z - q->z * ( double )v->y,
+		   ty =  q->w * ( double )v->y + q->z * ( double )v->x - q->x * ( double )v->z,
+		   tz =  q->w * ( double )v->z + q->x * ( double )v->y - q->y * ( double )v->x,
+		   tw = -q->x * ( double )v->x - q->y * ( double )v->y - q->z * ( double )v->z,
+		   // The conjugate.
+		   cx = -q->x, cy = -q->y, cz = -q->z, cw = q->w;
+
+	if( !l )
+	{
+		dst[ 0 ] = dst[ 1 ] = dst[ 2 ] = 0.0;
+		return;
+	}
+
+	dst[ 0 ] = ( tw * cx + tx * cw + ty * cz - tz * cy ) / l;
+	dst[ 1 ] = ( tw * cy + ty * cw + tz * cx - tx * cz ) / l;
+	dst[ 2 ] = ( tw * cz + tz * cw + tx * cy - ty * cx ) / l;
+}
+
+
+/*!
+	Function internally used to compute the reference spherical interpolation of two unit
+	quaternions, along the shortest path except at the end points.
+
+	\param[in,out] dst The result.
+	\param[in] q0 The first quaternion.
+	\param[in] q1 The second quaternion.
+	\param[in] t The interpolation factor.
+*/
+void ref_vec4_slerp( double *dst, vec4 *q0, vec4 *q1, float t )
+{
+	double c = ( double )q0->x * q1->x + ( double )q0->y * q1->y + ( double )q0->z * q1->z + ( double )q0->w * q1->w,
+		   s = 1.0,
+		   k0,
+		   k1;
+
+	// Like vec4_slerp, the end points are returned as is.
+	if( t == 0.0f || t == 1.0f )
+	{
+		vec4 *q = t ? q1 : q0;
+
+		dst[ 0 ] = q->x;
+		dst[ 1 ] = q->y;
+		dst[ 2 ] = q->z;
+		dst[ 3 ] = q->w;
+
+		return;
+	}
+
+	if( c < 0.0 )
+	{
+		c = -c;
+		s = -1.0;
+	}
+
+	if( c > 0.999999 )
+	{
+		k0 = 1.0 - t;
+		k1 = t;
+	}
+	else
+	{
+		double o = acos( c );
+
+		k0 = sin( ( 1.0 - t ) * o ) / sin( o );
+		k1 = sin( t * o ) / sin( o );
+	}
+
+	dst[ 0 ] = k0 * q0->x + k1 * s * q1->x;
+	dst[ 1 ] = k0 * q0->y + k1 * s * q1->y;
+	dst[ 2 ] = k0 * q0->z + k1 * s * q1->z;
+	dst[ 3 ] = k0 * q0->w + k1 * s * q1->w;
+}
+
+
+/*!
+	Function internally used to return the largest difference between a float array and its
+	double reference, relative to the largest element of the reference.
+
+	\param[in] f The float array.
+	\param[in] ref The reference array.
+	\param[in] n The number of elements.
+
+	\return Return the relative error.
+*/
+double get_error( float *f, double *ref, unsigned int n )
+{
+	unsigned int i = 0;
+
+	double e = 0.0,
+		   scale = 1.0;
+
+	while( i != n )
+	{
+		e	  = fmax( e, fabs( f[ i ] - ref[ i ] ) );
+		scale = fmax( scale, fabs( ref[ i ] ) );
+		++i;
+	}
+
+	return e / scale;
+}
+
+
+int main( void )
+{
+	unsigned int i,
+				 j;
+
+	double ref[ 16 ],
+		   error[ 8 ] = { 0.0 },
+		   t;
+
+	mat4 *m	 = ( mat4 * ) malloc( N_INPUT * sizeof( mat4 ) ),
+		 *m2 = ( mat4 * ) malloc( N_INPUT * sizeof( mat4 ) ),
+		 r;
+
+	vec4 *q	 = ( vec4 * ) malloc( N_INPUT * sizeof( vec4 ) ),
+		 *v4 = ( vec4 * ) malloc( N_INPUT * sizeof( vec4 ) ),
+		 *r4 = ( vec4 * ) malloc( N_INPUT * sizeof( vec4 ) );
+
+	vec3 *v3 = ( vec3 * ) malloc( N_INPUT * sizeof( vec3 ) ),
+		 *r3 = ( vec3 * ) malloc( N_INPUT * sizeof( vec3 ) );
+
+	i = 0;
+	while( i != N_INPUT )
+	{
+		random_mat4( &m [ i ], i & 1 );
+		random_mat4( &m2[ i ], 0 );
+
+		v3[ i ].x = TEST_random( -10.0f, 10.0f );
+		v3[ i ].y = TEST_random( -10.0f, 10.0f );
+		v3[ i ].z = TEST_random( -10.0f, 10.0f );
+
+		v4[ i ].x = TEST_random( -10.0f, 10.0f );
+		v4[ i ].y = TEST_random( -10.0f, 10.0f );
+		v4[ i ].z = TEST_random( -10.0f, 10.0f );
+		v4[ i ].w = TEST_random( -10.0f, 10.0f );
+
+		q[ i ].x = TEST_random( -1.0f, 1.0f );
+		q[ i ].y = TEST_random( -1.0f, 1.0f );
+		q[ i ].z = TEST_random( -1.0f, 1.0f );
+		q[ i ].w = TEST_random( -1.0f, 1.0f );
+
+		// Non-unit and null quaternions are valid rotations for vec3_rotate_vec4.
+		if( i % 3 ) vec4_normalize( &q[ i ], &q[ i ] );
+
+		if( i == 7 ) q[ i ].x = q[ i ].y = q[ i ].z = q[ i ].w = 0.0f;
+
+		++i;
+	}
+
+
+	i = 0;
+	while( i != N_INPUT )
+	{
+		unsigned int k = ( i + 1 ) % N_INPUT;
+
+		vec3 a3;
+
+		vec4 a4;
+
+		mat4_multiply_mat4( &r, &m[ i ], &m2[ i ] );
+		ref_mat4_multiply_mat4( ref, &m[ i ], &m2[ i ] );
+		error[ 0 ] = fmax( error[ 0 ], get_error( ( float * )&r, ref, 16 ) );
+
+		// The inverse times the matrix must give back the identity.
+		mat4_copy_mat4( &r, &m[ i ] );
+		TEST_CHECK( mat4_invert_full( &r ) );
+		ref_mat4_multiply_mat4( ref, &r, &m[ i ] );
+		j = 0;
+		while( j != 16 )
+		{
+			error[ 1 ] = fmax( error[ 1 ], fabs( ref[ j ] - ( ( j % 5 ) ? 0.0 : 1.0 ) ) );
+			++j;
+		}
+
+		vec4_multiply_mat4( &a4, &v4[ i ], &m[ i ] );
+		ref_vec_multiply_mat4( ref, ( float * )&v4[ i ], 4, &m[ i ], 0.0f );
+		error[ 2 ] = fmax( error[ 2 ], get_error( ( float * )&a4, ref, 4 ) );
+
+		vec3_multiply_mat4( &a3, &v3[ i ], &m[ i ] );
+		ref_vec_multiply_mat4( ref, ( float * )&v3[ i ], 3, &m[ i ], 0.0f );
+		error[ 3 ] = fmax( error[ 3 ], get_error( ( float * )&a3, ref, 3 ) );
+
+		vec3_rotate_vec4( &a3, &v3[ i ], &q[ i ] );
+		ref_vec3_rotate_vec4( ref, &v3[ i ], &q[ i ] );
+		error[ 4 ] = fmax( error[ 4 ], get_error( ( float * )&a3, ref, 3 ) );
+
+		if( i % 3 && k % 3 && i != 7 && k != 7 )
+		{
+			float s = ( float )( i % 11 ) / 10.0f;
+
+			vec4_slerp( &a4, &q[ i ], &q[ k ], s );
+			ref_vec4_slerp( ref, &q[ i ], &q[ k ], s );
+			error[ 5 ] = fmax( error[ 5 ], get_error( ( float * )&a4, ref, 4 ) );
+
+			// Nearly identical quaternions.
+			a4 = q[ i ];
+			a4.x += 0.0001f;
+			vec4_normalize( &a4, &a4 );
+			vec4_slerp( &a4, &q[ i ], &a4, s );
+			ref_vec4_slerp( ref, &q[ i ], &q[ i ], s );
+			error[ 5 ] = fmax( error[ 5 ], get_error( ( float * )&a4, ref, 4 ) - 0.0001 );
+		}
+
+		++i;
+	}
+
+	// The batch functions, including the remainder and in place.
+	vec3_multiply_mat4_array( r3, v3, N_INPUT - 3, &m[ 0 ], 1.0f );
+	vec4_multiply_mat4_array( r4, v4, N_INPUT - 1, &m[ 1 ] );
+
+	i = 0;
+	while( i != N_INPUT - 3 )
+	{
+		ref_vec_multiply_mat4( ref, ( float * )&v3[ i ], 3, &m[ 0 ], 1.0f );
+		error[ 6 ] = fmax( error[ 6 ], get_error( ( float * )&r3[ i ], ref, 3 ) );
+
+		ref_vec_multiply_mat4( ref, ( float * )&v4[ i ], 4, &m[ 1 ], 0.0f );
+		error[ 7 ] = fmax( error[ 7 ], get_error( ( float * )&r4[ i ], ref, 4 ) );
+		++i;
+	}
+
+	memcpy( r3, v3, N_INPUT * sizeof( vec3 ) );
+	vec3_multiply_mat4_array( r3, r3, N_INPUT, &m[ 2 ], 0.0f );
+
+	i = 0;
+	while( i != N_INPUT )
+	{
+		ref_vec_multiply_mat4( ref, ( float * )&v3[ i ], 3, &m[ 2 ], 0.0f );
+		error[ 6 ] = fmax( error[ 6 ], get_error( ( float * )&r3[ i ], ref, 3 ) );
+		++i;
+	}
+
+	printf( "relative errors: mat4_multiply_mat4 %g, mat4_invert_full %g, vec4_multiply_mat4 %g, vec3_multiply_mat4 %g\n"
+			"                 vec3_rotate_vec4 %g, vec4_slerp %g, vec3_multiply_mat4_array %g, vec4_multiply_mat4_array %g\n",
+			error[ 0 ], error[ 1 ], error[ 2 ], error[ 3 ], error[ 4 ], error[ 5 ], error[ 6 ], error[ 7 ] );
+
+	TEST_CHECK( error[ 0 ] < 0.000001 );
+	TEST_CHECK( error[ 1 ] < 0.00001 );
+	TEST_CHECK( error[ 2 ] < 0.000001 );
+	TEST_CHECK( error[ 3 ] < 0.000001 );
+	TEST_CHECK( error[ 4 ] < 0.000001 );
+	TEST_CHECK( error[ 5 ] < 0.00001 );
+	TEST_CHECK( error[ 6 ] < 0.000001 );
+	TEST_CHECK( error[ 7 ] < 0.000001 );
+
+
+	// Cost per call, best of 5 passes over the inputs.
+	{
+		const char *name[ 8 ] = { "mat4_multiply_mat4", "mat4_invert_full", "vec4_multiply_mat4", "vec3_multiply_mat4",
+								  "vec3_rotate_vec4", "vec4_slerp", "vec3_multiply_mat4_array", "vec4_multiply_mat4_array" };
+
+		float sink = 0.0f;
+
+		j = 0;
+		while( j != 8 )
+		{
+			unsigned int pass = 0;
+
+			double best = 0.0;
+
+			while( pass != 5 )
+			{
+				t = TEST_time();
+
+				i = 0;
+				switch( j )
+				{
+					case 0: while( i != N_INPUT ) { mat4_multiply_mat4( &m2[ i ], &m[ i ], &m2[ i ] ); ++i; } break;
+					case 1: while( i != N_INPUT ) { mat4_copy_mat4( &r, &m[ i ] ); mat4_invert_full( &r ); sink += r.m[ 0 ].x; ++i; } break;
+					case 2: while( i != N_INPUT ) { vec4_multiply_mat4( &r4[ i ], &v4[ i ], &m[ i ] ); ++i; } break;
+					case 3: while( i != N_INPUT ) { vec3_multiply_mat4( &r3[ i ], &v3[ i ], &m[ i ] ); ++i; } break;
+					case 4: while( i != N_INPUT ) { vec3_rotate_vec4( &r3[ i ], &v3[ i ], &q[ i ] ); ++i; } break;
+					case 5: while( i != N_INPUT - 1 ) { vec4_slerp( &r4[ i ], &q[ i ], &q[ i + 1 ], 0.3f ); ++i; } break;
+					case 6: vec3_multiply_mat4_array( r3, v3, N_INPUT, &m[ 0 ], 1.0f ); break;
+					case 7: vec4_multiply_mat4_array( r4, v4, N_INPUT, &m[ 0 ] ); break;
+				}
+
+				t = TEST_time() - t;
+
+				if( !pass || t < best ) best = t;
+
+				// Keep the products in range.
+				if( !j ) memcpy( m2, m, N_INPUT * sizeof( mat4 ) );
+
+				++pass;
+			}
+
+			printf( "%-26s %6.2f ns\n", name[ j ], best * 1000000000.0 / N_INPUT );
+
+			++j;
+		}
+
+		sink += r3[ 0 ].x + r4[ 0 ].x + m2[ 0 ].m[ 0 ].x;
+
+		if( sink == 12345.0f ) printf( "\n" );
+	}
+
+	free( r3 );
+	free( v3 );
+	free( r4 );
+	free( v4 );
+	free( q );
+	free( m2 );
+	free( m );
+
+	return TEST_end();
+}